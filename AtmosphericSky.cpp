@@ -0,0 +1,1070 @@
+// Procedural sky : physically based atmospheric scattering instead of the six skybox JPEGs.
+// Transmittance and multiple-scattering LUTs are baked on the CPU across all cores at startup and cached to disk,
+// a small sky-view LUT is re-rendered on the GPU only when the sun moves, and the sky itself is one full-screen
+// triangle drawn after the opaque geometry with GL_LEQUAL.
+// The LightWithAttenuation cubes are lit by the same sun : its color comes from the transmittance LUT and the
+// ambient term from the sky-view LUT, so time of day drives both.
+//
+// LEFT / RIGHT change the time of day, P pauses the day cycle, - / = change exposure
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <glm/detail/setup.hpp>
+#include <glm/glm.hpp>
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include "glm/gtc/matrix_transform.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+using namespace std;
+using namespace glm;
+
+/// Shader helpers : ---- (start)
+int success;
+char infoLog[512];
+
+/// This function will create shaders
+/// @param type Shader type
+/// @param source shader source
+/// @return shader ID
+GLuint compileShader(GLenum type, const GLchar* source) {
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        cout << "Error compiling shader: " << infoLog << endl;
+        return 0;
+    }
+    return shader;
+}
+/// This function will create shader program
+/// @param vertexSource vertex shader source
+/// @param fragmentSource fragment shader source
+/// @return program ID
+GLuint createProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint program = glCreateProgram();
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        cout << "Error linking program: " << infoLog << endl;
+    }
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return  program;
+}
+/// Shader helpers : ---- (end)
+
+/// Camera Structure consisting imp camera properties
+struct Camera {
+    vec3 Position;
+    vec3 Front;
+    vec3 Up;
+    vec3 Right;
+    vec3 WorldUp;
+    float Yaw;
+    float Pitch;
+    float MovementSpeed;
+    float MouseSensitivity;
+    float Zoom;
+};
+
+/// Directions camera will move in
+enum Direction {
+    forwardDir,
+    backwardDir,
+    leftDir,
+    rightDir
+};
+
+/// This function will updates camera vectors
+/// @param camera Camera object.
+void cameraUpdateVectors(Camera* camera) {
+    vec3 front;
+    front.x = cos(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    front.y = sin(radians(camera->Pitch));
+    front.z = sin(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    camera->Front = normalize(front);
+    camera->Right = normalize(cross(camera->Front, camera->WorldUp));
+    camera->Up = normalize(cross(camera->Right, camera->Front));
+}
+
+/// This function will initiate camera
+void cameraInit(Camera* camera, glm::vec3 position, glm::vec3 up, float yaw, float pitch, float movementSpeed, float mouseSensitivity, float zoom) {
+    camera->Position = position;
+    camera->WorldUp = up;
+    camera->Yaw = yaw;
+    camera->Pitch = pitch;
+    camera->MovementSpeed = movementSpeed;
+    camera->MouseSensitivity = mouseSensitivity;
+    camera->Zoom = zoom;
+    cameraUpdateVectors(camera);
+}
+
+/// Returns view matrix according to current camera vectors
+mat4 getCameraViewMatrix(Camera* camera) {
+    return lookAt(camera->Position, camera->Position + camera->Front, camera->Up);
+}
+
+/// Function to process camera inputs
+void cameraProcessKeyboard(Camera* camera, Direction direction, float deltaTime) {
+    float Speed = camera->MovementSpeed * deltaTime;
+    if (direction == forwardDir) {
+        camera->Position += camera->Front * Speed;
+    }
+    else if (direction == backwardDir) {
+        camera->Position -= camera->Front * Speed;
+    }
+    else if (direction == leftDir) {
+        camera->Position -= camera->Right * Speed;
+    }
+    else if (direction == rightDir) {
+        camera->Position += camera->Right * Speed;
+    }
+}
+
+/// Function to process mouse movement
+void cameraProcessMouseMovement(Camera* camera, float xoffset, float yoffset) {
+    xoffset *= camera->MouseSensitivity;
+    yoffset *= camera->MouseSensitivity;
+    camera->Yaw += xoffset;
+    camera->Pitch += yoffset;
+    camera->Pitch = glm::clamp(camera->Pitch, -89.f, 89.f);
+    cameraUpdateVectors(camera);
+}
+
+/// Function to process scroll movements
+void cameraProcessMouseScroll(Camera* camera, float Zoom) {
+    camera->Zoom -= Zoom;
+    if (camera->Zoom <= 1.0f) {camera->Zoom = 1.0f;}
+    else if (camera->Zoom >= 45.0f) {camera->Zoom = 45.0f;}
+}
+
+
+/// Atmosphere model ---------- (start)
+// Earth-like atmosphere, distances in km, coefficients per km.
+// Anything in here changes the baked LUTs, so all of it feeds the cache key.
+struct AtmosphereParams {
+    float bottomRadius = 6360.0f;
+    float topRadius = 6460.0f;
+    vec3 rayleighScattering = vec3(5.802e-3f, 13.558e-3f, 33.1e-3f);
+    float rayleighScaleHeight = 8.0f;
+    float mieScattering = 3.996e-3f;
+    float mieExtinction = 4.440e-3f;
+    float mieScaleHeight = 1.2f;
+    vec3 ozoneAbsorption = vec3(0.650e-3f, 1.881e-3f, 0.085e-3f);
+    float ozoneCenter = 25.0f;      // ozone layer is a tent around this height
+    float ozoneHalfWidth = 15.0f;
+    float groundAlbedo = 0.3f;
+};
+
+constexpr int TRANSMITTANCE_WIDTH = 256;
+constexpr int TRANSMITTANCE_HEIGHT = 64;
+constexpr int MULTI_SCATTERING_SIZE = 32;
+constexpr int SKY_VIEW_WIDTH = 192;
+constexpr int SKY_VIEW_HEIGHT = 108;
+constexpr int TRANSMITTANCE_STEPS = 40;
+constexpr int MULTI_SCATTERING_STEPS = 20;
+constexpr int MULTI_SCATTERING_DIRECTIONS = 64;
+constexpr uint32_t LUT_CACHE_MAGIC = 0x4F4D5441; // "ATMO"
+constexpr uint32_t LUT_CACHE_VERSION = 1;
+const char* LUT_CACHE_PATH = "atmosphere_luts.bin";
+
+const AtmosphereParams atmosphere;
+
+struct MediumSample {
+    vec3 scattering;   // rayleigh + mie
+    vec3 extinction;
+};
+
+MediumSample sampleMedium(float height) {
+    const float rayleighDensity = exp(-height / atmosphere.rayleighScaleHeight);
+    const float mieDensity = exp(-height / atmosphere.mieScaleHeight);
+    const float ozoneDensity = glm::max(0.0f, 1.0f - fabs(height - atmosphere.ozoneCenter) / atmosphere.ozoneHalfWidth);
+    MediumSample medium;
+    medium.scattering = atmosphere.rayleighScattering * rayleighDensity + vec3(atmosphere.mieScattering * mieDensity);
+    medium.extinction = atmosphere.rayleighScattering * rayleighDensity + vec3(atmosphere.mieExtinction * mieDensity)
+                      + atmosphere.ozoneAbsorption * ozoneDensity;
+    return medium;
+}
+
+/// Distance along the ray to the sphere of the given radius (centered on the planet), -1 when it is missed
+float raySphere(const vec3& origin, const vec3& dir, float radius) {
+    const float b = dot(origin, dir);
+    const float c = dot(origin, origin) - radius * radius;
+    const float disc = b * b - c;
+    if (disc < 0.0f) return -1.0f;
+    const float root = std::sqrt(disc);
+    if (-b - root >= 0.0f) return -b - root;
+    if (-b + root >= 0.0f) return -b + root;
+    return -1.0f;
+}
+
+// Transmittance LUT parametrization from Bruneton 2017 : packs resolution towards the horizon.
+// x = view zenith cosine (through the distance to the atmosphere top), y = height
+void transmittanceUvToRMu(float u, float v, float& r, float& mu) {
+    const float Rg = atmosphere.bottomRadius, Rt = atmosphere.topRadius;
+    const float H = std::sqrt(Rt * Rt - Rg * Rg);
+    const float rho = H * v;
+    r = std::sqrt(rho * rho + Rg * Rg);
+    const float dMin = Rt - r;
+    const float dMax = rho + H;
+    const float d = dMin + u * (dMax - dMin);
+    mu = d == 0.0f ? 1.0f : (H * H - rho * rho - d * d) / (2.0f * r * d);
+    mu = glm::clamp(mu, -1.0f, 1.0f);
+}
+
+void transmittanceRMuToUv(float r, float mu, float& u, float& v) {
+    const float Rg = atmosphere.bottomRadius, Rt = atmosphere.topRadius;
+    const float H = std::sqrt(Rt * Rt - Rg * Rg);
+    const float rho = std::sqrt(glm::max(r * r - Rg * Rg, 0.0f));
+    const float disc = r * r * (mu * mu - 1.0f) + Rt * Rt;
+    const float d = glm::max(-r * mu + std::sqrt(glm::max(disc, 0.0f)), 0.0f);
+    const float dMin = Rt - r;
+    const float dMax = rho + H;
+    u = (d - dMin) / (dMax - dMin);
+    v = rho / H;
+}
+
+/// Bilinear lookup in an RGBA float LUT, uv in [0, 1]
+vec3 sampleLut(const std::vector<vec4>& lut, int width, int height, float u, float v) {
+    const float x = glm::clamp(u * width - 0.5f, 0.0f, static_cast<float>(width - 1));
+    const float y = glm::clamp(v * height - 0.5f, 0.0f, static_cast<float>(height - 1));
+    const int x0 = static_cast<int>(x), y0 = static_cast<int>(y);
+    const int x1 = glm::min(x0 + 1, width - 1), y1 = glm::min(y0 + 1, height - 1);
+    const float fx = x - x0, fy = y - y0;
+    const vec3 top = mix(vec3(lut[y0 * width + x0]), vec3(lut[y0 * width + x1]), fx);
+    const vec3 bottom = mix(vec3(lut[y1 * width + x0]), vec3(lut[y1 * width + x1]), fx);
+    return mix(top, bottom, fy);
+}
+
+vec3 lookupTransmittance(const std::vector<vec4>& transmittance, float r, float mu) {
+    float u, v;
+    transmittanceRMuToUv(r, mu, u, v);
+    return sampleLut(transmittance, TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT, u, v);
+}
+
+// Optical depth from (r, mu) to the top of the atmosphere, the ground is ignored here
+vec4 bakeTransmittanceTexel(int x, int y) {
+    float r, mu;
+    transmittanceUvToRMu((x + 0.5f) / TRANSMITTANCE_WIDTH, (y + 0.5f) / TRANSMITTANCE_HEIGHT, r, mu);
+    const vec3 origin(0.0f, r, 0.0f);
+    const vec3 dir(std::sqrt(glm::max(1.0f - mu * mu, 0.0f)), mu, 0.0f);
+    const float distance = raySphere(origin, dir, atmosphere.topRadius);
+    const float dt = glm::max(distance, 0.0f) / TRANSMITTANCE_STEPS;
+    vec3 opticalDepth(0.0f);
+    for (int i = 0; i < TRANSMITTANCE_STEPS; i++) {
+        const vec3 p = origin + dir * ((i + 0.5f) * dt);
+        opticalDepth += sampleMedium(length(p) - atmosphere.bottomRadius).extinction * dt;
+    }
+    return vec4(exp(-opticalDepth), 1.0f);
+}
+
+// Hillaire 2020 multiple scattering : second order luminance L2 and transfer factor f_ms gathered over the sphere,
+// the infinite series of higher orders then collapses to L2 / (1 - f_ms). Stored per unit sun illuminance.
+vec4 bakeMultiScatteringTexel(int x, int y, const std::vector<vec4>& transmittance) {
+    const float sunCos = (x + 0.5f) / MULTI_SCATTERING_SIZE * 2.0f - 1.0f;
+    const float r = atmosphere.bottomRadius + 0.01f + (y + 0.5f) / MULTI_SCATTERING_SIZE * (atmosphere.topRadius - atmosphere.bottomRadius - 0.02f);
+    const vec3 origin(0.0f, r, 0.0f);
+    const vec3 sunDir(std::sqrt(glm::max(1.0f - sunCos * sunCos, 0.0f)), sunCos, 0.0f);
+    const float isotropicPhase = 1.0f / (4.0f * glm::pi<float>());
+
+    vec3 luminanceSum(0.0f), transferSum(0.0f);
+    for (int s = 0; s < MULTI_SCATTERING_DIRECTIONS; s++) {
+        // Fibonacci sphere : evenly spread directions without clumping at the poles
+        const float z = 1.0f - 2.0f * (s + 0.5f) / MULTI_SCATTERING_DIRECTIONS;
+        const float phi = s * 2.39996323f;
+        const float ring = std::sqrt(1.0f - z * z);
+        const vec3 dir(ring * cos(phi), z, ring * sin(phi));
+
+        const float groundDistance = raySphere(origin, dir, atmosphere.bottomRadius);
+        const bool hitsGround = groundDistance > 0.0f;
+        const float distance = hitsGround ? groundDistance : raySphere(origin, dir, atmosphere.topRadius);
+        const float dt = glm::max(distance, 0.0f) / MULTI_SCATTERING_STEPS;
+
+        vec3 throughput(1.0f), luminance(0.0f), transfer(0.0f);
+        for (int i = 0; i < MULTI_SCATTERING_STEPS; i++) {
+            const vec3 p = origin + dir * ((i + 0.5f) * dt);
+            const float pr = length(p);
+            const MediumSample medium = sampleMedium(pr - atmosphere.bottomRadius);
+            const vec3 stepTransmittance = exp(-medium.extinction * dt);
+
+            const vec3 up = p / pr;
+            const float sunVisible = raySphere(p, sunDir, atmosphere.bottomRadius) > 0.0f ? 0.0f : 1.0f;
+            const vec3 sunTransmittance = lookupTransmittance(transmittance, pr, dot(up, sunDir)) * sunVisible;
+            const vec3 inScatter = medium.scattering * sunTransmittance * isotropicPhase;
+
+            // Energy conserving integration of a constant source over the step (Hillaire 2015)
+            const vec3 safeExtinction = glm::max(medium.extinction, vec3(1e-7f));
+            luminance += throughput * (inScatter - inScatter * stepTransmittance) / safeExtinction;
+            transfer += throughput * (medium.scattering - medium.scattering * stepTransmittance) / safeExtinction;
+            throughput *= stepTransmittance;
+        }
+        if (hitsGround) {
+            const vec3 groundPoint = origin + dir * groundDistance;
+            const vec3 normal = normalize(groundPoint);
+            const float sunCosGround = dot(normal, sunDir);
+            const vec3 sunAtGround = lookupTransmittance(transmittance, atmosphere.bottomRadius, sunCosGround);
+            luminance += throughput * sunAtGround * glm::max(sunCosGround, 0.0f) * atmosphere.groundAlbedo / glm::pi<float>();
+        }
+        luminanceSum += luminance;
+        transferSum += transfer;
+    }
+
+    // Uniform sphere sampling with an isotropic phase : the estimates are plain averages
+    const vec3 secondOrder = luminanceSum / static_cast<float>(MULTI_SCATTERING_DIRECTIONS);
+    const vec3 transferFactor = transferSum / static_cast<float>(MULTI_SCATTERING_DIRECTIONS);
+    return vec4(secondOrder / (vec3(1.0f) - transferFactor), 1.0f);
+}
+
+/// Runs bake(x, y) for every texel, rows interleaved across the hardware threads
+template <typename Bake>
+void bakeParallel(std::vector<vec4>& lut, int width, int height, Bake bake) {
+    const unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; t++) {
+        workers.emplace_back([&, t]() {
+            for (int y = static_cast<int>(t); y < height; y += static_cast<int>(threadCount)) {
+                for (int x = 0; x < width; x++) lut[y * width + x] = bake(x, y);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+// FNV-1a over the parameters and LUT layout : any change invalidates the cache file
+uint64_t atmosphereCacheKey() {
+    uint64_t hash = 1469598103934665603ull;
+    auto feed = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) { hash ^= bytes[i]; hash *= 1099511628211ull; }
+    };
+    feed(&atmosphere, sizeof(atmosphere));
+    const int layout[] = {TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT, MULTI_SCATTERING_SIZE,
+                          TRANSMITTANCE_STEPS, MULTI_SCATTERING_STEPS, MULTI_SCATTERING_DIRECTIONS};
+    feed(layout, sizeof(layout));
+    return hash;
+}
+
+struct LutCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+};
+
+bool loadLutCache(std::vector<vec4>& transmittance, std::vector<vec4>& multiScattering) {
+    std::ifstream file(LUT_CACHE_PATH, std::ios::binary);
+    if (!file) return false;
+    LutCacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != LUT_CACHE_MAGIC || header.version != LUT_CACHE_VERSION || header.key != atmosphereCacheKey()) return false;
+    file.read(reinterpret_cast<char*>(transmittance.data()), static_cast<std::streamsize>(transmittance.size() * sizeof(vec4)));
+    file.read(reinterpret_cast<char*>(multiScattering.data()), static_cast<std::streamsize>(multiScattering.size() * sizeof(vec4)));
+    return static_cast<bool>(file);
+}
+
+void saveLutCache(const std::vector<vec4>& transmittance, const std::vector<vec4>& multiScattering) {
+    std::ofstream file(LUT_CACHE_PATH, std::ios::binary);
+    if (!file) {
+        cout << "Could not write " << LUT_CACHE_PATH << endl;
+        return;
+    }
+    const LutCacheHeader header{LUT_CACHE_MAGIC, LUT_CACHE_VERSION, atmosphereCacheKey()};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(transmittance.data()), static_cast<std::streamsize>(transmittance.size() * sizeof(vec4)));
+    file.write(reinterpret_cast<const char*>(multiScattering.data()), static_cast<std::streamsize>(multiScattering.size() * sizeof(vec4)));
+}
+
+GLuint createLutTexture(int width, int height, const vec4* data) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+/// Sun direction for an hour of the day : rises in the east (+x), peaks at 60 degrees, sets in the west
+vec3 sunDirectionForTime(float hours) {
+    const float dayAngle = (hours - 6.0f) / 12.0f * glm::pi<float>();
+    const float elevation = sin(dayAngle) * glm::radians(60.0f);
+    const vec2 horizontal = normalize(vec2(cos(dayAngle), -0.5f * sin(dayAngle)));
+    return normalize(vec3(horizontal.x * cos(elevation), sin(elevation), horizontal.y * cos(elevation)));
+}
+/// Atmosphere model ---------- (end)
+
+
+/// Shaders ---------- (start)
+// Constants and LUT mappings shared by the sky shaders, must match the CPU side above
+const std::string atmosphereCommonGLSL = R"(
+const float PI = 3.14159265;
+const float BOTTOM_RADIUS = 6360.0;
+const float TOP_RADIUS = 6460.0;
+const vec3 RAYLEIGH_SCATTERING = vec3(5.802e-3, 13.558e-3, 33.1e-3);
+const float RAYLEIGH_SCALE_HEIGHT = 8.0;
+const float MIE_SCATTERING = 3.996e-3;
+const float MIE_EXTINCTION = 4.440e-3;
+const float MIE_SCALE_HEIGHT = 1.2;
+const float MIE_G = 0.8;
+const vec3 OZONE_ABSORPTION = vec3(0.650e-3, 1.881e-3, 0.085e-3);
+
+uniform sampler2D transmittanceLut;
+uniform sampler2D multiScatteringLut;
+
+float raySphere(vec3 origin, vec3 dir, float radius) {
+    float b = dot(origin, dir);
+    float c = dot(origin, origin) - radius * radius;
+    float disc = b * b - c;
+    if (disc < 0.0) return -1.0;
+    float root = sqrt(disc);
+    if (-b - root >= 0.0) return -b - root;
+    if (-b + root >= 0.0) return -b + root;
+    return -1.0;
+}
+
+vec3 transmittanceToTop(float r, float mu) {
+    float H = sqrt(TOP_RADIUS * TOP_RADIUS - BOTTOM_RADIUS * BOTTOM_RADIUS);
+    float rho = sqrt(max(r * r - BOTTOM_RADIUS * BOTTOM_RADIUS, 0.0));
+    float disc = r * r * (mu * mu - 1.0) + TOP_RADIUS * TOP_RADIUS;
+    float d = max(-r * mu + sqrt(max(disc, 0.0)), 0.0);
+    float dMin = TOP_RADIUS - r;
+    float dMax = rho + H;
+    return texture(transmittanceLut, vec2((d - dMin) / (dMax - dMin), rho / H)).rgb;
+}
+
+vec3 multiScattering(float r, float sunCos) {
+    vec2 uv = vec2(sunCos * 0.5 + 0.5, (r - BOTTOM_RADIUS) / (TOP_RADIUS - BOTTOM_RADIUS));
+    return texture(multiScatteringLut, uv).rgb;
+}
+
+// Sky-view LUT : x = azimuth from the sun (0..pi, the sky is symmetric around the sun's vertical plane),
+// y = elevation with resolution packed around the horizon
+vec2 skyViewUv(vec3 dir, vec3 sunDir) {
+    float elevation = asin(clamp(dir.y, -1.0, 1.0));
+    float v = 0.5 + 0.5 * sign(elevation) * sqrt(abs(elevation) / (0.5 * PI));
+    vec2 flatDir = dir.xz, flatSun = sunDir.xz;
+    float cosAzimuth = (length(flatDir) > 1e-4 && length(flatSun) > 1e-4) ? dot(normalize(flatDir), normalize(flatSun)) : 1.0;
+    float u = acos(clamp(cosAzimuth, -1.0, 1.0)) / PI;
+    return vec2(u, v);
+}
+
+vec3 tonemap(vec3 color, float exposure) {
+    return pow(vec3(1.0) - exp(-color * exposure), vec3(1.0 / 2.2));
+}
+)";
+
+const char* fullScreenVertexShader = R"(
+#version 410 core
+out vec2 uv;
+void main()
+{
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = p;
+    // On the far plane so the sky only fills what the geometry left (GL_LEQUAL)
+    gl_Position = vec4(p * 2.0 - 1.0, 1.0, 1.0);
+}
+)";
+
+// Single scattering from the sun plus the multiple scattering LUT, marched once per LUT texel
+const std::string skyViewFragmentShader = std::string(R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform vec3 sunDir;
+uniform float cameraRadius;
+uniform float sunIlluminance;
+)") + atmosphereCommonGLSL + R"(
+const int SKY_STEPS = 30;
+
+void main()
+{
+    // Inverse of skyViewUv, built in a frame whose azimuth 0 faces the sun
+    float centered = uv.y * 2.0 - 1.0;
+    float elevation = sign(centered) * centered * centered * 0.5 * PI;
+    float azimuth = uv.x * PI;
+    vec2 sunFlat = length(sunDir.xz) > 1e-4 ? normalize(sunDir.xz) : vec2(1.0, 0.0);
+    vec2 sideFlat = vec2(-sunFlat.y, sunFlat.x);
+    vec2 flatDir = sunFlat * cos(azimuth) + sideFlat * sin(azimuth);
+    vec3 dir = vec3(flatDir.x * cos(elevation), sin(elevation), flatDir.y * cos(elevation));
+
+    vec3 origin = vec3(0.0, cameraRadius, 0.0);
+    float groundDistance = raySphere(origin, dir, BOTTOM_RADIUS);
+    float distance = groundDistance > 0.0 ? groundDistance : raySphere(origin, dir, TOP_RADIUS);
+
+    float cosTheta = dot(dir, sunDir);
+    float rayleighPhase = 3.0 / (16.0 * PI) * (1.0 + cosTheta * cosTheta);
+    float g2 = MIE_G * MIE_G;
+    float miePhase = 3.0 / (8.0 * PI) * ((1.0 - g2) * (1.0 + cosTheta * cosTheta)) / ((2.0 + g2) * pow(1.0 + g2 - 2.0 * MIE_G * cosTheta, 1.5));
+
+    vec3 throughput = vec3(1.0), luminance = vec3(0.0);
+    float previousT = 0.0;
+    for (int i = 0; i < SKY_STEPS; i++) {
+        // Quadratic step distribution : short steps close to the camera where density changes fastest
+        float t = distance * pow((float(i) + 0.5) / float(SKY_STEPS), 2.0);
+        float dt = distance * pow((float(i) + 1.0) / float(SKY_STEPS), 2.0) - previousT;
+        previousT += dt;
+        vec3 p = origin + dir * t;
+        float r = length(p);
+        float height = r - BOTTOM_RADIUS;
+
+        float rayleighDensity = exp(-height / RAYLEIGH_SCALE_HEIGHT);
+        float mieDensity = exp(-height / MIE_SCALE_HEIGHT);
+        float ozoneDensity = max(0.0, 1.0 - abs(height - 25.0) / 15.0);
+        vec3 rayleigh = RAYLEIGH_SCATTERING * rayleighDensity;
+        float mie = MIE_SCATTERING * mieDensity;
+        vec3 extinction = rayleigh + MIE_EXTINCTION * mieDensity + OZONE_ABSORPTION * ozoneDensity;
+
+        float sunCos = dot(p / r, sunDir);
+        float sunVisible = raySphere(p, sunDir, BOTTOM_RADIUS) > 0.0 ? 0.0 : 1.0;
+        vec3 sunLight = transmittanceToTop(r, sunCos) * sunVisible;
+        vec3 inScatter = (rayleigh * rayleighPhase + mie * miePhase) * sunLight + (rayleigh + mie) * multiScattering(r, sunCos);
+
+        vec3 stepTransmittance = exp(-extinction * dt);
+        luminance += throughput * (inScatter - inScatter * stepTransmittance) / max(extinction, vec3(1e-7));
+        throughput *= stepTransmittance;
+    }
+    FragColor = vec4(luminance * sunIlluminance, 1.0);
+}
+)";
+
+const std::string skyFragmentShader = std::string(R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D skyViewLut;
+uniform mat4 invViewProjection;  // rotation-only view
+uniform vec3 sunDir;
+uniform float cameraRadius;
+uniform float sunIlluminance;
+uniform float exposure;
+)") + atmosphereCommonGLSL + R"(
+const float SUN_COS_RADIUS = 0.99998930; // cos(0.265 degrees)
+
+void main()
+{
+    vec4 world = invViewProjection * vec4(uv * 2.0 - 1.0, 1.0, 1.0);
+    vec3 dir = normalize(world.xyz / world.w);
+    vec3 color = textureLod(skyViewLut, skyViewUv(dir, sunDir), 0.0).rgb;
+
+    // Sun disk, dimmed by the same transmittance that colors the scene light
+    if (dot(dir, sunDir) > SUN_COS_RADIUS && raySphere(vec3(0.0, cameraRadius, 0.0), dir, BOTTOM_RADIUS) < 0.0) {
+        color += transmittanceToTop(cameraRadius, dir.y) * sunIlluminance * 20.0;
+    }
+    FragColor = vec4(tonemap(color, exposure), 1.0);
+}
+)";
+
+/// Shader to render objects lit by the sun ---- (start)
+const char* cubeObjectVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+const std::string cubeObjectFragmentShader = std::string(R"(
+#version 410 core
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform vec3 sunDir;
+uniform vec3 sunColor;          // illuminance reaching the ground, already attenuated by the atmosphere
+uniform sampler2D skyViewLut;   // its smallest mip is the average sky radiance
+uniform float exposure;
+)") + atmosphereCommonGLSL + R"(
+void main()
+{
+    vec3 albedo = vec3(texture(material.diffuse, TexCoords));
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+
+    // Irradiance from a uniform sky is PI * radiance, the lambert BRDF divides it back out; small floor for the night
+    vec3 skyAverage = textureLod(skyViewLut, vec2(0.5), 16.0).rgb;
+    vec3 ambient = (skyAverage + vec3(0.002)) * albedo;
+
+    float diff = max(dot(norm, sunDir), 0.0);
+    vec3 diffuse = sunColor * diff * albedo / PI;
+
+    vec3 halfwayDir = normalize(sunDir + viewDir);
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), material.shininess);
+    vec3 specular = sunColor * spec * vec3(texture(material.specular, TexCoords)) * diff;
+
+    FragColor = vec4(tonemap(ambient + diffuse + specular, exposure), 1.0);
+}
+)";
+/// Shader to render objects lit by the sun ---- (end)
+/// Shaders ---------- (end)
+
+/// Texture helpers ---------- (start)
+GLuint loadTexture(const char* path) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    int width, height, channels;
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if (data) {
+        GLenum format = GL_RGBA;
+        if (channels == 1) { format = GL_RED; }
+        else if (channels == 3) { format = GL_RGB; }
+        else if (channels == 4) { format = GL_RGBA; }
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    } else {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+
+    stbi_image_free(data);
+    return texture;
+}
+/// Texture helpers ---------- (end)
+
+
+/// App Global --- (start)
+int SCR_WIDTH;
+int SCR_HEIGHT;
+
+Camera camera;
+float lastX;
+float lastY;
+bool firstMouse = true;
+
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+float timeOfDay = 7.0f;         // hours
+bool dayCyclePaused = false;
+constexpr float DAY_CYCLE_SPEED = 0.25f; // hours per second
+constexpr float SUN_ILLUMINANCE = 1.0f;
+float exposure = 10.0f;
+
+// Scene units are meters, the atmosphere works in km above the planet surface
+constexpr float CAMERA_GROUND_HEIGHT_KM = 0.2f;
+/// App Global --- (end)
+
+/// Callbacks ---- (start)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, GLdouble xPos, GLdouble yPos);
+void scroll_callback(GLFWwindow* window, GLdouble xOffset, GLdouble yOffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void ProcessInput(GLFWwindow* window);
+/// Callbacks ---- (end)
+
+int main() {
+    // LUTs first : the bake needs no GL context, so it is timed on its own
+    std::vector<vec4> transmittance(TRANSMITTANCE_WIDTH * TRANSMITTANCE_HEIGHT);
+    std::vector<vec4> multiScatteringData(MULTI_SCATTERING_SIZE * MULTI_SCATTERING_SIZE);
+    const auto bakeStart = std::chrono::high_resolution_clock::now();
+    if (loadLutCache(transmittance, multiScatteringData)) {
+        cout << "Atmosphere LUTs loaded from " << LUT_CACHE_PATH << " in "
+             << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - bakeStart).count() << " ms" << endl;
+    } else {
+        bakeParallel(transmittance, TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT, bakeTransmittanceTexel);
+        bakeParallel(multiScatteringData, MULTI_SCATTERING_SIZE, MULTI_SCATTERING_SIZE,
+                     [&transmittance](int x, int y) { return bakeMultiScatteringTexel(x, y, transmittance); });
+        saveLutCache(transmittance, multiScatteringData);
+        cout << "Atmosphere LUTs baked on " << std::max(1u, std::thread::hardware_concurrency()) << " threads in "
+             << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - bakeStart).count() << " ms" << endl;
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Atmospheric sky", monitor, nullptr);
+    glfwMakeContextCurrent(window);
+
+    lastX = mode->width / 2.0f;
+    lastY = mode->height / 2.0f;
+
+    camera = Camera();
+    cameraInit(&camera, vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 10.0f, 2.0f, 0.2f, 45.0f);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialise GLAD" << std::endl;
+        return -1;
+    }
+
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+
+    // Callbacks
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+
+    GLuint cubeObjectProgram = createProgram(cubeObjectVertexShader, cubeObjectFragmentShader.c_str());
+    GLuint skyViewProgram = createProgram(fullScreenVertexShader, skyViewFragmentShader.c_str());
+    GLuint skyProgram = createProgram(fullScreenVertexShader, skyFragmentShader.c_str());
+
+    // cube vertex data
+    float vertices[] = {
+        // positions          // normals           // tex coords
+        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+         0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,0.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+        -0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+
+        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+        -0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,1.0f,
+        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+
+        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+        -0.5f, 0.5f,-0.5f,  -1.0f,0.0f,0.0f,      1.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+        -0.5f,-0.5f, 0.5f,  -1.0f,0.0f,0.0f,      0.0f,0.0f,
+        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+         0.5f, 0.5f,-0.5f,   1.0f,0.0f,0.0f,      1.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+         0.5f,-0.5f, 0.5f,   1.0f,0.0f,0.0f,      0.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     1.0f,1.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+        -0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     0.0f,0.0f,
+        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+
+        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      1.0f,1.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+        -0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      0.0f,0.0f,
+        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f
+    };
+
+    glm::vec3 cubePositions[20] = {
+        glm::vec3( 0.0f,  0.0f,   0.0f),
+        glm::vec3( 2.0f,  5.0f,  -6.0f),
+        glm::vec3(-1.5f, -2.2f,  -1.0f),
+        glm::vec3(-3.8f, -2.0f,  -5.0f),
+        glm::vec3( 2.4f, -0.4f,  -1.5f),
+        glm::vec3(-1.7f,  3.0f,  -3.0f),
+        glm::vec3( 1.3f, -2.0f,  -1.0f),
+        glm::vec3( 1.5f,  2.0f,  -1.0f),
+        glm::vec3( 1.5f,  0.2f,  -0.6f),
+        glm::vec3(-1.3f,  1.0f,  -0.6f),
+
+        glm::vec3( 4.0f,  3.0f,  -8.0f),
+        glm::vec3(-4.0f, -3.0f,  -7.0f),
+        glm::vec3( 6.0f,  1.0f, -10.0f),
+        glm::vec3(-6.0f,  2.0f,  -9.0f),
+        glm::vec3( 0.0f,  6.0f, -12.0f),
+        glm::vec3( 3.0f, -4.0f, -11.0f),
+        glm::vec3(-3.0f,  4.0f, -10.5f),
+        glm::vec3( 5.5f, -1.0f, -9.5f),
+        glm::vec3(-5.5f,  2.5f, -10.8f),
+        glm::vec3( 0.0f, -5.0f, -14.0f)
+    };
+
+    GLuint VBO, cubeVAO, emptyVAO;
+    glGenVertexArrays(1, &cubeVAO);
+    glBindVertexArray(cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // Full screen passes generate their triangle from gl_VertexID
+    glGenVertexArrays(1, &emptyVAO);
+
+    stbi_set_flip_vertically_on_load(true);
+    GLuint diffuseMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2-2.png");
+    GLuint specularMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2_specular-2.png");
+
+    // --- Atmosphere textures ---
+    GLuint transmittanceTex = createLutTexture(TRANSMITTANCE_WIDTH, TRANSMITTANCE_HEIGHT, transmittance.data());
+    GLuint multiScatteringTex = createLutTexture(MULTI_SCATTERING_SIZE, MULTI_SCATTERING_SIZE, multiScatteringData.data());
+
+    // Sky-view LUT is mipmapped : the last level is the ambient term for the scene
+    GLuint skyViewTex = createLutTexture(SKY_VIEW_WIDTH, SKY_VIEW_HEIGHT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GLuint skyViewFBO;
+    glGenFramebuffers(1, &skyViewFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, skyViewFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, skyViewTex, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cout << "Sky-view framebuffer incomplete" << endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Texture units : 0/1 material, 2 transmittance, 3 multiple scattering, 4 sky view
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, transmittanceTex);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, multiScatteringTex);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D, skyViewTex);
+    glActiveTexture(GL_TEXTURE0);
+
+    for (GLuint program : {cubeObjectProgram, skyViewProgram, skyProgram}) {
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "transmittanceLut"), 2);
+        glUniform1i(glGetUniformLocation(program, "multiScatteringLut"), 3);
+        glUniform1i(glGetUniformLocation(program, "skyViewLut"), 4);
+    }
+
+    glUseProgram(cubeObjectProgram);
+    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.diffuse"), 0);
+    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.specular"), 1);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "material.shininess"), 512.0f);
+    GLint ViewPosition = glGetUniformLocation(cubeObjectProgram, "viewPos");
+    GLint CubeProjection = glGetUniformLocation(cubeObjectProgram, "projection");
+    GLint CubeView = glGetUniformLocation(cubeObjectProgram, "view");
+    GLint CubeModel = glGetUniformLocation(cubeObjectProgram, "model");
+    GLint CubeSunDir = glGetUniformLocation(cubeObjectProgram, "sunDir");
+    GLint CubeSunColor = glGetUniformLocation(cubeObjectProgram, "sunColor");
+    GLint CubeExposure = glGetUniformLocation(cubeObjectProgram, "exposure");
+
+    GLint SkyViewSunDir = glGetUniformLocation(skyViewProgram, "sunDir");
+    GLint SkyViewCameraRadius = glGetUniformLocation(skyViewProgram, "cameraRadius");
+    GLint SkyViewIlluminance = glGetUniformLocation(skyViewProgram, "sunIlluminance");
+
+    GLint SkyInvViewProjection = glGetUniformLocation(skyProgram, "invViewProjection");
+    GLint SkySunDir = glGetUniformLocation(skyProgram, "sunDir");
+    GLint SkyCameraRadius = glGetUniformLocation(skyProgram, "cameraRadius");
+    GLint SkyIlluminance = glGetUniformLocation(skyProgram, "sunIlluminance");
+    GLint SkyExposure = glGetUniformLocation(skyProgram, "exposure");
+
+    vec3 renderedSunDir(0.0f);
+    float renderedCameraRadius = 0.0f;
+    int skyViewUpdates = 0;
+    float lastStatsTime = 0.0f;
+
+    while (!glfwWindowShouldClose(window)) {
+        float currentFrame = glfwGetTime();
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        ProcessInput(window);
+
+        if (!dayCyclePaused) timeOfDay = fmod(timeOfDay + deltaTime * DAY_CYCLE_SPEED, 24.0f);
+        const vec3 sunDir = sunDirectionForTime(timeOfDay);
+        const float cameraRadius = atmosphere.bottomRadius + CAMERA_GROUND_HEIGHT_KM + glm::max(camera.Position.y, 0.0f) * 0.001f;
+
+        // --- Sky-view LUT : only when the sun or the camera height actually moved ---
+        if (dot(sunDir, renderedSunDir) < 0.9999999f || fabs(cameraRadius - renderedCameraRadius) > 0.001f) {
+            glBindFramebuffer(GL_FRAMEBUFFER, skyViewFBO);
+            glViewport(0, 0, SKY_VIEW_WIDTH, SKY_VIEW_HEIGHT);
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(skyViewProgram);
+            glUniform3fv(SkyViewSunDir, 1, value_ptr(sunDir));
+            glUniform1f(SkyViewCameraRadius, cameraRadius);
+            glUniform1f(SkyViewIlluminance, SUN_ILLUMINANCE);
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+            glEnable(GL_DEPTH_TEST);
+
+            glActiveTexture(GL_TEXTURE4);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glActiveTexture(GL_TEXTURE0);
+
+            renderedSunDir = sunDir;
+            renderedCameraRadius = cameraRadius;
+            skyViewUpdates++;
+        }
+
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT), 0.1f, 1000.0f);
+        glm::mat4 view = getCameraViewMatrix(&camera);
+
+        // Sun light at the camera : what the transmittance LUT lets through, nothing once it is below the horizon
+        const float horizonVisible = raySphere(vec3(0.0f, cameraRadius, 0.0f), sunDir, atmosphere.bottomRadius) > 0.0f ? 0.0f : 1.0f;
+        const vec3 sunColor = lookupTransmittance(transmittance, cameraRadius, sunDir.y) * SUN_ILLUMINANCE * horizonVisible;
+
+        // --- Opaque cubes ---
+        glUseProgram(cubeObjectProgram);
+        glUniform3fv(ViewPosition, 1, value_ptr(camera.Position));
+        glUniform3fv(CubeSunDir, 1, value_ptr(sunDir));
+        glUniform3fv(CubeSunColor, 1, value_ptr(sunColor));
+        glUniform1f(CubeExposure, exposure);
+        glUniformMatrix4fv(CubeProjection, 1, GL_FALSE, value_ptr(projection));
+        glUniformMatrix4fv(CubeView, 1, GL_FALSE, value_ptr(view));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, diffuseMap);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, specularMap);
+        glActiveTexture(GL_TEXTURE0);
+        glBindVertexArray(cubeVAO);
+        for (unsigned int i = 0; i < 20; i++) {
+            const float angle = 2.0f * i * glfwGetTime();
+            glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+            model = glm::translate(model, cubePositions[i]);
+            glUniformMatrix4fv(CubeModel, 1, GL_FALSE, value_ptr(model));
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        // --- Sky last : one triangle on the far plane, only where nothing was drawn ---
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_LEQUAL);
+        glUseProgram(skyProgram);
+        const glm::mat4 skyViewProjection = projection * glm::mat4(glm::mat3(view)); // remove translation
+        glUniformMatrix4fv(SkyInvViewProjection, 1, GL_FALSE, value_ptr(glm::inverse(skyViewProjection)));
+        glUniform3fv(SkySunDir, 1, value_ptr(sunDir));
+        glUniform1f(SkyCameraRadius, cameraRadius);
+        glUniform1f(SkyIlluminance, SUN_ILLUMINANCE);
+        glUniform1f(SkyExposure, exposure);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        if (currentFrame - lastStatsTime >= 2.0f) {
+            cout << "Time " << static_cast<int>(timeOfDay) << ":" << static_cast<int>(fmod(timeOfDay, 1.0f) * 60.0f)
+                 << " | sun elevation " << glm::degrees(asin(sunDir.y)) << " deg | sky-view LUT updates " << skyViewUpdates << endl;
+            skyViewUpdates = 0;
+            lastStatsTime = currentFrame;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteFramebuffers(1, &skyViewFBO);
+    glDeleteTextures(1, &transmittanceTex);
+    glDeleteTextures(1, &multiScatteringTex);
+    glDeleteTextures(1, &skyViewTex);
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteProgram(cubeObjectProgram);
+    glDeleteProgram(skyViewProgram);
+    glDeleteProgram(skyProgram);
+
+    glfwTerminate();
+    return 0;
+}
+
+void ProcessInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, forwardDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, backwardDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, leftDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, rightDir, deltaTime);
+
+    // Time of day scrubbing, two hours per second
+    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+        timeOfDay = fmod(timeOfDay + deltaTime * 2.0f, 24.0f);
+    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+        timeOfDay = fmod(timeOfDay - deltaTime * 2.0f + 24.0f, 24.0f);
+}
+
+void key_callback(GLFWwindow*, int key, int, int action, int)
+{
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_P) dayCyclePaused = !dayCyclePaused;
+    if (key == GLFW_KEY_MINUS) exposure = glm::max(exposure * 0.5f, 0.25f);
+    if (key == GLFW_KEY_EQUAL) exposure = glm::min(exposure * 2.0f, 256.0f);
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int, int)
+{
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+}
+
+void mouse_callback(GLFWwindow* window, const double xPos, const double yPos)
+{
+    const auto xpos = static_cast<float>(xPos);
+    const auto ypos = static_cast<float>(yPos);
+    if (firstMouse) {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+    float xOffset = xpos - lastX;
+    float yOffset = lastY - ypos; // reversed
+    lastX = xpos;
+    lastY = ypos;
+    cameraProcessMouseMovement(&camera, xOffset, yOffset);
+}
+
+void scroll_callback(GLFWwindow*, double, const double yOffset)
+{
+    cameraProcessMouseScroll(&camera, static_cast<float>(yOffset));
+}
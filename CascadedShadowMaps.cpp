@@ -0,0 +1,806 @@
+// Cascaded shadow maps : an outdoor field of cubes lit by a directional sun.
+// Practical split scheme, sphere-fit cascades snapped to shadow-map texels so they do not shimmer,
+// one instanced draw per cascade, and cascades whose projection and casters are unchanged keep last frame's map.
+//
+// Arrows move the sun, T animates it, M toggles moving cubes, C colours the cascades.
+
+#include <cmath>
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "GpuProfiler.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+/// Defining Globals variable ---- (start)
+/// Camera
+constexpr float CAMERA_SPEED = 8.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// Scene
+constexpr int NUM_STATIC_CUBES = 600;
+constexpr int NUM_MOVING_CUBES = 12;
+constexpr float FIELD_EXTENT = 120.0f;
+
+/// Shadows
+constexpr int NUM_CASCADES = 4;
+constexpr int SHADOW_MAP_SIZE = 2048;
+/// Shadows stop at this view distance
+constexpr float SHADOW_DISTANCE = 150.0f;
+/// 0 = uniform splits, 1 = logarithmic splits
+constexpr float SPLIT_LAMBDA = 0.75f;
+/// How far behind a cascade (towards the sun) casters are still captured
+constexpr float CASTER_EXTENT = 100.0f;
+
+bool bAnimateSun = false;
+bool bMoveCubes = true;
+bool bShowCascades = false;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 6.0f, 30.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = -10.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() { updateVectors(); }
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe, dir.z : forward, dir.y : world vertical
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(glm::radians(FOV), aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles vertex and fragment shader from raw GLSL source strings, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource) {
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets an array of 4x4 matrices (one light view-projection per cascade).
+    void setMat4Array(const char* uniform, const glm::mat4* mats, const int count) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), count, GL_FALSE, glm::value_ptr(mats[0]));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a float array uniform (split distances, texel sizes).
+    void setFloatArray(const char* uniform, const float* vals, const int count) const {
+        glUniform1fv(glGetUniformLocation(ProgramID, uniform), count, vals);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVBO = 0;
+
+float cubeData[216] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1,   0.5f, 0.5f,-0.5f, 0,0,-1,   0.5f,-0.5f,-0.5f, 0,0,-1,
+     0.5f, 0.5f,-0.5f, 0,0,-1,  -0.5f,-0.5f,-0.5f, 0,0,-1,  -0.5f, 0.5f,-0.5f, 0,0,-1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1,   0.5f,-0.5f, 0.5f, 0,0, 1,   0.5f, 0.5f, 0.5f, 0,0, 1,
+     0.5f, 0.5f, 0.5f, 0,0, 1,  -0.5f, 0.5f, 0.5f, 0,0, 1,  -0.5f,-0.5f, 0.5f, 0,0, 1,
+    -0.5f, 0.5f, 0.5f,-1,0, 0,  -0.5f,-0.5f,-0.5f,-1,0, 0,  -0.5f, 0.5f,-0.5f,-1,0, 0,
+    -0.5f,-0.5f,-0.5f,-1,0, 0,  -0.5f, 0.5f, 0.5f,-1,0, 0,  -0.5f,-0.5f, 0.5f,-1,0, 0,
+     0.5f, 0.5f, 0.5f, 1,0, 0,   0.5f,-0.5f,-0.5f, 1,0, 0,   0.5f, 0.5f,-0.5f, 1,0, 0,
+     0.5f,-0.5f,-0.5f, 1,0, 0,   0.5f, 0.5f, 0.5f, 1,0, 0,   0.5f,-0.5f, 0.5f, 1,0, 0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0,   0.5f,-0.5f,-0.5f, 0,-1,0,   0.5f,-0.5f, 0.5f, 0,-1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0,  -0.5f,-0.5f,-0.5f, 0,-1,0,
+    -0.5f, 0.5f,-0.5f, 0, 1,0,   0.5f, 0.5f, 0.5f, 0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0,
+     0.5f, 0.5f, 0.5f, 0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0,  -0.5f, 0.5f, 0.5f, 0, 1,0
+};
+
+// Cube VAO with per-instance attributes : model matrix at locations 2-5, and color at 6 when withColor is set.
+// Instance data is tightly packed, so the stride is the matrix alone or matrix + color.
+GLuint createInstancedCubeVAO(GLuint instanceBuffer, bool withColor) {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,6*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,6*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    const GLsizei stride = withColor ? sizeof(glm::mat4) + sizeof(glm::vec4) : sizeof(glm::mat4);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(2 + column);
+        glVertexAttribDivisor(2 + column, 1);
+    }
+    if (withColor) {
+        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(sizeof(glm::mat4)));
+        glEnableVertexAttribArray(6);
+        glVertexAttribDivisor(6, 1);
+    }
+    glBindVertexArray(0);
+    return vao;
+}
+/// Cube vertex data ------------- (end)
+
+
+/// Scene objects ---- (start)
+struct SceneObject {
+    glm::vec3 position;
+    glm::vec3 scale;
+    glm::vec4 color;
+    float boundRadius;
+    bool castsShadow = true;
+
+    // Moving cubes circle an anchor point
+    bool dynamic = false;
+    glm::vec3 anchor{};
+    float orbitRadius = 0.0f, orbitSpeed = 0.0f, phase = 0.0f;
+    glm::vec3 prevPosition{};
+
+    SceneObject(glm::vec3 p, glm::vec3 s, glm::vec4 c) : position(p), scale(s), color(c), boundRadius(glm::length(s) * 0.5f), prevPosition(p) {}
+
+    [[nodiscard]] glm::mat4 model() const {
+        return glm::scale(glm::translate(glm::mat4(1.0f), position), scale);
+    }
+};
+
+std::vector<SceneObject> sceneObjects;
+/// Scene objects ---- (end)
+
+
+/// Cascades ---- (start)
+struct Cascade {
+    float splitNear = 0.0f, splitFar = 0.0f;
+    // Sphere fit of the frustum slice, constant while fov / aspect are, so the projection size never changes
+    float radius = 0.0f;
+    float texelSize = 0.0f;
+
+    // Light-space box after snapping : x/y extents and z range (light view looks down -Z)
+    float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f, minZ = 0.0f, maxZ = 0.0f;
+    glm::mat4 lightViewProjection{1.0f};
+    bool valid = false;
+
+    // Casters drawn into this cascade : one instanced draw
+    GLuint instanceBuffer = 0;
+    GLuint vao = 0;
+    int casterCount = 0;
+    std::vector<glm::mat4> casterModels;
+
+    // Stats for the current reporting window
+    int renders = 0;
+};
+
+Cascade cascades[NUM_CASCADES];
+// Cascade render times, read back PROFILER_FRAMES later so a refresh never stalls on the GPU
+GpuProfiler gpuProfiler;
+const char* cascadeScopeNames[NUM_CASCADES] = {"cascade0", "cascade1", "cascade2", "cascade3"};
+GLuint shadowMapArray = 0;
+GLuint shadowFBO = 0;
+
+// Practical split scheme : blend of logarithmic and uniform split distances.
+void computeSplits(float nearPlane, float farPlane) {
+    float previous = nearPlane;
+    for (int i = 0; i < NUM_CASCADES; i++) {
+        const float p = static_cast<float>(i + 1) / NUM_CASCADES;
+        const float logSplit = nearPlane * pow(farPlane / nearPlane, p);
+        const float uniformSplit = nearPlane + (farPlane - nearPlane) * p;
+        cascades[i].splitNear = previous;
+        cascades[i].splitFar = SPLIT_LAMBDA * logSplit + (1.0f - SPLIT_LAMBDA) * uniformSplit;
+        previous = cascades[i].splitFar;
+    }
+}
+
+// Light view rotation only, fixed at the origin, so snapping in light space is exact between frames.
+glm::mat4 lightViewMatrix(const glm::vec3& lightDir) {
+    const glm::vec3 up = fabs(lightDir.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    return glm::lookAt(glm::vec3(0.0f), lightDir, up);
+}
+
+// Fits a sphere around the camera frustum slice and snaps its light-space centre to whole shadow-map texels.
+// Returns true when the resulting projection differs from the one the cascade was last rendered with.
+bool updateCascadeProjection(Cascade& cascade, const Camera& cam, float aspect, const glm::mat4& lightView) {
+    const float tanHalfFov = tan(glm::radians(FOV) * 0.5f);
+    const float nearHalfH = cascade.splitNear * tanHalfFov, farHalfH = cascade.splitFar * tanHalfFov;
+    const float nearHalfW = nearHalfH * aspect, farHalfW = farHalfH * aspect;
+
+    // The slice is symmetric about the view axis, so the smallest enclosing sphere is centred on it.
+    // Centre distance c balances the near and far corner distances : (c-n)^2 + rn^2 = (f-c)^2 + rf^2
+    const float n = cascade.splitNear, f = cascade.splitFar;
+    const float nearCornerSq = nearHalfW * nearHalfW + nearHalfH * nearHalfH;
+    const float farCornerSq = farHalfW * farHalfW + farHalfH * farHalfH;
+    float centerDist = (f * f - n * n + farCornerSq - nearCornerSq) / (2.0f * (f - n));
+    centerDist = glm::clamp(centerDist, n, f);
+    float radius = glm::max(std::sqrt((centerDist - n) * (centerDist - n) + nearCornerSq),
+                            std::sqrt((f - centerDist) * (f - centerDist) + farCornerSq));
+    radius = ceil(radius * 16.0f) / 16.0f;
+
+    cascade.radius = radius;
+    cascade.texelSize = 2.0f * radius / SHADOW_MAP_SIZE;
+
+    const glm::vec3 worldCenter = cam.position + cam.front * centerDist;
+    glm::vec3 lc = glm::vec3(lightView * glm::vec4(worldCenter, 1.0f));
+    lc.x = floor(lc.x / cascade.texelSize) * cascade.texelSize;
+    lc.y = floor(lc.y / cascade.texelSize) * cascade.texelSize;
+    lc.z = floor(lc.z / cascade.texelSize) * cascade.texelSize;
+
+    cascade.minX = lc.x - radius; cascade.maxX = lc.x + radius;
+    cascade.minY = lc.y - radius; cascade.maxY = lc.y + radius;
+    cascade.minZ = lc.z - radius; cascade.maxZ = lc.z + radius + CASTER_EXTENT;
+
+    const glm::mat4 lightProjection = glm::ortho(cascade.minX, cascade.maxX, cascade.minY, cascade.maxY, -cascade.maxZ, -cascade.minZ);
+    const glm::mat4 lightViewProjection = lightProjection * lightView;
+    const bool changed = !cascade.valid || !(lightViewProjection == cascade.lightViewProjection);
+    cascade.lightViewProjection = lightViewProjection;
+    return changed;
+}
+
+// Sphere (given in light view space) against the cascade's light-space box.
+bool sphereInCascade(const Cascade& cascade, const glm::vec3& lightSpaceCenter, float radius) {
+    return lightSpaceCenter.x + radius >= cascade.minX && lightSpaceCenter.x - radius <= cascade.maxX &&
+           lightSpaceCenter.y + radius >= cascade.minY && lightSpaceCenter.y - radius <= cascade.maxY &&
+           lightSpaceCenter.z + radius >= cascade.minZ && lightSpaceCenter.z - radius <= cascade.maxZ;
+}
+
+void createShadowResources() {
+    glGenTextures(1, &shadowMapArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMapArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, NUM_CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    const float border[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+    // Hardware depth comparison : bilinear PCF for free
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glGenFramebuffers(1, &shadowFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMapArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Shadow framebuffer incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (auto& cascade : cascades) {
+        glGenBuffers(1, &cascade.instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, cascade.instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (NUM_STATIC_CUBES + NUM_MOVING_CUBES) * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+        cascade.vao = createInstancedCubeVAO(cascade.instanceBuffer, false);
+    }
+    profilerInit(&gpuProfiler);
+}
+
+// Renders one cascade : gathers the casters overlapping its light-space box and draws them in one instanced call.
+void renderCascade(int index, const glm::mat4& lightView, const Shader* depthShader) {
+    Cascade& cascade = cascades[index];
+
+    cascade.casterModels.clear();
+    for (const auto& obj : sceneObjects) {
+        if (!obj.castsShadow) continue;
+        const glm::vec3 lightSpace = glm::vec3(lightView * glm::vec4(obj.position, 1.0f));
+        if (sphereInCascade(cascade, lightSpace, obj.boundRadius)) {
+            cascade.casterModels.push_back(obj.model());
+        }
+    }
+    cascade.casterCount = static_cast<int>(cascade.casterModels.size());
+
+    profilerPush(&gpuProfiler, cascadeScopeNames[index]);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMapArray, 0, index);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    if (cascade.casterCount > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, cascade.instanceBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, cascade.casterCount * sizeof(glm::mat4), cascade.casterModels.data());
+        depthShader->setMat4("lightViewProjection", cascade.lightViewProjection);
+        glBindVertexArray(cascade.vao);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, cascade.casterCount);
+    }
+    profilerPop(&gpuProfiler);
+
+    cascade.valid = true;
+    cascade.renders++;
+}
+/// Cascades ---- (end)
+
+
+/// shaders --------- (Start)
+const char* depthVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in mat4 aModel;
+uniform mat4 lightViewProjection;
+void main() {
+    gl_Position = lightViewProjection * aModel * vec4(aPos, 1.0);
+}
+)";
+
+const char* depthFragmentShaderSource = R"(
+#version 410 core
+void main() {}
+)";
+
+const char* sceneVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in mat4 aModel;
+layout (location = 6) in vec4 aColor;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 Albedo;
+out float ViewDepth;
+
+uniform mat4 view, projection;
+
+void main() {
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    // Scale-only model matrices : the inverse transpose is the inverse scale
+    Normal = normalize(aNormal / vec3(length(aModel[0].xyz), length(aModel[1].xyz), length(aModel[2].xyz)));
+    Albedo = aColor.rgb;
+    vec4 viewPos = view * vec4(FragPos, 1.0);
+    ViewDepth = -viewPos.z;
+    gl_Position = projection * viewPos;
+}
+)";
+
+const char* sceneFragmentShaderSource = R"(
+#version 410 core
+#define NUM_CASCADES 4
+
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 cascadeViewProjection[NUM_CASCADES];
+uniform float cascadeSplit[NUM_CASCADES];
+uniform float cascadeTexelSize[NUM_CASCADES];
+uniform vec3 sunDirection;
+uniform vec3 sunColor;
+uniform vec3 viewPos;
+uniform int showCascades;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec3 Albedo;
+in float ViewDepth;
+out vec4 FragColor;
+
+const vec3 cascadeTint[NUM_CASCADES] = vec3[](vec3(1.0, 0.4, 0.4), vec3(0.4, 1.0, 0.4), vec3(0.4, 0.4, 1.0), vec3(1.0, 1.0, 0.4));
+
+// 3x3 taps of hardware-filtered comparisons, offset along the normal by a texel to avoid acne
+float sunVisibility(vec3 norm, out int cascade) {
+    cascade = NUM_CASCADES;
+    for (int i = 0; i < NUM_CASCADES; i++) {
+        if (ViewDepth < cascadeSplit[i]) { cascade = i; break; }
+    }
+    if (cascade == NUM_CASCADES) return 1.0;
+
+    vec3 offsetPos = FragPos + norm * cascadeTexelSize[cascade] * 1.5;
+    vec4 lightClip = cascadeViewProjection[cascade] * vec4(offsetPos, 1.0);
+    vec3 coord = lightClip.xyz / lightClip.w * 0.5 + 0.5;
+
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++) {
+        for (int y = -1; y <= 1; y++) {
+            lit += texture(shadowMap, vec4(coord.xy + vec2(x, y) * texel, float(cascade), coord.z - 0.0005));
+        }
+    }
+    return lit / 9.0;
+}
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = -sunDirection;
+    vec3 viewDir = normalize(viewPos - FragPos);
+
+    int cascade;
+    float visibility = sunVisibility(norm, cascade);
+
+    vec3 ambient = 0.15 * Albedo;
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), 64.0) * 0.3;
+    vec3 result = ambient + visibility * (diff * Albedo + spec) * sunColor;
+
+    if (showCascades == 1 && cascade < NUM_CASCADES) {
+        result *= cascadeTint[cascade];
+    }
+    FragColor = vec4(result, 1.0);
+}
+)";
+/// shaders --------- (End)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* sceneShader = nullptr;
+Shader* depthShader = nullptr;
+
+/// Sun angles in degrees
+float sunAzimuth = 35.0f;
+float sunElevation = 40.0f;
+
+int WindowWidth, WindowHeight;
+/// Global Objects ------ (End)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+}
+
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_T) bAnimateSun = !bAnimateSun;
+    if (key == GLFW_KEY_M) bMoveCubes = !bMoveCubes;
+    if (key == GLFW_KEY_C) bShowCascades = !bShowCascades;
+}
+
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+
+    if(glfwGetKey(win, GLFW_KEY_LEFT))  sunAzimuth -= 30.0f * dt;
+    if(glfwGetKey(win, GLFW_KEY_RIGHT)) sunAzimuth += 30.0f * dt;
+    if(glfwGetKey(win, GLFW_KEY_UP))    sunElevation = glm::min(sunElevation + 20.0f * dt, 89.0f);
+    if(glfwGetKey(win, GLFW_KEY_DOWN))  sunElevation = glm::max(sunElevation - 20.0f * dt, 5.0f);
+}
+/// Callbacks ----- (End)
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Cascaded Shadow Maps", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    lastX = static_cast<float>(mode->width) / 2.0f;
+    lastY = static_cast<float>(mode->height) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+
+    glGenBuffers(1, &cubeVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+
+    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentShaderSource);
+    depthShader = new Shader(depthVertexShaderSource, depthFragmentShaderSource);
+    camera = new Camera();
+
+    // --- Scene : ground, a field of static cubes and pillars, a few moving cubes ---
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> rPos(-FIELD_EXTENT, FIELD_EXTENT), rSize(0.8f, 3.0f), rHeight(1.0f, 12.0f), rTone(0.5f, 0.9f);
+
+    SceneObject ground(glm::vec3(0.0f, -0.5f, 0.0f), glm::vec3(FIELD_EXTENT * 2.5f, 1.0f, FIELD_EXTENT * 2.5f), glm::vec4(0.45f, 0.5f, 0.4f, 1.0f));
+    ground.castsShadow = false;
+    sceneObjects.push_back(ground);
+
+    for (int i = 0; i < NUM_STATIC_CUBES; i++) {
+        const float w = rSize(gen), h = (i % 4 == 0) ? rHeight(gen) : rSize(gen);
+        const float tone = rTone(gen);
+        sceneObjects.emplace_back(glm::vec3(rPos(gen), h * 0.5f, rPos(gen)), glm::vec3(w, h, w), glm::vec4(tone, tone * 0.9f, tone * 0.8f, 1.0f));
+    }
+    for (int i = 0; i < NUM_MOVING_CUBES; i++) {
+        SceneObject cube(glm::vec3(0.0f), glm::vec3(1.5f), glm::vec4(0.9f, 0.3f, 0.2f, 1.0f));
+        cube.dynamic = true;
+        cube.anchor = glm::vec3(rPos(gen) * 0.3f, 2.0f, rPos(gen) * 0.3f);
+        cube.orbitRadius = 4.0f + static_cast<float>(i % 3) * 2.0f;
+        cube.orbitSpeed = 0.4f + static_cast<float>(i % 5) * 0.15f;
+        cube.phase = static_cast<float>(i) * 1.7f;
+        sceneObjects.push_back(cube);
+    }
+
+    // Scene draw : every object in one instanced call, matrix + color per instance
+    std::vector<float> sceneInstances;
+    GLuint sceneInstanceBuffer;
+    glGenBuffers(1, &sceneInstanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, sceneInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sceneObjects.size() * (sizeof(glm::mat4) + sizeof(glm::vec4)), nullptr, GL_DYNAMIC_DRAW);
+    const GLuint sceneVAO = createInstancedCubeVAO(sceneInstanceBuffer, true);
+
+    createShadowResources();
+    computeSplits(NEAR_PLANE, SHADOW_DISTANCE);
+
+    sceneShader->use();
+    sceneShader->setInt("shadowMap", 0);
+
+    glm::vec3 lastSunDirection(0.0f);
+    float animationTime = 0.0f;
+    auto lastTime = std::chrono::high_resolution_clock::now();
+    double lastStatsTime = glfwGetTime();
+    int statsFrames = 0;
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+        processInput(window, dt);
+        profilerBeginFrame(&gpuProfiler);
+
+        if (bAnimateSun) sunAzimuth += 10.0f * dt;
+        const glm::vec3 sunDirection = -glm::normalize(glm::vec3(
+            cos(glm::radians(sunElevation)) * cos(glm::radians(sunAzimuth)),
+            sin(glm::radians(sunElevation)),
+            cos(glm::radians(sunElevation)) * sin(glm::radians(sunAzimuth))));
+        const bool sunMoved = !(sunDirection == lastSunDirection);
+        lastSunDirection = sunDirection;
+
+        // --- Move dynamic cubes, remembering where they were ---
+        if (bMoveCubes) animationTime += dt;
+        for (auto& obj : sceneObjects) {
+            if (!obj.dynamic) continue;
+            obj.prevPosition = obj.position;
+            const float a = animationTime * obj.orbitSpeed + obj.phase;
+            obj.position = obj.anchor + glm::vec3(cos(a) * obj.orbitRadius, 1.0f + sin(a * 2.0f), sin(a) * obj.orbitRadius);
+        }
+
+        const float aspect = static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight);
+        const glm::mat4 lightView = lightViewMatrix(sunDirection);
+
+        // --- Shadow pass : only cascades whose projection, sun or casters changed ---
+        glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
+        glViewport(0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
+        glEnable(GL_DEPTH_CLAMP);           // casters in front of the near plane still write depth
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+        depthShader->use();
+
+        glm::mat4 cascadeMatrices[NUM_CASCADES];
+        float cascadeSplits[NUM_CASCADES], cascadeTexels[NUM_CASCADES];
+        for (int i = 0; i < NUM_CASCADES; i++) {
+            Cascade& cascade = cascades[i];
+            bool dirty = updateCascadeProjection(cascade, *camera, aspect, lightView) || sunMoved;
+
+            // A moving caster dirties every cascade it touched last frame or touches now
+            for (const auto& obj : sceneObjects) {
+                if (dirty) break;
+                if (!obj.dynamic || obj.position == obj.prevPosition) continue;
+                dirty = sphereInCascade(cascade, glm::vec3(lightView * glm::vec4(obj.position, 1.0f)), obj.boundRadius) ||
+                        sphereInCascade(cascade, glm::vec3(lightView * glm::vec4(obj.prevPosition, 1.0f)), obj.boundRadius);
+            }
+
+            if (dirty) renderCascade(i, lightView, depthShader);
+
+            cascadeMatrices[i] = cascade.lightViewProjection;
+            cascadeSplits[i] = cascade.splitFar;
+            cascadeTexels[i] = cascade.texelSize;
+        }
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glDisable(GL_DEPTH_CLAMP);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, WindowWidth, WindowHeight);
+
+        // --- Scene ---
+        glClearColor(0.55f, 0.7f, 0.9f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        sceneInstances.clear();
+        for (const auto& obj : sceneObjects) {
+            const glm::mat4 model = obj.model();
+            sceneInstances.insert(sceneInstances.end(), glm::value_ptr(model), glm::value_ptr(model) + 16);
+            sceneInstances.insert(sceneInstances.end(), glm::value_ptr(obj.color), glm::value_ptr(obj.color) + 4);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, sceneInstanceBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sceneInstances.size() * sizeof(float), sceneInstances.data());
+
+        sceneShader->use();
+        sceneShader->setMat4("projection", camera->getProjectionMatrix(aspect));
+        sceneShader->setMat4("view", camera->getViewMatrix());
+        sceneShader->setVec3("viewPos", camera->position);
+        sceneShader->setVec3("sunDirection", sunDirection);
+        sceneShader->setVec3("sunColor", glm::vec3(1.0f, 0.95f, 0.85f));
+        sceneShader->setInt("showCascades", bShowCascades ? 1 : 0);
+        sceneShader->setMat4Array("cascadeViewProjection", cascadeMatrices, NUM_CASCADES);
+        sceneShader->setFloatArray("cascadeSplit", cascadeSplits, NUM_CASCADES);
+        sceneShader->setFloatArray("cascadeTexelSize", cascadeTexels, NUM_CASCADES);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMapArray);
+        glBindVertexArray(sceneVAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, static_cast<GLsizei>(sceneObjects.size()));
+
+        profilerEndFrame(&gpuProfiler);
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+        // --- Per-cascade stats, every ~2 seconds ---
+        statsFrames++;
+        if (glfwGetTime() - lastStatsTime >= 2.0) {
+            for (int i = 0; i < NUM_CASCADES; i++) {
+                Cascade& cascade = cascades[i];
+                const GpuScopeStats* renderStats = profilerFindStats(&gpuProfiler, cascadeScopeNames[i]);
+                std::cout << "C" << i << " " << cascade.splitNear << "-" << cascade.splitFar << "m"
+                          << " | casters " << cascade.casterCount
+                          << " | rendered " << cascade.renders << "/" << statsFrames
+                          << " | " << (renderStats ? renderStats->averageMs : 0.0) << " ms/render" << std::endl;
+                cascade.renders = 0;
+            }
+            statsFrames = 0;
+            lastStatsTime = glfwGetTime();
+        }
+    }
+
+    profilerDestroy(&gpuProfiler);
+    for (auto& cascade : cascades) {
+        glDeleteBuffers(1, &cascade.instanceBuffer);
+        glDeleteVertexArrays(1, &cascade.vao);
+    }
+    glDeleteFramebuffers(1, &shadowFBO);
+    glDeleteTextures(1, &shadowMapArray);
+    glDeleteBuffers(1, &sceneInstanceBuffer);
+    glDeleteVertexArrays(1, &sceneVAO);
+    glDeleteBuffers(1, &cubeVBO);
+    delete sceneShader;
+    delete depthShader;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,1199 @@
+// Clustered forward lighting : thousands of point lights binned into a 3D view-frustum grid
+
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "FixedTimestep.h"
+#include "JobSystem.h"
+#include "GpuProfiler.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CLUSTER_USE_SSE 1
+#endif
+
+
+/// Defining Globals variable ---- (start)
+/// Rendering
+constexpr int NUM_CUBES = 256;
+constexpr float SCENE_EXTENT = 40.0f;
+
+/// Simulation
+/// SceneObject spin speeds are given in degrees per frame at this rate, they turn at rotSpeed * 60 degrees per second
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+/// Cube spin advances in fixed ticks, so it turns at the same speed and costs the same work at any frame rate
+SimulationClock simClock;
+
+/// Camera
+constexpr float CAMERA_SPEED = 8.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// SpotLight
+constexpr float SPOT_LIGHT_INNER = 15.0f;
+constexpr float SPOT_LIGHT_OUTER = 30.0f;
+
+/// Point lights
+constexpr int MAX_POINT_LIGHTS = 4096;
+constexpr float LIGHT_CONSTANT = 1.0f;
+constexpr float LIGHT_LINEAR = 0.7f;
+constexpr float LIGHT_QUADRATIC = 1.8f;
+/// Contribution below this fraction of the light's brightest channel is treated as zero (~ 5/256)
+constexpr float LIGHT_CUTOFF = 0.02f;
+
+/// Cluster grid : TILES_X * TILES_Y screen tiles, CLUSTER_SLICES exponential depth slices
+constexpr int CLUSTER_TILES_X = 16;
+constexpr int CLUSTER_TILES_Y = 9;
+constexpr int CLUSTER_SLICES = 24;
+constexpr int CLUSTER_COUNT = CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES;
+/// Depth range covered by the slices, anything further lands in the last slice
+constexpr float CLUSTER_FAR = 200.0f;
+constexpr int MAX_LIGHTS_PER_CLUSTER = 512;
+
+/// Turn off or on spotlight
+bool bIsCameraLightOn = true;
+/// Shows number of lights per cluster instead of shading
+bool bShowHeatmap = false;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 12.0f, 45.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = -15.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() { updateVectors(); }
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe, dir.z : forward, dir.y : world vertical
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    // The cluster grid assumes this exact projection (symmetric frustum, NEAR_PLANE).
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(glm::radians(FOV), aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles vertex and fragment shader from raw GLSL source strings, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource) {
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a vec2 uniform (screen size).
+    void setVec2(const char* uniform, const float x, const float y) const {
+        glUniform2f(glGetUniformLocation(ProgramID, uniform), x, y);
+    }
+
+    // Sets a float uniform (shininess, attenuation values, time, etc.).
+    void setFloat(const char* uniform, const float val) const {
+        glUniform1f(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an ivec3 uniform (grid dimensions).
+    void setIVec3(const char* uniform, const int x, const int y, const int z) const {
+        glUniform3i(glGetUniformLocation(ProgramID, uniform), x, y, z);
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Creating procedural texture ------------------ (start)
+class Texture {
+public:
+    // OpenGL texture handle — 0 = invalid/uninitialized
+    GLuint TextureID = 0;
+    Texture() {
+        glGenTextures(1, &TextureID);
+        glBindTexture(GL_TEXTURE_2D, TextureID);
+
+        // Texture dimensions — 256x256 pixels, RGBA.
+        constexpr int size = 256;
+        auto* data = new unsigned char[size * size * 4];
+
+        // Same procedural stripes as MultipleLights.
+        for (int y = 0 ; y < size ; y++) {
+            for (int x = 0 ; x < size ; x++) {
+                const float fx = static_cast<float>(x) / size;
+                const float fy = static_cast<float>(y) / size;
+                float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+                const int i = (y * size + x) * 4;
+                data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+                data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+                data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+                data[i+3] = 255;
+            }
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        delete[] data;
+
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    }
+};
+
+/// Creating procedural texture ------------------ (end)
+
+
+/// Light structs --------- (Start)
+struct SpotLight {
+    glm::vec3 position, dir, color;
+    float innerCutoff, outerCutoff;
+    float constant = 1.0f;
+    float linear = 0.07f;
+    float quadratic = 0.017f;
+
+    SpotLight(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer)
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))) {}
+};
+
+// Distance at which constant/linear/quadratic attenuation drops below LIGHT_CUTOFF of the light's brightest channel.
+// Solves quadratic*d^2 + linear*d + constant = maxChannel / cutoff for d.
+float lightRadius(const glm::vec3& color) {
+    const float maxChannel = glm::max(color.x, glm::max(color.y, color.z));
+    const float c = LIGHT_CONSTANT - maxChannel / LIGHT_CUTOFF;
+    return (-LIGHT_LINEAR + sqrt(LIGHT_LINEAR * LIGHT_LINEAR - 4.0f * LIGHT_QUADRATIC * c)) / (2.0f * LIGHT_QUADRATIC);
+}
+
+// Point lights stored as structure of arrays so the binning code can load 4 lights per SSE register.
+// Arrays are padded to a multiple of 4.
+struct PointLightSet {
+    int count = 0;
+    std::vector<float> x, y, z, radius;
+    std::vector<float> r, g, b;
+    // orbit animation : anchor, orbit radius, angular speed, phase
+    std::vector<glm::vec3> anchor;
+    std::vector<float> orbit, speed, phase;
+
+    void resize(int n) {
+        count = n;
+        const size_t padded = (n + 3) & ~3;
+        for (auto* v : {&x, &y, &z, &radius, &r, &g, &b, &orbit, &speed, &phase}) v->assign(padded, 0.0f);
+        anchor.assign(padded, glm::vec3(0.0f));
+    }
+};
+
+// Random lights spread over the scene. The same seed always gives the same set.
+void createPointLights(PointLightSet& lights, int count, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> rPos(-SCENE_EXTENT, SCENE_EXTENT), rHeight(0.3f, 6.0f);
+    std::uniform_real_distribution<float> rOrbit(0.5f, 4.0f), rSpeed(-1.0f, 1.0f), rPhase(0.0f, 6.2831f), rHue(0.0f, 1.0f);
+
+    lights.resize(count);
+    for (int i = 0; i < count; i++) {
+        lights.anchor[i] = glm::vec3(rPos(gen), rHeight(gen), rPos(gen));
+        lights.orbit[i] = rOrbit(gen);
+        lights.speed[i] = rSpeed(gen);
+        lights.phase[i] = rPhase(gen);
+
+        // Saturated hue so overlapping lights stay readable.
+        const float h = rHue(gen) * 6.0f;
+        const glm::vec3 color = glm::clamp(glm::vec3(fabs(h - 3.0f) - 1.0f, 2.0f - fabs(h - 2.0f), 2.0f - fabs(h - 4.0f)), 0.0f, 1.0f);
+        lights.r[i] = color.x;
+        lights.g[i] = color.y;
+        lights.b[i] = color.z;
+        lights.radius[i] = lightRadius(color);
+    }
+}
+
+// Moves every light along its orbit, split into chunks of 256 lights across the job system.
+void animatePointLights(PointLightSet& lights, float time, JobSystem& jobs) {
+    constexpr int CHUNK = 256;
+    const int chunks = (lights.count + CHUNK - 1) / CHUNK;
+    jobsRun(&jobs, chunks, [&](int chunk) {
+        const int end = std::min(lights.count, (chunk + 1) * CHUNK);
+        for (int i = chunk * CHUNK; i < end; i++) {
+            const float a = time * lights.speed[i] + lights.phase[i];
+            lights.x[i] = lights.anchor[i].x + cos(a) * lights.orbit[i];
+            lights.z[i] = lights.anchor[i].z + sin(a) * lights.orbit[i];
+            lights.y[i] = lights.anchor[i].y + sin(a * 1.3f) * 0.5f;
+        }
+    });
+}
+/// Light structs --------- (end)
+
+
+/// Cluster builder --------- (start)
+// Bins point lights into a TILES_X * TILES_Y * SLICES froxel grid every frame.
+// Step 1 (parallel over chunks of lights, SSE) : view-space sphere -> conservative tile and slice range.
+// Step 2 (parallel over depth slices)          : sphere vs cluster AABB, indices appended to per-cluster scratch lists.
+// Step 3 (serial prefix sum + parallel copy)   : compact lists into the (offset, count) grid + index list the shader reads.
+class ClusterBuilder {
+public:
+    // View-space AABB of each cluster, rebuilt when the projection changes.
+    std::vector<glm::vec3> clusterMin, clusterMax;
+
+    // Per light results of step 1.
+    std::vector<float> viewX, viewY, viewZ;
+    std::vector<int32_t> tileMinX, tileMaxX, tileMinY, tileMaxY, sliceMin, sliceMax;
+
+    // Per cluster lists.
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> scratch;        // CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER
+    std::vector<uint32_t> grid;           // 2 per cluster : offset, count
+    std::vector<uint32_t> lightIndices;   // compacted
+    uint32_t totalIndices = 0;
+    std::atomic<uint32_t> droppedIndices{0};
+
+    float projX = 1.0f;   // projection[0][0]
+    float projY = 1.0f;   // projection[1][1]
+    float sliceScale = 1.0f;
+
+    ClusterBuilder() {
+        clusterMin.resize(CLUSTER_COUNT);
+        clusterMax.resize(CLUSTER_COUNT);
+        counts.resize(CLUSTER_COUNT);
+        scratch.resize(static_cast<size_t>(CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER);
+        grid.resize(CLUSTER_COUNT * 2);
+        lightIndices.resize(static_cast<size_t>(CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER);
+        sliceScale = CLUSTER_SLICES / log(CLUSTER_FAR / NEAR_PLANE);
+    }
+
+    // Depth at which a slice starts, slices are spaced exponentially between NEAR_PLANE and CLUSTER_FAR.
+    static float sliceDepth(int slice) {
+        return NEAR_PLANE * pow(CLUSTER_FAR / NEAR_PLANE, static_cast<float>(slice) / CLUSTER_SLICES);
+    }
+
+    [[nodiscard]] int sliceOf(float depth) const {
+        const int s = static_cast<int>(log(glm::max(depth, NEAR_PLANE) / NEAR_PLANE) * sliceScale);
+        return glm::clamp(s, 0, CLUSTER_SLICES - 1);
+    }
+
+    // Rebuilds the view-space AABB of every cluster for a new projection matrix.
+    void setProjection(const glm::mat4& projection) {
+        projX = projection[0][0];
+        projY = projection[1][1];
+        for (int z = 0; z < CLUSTER_SLICES; z++) {
+            const float dNear = sliceDepth(z);
+            // The last slice swallows everything up to the far plane
+            const float dFar = (z == CLUSTER_SLICES - 1) ? FAR_PLANE : sliceDepth(z + 1);
+            for (int y = 0; y < CLUSTER_TILES_Y; y++) {
+                for (int x = 0; x < CLUSTER_TILES_X; x++) {
+                    // Tile bounds in NDC
+                    const float nx0 = -1.0f + 2.0f * x / CLUSTER_TILES_X;
+                    const float nx1 = -1.0f + 2.0f * (x + 1) / CLUSTER_TILES_X;
+                    const float ny0 = -1.0f + 2.0f * y / CLUSTER_TILES_Y;
+                    const float ny1 = -1.0f + 2.0f * (y + 1) / CLUSTER_TILES_Y;
+                    // A point at depth d with NDC n sits at view x = n * d / projX
+                    const float xs[4] = {nx0 * dNear / projX, nx1 * dNear / projX, nx0 * dFar / projX, nx1 * dFar / projX};
+                    const float ys[4] = {ny0 * dNear / projY, ny1 * dNear / projY, ny0 * dFar / projY, ny1 * dFar / projY};
+                    const int c = (z * CLUSTER_TILES_Y + y) * CLUSTER_TILES_X + x;
+                    clusterMin[c] = glm::vec3(std::min({xs[0], xs[1], xs[2], xs[3]}), std::min({ys[0], ys[1], ys[2], ys[3]}), -dFar);
+                    clusterMax[c] = glm::vec3(std::max({xs[0], xs[1], xs[2], xs[3]}), std::max({ys[0], ys[1], ys[2], ys[3]}), -dNear);
+                }
+            }
+        }
+    }
+
+    // Step 1 for lights [begin, end), begin is a multiple of 4.
+    void computeLightRanges(const PointLightSet& lights, const glm::mat4& view, int begin, int end) {
+        int i = begin;
+#ifdef CLUSTER_USE_SSE
+        const __m128 m00 = _mm_set1_ps(view[0][0]), m10 = _mm_set1_ps(view[1][0]), m20 = _mm_set1_ps(view[2][0]), m30 = _mm_set1_ps(view[3][0]);
+        const __m128 m01 = _mm_set1_ps(view[0][1]), m11 = _mm_set1_ps(view[1][1]), m21 = _mm_set1_ps(view[2][1]), m31 = _mm_set1_ps(view[3][1]);
+        const __m128 m02 = _mm_set1_ps(view[0][2]), m12 = _mm_set1_ps(view[1][2]), m22 = _mm_set1_ps(view[2][2]), m32 = _mm_set1_ps(view[3][2]);
+        const __m128 nearV = _mm_set1_ps(NEAR_PLANE);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 px = _mm_set1_ps(projX), py = _mm_set1_ps(projY);
+        const __m128 tilesX = _mm_set1_ps(static_cast<float>(CLUSTER_TILES_X));
+        const __m128 tilesY = _mm_set1_ps(static_cast<float>(CLUSTER_TILES_Y));
+        const __m128 maxTileX = _mm_set1_ps(CLUSTER_TILES_X - 1.0f);
+        const __m128 maxTileY = _mm_set1_ps(CLUSTER_TILES_Y - 1.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (; i + 4 <= end; i += 4) {
+            const __m128 wx = _mm_loadu_ps(&lights.x[i]);
+            const __m128 wy = _mm_loadu_ps(&lights.y[i]);
+            const __m128 wz = _mm_loadu_ps(&lights.z[i]);
+            const __m128 r = _mm_loadu_ps(&lights.radius[i]);
+
+            // world -> view
+            const __m128 vx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, wx), _mm_mul_ps(m10, wy)), _mm_add_ps(_mm_mul_ps(m20, wz), m30));
+            const __m128 vy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, wx), _mm_mul_ps(m11, wy)), _mm_add_ps(_mm_mul_ps(m21, wz), m31));
+            const __m128 vz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, wx), _mm_mul_ps(m12, wy)), _mm_add_ps(_mm_mul_ps(m22, wz), m32));
+            _mm_storeu_ps(&viewX[i], vx);
+            _mm_storeu_ps(&viewY[i], vy);
+            _mm_storeu_ps(&viewZ[i], vz);
+
+            // Nearest and furthest depth of the sphere, clamped to the near plane
+            const __m128 depth = _mm_sub_ps(zero, vz);
+            const __m128 invMin = _mm_div_ps(one, _mm_max_ps(_mm_sub_ps(depth, r), nearV));
+            const __m128 invMax = _mm_div_ps(one, _mm_max_ps(_mm_add_ps(depth, r), nearV));
+
+            // Projected extent of the sphere's AABB : the extremes sit at either the nearest or furthest depth
+            const __m128 lx = _mm_sub_ps(vx, r), hx = _mm_add_ps(vx, r);
+            const __m128 ly = _mm_sub_ps(vy, r), hy = _mm_add_ps(vy, r);
+            const __m128 ndcMinX = _mm_mul_ps(px, _mm_min_ps(_mm_mul_ps(lx, invMin), _mm_mul_ps(lx, invMax)));
+            const __m128 ndcMaxX = _mm_mul_ps(px, _mm_max_ps(_mm_mul_ps(hx, invMin), _mm_mul_ps(hx, invMax)));
+            const __m128 ndcMinY = _mm_mul_ps(py, _mm_min_ps(_mm_mul_ps(ly, invMin), _mm_mul_ps(ly, invMax)));
+            const __m128 ndcMaxY = _mm_mul_ps(py, _mm_max_ps(_mm_mul_ps(hy, invMin), _mm_mul_ps(hy, invMax)));
+
+            // NDC -> tile, clamped before truncation so the conversion never overflows
+            auto toTile = [&](__m128 ndc, __m128 tiles, __m128 maxTile) {
+                const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ndc, half), half), tiles);
+                return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(t, zero), maxTile));
+            };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&tileMinX[i]), toTile(ndcMinX, tilesX, maxTileX));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&tileMaxX[i]), toTile(ndcMaxX, tilesX, maxTileX));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&tileMinY[i]), toTile(ndcMinY, tilesY, maxTileY));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&tileMaxY[i]), toTile(ndcMaxY, tilesY, maxTileY));
+        }
+#endif
+        // Scalar path : remaining lights, or everything when SSE is not available
+        for (; i < end; i++) {
+            const glm::vec4 v = view * glm::vec4(lights.x[i], lights.y[i], lights.z[i], 1.0f);
+            viewX[i] = v.x;
+            viewY[i] = v.y;
+            viewZ[i] = v.z;
+            const float r = lights.radius[i];
+            const float invMin = 1.0f / glm::max(-v.z - r, NEAR_PLANE);
+            const float invMax = 1.0f / glm::max(-v.z + r, NEAR_PLANE);
+            auto toTile = [](float ndc, int tiles) {
+                return static_cast<int32_t>(glm::clamp((ndc * 0.5f + 0.5f) * tiles, 0.0f, tiles - 1.0f));
+            };
+            tileMinX[i] = toTile(projX * glm::min((v.x - r) * invMin, (v.x - r) * invMax), CLUSTER_TILES_X);
+            tileMaxX[i] = toTile(projX * glm::max((v.x + r) * invMin, (v.x + r) * invMax), CLUSTER_TILES_X);
+            tileMinY[i] = toTile(projY * glm::min((v.y - r) * invMin, (v.y - r) * invMax), CLUSTER_TILES_Y);
+            tileMaxY[i] = toTile(projY * glm::max((v.y + r) * invMin, (v.y + r) * invMax), CLUSTER_TILES_Y);
+        }
+
+        // Depth slices (needs log, stays scalar) and rejection of lights fully behind the camera
+        for (i = begin; i < end; i++) {
+            const float depth = -viewZ[i];
+            const float r = lights.radius[i];
+            if (depth + r <= NEAR_PLANE || depth - r >= FAR_PLANE) {
+                sliceMin[i] = 1;
+                sliceMax[i] = 0;
+                continue;
+            }
+            sliceMin[i] = sliceOf(depth - r);
+            sliceMax[i] = sliceOf(depth + r);
+        }
+    }
+
+    // Step 2 for one depth slice. Only this call writes to the slice's clusters, so no locking is needed.
+    void binSlice(const PointLightSet& lights, int z) {
+        const int first = z * CLUSTER_TILES_X * CLUSTER_TILES_Y;
+        std::fill(counts.begin() + first, counts.begin() + first + CLUSTER_TILES_X * CLUSTER_TILES_Y, 0u);
+        uint32_t dropped = 0;
+
+        for (int i = 0; i < lights.count; i++) {
+            if (sliceMin[i] > z || sliceMax[i] < z) continue;
+            const glm::vec3 center(viewX[i], viewY[i], viewZ[i]);
+            const float r2 = lights.radius[i] * lights.radius[i];
+            for (int y = tileMinY[i]; y <= tileMaxY[i]; y++) {
+                for (int x = tileMinX[i]; x <= tileMaxX[i]; x++) {
+                    const int c = first + y * CLUSTER_TILES_X + x;
+                    // Sphere vs AABB : squared distance from the centre to the closest point of the box
+                    const glm::vec3 closest = glm::clamp(center, clusterMin[c], clusterMax[c]);
+                    const glm::vec3 d = center - closest;
+                    if (glm::dot(d, d) > r2) continue;
+                    if (counts[c] < MAX_LIGHTS_PER_CLUSTER) {
+                        scratch[static_cast<size_t>(c) * MAX_LIGHTS_PER_CLUSTER + counts[c]++] = static_cast<uint32_t>(i);
+                    } else {
+                        dropped++;
+                    }
+                }
+            }
+        }
+        if (dropped) droppedIndices += dropped;
+    }
+
+    // Runs all three steps.
+    void build(const PointLightSet& lights, const glm::mat4& view, JobSystem& jobs) {
+        const size_t padded = (lights.count + 3) & ~3;
+        if (viewX.size() < padded) {
+            for (auto* v : {&viewX, &viewY, &viewZ}) v->resize(padded);
+            for (auto* v : {&tileMinX, &tileMaxX, &tileMinY, &tileMaxY, &sliceMin, &sliceMax}) v->resize(padded);
+        }
+        droppedIndices = 0;
+
+        constexpr int CHUNK = 256;
+        const int chunks = (lights.count + CHUNK - 1) / CHUNK;
+        jobsRun(&jobs, chunks, [&](int chunk) {
+            computeLightRanges(lights, view, chunk * CHUNK, std::min(lights.count, (chunk + 1) * CHUNK));
+        });
+
+        jobsRun(&jobs, CLUSTER_SLICES, [&](int z) { binSlice(lights, z); });
+
+        uint32_t offset = 0;
+        for (int c = 0; c < CLUSTER_COUNT; c++) {
+            grid[c * 2 + 0] = offset;
+            grid[c * 2 + 1] = counts[c];
+            offset += counts[c];
+        }
+        totalIndices = offset;
+
+        jobsRun(&jobs, CLUSTER_SLICES, [&](int z) {
+            const int first = z * CLUSTER_TILES_X * CLUSTER_TILES_Y;
+            for (int c = first; c < first + CLUSTER_TILES_X * CLUSTER_TILES_Y; c++) {
+                std::memcpy(&lightIndices[grid[c * 2]], &scratch[static_cast<size_t>(c) * MAX_LIGHTS_PER_CLUSTER], counts[c] * sizeof(uint32_t));
+            }
+        });
+    }
+};
+/// Cluster builder --------- (end)
+
+
+/// Binning benchmark --------- (start)
+// Measures CPU binning cost for growing light counts, no window or GL context needed.
+// Run with : ClusteredLighting --bench
+int runClusterBenchmark() {
+    constexpr int ITERATIONS = 200;
+    const glm::mat4 projection = glm::perspective(glm::radians(FOV), 16.0f / 9.0f, NEAR_PLANE, FAR_PLANE);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 12.0f, 45.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    JobSystem serialJobs;
+    JobSystem parallelJobs;
+    jobsInit(&serialJobs, 1);
+    jobsInit(&parallelJobs, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+
+    std::cout << "Cluster binning benchmark : " << CLUSTER_TILES_X << "x" << CLUSTER_TILES_Y << "x" << CLUSTER_SLICES
+              << " clusters, " << ITERATIONS << " iterations" << std::endl;
+    for (JobSystem* jobs : {&serialJobs, &parallelJobs}) {
+        std::cout << "-- " << jobsThreadCount(jobs) << " thread(s)" << std::endl;
+        for (int count = 256; count <= MAX_POINT_LIGHTS; count *= 2) {
+            PointLightSet lights;
+            createPointLights(lights, count, 1234u);
+            ClusterBuilder builder;
+            builder.setProjection(projection);
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (int it = 0; it < ITERATIONS; it++) {
+                animatePointLights(lights, it * 0.016f, *jobs);
+                builder.build(lights, view, *jobs);
+            }
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / ITERATIONS;
+
+            std::cout << "lights " << count
+                      << " | " << ms << " ms/frame"
+                      << " | " << ms * 1.0e6 / count << " ns/light"
+                      << " | " << static_cast<float>(builder.totalIndices) / CLUSTER_COUNT << " lights/cluster avg"
+                      << " | dropped " << builder.droppedIndices.load() << std::endl;
+        }
+    }
+    jobsShutdown(&serialJobs);
+    jobsShutdown(&parallelJobs);
+    return 0;
+}
+/// Binning benchmark --------- (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVAO = 0;
+
+float cubeData[288] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
+     0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,  -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,  -0.5f, 0.5f,-0.5f, 0,0,-1, 0,1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,   0.5f,-0.5f, 0.5f, 0,0, 1, 1,0,   0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,
+     0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,  -0.5f, 0.5f, 0.5f, 0,0, 1, 0,1,  -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,
+    -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f,-0.5f,-1,0, 0, 1,1,
+    -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f, 0.5f,-1,0, 0, 0,0,
+     0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f,-0.5f, 1,0, 0, 1,1,
+     0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f, 0.5f, 1,0, 0, 0,0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,   0.5f,-0.5f,-0.5f, 0,-1,0, 1,1,   0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0, 0,0,  -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,
+    -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,   0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0, 1,1,
+     0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,  -0.5f, 0.5f, 0.5f, 0, 1,0, 0,0
+};
+
+void setupCubeVAO() {
+    unsigned int VBO;
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // uv
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+/// Cube vertex data ------------- (end)
+
+/// Scene objects ---- (start)
+struct Material { glm::vec3 specular; float shininess; };
+
+Material materials[5] = {
+    {{1.0f,1.0f,1.0f}, 32.0f},
+    {{1.0f,1.0f,1.0f}, 64.0f},
+    {{1.0f,1.0f,1.0f}, 128.0f},
+    {{1.0f,1.0f,1.0f}, 256.0f},
+    {{0.9f,0.9f,0.9f}, 512.0f}
+};
+
+class SceneObject {
+public:
+    glm::mat4 model{};
+    int matId;
+    float rotSpeed;
+
+    // Translation and scale, the spin is applied on top
+    glm::mat4 base{};
+    // Spin in degrees at the latest and the previous simulation tick
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObject(glm::vec3 pos, glm::vec3 scale, int mat, float rot) : matId(mat), rotSpeed(rot) {
+        base = glm::scale(glm::translate(glm::mat4(1.0f), pos), scale);
+        model = base;
+    }
+
+    // One simulation tick
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        // Keep the angle small so it does not lose precision over a long run, both move so the blend is unchanged
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    // Model matrix between the previous and the latest tick
+    void interpolate(float alpha) {
+        model = glm::rotate(base, glm::radians(previousAngle + (angle - previousAngle) * alpha), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+/// Scene objects ---- (end)
+
+
+/// shaders --------- (Start)
+const char* sceneVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+out float ViewDepth;
+
+uniform mat4 model, view, projection;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = aTexCoord;
+    vec4 viewPosition = view * vec4(FragPos, 1.0);
+    ViewDepth = -viewPosition.z;
+    gl_Position = projection * viewPosition;
+}
+
+)";
+
+const char* sceneFragmentShaderSource = R"(
+#version 410 core
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float innerCutOff;
+    float outerCutOff;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+uniform SpotLight cameraLight;
+uniform vec3 viewPos;
+uniform Material material;
+uniform int isCameraLightOn;
+uniform int showHeatmap;
+
+// Point lights : 2 texels per light, (position, radius) and (color, unused)
+uniform samplerBuffer lightData;
+// Per cluster : (offset into lightIndices, light count)
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer lightIndices;
+
+uniform ivec3 clusterDims;
+uniform vec2 screenSize;
+uniform float clusterNear;
+uniform float sliceScale;      // slices / log(clusterFar / clusterNear)
+uniform float lightConstant;
+uniform float lightLinear;
+uniform float lightQuadratic;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+in float ViewDepth;
+out vec4 FragColor;
+
+float attenuate(float distance, float constant, float linear, float quadratic) {
+    return 1.0 / (constant + linear * distance + quadratic * distance * distance);
+}
+
+// Fades the light to exactly zero at its radius so clusters outside it can safely skip it.
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+vec3 calPointLightEffect(vec3 position, float radius, vec3 color, vec3 norm, vec3 viewDir) {
+    vec3 toLight = position - FragPos;
+    float distance = length(toLight);
+    vec3 lightDir = toLight / distance;
+    float attenuation = attenuate(distance, lightConstant, lightLinear, lightQuadratic) * rangeWindow(distance, radius);
+
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * color * material.specular;
+
+    return (diffuse + specular) * attenuation;
+}
+
+vec3 calSpotLightEffect(SpotLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon , 0.0, 1.0);
+
+    if(intensity <= 0) return vec3(0.0);
+
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff    = max(dot(norm, lightDir), 0.0);
+    vec3  diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + (diffuse + specular) * intensity) * attenuation;
+}
+
+void main() {
+    // Which cluster is this fragment in
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / screenSize * vec2(clusterDims.xy)), ivec2(0), clusterDims.xy - 1);
+    int slice = clamp(int(log(max(ViewDepth, clusterNear) / clusterNear) * sliceScale), 0, clusterDims.z - 1);
+    int cluster = (slice * clusterDims.y + tile.y) * clusterDims.x + tile.x;
+    uvec2 range = texelFetch(clusterGrid, cluster).rg;
+
+    if (showHeatmap == 1) {
+        float heat = clamp(float(range.y) / 32.0, 0.0, 1.0);
+        FragColor = vec4(heat, 1.0 - abs(heat - 0.5) * 2.0, 1.0 - heat, 1.0);
+        return;
+    }
+
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec4 texColor = texture(material.diffuseTex, TexCoord);
+
+    vec3 result = 0.1 * texColor.rgb;
+    if (isCameraLightOn == 1) {
+        result += calSpotLightEffect(cameraLight, norm, viewDir) * texColor.rgb;
+    }
+
+    // Only the lights binned into this cluster
+    for (uint i = 0u; i < range.y; i++) {
+        int light = int(texelFetch(lightIndices, int(range.x + i)).r);
+        vec4 positionRadius = texelFetch(lightData, light * 2);
+        vec3 color = texelFetch(lightData, light * 2 + 1).rgb;
+        result += calPointLightEffect(positionRadius.xyz, positionRadius.w, color, norm, viewDir) * texColor.rgb;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+// Light markers : one small cube per light, instanced, position and color read from the light buffer
+const char* lightCubeVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+uniform mat4 view, projection;
+uniform samplerBuffer lightData;
+out vec3 emissiveColor;
+void main(){
+    vec3 position = texelFetch(lightData, gl_InstanceID * 2).xyz;
+    emissiveColor = texelFetch(lightData, gl_InstanceID * 2 + 1).rgb;
+    gl_Position = projection * view * vec4(aPos * 0.12 + position, 1.0);
+})";
+
+const char* lightCubeFS = R"(
+#version 410 core
+in vec3 emissiveColor;
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(emissiveColor, 1.0);
+})";
+/// shaders --------- (End)
+
+
+/// Light buffers ------ (start)
+// Texture buffer objects holding the light array and the cluster lists.
+// GL 4.1 has no shader storage buffers, samplerBuffer / usamplerBuffer give the same indexed access from the fragment shader.
+struct TextureBuffer {
+    GLuint buffer = 0;
+    GLuint texture = 0;
+    GLsizeiptr capacity = 0;
+
+    void create(GLenum format, GLsizeiptr bytes) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        capacity = bytes;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    }
+
+    // Orphans the old storage so the driver never waits for last frame's draws to finish reading it.
+    void upload(const void* data, GLsizeiptr bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, std::min(bytes, capacity), data);
+    }
+
+    void bind(GLuint unit) const {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+    }
+
+    void destroy() {
+        glDeleteTextures(1, &texture);
+        glDeleteBuffers(1, &buffer);
+    }
+};
+/// Light buffers ------ (end)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* sceneShader = nullptr;
+Shader* lightingShader = nullptr;
+Texture* defaultTexture = nullptr;
+
+std::vector<SceneObject> sceneObjects;
+SpotLight cameraLight(glm::vec3(0.0f), glm::vec3(0.0f,0.0f,-1.0f), glm::vec3(1.0f, 1.0f, 1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER);
+
+PointLightSet pointLights;
+/// Number of lights currently shaded, changed with - / =
+int activeLightCount = 1024;
+
+int WindowWidth, WindowHeight;
+bool projectionDirty = true;
+/// Global Objects ------ (End)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+    projectionDirty = true;
+}
+
+// Key presses that toggle, as opposed to keys held down for movement
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_EQUAL) activeLightCount = std::min(activeLightCount * 2, MAX_POINT_LIGHTS);
+    if (key == GLFW_KEY_MINUS) activeLightCount = std::max(activeLightCount / 2, 16);
+    if (key == GLFW_KEY_H) bShowHeatmap = !bShowHeatmap;
+}
+
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+    if(glfwGetKey(win, GLFW_KEY_O) == GLFW_PRESS) bIsCameraLightOn = true;
+    if(glfwGetKey(win, GLFW_KEY_P) == GLFW_PRESS) bIsCameraLightOn = false;
+}
+/// Callbacks ----- (End)
+
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return runClusterBenchmark();
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Clustered Lighting", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    lastX = static_cast<float>(mode->width) / 2.0f;
+    lastY = static_cast<float>(mode->height) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+
+    setupCubeVAO();
+    defaultTexture = new Texture();
+    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentShaderSource);
+    lightingShader = new Shader(lightCubeVS, lightCubeFS);
+    camera = new Camera();
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_real_distribution<float> rPos(-SCENE_EXTENT, SCENE_EXTENT), rRot(-1.5f,1.5f);
+    std::uniform_int_distribution<int> rMat(0,4);
+
+    // Ground slab + random cubes
+    sceneObjects.emplace_back(glm::vec3(0.0f, -0.6f, 0.0f), glm::vec3(SCENE_EXTENT * 2.2f, 0.2f, SCENE_EXTENT * 2.2f), 0, 0.0f);
+    for(int i = 0; i < NUM_CUBES; i++){
+        float scale = 0.6f + (i%5)*0.3f;
+        sceneObjects.emplace_back(glm::vec3(rPos(gen), scale * 0.5f - 0.5f, rPos(gen)), glm::vec3(scale), rMat(gen), rRot(gen));
+    }
+
+    createPointLights(pointLights, MAX_POINT_LIGHTS, std::random_device{}());
+
+    JobSystem jobs;
+    jobsInit(&jobs, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    ClusterBuilder clusters;
+
+    // GL_MAX_TEXTURE_BUFFER_SIZE is only guaranteed to be 65536 texels in GL 4.1
+    GLint maxTexelCount = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexelCount);
+    const GLsizeiptr indexCapacity = std::min<GLsizeiptr>(maxTexelCount, static_cast<GLsizeiptr>(CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER);
+
+    TextureBuffer lightDataBuffer, clusterGridBuffer, lightIndexBuffer;
+    lightDataBuffer.create(GL_RGBA32F, MAX_POINT_LIGHTS * 8 * sizeof(float));
+    clusterGridBuffer.create(GL_RG32UI, CLUSTER_COUNT * 2 * sizeof(uint32_t));
+    lightIndexBuffer.create(GL_R32UI, indexCapacity * sizeof(uint32_t));
+    std::vector<float> lightUpload(MAX_POINT_LIGHTS * 8);
+
+    // Samplers never change unit, set once
+    sceneShader->use();
+    sceneShader->setInt("material.diffuseTex", 0);
+    sceneShader->setInt("lightData", 1);
+    sceneShader->setInt("clusterGrid", 2);
+    sceneShader->setInt("lightIndices", 3);
+    sceneShader->setIVec3("clusterDims", CLUSTER_TILES_X, CLUSTER_TILES_Y, CLUSTER_SLICES);
+    sceneShader->setFloat("clusterNear", NEAR_PLANE);
+    sceneShader->setFloat("sliceScale", clusters.sliceScale);
+    sceneShader->setFloat("lightConstant", LIGHT_CONSTANT);
+    sceneShader->setFloat("lightLinear", LIGHT_LINEAR);
+    sceneShader->setFloat("lightQuadratic", LIGHT_QUADRATIC);
+    lightingShader->use();
+    lightingShader->setInt("lightData", 1);
+
+    // GPU time of the lit scene pass, read back PROFILER_FRAMES later so it never stalls
+    GpuProfiler gpuProfiler;
+    profilerInit(&gpuProfiler);
+    double cpuBinMs = 0.0;
+    int statsFrames = 0;
+    double lastStatsTime = glfwGetTime();
+
+    auto lastTime = std::chrono::high_resolution_clock::now();
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+
+        float time = static_cast<float>(glfwGetTime());
+        processInput(window, dt);
+
+        cameraLight.position = camera->position;
+        cameraLight.dir = camera->front;
+
+        glm::mat4 proj = camera->getProjectionMatrix(static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight));
+        glm::mat4 view = camera->getViewMatrix();
+        if (projectionDirty) {
+            clusters.setProjection(proj);
+            projectionDirty = false;
+        }
+
+        // --- Spin the cubes in fixed ticks ---
+        simClockAdvance(&simClock, dt);
+        while (simClockStep(&simClock)) {
+            for(auto& obj : sceneObjects){
+                obj.update(static_cast<float>(simClock.tickSeconds));
+            }
+        }
+        const float alpha = simClockAlpha(&simClock);
+        for(auto& obj : sceneObjects){
+            obj.interpolate(alpha);
+        }
+
+        // --- Animate + bin lights on the CPU ---
+        const auto binStart = std::chrono::high_resolution_clock::now();
+        pointLights.count = activeLightCount;
+        animatePointLights(pointLights, time, jobs);
+        clusters.build(pointLights, view, jobs);
+        cpuBinMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - binStart).count();
+
+        // --- Upload : one buffer for all lights instead of 5 uniforms per light ---
+        for (int i = 0; i < pointLights.count; i++) {
+            float* dst = &lightUpload[i * 8];
+            dst[0] = pointLights.x[i]; dst[1] = pointLights.y[i]; dst[2] = pointLights.z[i]; dst[3] = pointLights.radius[i];
+            dst[4] = pointLights.r[i]; dst[5] = pointLights.g[i]; dst[6] = pointLights.b[i]; dst[7] = 0.0f;
+        }
+        lightDataBuffer.upload(lightUpload.data(), pointLights.count * 8 * sizeof(float));
+        clusterGridBuffer.upload(clusters.grid.data(), CLUSTER_COUNT * 2 * sizeof(uint32_t));
+        lightIndexBuffer.upload(clusters.lightIndices.data(), clusters.totalIndices * sizeof(uint32_t));
+
+        // --- Clear ---
+        glClearColor(0.02f, 0.02f, 0.04f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        profilerBeginFrame(&gpuProfiler);
+        profilerPush(&gpuProfiler, "scene");
+
+        sceneShader->use();
+        sceneShader->setMat4("projection", proj);
+        sceneShader->setMat4("view", view);
+        sceneShader->setVec3("viewPos", camera->position);
+        sceneShader->setVec2("screenSize", static_cast<float>(WindowWidth), static_cast<float>(WindowHeight));
+        sceneShader->setInt("showHeatmap", bShowHeatmap ? 1 : 0);
+
+        sceneShader->setInt("isCameraLightOn", bIsCameraLightOn ? 1 : 0);
+        sceneShader->setVec3("cameraLight.position", cameraLight.position);
+        sceneShader->setVec3("cameraLight.direction", cameraLight.dir);
+        sceneShader->setVec3 ("cameraLight.color", cameraLight.color);
+        sceneShader->setFloat("cameraLight.innerCutOff", cameraLight.innerCutoff);
+        sceneShader->setFloat("cameraLight.outerCutOff", cameraLight.outerCutoff);
+        sceneShader->setFloat("cameraLight.constant", cameraLight.constant);
+        sceneShader->setFloat("cameraLight.linear", cameraLight.linear);
+        sceneShader->setFloat("cameraLight.quadratic", cameraLight.quadratic);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+        lightDataBuffer.bind(1);
+        clusterGridBuffer.bind(2);
+        lightIndexBuffer.bind(3);
+
+        glBindVertexArray(cubeVAO);
+        for(auto& obj : sceneObjects){
+            sceneShader->setMat4 ("model", obj.model);
+            sceneShader->setVec3 ("material.specular", materials[obj.matId].specular);
+            sceneShader->setFloat("material.shininess", materials[obj.matId].shininess);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        profilerPop(&gpuProfiler);
+        profilerEndFrame(&gpuProfiler);
+
+        // All light markers in one instanced draw
+        lightingShader->use();
+        lightingShader->setMat4("projection", proj);
+        lightingShader->setMat4("view", view);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, pointLights.count);
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+        // --- Cost per light, averaged over ~2 seconds ---
+        statsFrames++;
+        if (glfwGetTime() - lastStatsTime >= 2.0) {
+            const double cpu = cpuBinMs / statsFrames;
+            const GpuScopeStats* sceneStats = profilerFindStats(&gpuProfiler, "scene");
+            const double gpu = sceneStats ? sceneStats->averageMs : 0.0;
+            std::cout << "lights " << pointLights.count
+                      << " | CPU bin " << cpu << " ms (" << cpu * 1.0e6 / pointLights.count << " ns/light)"
+                      << " | GPU scene " << gpu << " ms (" << gpu * 1.0e6 / pointLights.count << " ns/light)"
+                      << " | " << static_cast<float>(clusters.totalIndices) / CLUSTER_COUNT << " lights/cluster avg";
+            if (clusters.droppedIndices > 0) std::cout << " | dropped " << clusters.droppedIndices.load();
+            if (clusters.totalIndices > indexCapacity) std::cout << " | index buffer overflow";
+            std::cout << std::endl;
+            cpuBinMs = 0.0;
+            statsFrames = 0;
+            lastStatsTime = glfwGetTime();
+        }
+    }
+
+    profilerDestroy(&gpuProfiler);
+    jobsShutdown(&jobs);
+    lightDataBuffer.destroy();
+    clusterGridBuffer.destroy();
+    lightIndexBuffer.destroy();
+    glDeleteVertexArrays(1, &cubeVAO);
+    delete sceneShader;
+    delete lightingShader;
+    delete defaultTexture;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}
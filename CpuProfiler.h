@@ -0,0 +1,158 @@
+// CPU profiler : begin / end markers written to per-thread ring buffers, flushed as Chrome trace event JSON
+// (open the file in chrome://tracing or ui.perfetto.dev).
+//
+// Records only when CPU_PROFILER_ENABLED is defined, which the build does with cmake -DCPU_PROFILER=ON. Without it
+// every macro expands to nothing, so the markers can stay in the code at no cost.
+//   CPU_PROFILE_SCOPE("name")                      times the rest of the enclosing block
+//   CPU_PROFILE_BEGIN("name") / CPU_PROFILE_END()  for phases that are not a block, must pair up on one thread
+//   CPU_PROFILE_INSTANT("name")                    a single point in time (a driver warning, a hitch)
+//   CPU_PROFILE_THREAD_NAME("name")                labels the calling thread in the trace
+//   CPU_PROFILE_FLUSH("trace.json")                writes everything still held by the rings
+// Only the name pointer is stored, so names must be string literals.
+
+#pragma once
+
+#ifdef CPU_PROFILER_ENABLED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// Events each thread keeps, the oldest are overwritten once it wraps (24 bytes each, 1.5 MB per thread)
+constexpr uint64_t CPU_PROFILER_RING_EVENTS = 1 << 16;
+
+struct CpuProfileEvent {
+    const char* name;
+    uint64_t timeNs;   // since the profiler started
+    char phase;        // 'B', 'E' or 'i'
+};
+
+/// Written only by its owning thread. `head` counts every event ever written, the flush reads behind it.
+struct CpuProfileRing {
+    CpuProfileEvent events[CPU_PROFILER_RING_EVENTS];
+    std::atomic<uint64_t> head{0};
+    uint32_t threadId = 0;
+    const char* threadName = nullptr;
+};
+
+/// Owns every ring. Rings outlive their threads so a flush still sees threads that already finished.
+struct CpuProfilerRegistry {
+    std::mutex mutex;   // taken once per thread on its first event, and by the flush, never while recording
+    std::vector<std::unique_ptr<CpuProfileRing>> rings;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+inline CpuProfilerRegistry& cpuProfilerRegistry() {
+    static CpuProfilerRegistry registry;
+    return registry;
+}
+
+/// Ring of the calling thread, registered on first use
+inline CpuProfileRing* cpuProfilerThreadRing() {
+    thread_local CpuProfileRing* ring = nullptr;
+    if (!ring) {
+        CpuProfilerRegistry& registry = cpuProfilerRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.rings.push_back(std::make_unique<CpuProfileRing>());
+        ring = registry.rings.back().get();
+        ring->threadId = static_cast<uint32_t>(registry.rings.size());
+    }
+    return ring;
+}
+
+/// Appends one event to the calling thread's ring, no locks and no allocation
+/// @param name Scope name
+/// @param phase 'B', 'E' or 'i'
+inline void cpuProfilerRecord(const char* name, char phase) {
+    CpuProfileRing* ring = cpuProfilerThreadRing();
+    const uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - cpuProfilerRegistry().start).count());
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head % CPU_PROFILER_RING_EVENTS] = {name, now, phase};
+    // Publishes the event, the flush only reads slots below head
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+/// Writes every ring as Chrome trace event JSON. Safe to call while other threads keep recording,
+/// events they overwrite during the copy are dropped.
+/// @param path Output file
+inline void cpuProfilerFlush(const char* path) {
+    std::vector<CpuProfileEvent> events;
+    std::ofstream out(path);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+
+    CpuProfilerRegistry& registry = cpuProfilerRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& ring : registry.rings) {
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = head > CPU_PROFILER_RING_EVENTS ? head - CPU_PROFILER_RING_EVENTS : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) { events.push_back(ring->events[i % CPU_PROFILER_RING_EVENTS]); }
+
+        // The owner may have lapped us while copying : anything at or below newHead - capacity could be torn
+        const uint64_t newHead = ring->head.load(std::memory_order_acquire);
+        const uint64_t safeBegin = newHead >= CPU_PROFILER_RING_EVENTS ? newHead - CPU_PROFILER_RING_EVENTS + 1 : 0;
+        const size_t skip = safeBegin > begin ? static_cast<size_t>(std::min(safeBegin - begin, head - begin)) : 0;
+
+        if (ring->threadName) {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId
+                << ",\"args\":{\"name\":\"" << ring->threadName << "\"}}";
+            first = false;
+        }
+
+        // A wrapped ring starts in the middle of scopes, their end events have no begin and are dropped
+        int depth = 0;
+        for (size_t i = skip; i < events.size(); i++) {
+            const CpuProfileEvent& event = events[i];
+            if (event.phase == 'E') {
+                if (depth == 0) { continue; }
+                depth--;
+            } else if (event.phase == 'B') {
+                depth++;
+            }
+            out << (first ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+                << "\",\"pid\":1,\"tid\":" << ring->threadId << ",\"ts\":" << event.timeNs / 1000 << '.'
+                << (event.timeNs / 100) % 10 << (event.timeNs / 10) % 10 << event.timeNs % 10
+                << (event.phase == 'i' ? ",\"s\":\"t\"}" : "}");
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    std::cout << "CPU trace written to " << path << std::endl;
+}
+
+/// Times the block it lives in
+struct CpuProfileScope {
+    const char* name;
+    explicit CpuProfileScope(const char* scopeName) : name(scopeName) { cpuProfilerRecord(name, 'B'); }
+    ~CpuProfileScope() { cpuProfilerRecord(name, 'E'); }
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+};
+
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+#define CPU_PROFILE_SCOPE(name) CpuProfileScope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#define CPU_PROFILE_BEGIN(name) cpuProfilerRecord(name, 'B')
+#define CPU_PROFILE_END() cpuProfilerRecord("", 'E')
+#define CPU_PROFILE_INSTANT(name) cpuProfilerRecord(name, 'i')
+#define CPU_PROFILE_THREAD_NAME(name) (cpuProfilerThreadRing()->threadName = (name))
+#define CPU_PROFILE_FLUSH(path) cpuProfilerFlush(path)
+
+#else
+
+#define CPU_PROFILE_SCOPE(name) ((void)0)
+#define CPU_PROFILE_BEGIN(name) ((void)0)
+#define CPU_PROFILE_END() ((void)0)
+#define CPU_PROFILE_INSTANT(name) ((void)0)
+#define CPU_PROFILE_THREAD_NAME(name) ((void)0)
+#define CPU_PROFILE_FLUSH(path) ((void)0)
+
+#endif
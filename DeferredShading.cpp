@@ -0,0 +1,1353 @@
+// Deferred shading : the MultipleLights scene rendered through a compact G-buffer,
+// lights accumulated by rasterizing their bounding volumes with stencil culling.
+// F switches between this path and the forward per-fragment light loop at runtime.
+
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "FixedTimestep.h"
+#include "GpuProfiler.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+/// Defining Globals variable ---- (start)
+/// Rendering
+constexpr int NUM_CUBES = 64;
+
+/// Simulation
+/// SceneObject spin speeds are given in degrees per frame at this rate, they turn at rotSpeed * 60 degrees per second
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+/// Cube spin advances in fixed ticks, so it turns at the same speed and costs the same work at any frame rate
+SimulationClock simClock;
+
+/// Camera
+constexpr float CAMERA_SPEED = 4.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// SpotLight
+constexpr float SPOT_LIGHT_INNER = 15.0f;
+constexpr float SPOT_LIGHT_OUTER = 30.0f;
+
+/// Point lights : the 3 animated MultipleLights lights plus up to MAX_EXTRA_LIGHTS small ones (- / = to change)
+constexpr int MAX_EXTRA_LIGHTS = 1024;
+constexpr int MAX_POINT_LIGHTS = 3 + MAX_EXTRA_LIGHTS;
+/// Contribution below this fraction of the light's brightest channel is treated as zero (~ 5/256)
+constexpr float LIGHT_CUTOFF = 0.02f;
+
+/// Light volume tessellation
+constexpr int SPHERE_RINGS = 8;
+constexpr int SPHERE_SEGMENTS = 12;
+constexpr int CONE_SEGMENTS = 16;
+
+/// Turn off or on spotlight
+bool bIsCameraLightOn = true;
+/// Deferred (true) or forward (false) path
+bool bUseDeferred = true;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 0.0f, 5.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() = default;
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe, dir.z : forward, dir.y : world vertical
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(glm::radians(FOV), aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles vertex and fragment shader from raw GLSL source strings, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource) {
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a vec2 uniform (screen size).
+    void setVec2(const char* uniform, const float x, const float y) const {
+        glUniform2f(glGetUniformLocation(ProgramID, uniform), x, y);
+    }
+
+    // Sets a float uniform (shininess, attenuation values, time, etc.).
+    void setFloat(const char* uniform, const float val) const {
+        glUniform1f(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Creating procedural texture ------------------ (start)
+class Texture {
+public:
+    // OpenGL texture handle — 0 = invalid/uninitialized
+    GLuint TextureID = 0;
+    Texture() {
+        glGenTextures(1, &TextureID);
+        glBindTexture(GL_TEXTURE_2D, TextureID);
+
+        // Texture dimensions — 256x256 pixels, RGBA.
+        constexpr int size = 256;
+        auto* data = new unsigned char[size * size * 4];
+
+        // Same procedural stripes as MultipleLights.
+        for (int y = 0 ; y < size ; y++) {
+            for (int x = 0 ; x < size ; x++) {
+                const float fx = static_cast<float>(x) / size;
+                const float fy = static_cast<float>(y) / size;
+                float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+                const int i = (y * size + x) * 4;
+                data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+                data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+                data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+                data[i+3] = 255;
+            }
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        delete[] data;
+
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    }
+};
+
+/// Creating procedural texture ------------------ (end)
+
+
+
+/// Light structs --------- (Start)
+// Distance at which attenuation drops below LIGHT_CUTOFF of the light's brightest channel.
+// Solves quadratic*d^2 + linear*d + constant = maxChannel / cutoff for d.
+float attenuationRadius(const glm::vec3& color, float constant, float linear, float quadratic) {
+    const float maxChannel = glm::max(color.x, glm::max(color.y, color.z));
+    const float c = constant - maxChannel / LIGHT_CUTOFF;
+    return (-linear + sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
+struct PointLight {
+    glm::vec3 position, color;
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+    float radius = 0.0f;
+
+    PointLight(glm::vec3 p, glm::vec3 c) : position(p), color(c) {
+        radius = attenuationRadius(color, constant, linear, quadratic);
+    }
+    PointLight(glm::vec3 p, glm::vec3 c, float l, float q) : position(p), color(c), linear(l), quadratic(q) {
+        radius = attenuationRadius(color, constant, linear, quadratic);
+    }
+};
+
+struct SpotLight {
+    glm::vec3 position, dir, color;
+    float innerCutoff, outerCutoff;
+    float outerAngle;
+    float constant = 1.0f;
+    float linear = 0.07f;
+    float quadratic = 0.017f;
+    float range = 0.0f;
+
+    SpotLight(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer)
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))), outerAngle(glm::radians(outer)) {
+        range = attenuationRadius(color, constant, linear, quadratic);
+    }
+};
+/// Light structs --------- (end)
+
+
+/// Material ------ (start)
+struct Material { glm::vec3 specular; float shininess; };
+
+Material materials[6] = {
+    {{1.0f,1.0f,1.0f}, 32.0f},
+    {{1.0f,1.0f,1.0f}, 64.0f},
+    {{1.0f,1.0f,1.0f}, 128.0f},
+    {{1.0f,1.0f,1.0f}, 256.0f},
+    {{0.9f,0.9f,0.9f}, 512.0f},
+    {{0.4f,0.9f,0.4f}, 1028.0f}
+};
+
+/// Material ------ (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVAO = 0;
+
+float cubeData[288] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
+     0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,  -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,  -0.5f, 0.5f,-0.5f, 0,0,-1, 0,1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,   0.5f,-0.5f, 0.5f, 0,0, 1, 1,0,   0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,
+     0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,  -0.5f, 0.5f, 0.5f, 0,0, 1, 0,1,  -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,
+    -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f,-0.5f,-1,0, 0, 1,1,
+    -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f, 0.5f,-1,0, 0, 0,0,
+     0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f,-0.5f, 1,0, 0, 1,1,
+     0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f, 0.5f, 1,0, 0, 0,0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,   0.5f,-0.5f,-0.5f, 0,-1,0, 1,1,   0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0, 0,0,  -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,
+    -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,   0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0, 1,1,
+     0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,  -0.5f, 0.5f, 0.5f, 0, 1,0, 0,0
+};
+
+void setupCubeVAO() {
+    unsigned int VBO;
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // uv
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+/// Cube vertex data ------------- (end)
+
+/// Light volume meshes ------------- (start)
+// Both meshes are slightly inflated so their flat faces fully contain the true sphere / cone.
+unsigned int sphereVAO = 0, coneVAO = 0;
+GLsizei sphereVertexCount = 0, coneVertexCount = 0;
+
+GLuint uploadPositions(const std::vector<glm::vec3>& positions) {
+    GLuint vao, vbo;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    return vao;
+}
+
+// Unit UV sphere, counter-clockwise triangles seen from outside.
+void setupSphereVAO() {
+    const float inflate = 1.0f / (cos(glm::pi<float>() / SPHERE_SEGMENTS) * cos(glm::pi<float>() / (2.0f * SPHERE_RINGS)));
+    auto point = [&](int ring, int segment) {
+        const float theta = glm::pi<float>() * ring / SPHERE_RINGS;             // 0 at +Y, pi at -Y
+        const float phi = 2.0f * glm::pi<float>() * segment / SPHERE_SEGMENTS;
+        return glm::vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)) * inflate;
+    };
+    std::vector<glm::vec3> positions;
+    for (int r = 0; r < SPHERE_RINGS; r++) {
+        for (int s = 0; s < SPHERE_SEGMENTS; s++) {
+            const glm::vec3 a = point(r, s), b = point(r, s + 1), c = point(r + 1, s), d = point(r + 1, s + 1);
+            if (r != 0) { positions.push_back(a); positions.push_back(b); positions.push_back(c); }
+            if (r != SPHERE_RINGS - 1) { positions.push_back(b); positions.push_back(d); positions.push_back(c); }
+        }
+    }
+    sphereVertexCount = static_cast<GLsizei>(positions.size());
+    sphereVAO = uploadPositions(positions);
+}
+
+// Unit cone : apex at the origin, opening along -Z, base of radius 1 at z = -1, closed by a cap.
+void setupConeVAO() {
+    const float inflate = 1.0f / cos(glm::pi<float>() / CONE_SEGMENTS);
+    std::vector<glm::vec3> positions;
+    const glm::vec3 apex(0.0f), capCenter(0.0f, 0.0f, -1.0f);
+    for (int s = 0; s < CONE_SEGMENTS; s++) {
+        const float a0 = 2.0f * glm::pi<float>() * s / CONE_SEGMENTS;
+        const float a1 = 2.0f * glm::pi<float>() * (s + 1) / CONE_SEGMENTS;
+        const glm::vec3 p0(cos(a0) * inflate, sin(a0) * inflate, -1.0f);
+        const glm::vec3 p1(cos(a1) * inflate, sin(a1) * inflate, -1.0f);
+        positions.push_back(apex); positions.push_back(p0); positions.push_back(p1);
+        positions.push_back(capCenter); positions.push_back(p1); positions.push_back(p0);
+    }
+    coneVertexCount = static_cast<GLsizei>(positions.size());
+    coneVAO = uploadPositions(positions);
+}
+/// Light volume meshes ------------- (end)
+
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (start)
+class SceneObject {
+public:
+    glm::mat4 model{};
+    int matId;
+    float rotSpeed;
+
+    // Translation and scale, the spin is applied on top
+    glm::mat4 base{};
+    // Spin in degrees at the latest and the previous simulation tick
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObject(glm::vec3 pos, float scale, int mat, float rot) : matId(mat), rotSpeed(rot) {
+        base = glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(scale));
+        model = base;
+    }
+
+    // One simulation tick
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        // Keep the angle small so it does not lose precision over a long run, both move so the blend is unchanged
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    // Model matrix between the previous and the latest tick
+    void interpolate(float alpha) {
+        model = glm::rotate(base, glm::radians(previousAngle + (angle - previousAngle) * alpha), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (end)
+
+
+/// shaders --------- (Start)
+// Shared GLSL : point light data layout, attenuation, and the Blinn-Phong terms both paths use.
+// Point lights live in a texture buffer, 3 texels per light :
+// (position, radius) (color, constant) (linear, quadratic, -, -)
+const char* lightingCommonGLSL = R"(
+uniform samplerBuffer lightData;
+
+struct PointLight {
+    vec3 position;
+    float radius;
+    vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+PointLight fetchPointLight(int index) {
+    vec4 a = texelFetch(lightData, index * 3);
+    vec4 b = texelFetch(lightData, index * 3 + 1);
+    vec4 c = texelFetch(lightData, index * 3 + 2);
+    return PointLight(a.xyz, a.w, b.rgb, b.a, c.x, c.y);
+}
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float innerCutOff;
+    float outerCutOff;
+    float constant;
+    float linear;
+    float quadratic;
+    float range;
+};
+
+float attenuate(float distance, float constant, float linear, float quadratic) {
+    return 1.0 / (constant + linear * distance + quadratic * distance * distance);
+}
+
+// Fades the light to exactly zero at its radius so geometry outside the light volume is never missing light.
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+vec3 calPointLightEffect(PointLight light, vec3 fragPos, vec3 norm, vec3 viewDir, vec3 specularColor, float shininess) {
+    vec3 toLight = light.position - fragPos;
+    float distance = length(toLight);
+    vec3 lightDir = toLight / distance;
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.radius);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), shininess);
+    vec3 specular = spec * light.color * specularColor;
+
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+vec3 calSpotLightEffect(SpotLight light, vec3 fragPos, vec3 norm, vec3 viewDir, vec3 specularColor, float shininess) {
+    vec3 lightDir = normalize(light.position - fragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon , 0.0, 1.0);
+
+    if(intensity <= 0) return vec3(0.0);
+
+    float distance = length(light.position - fragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.range);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff    = max(dot(norm, lightDir), 0.0);
+    vec3  diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), shininess);
+    vec3 specular = spec * light.color * specularColor;
+
+    return (ambient + (diffuse + specular) * intensity) * attenuation;
+}
+)";
+
+// G-buffer encoding : octahedral normal + log2 shininess packed in RGB10_A2, albedo + specular in RGBA8.
+const char* gBufferCommonGLSL = R"(
+uniform sampler2D gAlbedoSpec;
+uniform sampler2D gNormalShininess;
+uniform sampler2D gDepth;
+uniform mat4 invViewProjection;
+uniform vec2 screenSize;
+
+vec2 signNotZero(vec2 v) {
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 encodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    return e * 0.5 + 0.5;
+}
+
+vec3 decodeNormal(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy -= t * signNotZero(n.xy);
+    return normalize(n);
+}
+
+// Shininess 1 .. 2048 stored as log2 / 11 in 10 bits
+float encodeShininess(float s) { return log2(max(s, 1.0)) / 11.0; }
+float decodeShininess(float e) { return exp2(e * 11.0); }
+
+// World position rebuilt from the depth buffer, no position target needed
+vec3 reconstructPosition(vec2 uv, float depth) {
+    vec4 world = invViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    return world.xyz / world.w;
+}
+)";
+
+/// Forward path : the MultipleLights shader, lights read from the same buffer as the deferred path
+const char* forwardVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model, view, projection;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = aTexCoord;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+const std::string forwardFragmentShaderSource = std::string(R"(
+#version 410 core
+)") + lightingCommonGLSL + R"(
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+
+uniform SpotLight cameraLight;
+uniform int pointLightCount;
+uniform vec3 viewPos;
+uniform Material material;
+uniform int isCameraLightOn;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+out vec4 FragColor;
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec4 texColor = texture(material.diffuseTex, TexCoord);
+
+    vec3 result = 0.1 * texColor.rgb;
+    if (isCameraLightOn == 1) {
+        result += calSpotLightEffect(cameraLight, FragPos, norm, viewDir, material.specular, material.shininess) * texColor.rgb;
+    }
+
+    // Every light, every fragment
+    for (int i = 0; i < pointLightCount; i++) {
+        result += calPointLightEffect(fetchPointLight(i), FragPos, norm, viewDir, material.specular, material.shininess) * texColor.rgb;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+/// Geometry pass : fills the G-buffer, no lighting
+const std::string gBufferFragmentShaderSource = std::string(R"(
+#version 410 core
+)") + gBufferCommonGLSL + R"(
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+uniform Material material;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+
+layout (location = 0) out vec4 outAlbedoSpec;
+layout (location = 1) out vec4 outNormalShininess;
+
+void main() {
+    vec3 albedo = texture(material.diffuseTex, TexCoord).rgb;
+    float specular = dot(material.specular, vec3(1.0 / 3.0));
+    outAlbedoSpec = vec4(albedo, specular);
+    outNormalShininess = vec4(encodeNormal(normalize(Normal)), encodeShininess(material.shininess), 0.0);
+}
+)";
+
+/// Full-screen triangle, no vertex buffer needed
+const char* fullScreenVertexShaderSource = R"(
+#version 410 core
+void main() {
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+/// Ambient term + background, written once per pixel before lights are added on top
+const std::string ambientFragmentShaderSource = std::string(R"(
+#version 410 core
+)") + gBufferCommonGLSL + R"(
+uniform vec3 backgroundColor;
+out vec4 FragColor;
+void main() {
+    vec2 uv = gl_FragCoord.xy / screenSize;
+    if (texture(gDepth, uv).r >= 1.0) {
+        FragColor = vec4(backgroundColor, 1.0);
+        return;
+    }
+    FragColor = vec4(0.1 * texture(gAlbedoSpec, uv).rgb, 1.0);
+}
+)";
+
+/// Light volumes : instanced spheres for point lights, one cone per spot light
+const char* pointVolumeVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 view, projection;
+uniform samplerBuffer lightData;
+flat out int LightIndex;
+void main() {
+    vec4 positionRadius = texelFetch(lightData, gl_InstanceID * 3);
+    LightIndex = gl_InstanceID;
+    gl_Position = projection * view * vec4(positionRadius.xyz + aPos * positionRadius.w, 1.0);
+}
+)";
+
+const char* spotVolumeVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 model, view, projection;
+void main() {
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)";
+
+/// Stencil marking pass writes no color
+const char* emptyFragmentShaderSource = R"(
+#version 410 core
+void main() {}
+)";
+
+const std::string pointLightFragmentShaderSource = std::string(R"(
+#version 410 core
+)") + lightingCommonGLSL + gBufferCommonGLSL + R"(
+uniform vec3 viewPos;
+flat in int LightIndex;
+out vec4 FragColor;
+void main() {
+    vec2 uv = gl_FragCoord.xy / screenSize;
+    vec3 fragPos = reconstructPosition(uv, texture(gDepth, uv).r);
+    PointLight light = fetchPointLight(LightIndex);
+    if (distance(fragPos, light.position) >= light.radius) discard;
+
+    vec4 albedoSpec = texture(gAlbedoSpec, uv);
+    vec3 normalShininess = texture(gNormalShininess, uv).rgb;
+    vec3 norm = decodeNormal(normalShininess.xy);
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 light3 = calPointLightEffect(light, fragPos, norm, viewDir, vec3(albedoSpec.a), decodeShininess(normalShininess.z));
+    FragColor = vec4(light3 * albedoSpec.rgb, 1.0);
+}
+)";
+
+const std::string spotLightFragmentShaderSource = std::string(R"(
+#version 410 core
+)") + lightingCommonGLSL + gBufferCommonGLSL + R"(
+uniform SpotLight spotLight;
+uniform vec3 viewPos;
+out vec4 FragColor;
+void main() {
+    vec2 uv = gl_FragCoord.xy / screenSize;
+    vec3 fragPos = reconstructPosition(uv, texture(gDepth, uv).r);
+    vec4 albedoSpec = texture(gAlbedoSpec, uv);
+    vec3 normalShininess = texture(gNormalShininess, uv).rgb;
+    vec3 norm = decodeNormal(normalShininess.xy);
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 light3 = calSpotLightEffect(spotLight, fragPos, norm, viewDir, vec3(albedoSpec.a), decodeShininess(normalShininess.z));
+    FragColor = vec4(light3 * albedoSpec.rgb, 1.0);
+}
+)";
+
+// Light markers : one small cube per light, instanced, position and color read from the light buffer
+const char* lightCubeVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+uniform mat4 view, projection;
+uniform samplerBuffer lightData;
+out vec3 emissiveColor;
+void main(){
+    vec3 position = texelFetch(lightData, gl_InstanceID * 3).xyz;
+    emissiveColor = texelFetch(lightData, gl_InstanceID * 3 + 1).rgb;
+    float size = gl_InstanceID < 3 ? 0.3 : 0.08;
+    gl_Position = projection * view * vec4(aPos * size + position, 1.0);
+})";
+
+const char* lightCubeFS = R"(
+#version 410 core
+in vec3 emissiveColor;
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(emissiveColor, 1.0);
+})";
+/// shaders --------- (End)
+
+
+/// G-buffer ------ (start)
+// RT0 RGBA8    : albedo.rgb, specular intensity
+// RT1 RGB10_A2 : octahedral normal.xy, log2 shininess
+// depth        : DEPTH24_STENCIL8 texture, world position is rebuilt from it
+// 8 bytes of color + 4 bytes of depth per pixel.
+// The light pass tests against a separate depth-stencil renderbuffer (a blit copy of the G-buffer depth),
+// so the depth texture it samples is never attached to the framebuffer being drawn to.
+struct GBuffer {
+    GLuint fbo = 0;
+    GLuint albedoSpec = 0;
+    GLuint normalShininess = 0;
+    GLuint depthStencil = 0;
+
+    GLuint lightFbo = 0;
+    GLuint lightColor = 0;
+    GLuint lightDepthStencil = 0;
+
+    int width = 0, height = 0;
+
+    static GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type, int w, int h) {
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return tex;
+    }
+
+    void create(int w, int h) {
+        destroy();
+        width = w;
+        height = h;
+
+        albedoSpec = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, w, h);
+        normalShininess = createTexture(GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, w, h);
+        depthStencil = createTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, w, h);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoSpec, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalShininess, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthStencil, 0);
+        const GLenum drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        glDrawBuffers(2, drawBuffers);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "G-buffer framebuffer incomplete" << std::endl;
+        }
+
+        lightColor = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, w, h);
+        glGenRenderbuffers(1, &lightDepthStencil);
+        glBindRenderbuffer(GL_RENDERBUFFER, lightDepthStencil);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+
+        glGenFramebuffers(1, &lightFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, lightFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightColor, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, lightDepthStencil);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "Light accumulation framebuffer incomplete" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void bindTextures() const {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, albedoSpec);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, normalShininess);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, depthStencil);
+    }
+
+    void destroy() {
+        if (fbo == 0) return;
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteFramebuffers(1, &lightFbo);
+        const GLuint textures[4] = {albedoSpec, normalShininess, depthStencil, lightColor};
+        glDeleteTextures(4, textures);
+        glDeleteRenderbuffers(1, &lightDepthStencil);
+        fbo = 0;
+    }
+};
+/// G-buffer ------ (end)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* forwardShader = nullptr;
+Shader* gBufferShader = nullptr;
+Shader* ambientShader = nullptr;
+Shader* stencilShader = nullptr;
+Shader* spotStencilShader = nullptr;
+Shader* pointLightShader = nullptr;
+Shader* spotLightShader = nullptr;
+Shader* lightingShader = nullptr;
+Texture* defaultTexture = nullptr;
+GBuffer gBuffer;
+
+std::vector<SceneObject> sceneObjects;
+SpotLight cameraLight(glm::vec3(0.0f), glm::vec3(0.0f,0.0f,-1.0f), glm::vec3(1.0f, 1.0f, 1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER);
+
+std::vector<PointLight> pointLights = {
+    { glm::vec3( 0.0f, 8.0f,  0.0f), glm::vec3(1.0f, 0.55f, 0.15f) }, // warm orange
+    { glm::vec3(12.0f, 5.0f, -6.0f), glm::vec3(0.2f, 0.75f, 1.0f ) }, // cool cyan
+    { glm::vec3(-10.0f,7.0f, 10.0f), glm::vec3(1.0f, 0.3f,  0.5f ) }  // pink-red
+};
+/// Extra small lights wandering through the cubes, changed with - / =
+int extraLightCount = 0;
+std::vector<glm::vec3> extraLightAnchors;
+
+int WindowWidth, WindowHeight;
+bool bResizeGBuffer = false;
+glm::vec3 backgroundColor(0.04f, 0.04f, 0.08f);
+/// Global Objects ------ (End)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+    bResizeGBuffer = true;
+}
+
+// Key presses that toggle, as opposed to keys held down for movement
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_F) {
+        bUseDeferred = !bUseDeferred;
+        std::cout << (bUseDeferred ? "Deferred" : "Forward") << " path" << std::endl;
+    }
+    if (key == GLFW_KEY_EQUAL) extraLightCount = std::min(std::max(extraLightCount * 2, 8), MAX_EXTRA_LIGHTS);
+    if (key == GLFW_KEY_MINUS) extraLightCount = extraLightCount <= 8 ? 0 : extraLightCount / 2;
+}
+
+bool roamFirstLight = false;
+bool roamSecondLight = false;
+bool roamThirdLight = false;
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+    if(glfwGetKey(win, GLFW_KEY_O) == GLFW_PRESS) bIsCameraLightOn = true;
+    if(glfwGetKey(win, GLFW_KEY_P) == GLFW_PRESS) bIsCameraLightOn = false;
+
+    if(glfwGetKey(win, GLFW_KEY_1) == GLFW_PRESS) {
+        roamFirstLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_2) == GLFW_PRESS) {
+        roamSecondLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_3) == GLFW_PRESS) {
+        roamThirdLight = true;
+    } else {
+        roamFirstLight = false;
+        roamSecondLight = false;
+        roamThirdLight = false;
+    }
+}
+/// Callbacks ----- (End)
+
+
+/// Light uploads ------ (start)
+// 3 texels per light, same layout as fetchPointLight() in the shaders.
+void uploadPointLights(GLuint buffer, std::vector<float>& scratch) {
+    scratch.resize(pointLights.size() * 12);
+    for (size_t i = 0; i < pointLights.size(); i++) {
+        const PointLight& l = pointLights[i];
+        float* dst = &scratch[i * 12];
+        dst[0] = l.position.x; dst[1] = l.position.y; dst[2] = l.position.z; dst[3] = l.radius;
+        dst[4] = l.color.x;    dst[5] = l.color.y;    dst[6] = l.color.z;    dst[7] = l.constant;
+        dst[8] = l.linear;     dst[9] = l.quadratic;  dst[10] = 0.0f;        dst[11] = 0.0f;
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, MAX_POINT_LIGHTS * 12 * sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, scratch.size() * sizeof(float), scratch.data());
+}
+
+void setSpotLightUniforms(const Shader* shader, const char* name, const SpotLight& light) {
+    const std::string b = std::string(name) + ".";
+    shader->setVec3 ((b + "position").c_str(), light.position);
+    shader->setVec3 ((b + "direction").c_str(), light.dir);
+    shader->setVec3 ((b + "color").c_str(), light.color);
+    shader->setFloat((b + "innerCutOff").c_str(), light.innerCutoff);
+    shader->setFloat((b + "outerCutOff").c_str(), light.outerCutoff);
+    shader->setFloat((b + "constant").c_str(), light.constant);
+    shader->setFloat((b + "linear").c_str(), light.linear);
+    shader->setFloat((b + "quadratic").c_str(), light.quadratic);
+    shader->setFloat((b + "range").c_str(), light.range);
+}
+
+// Cone model matrix : apex at the light, -Z along the light direction, base sized to the range and outer angle.
+glm::mat4 spotVolumeMatrix(const SpotLight& light) {
+    const glm::vec3 worldUp = fabs(light.dir.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    const glm::mat4 orient = glm::inverse(glm::lookAt(light.position, light.position + light.dir, worldUp));
+    const float baseRadius = light.range * tan(light.outerAngle);
+    return glm::scale(orient, glm::vec3(baseRadius, baseRadius, light.range));
+}
+/// Light uploads ------ (end)
+
+
+/// Timers ------ (start)
+// GPU time per pass, read back PROFILER_FRAMES late so the CPU never waits on the GPU.
+enum TimedPass { PASS_FORWARD, PASS_GEOMETRY, PASS_LIGHTING, PASS_COUNT };
+const char* passNames[PASS_COUNT] = {"forward", "geometry", "lighting"};
+GpuProfiler gpuProfiler;
+
+void beginPass(TimedPass pass) {
+    profilerPush(&gpuProfiler, passNames[pass]);
+}
+
+void endPass(TimedPass) {
+    profilerPop(&gpuProfiler);
+}
+/// Timers ------ (end)
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Deferred Shading", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    lastX = static_cast<float>(mode->width) / 2.0f;
+    lastY = static_cast<float>(mode->height) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    setupCubeVAO();
+    setupSphereVAO();
+    setupConeVAO();
+    GLuint emptyVAO;
+    glGenVertexArrays(1, &emptyVAO);
+
+    defaultTexture = new Texture();
+    forwardShader = new Shader(forwardVertexShaderSource, forwardFragmentShaderSource.c_str());
+    gBufferShader = new Shader(forwardVertexShaderSource, gBufferFragmentShaderSource.c_str());
+    ambientShader = new Shader(fullScreenVertexShaderSource, ambientFragmentShaderSource.c_str());
+    stencilShader = new Shader(pointVolumeVertexShaderSource, emptyFragmentShaderSource);
+    spotStencilShader = new Shader(spotVolumeVertexShaderSource, emptyFragmentShaderSource);
+    pointLightShader = new Shader(pointVolumeVertexShaderSource, pointLightFragmentShaderSource.c_str());
+    spotLightShader = new Shader(spotVolumeVertexShaderSource, spotLightFragmentShaderSource.c_str());
+    lightingShader = new Shader(lightCubeVS, lightCubeFS);
+    camera = new Camera();
+    gBuffer.create(WindowWidth, WindowHeight);
+
+    // Light buffer : texture unit 4 in every program that reads lights
+    GLuint lightBuffer, lightBufferTex;
+    glGenBuffers(1, &lightBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, MAX_POINT_LIGHTS * 12 * sizeof(float), nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, &lightBufferTex);
+    glBindTexture(GL_TEXTURE_BUFFER, lightBufferTex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightBuffer);
+    std::vector<float> lightScratch;
+
+    // Samplers never change unit, set once : 0 diffuse, 1-3 G-buffer, 4 lights
+    for (const Shader* shader : {forwardShader, gBufferShader, ambientShader, stencilShader, pointLightShader, spotLightShader, lightingShader}) {
+        shader->use();
+        shader->setInt("material.diffuseTex", 0);
+        shader->setInt("gAlbedoSpec", 1);
+        shader->setInt("gNormalShininess", 2);
+        shader->setInt("gDepth", 3);
+        shader->setInt("lightData", 4);
+    }
+
+    profilerInit(&gpuProfiler);
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_real_distribution<float> rPos(-15.0f, 15.0f), rRot(-1.5f,1.5f);
+    std::uniform_int_distribution<int> rMat(0,4);
+
+    for(int i = 0; i < NUM_CUBES; i++){
+        float scale = 0.6f + (i%5)*0.1f;
+        sceneObjects.emplace_back(glm::vec3(rPos(gen), rPos(gen)*0.3f+1.0f, rPos(gen)),scale, rMat(gen), rRot(gen));
+    }
+    for (int i = 0; i < MAX_EXTRA_LIGHTS; i++) {
+        extraLightAnchors.emplace_back(rPos(gen), rPos(gen) * 0.3f + 1.0f, rPos(gen));
+    }
+
+    auto lastTime = std::chrono::high_resolution_clock::now();
+    double lastStatsTime = glfwGetTime();
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+
+        float time = static_cast<float>(glfwGetTime());
+        processInput(window, dt);
+        profilerBeginFrame(&gpuProfiler);
+
+        if (bResizeGBuffer) {
+            gBuffer.create(WindowWidth, WindowHeight);
+            bResizeGBuffer = false;
+        }
+
+        // --- Animate point lights ---
+        // [0] orbits horizontally around scene centre
+        pointLights[0].position.x = 8.0f * sin(time * 0.3f);
+        pointLights[0].position.z = 8.0f * cos(time * 0.3f);
+        pointLights[0].position.y = 7.0f + sin(time * 0.5f) * 1.5f;
+
+        // [1] bobs up and down on the right side
+        pointLights[1].position.y = 5.0f + sin(time * 0.7f) * 3.0f;
+        pointLights[1].position.x = 10.0f * cos(time * 0.2f);
+
+        // [2] sweeps front-back on the left side
+        pointLights[2].position.z = 8.0f * sin(time * 0.4f);
+        pointLights[2].position.y = 6.0f + cos(time * 0.6f) * 2.0f;
+
+        // Extra lights : short range, circling their anchors
+        pointLights.resize(3, pointLights[0]);
+        for (int i = 0; i < extraLightCount; i++) {
+            const float a = time * 0.5f + static_cast<float>(i) * 2.399f;
+            const glm::vec3 p = extraLightAnchors[i] + glm::vec3(cos(a), sin(a * 1.7f) * 0.5f, sin(a)) * 1.5f;
+            const glm::vec3 c = glm::vec3(0.5f + 0.5f * sin(i * 1.3f), 0.5f + 0.5f * sin(i * 2.1f + 2.0f), 0.5f + 0.5f * sin(i * 0.7f + 4.0f));
+            pointLights.emplace_back(p, c, 0.7f, 1.8f);
+        }
+        const int pointLightCount = static_cast<int>(pointLights.size());
+
+        if (roamFirstLight) {
+            camera->position = pointLights[0].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamSecondLight) {
+            camera->position = pointLights[1].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamThirdLight) {
+            camera->position = pointLights[2].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        }
+
+        // --- Animate camera lights ---
+        cameraLight.position = camera->position;
+        cameraLight.dir = camera->front;
+
+        glm::mat4 proj = camera->getProjectionMatrix(static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight));
+        glm::mat4 view = camera->getViewMatrix();
+        glm::mat4 invViewProj = glm::inverse(proj * view);
+
+        simClockAdvance(&simClock, dt);
+        while (simClockStep(&simClock)) {
+            for(auto& obj : sceneObjects){
+                obj.update(static_cast<float>(simClock.tickSeconds));
+            }
+        }
+        const float alpha = simClockAlpha(&simClock);
+        for(auto& obj : sceneObjects){
+            obj.interpolate(alpha);
+        }
+        uploadPointLights(lightBuffer, lightScratch);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_BUFFER, lightBufferTex);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+
+        if (!bUseDeferred) {
+            // ---------------- Forward : every fragment loops over every light ----------------
+            beginPass(PASS_FORWARD);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glEnable(GL_DEPTH_TEST);
+            glDepthMask(GL_TRUE);
+            glClearColor(backgroundColor.x, backgroundColor.y, backgroundColor.z, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            forwardShader->use();
+            forwardShader->setMat4("projection", proj);
+            forwardShader->setMat4("view", view);
+            forwardShader->setVec3("viewPos", camera->position);
+            forwardShader->setInt("isCameraLightOn", bIsCameraLightOn ? 1 : 0);
+            forwardShader->setInt("pointLightCount", pointLightCount);
+            setSpotLightUniforms(forwardShader, "cameraLight", cameraLight);
+
+            glBindVertexArray(cubeVAO);
+            for(auto& obj : sceneObjects){
+                forwardShader->setMat4 ("model", obj.model);
+                forwardShader->setVec3 ("material.specular", materials[obj.matId].specular);
+                forwardShader->setFloat("material.shininess", materials[obj.matId].shininess);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            endPass(PASS_FORWARD);
+        } else {
+            // ---------------- Deferred : geometry once, then each light only touches pixels inside its volume ----------------
+            beginPass(PASS_GEOMETRY);
+            glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.fbo);
+            glEnable(GL_DEPTH_TEST);
+            glDepthMask(GL_TRUE);
+            glDepthFunc(GL_LESS);
+            glStencilMask(0xFF);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+            gBufferShader->use();
+            gBufferShader->setMat4("projection", proj);
+            gBufferShader->setMat4("view", view);
+            glBindVertexArray(cubeVAO);
+            for(auto& obj : sceneObjects){
+                gBufferShader->setMat4 ("model", obj.model);
+                gBufferShader->setVec3 ("material.specular", materials[obj.matId].specular);
+                gBufferShader->setFloat("material.shininess", materials[obj.matId].shininess);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+
+            // Copy depth into the renderbuffer the light pass tests against
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer.fbo);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gBuffer.lightFbo);
+            glBlitFramebuffer(0, 0, gBuffer.width, gBuffer.height, 0, 0, gBuffer.width, gBuffer.height,
+                              GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+            endPass(PASS_GEOMETRY);
+
+            beginPass(PASS_LIGHTING);
+            glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.lightFbo);
+            gBuffer.bindTextures();
+
+            // Ambient + background, one full-screen triangle
+            glDisable(GL_DEPTH_TEST);
+            glDepthMask(GL_FALSE);
+            ambientShader->use();
+            ambientShader->setVec2("screenSize", static_cast<float>(WindowWidth), static_cast<float>(WindowHeight));
+            ambientShader->setVec3("backgroundColor", backgroundColor);
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            glEnable(GL_STENCIL_TEST);
+
+            // Two passes per volume :
+            // 1. Stencil : both faces depth tested against the scene, no color. Back faces that fail increment,
+            //    front faces that fail decrement, so only pixels whose surface lies inside a volume end non-zero.
+            //    Counting depth failures keeps this correct when the camera is inside the volume.
+            // 2. Shade : back faces only (still rasterized when the camera is inside), stencil != 0, additive.
+            auto markVolumes = [&](const Shader* shader, GLuint vao, GLsizei vertexCount, GLsizei instances) {
+                glClear(GL_STENCIL_BUFFER_BIT);
+                glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                glEnable(GL_DEPTH_TEST);
+                glDepthFunc(GL_LESS);
+                glDisable(GL_CULL_FACE);
+                glStencilFunc(GL_ALWAYS, 0, 0xFF);
+                glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+                glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+                shader->use();
+                glBindVertexArray(vao);
+                glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instances);
+            };
+            auto beginShadeVolumes = [&]() {
+                glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                glDisable(GL_DEPTH_TEST);
+                glEnable(GL_CULL_FACE);
+                glCullFace(GL_FRONT);
+                glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+                glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+            };
+
+            // Point lights : all volumes in one instanced draw per pass
+            stencilShader->use();
+            stencilShader->setMat4("projection", proj);
+            stencilShader->setMat4("view", view);
+            markVolumes(stencilShader, sphereVAO, sphereVertexCount, pointLightCount);
+
+            beginShadeVolumes();
+            pointLightShader->use();
+            pointLightShader->setMat4("projection", proj);
+            pointLightShader->setMat4("view", view);
+            pointLightShader->setMat4("invViewProjection", invViewProj);
+            pointLightShader->setVec2("screenSize", static_cast<float>(WindowWidth), static_cast<float>(WindowHeight));
+            pointLightShader->setVec3("viewPos", camera->position);
+            glBindVertexArray(sphereVAO);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, sphereVertexCount, pointLightCount);
+
+            // Spot light : cone volume
+            if (bIsCameraLightOn) {
+                const glm::mat4 coneModel = spotVolumeMatrix(cameraLight);
+                spotStencilShader->use();
+                spotStencilShader->setMat4("projection", proj);
+                spotStencilShader->setMat4("view", view);
+                spotStencilShader->setMat4("model", coneModel);
+                markVolumes(spotStencilShader, coneVAO, coneVertexCount, 1);
+
+                beginShadeVolumes();
+                spotLightShader->use();
+                spotLightShader->setMat4("projection", proj);
+                spotLightShader->setMat4("view", view);
+                spotLightShader->setMat4("model", coneModel);
+                spotLightShader->setMat4("invViewProjection", invViewProj);
+                spotLightShader->setVec2("screenSize", static_cast<float>(WindowWidth), static_cast<float>(WindowHeight));
+                spotLightShader->setVec3("viewPos", camera->position);
+                setSpotLightUniforms(spotLightShader, "spotLight", cameraLight);
+                glBindVertexArray(coneVAO);
+                glDrawArrays(GL_TRIANGLES, 0, coneVertexCount);
+            }
+
+            glDisable(GL_STENCIL_TEST);
+            glDisable(GL_CULL_FACE);
+            glDisable(GL_BLEND);
+            glEnable(GL_DEPTH_TEST);
+            glDepthMask(GL_TRUE);
+            endPass(PASS_LIGHTING);
+        }
+
+        // Light markers, depth tested against whichever depth buffer is bound
+        glActiveTexture(GL_TEXTURE0);
+        lightingShader->use();
+        lightingShader->setMat4("projection", proj);
+        lightingShader->setMat4("view", view);
+        glBindVertexArray(cubeVAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, pointLightCount);
+
+        if (bUseDeferred) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer.lightFbo);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, gBuffer.width, gBuffer.height, 0, 0, WindowWidth, WindowHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        profilerEndFrame(&gpuProfiler);
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+        // --- Pass costs, rolling averages printed every ~2 seconds ---
+        if (glfwGetTime() - lastStatsTime >= 2.0) {
+            std::cout << (bUseDeferred ? "deferred" : "forward") << " | " << pointLightCount << " point lights";
+            // Only the passes of the current mode were resolved since the last report
+            for (auto& stat : gpuProfiler.stats) {
+                if (stat.windowSamples > 0) std::cout << " | " << stat.path << " " << stat.averageMs << " ms";
+                stat.windowSamples = 0;
+            }
+            std::cout << std::endl;
+            lastStatsTime = glfwGetTime();
+        }
+    }
+
+    profilerDestroy(&gpuProfiler);
+    gBuffer.destroy();
+    glDeleteTextures(1, &lightBufferTex);
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &sphereVAO);
+    glDeleteVertexArrays(1, &coneVAO);
+    glDeleteVertexArrays(1, &emptyVAO);
+    delete forwardShader;
+    delete gBufferShader;
+    delete ambientShader;
+    delete stencilShader;
+    delete spotStencilShader;
+    delete pointLightShader;
+    delete spotLightShader;
+    delete lightingShader;
+    delete defaultTexture;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}
@@ -10,6 +10,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "stb_image.h"
+#include "GLDebug.h"
 
 // Shader helpers ----- (start)
 int success;
@@ -277,6 +278,7 @@ GLuint loadTexture(const char* path) {
         else if (channels == 4) { format = GL_RGBA; }
 
         glBindTexture(GL_TEXTURE_2D, texture);
+        GL_DEBUG_LABEL_TEXTURE(texture, path);
         glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format), width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -295,6 +297,7 @@ GLuint loadCubemap(std::vector<std::string> faces)
     GLuint texID;
     glGenTextures(1, &texID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+    GL_DEBUG_LABEL(GL_TEXTURE, texID, "skybox");
 
     int w, h, ch;
     for (unsigned int i = 0; i < faces.size(); i++) {
@@ -348,6 +351,7 @@ int main() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    GL_DEBUG_WINDOW_HINTS();
 
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -364,6 +368,7 @@ int main() {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    GL_DEBUG_INIT();
 
     int fbWidth, fbHeight;
     glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
@@ -382,14 +387,17 @@ int main() {
     // Compile shader
     std::cout << "Compiling Lighting Program --- (start)" << std::endl;
     GLuint lightingProgram = createProgram(lightingVertexShaderSource, lightingFragmentShaderSource);
+    GL_DEBUG_LABEL(GL_PROGRAM, lightingProgram, "lightingProgram");
     std::cout << "Compiling Lighting Program --- (end)" << std::endl;
 
     std::cout << "Compiling lighting cube program -- (start)" << std::endl;
     GLuint lightCubeProgram = createProgram(lightCubeVertexShaderSource, lightCubeFragmentShaderSource);
+    GL_DEBUG_LABEL(GL_PROGRAM, lightCubeProgram, "lightCubeProgram");
     std::cout << "Compiling lighting cube program -- (end)" << std::endl;
 
     std::cout << "Generating ShaderProgramSky --- (start)" << std::endl;
     GLuint ShaderProgramSky = createProgram(VertexShaderSourceSky, FragmentShaderSourceSky);
+    GL_DEBUG_LABEL(GL_PROGRAM, ShaderProgramSky, "ShaderProgramSky");
     std::cout << "Generating ShaderProgramSky --- (end)" << std::endl;
 
 
@@ -451,8 +459,10 @@ int main() {
     GLuint VBO, cubeVAO, lightCubeVAO;
     glGenVertexArrays(1, &cubeVAO);
     glBindVertexArray(cubeVAO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, cubeVAO, "cubeVAO");
     glGenBuffers(1, &VBO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GL_DEBUG_LABEL(GL_BUFFER, VBO, "cube vertices");
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
     glEnableVertexAttribArray(0);
@@ -463,6 +473,7 @@ int main() {
 
     glGenVertexArrays(1, &lightCubeVAO);
     glBindVertexArray(lightCubeVAO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, lightCubeVAO, "lightCubeVAO");
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
     glEnableVertexAttribArray(0);
@@ -474,6 +485,8 @@ int main() {
 
     glBindVertexArray(skyVAO);
     glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, skyVAO, "skyVAO");
+    GL_DEBUG_LABEL(GL_BUFFER, skyVBO, "sky vertices");
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), nullptr);
@@ -596,10 +609,8 @@ int main() {
         glfwSwapBuffers(window);
         glfwPollEvents();
 
-        GLenum err = glGetError();
-        if (err != GL_NO_ERROR) {
-            std::cerr << "OpenGL error: 0x" << std::hex << err << std::dec << std::endl;
-        }
+        // Errors come through the debug callback, this only polls where KHR_debug is missing (debug builds only)
+        GL_DEBUG_FRAME_CHECK();
     }
 
     glDeleteVertexArrays(1, &cubeVAO);
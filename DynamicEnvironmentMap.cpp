@@ -0,0 +1,1262 @@
+// Dynamic environment map : the MultipleLights scene captured into a cube map around a mirror sphere, all six
+// faces in one pass. A layered framebuffer takes the cube's colour and depth, and the geometry shader runs six
+// invocations per triangle, each writing gl_Layer for its face.
+// Every object is tested against the six 90 degree face frustums on the CPU. The resulting face mask goes to
+// the geometry shader, so an object only reaches the faces that can see it, and an object no refreshed face
+// sees is not drawn at all.
+// Faces can be refreshed round-robin (6, 3, 2 or 1 per frame) to spread the capture cost over several frames.
+//
+// C cycles faces refreshed per frame, X toggles the per-face culling.
+
+#include <cmath>
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "FixedTimestep.h"
+#include "GpuProfiler.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+/// Defining Globals variable ---- (start)
+/// Rendering
+constexpr int NUM_CUBES = 64;
+
+/// Simulation
+/// SceneObject spin speeds are given in degrees per frame at this rate, they turn at rotSpeed * 60 degrees per second
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+/// Cube spin advances in fixed ticks, so it turns at the same speed and costs the same work at any frame rate
+SimulationClock simClock;
+
+/// Camera
+constexpr float CAMERA_SPEED = 4.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// SpotLight
+constexpr float SPOT_LIGHT_INNER = 15.0f;
+constexpr float SPOT_LIGHT_OUTER = 30.0f;
+
+/// Light culling
+/// A light stops at the distance where its luminance falls below this value ([ and ] halve / double it)
+constexpr float DEFAULT_LUMINANCE_CUTOFF = 0.02f;
+/// Upper bound on point lights a single draw evaluates, must match objectLights[] in the fragment shader
+constexpr int MAX_LIGHTS_PER_OBJECT = 4;
+float luminanceCutoff = DEFAULT_LUMINANCE_CUTOFF;
+
+/// Environment capture
+constexpr int ENV_CUBE_SIZE = 256;
+constexpr float ENV_NEAR = 0.1f;
+constexpr float ENV_FAR = 100.0f;
+/// Mirror sphere the cube map is captured around (it is left out of its own capture)
+const glm::vec3 MIRROR_CENTER(0.0f, 1.0f, 0.0f);
+constexpr float MIRROR_RADIUS = 2.0f;
+/// Faces refreshed per frame, C steps through these
+constexpr int FACE_CADENCES[4] = {6, 3, 2, 1};
+int cadenceIndex = 0;
+bool bCullPerFace = true;
+
+/// Turn off or on spotlight
+bool bIsCameraLightOn = true;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 0.0f, 5.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() = default;
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    // deltaX → yaw  (left/right look)
+    // deltaY → pitch (up/down look)
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe  (-1 = left,    +1 = right)
+    // dir.z : forward (-1 = back,    +1 = forward)
+    // dir.y : vertical(-1 = down,    +1 = up)
+    // dir.y uses world Y (0,1,0) not camera up — so Space always goes straight up in world space regardless of where camera is looking.
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    // Transforms world-space coordinates into camera-space.
+    // (position + front) is the target point — direction matters, not distance.
+    // [[nodiscard]] — ignoring this return value is always a bug.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    // aspectRatio = window width / height — pass every frame in case of resize.
+    // FOV, NEAR_PLANE, FAR_PLANE are global constexpr constants, Zoom is not implemented here.
+    // [[nodiscard]] — ignoring this return value is always a bug.
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(FOV, aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + optional geometry + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles the given GLSL stages, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr) {
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        GLuint geometryShader = 0;
+        if (geometrySource) {
+            geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+            compileShader(geometryShader, geometrySource);
+            glAttachShader(ProgramID, geometryShader);
+        }
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        if (geometryShader) glDeleteShader(geometryShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets an array of 4x4 matrices (one light view-projection per tile in a batch).
+    void setMat4Array(const char* uniform, const glm::mat4* mats, const int count) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), count, GL_FALSE, glm::value_ptr(mats[0]));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a float uniform (shininess, attenuation values, time, etc.).
+    void setFloat(const char* uniform, const float val) const {
+        glUniform1f(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int array uniform (per-object light index lists).
+    void setIntArray(const char* uniform, const int* vals, const int count) const {
+        glUniform1iv(glGetUniformLocation(ProgramID, uniform), count, vals);
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Creating procedural texture ------------------ (start)
+class Texture {
+public:
+    // OpenGL texture handle — 0 = invalid/uninitialized
+    GLuint TextureID = 0;
+    Texture() {
+        glGenTextures(1, &TextureID);
+        glBindTexture(GL_TEXTURE_2D, TextureID);
+
+        // Texture dimensions — 256x256 pixels.
+        constexpr int size = 256;
+
+        // Allocate CPU-side pixel buffer.
+        // sz*sz = total pixels, *4 = RGBA (red, green, blue, alpha channels).
+        // Each channel is 1 byte (0-255), so total = 256*256*4 = 262144 bytes.
+        auto* data = new unsigned char[size * size * 4];
+
+        // Fill every pixel with a procedural pattern.
+        // No image file needed — the pattern is computed mathematically.
+        for (int y = 0 ; y < size ; y++) {
+            for (int x = 0 ; x < size ; x++) {
+                // Normalize pixel coordinates to 0.0 - 1.0 range.
+                // fx=0.0 at left edge, fx=1.0 at right edge (same for fy vertically)
+                const float fx = static_cast<float>(x) / size;
+                const float fy = static_cast<float>(y) / size;
+
+                // Noise value — drives the mix between R and G channels.
+                // sin() oscillates between -1 and +1, *0.5+0.5 shifts to 0.0-1.0.
+                // High frequency (20, 10) creates a fine diagonal stripe pattern.
+                float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+
+                // Calculate flat array index for this pixel.
+                // Each pixel takes 4 consecutive bytes: [R, G, B, A]
+                // Row y starts at y*sz, pixel x is at offset x, times 4 bytes each.
+                const int i = (y * size + x) * 4;
+
+                // RED channel — sin wave scaled to 0-255, fades with noise n.
+                // When n=1.0 → full red contribution
+                // When n=0.0 → red is zero
+                data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+
+                // GREEN channel — cos wave scaled to 0-255, fades opposite to red.
+                // (1-n) means green is bright where red is dark and vice versa.
+                // Creates a complementary color shift across the texture.
+                data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+
+                // BLUE channel — independent sin wave, not affected by noise n.
+                // Adds a third color variation layer across the texture.
+                data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+
+                // ALPHA channel — fully opaque, no transparency.
+                data[i+3] = 255;
+            }
+        }
+
+        // Upload the pixel data from CPU memory to GPU texture memory.
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+        // Auto-generate all mipmap levels from the base image just uploaded
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // Delete CPU side array
+        delete[] data;
+
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    }
+};
+
+/// Creating procedural texture ------------------ (end)
+
+
+
+/// Light structs --------- (Start)
+// Distance at which the light's luminance, attenuated, drops to the cutoff.
+// Solves quadratic*d^2 + linear*d + constant = luminance / cutoff for d.
+float attenuationRadius(const glm::vec3& color, float constant, float linear, float quadratic, float cutoff) {
+    const float luminance = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    const float c = constant - luminance / cutoff;
+    if (c >= 0.0f) return 0.0f; // never bright enough to pass the cutoff
+    return (-linear + sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
+struct PointLight {
+    glm::vec3 position, color;
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+    float radius = 0.0f;
+
+    PointLight(glm::vec3 p, glm::vec3 c) : position(p), color(c) {
+        updateRadius(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRadius(float cutoff) {
+        radius = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
+};
+
+struct SpotLight {
+    glm::vec3 position, dir, color;
+    float innerCutoff, outerCutoff;
+    float outerAngle; // radians, used by the cone vs bounds test
+    float constant = 1.0f;
+    float linear = 0.07f;
+    float quadratic = 0.017f;
+    float range = 0.0f;
+
+    SpotLight(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer)
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))), outerAngle(glm::radians(outer)) {
+        updateRange(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRange(float cutoff) {
+        range = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
+};
+/// Light structs --------- (end)
+
+
+/// Material ------ (start)
+struct Material { glm::vec3 specular; float shininess; };
+
+Material materials[6] = {
+    {{1.0f,1.0f,1.0f}, 32.0f},
+    {{1.0f,1.0f,1.0f}, 64.0f},
+    {{1.0f,1.0f,1.0f}, 128.0f},
+    {{1.0f,1.0f,1.0f}, 256.0f},
+    {{0.9f,0.9f,0.9f}, 512.0f},
+    {{0.4f,0.9f,0.4f}, 1028.0f}
+};
+
+/// Material ------ (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVAO = 0;
+
+float cubeData[288] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
+     0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,  -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,  -0.5f, 0.5f,-0.5f, 0,0,-1, 0,1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,   0.5f,-0.5f, 0.5f, 0,0, 1, 1,0,   0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,
+     0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,  -0.5f, 0.5f, 0.5f, 0,0, 1, 0,1,  -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,
+    -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f,-0.5f,-1,0, 0, 1,1,
+    -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f, 0.5f,-1,0, 0, 0,0,
+     0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f,-0.5f, 1,0, 0, 1,1,
+     0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f, 0.5f, 1,0, 0, 0,0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,   0.5f,-0.5f,-0.5f, 0,-1,0, 1,1,   0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0, 0,0,  -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,
+    -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,   0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0, 1,1,
+     0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,  -0.5f, 0.5f, 0.5f, 0, 1,0, 0,0
+};
+
+void setupCubeVAO() {
+    unsigned int VBO;
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // uv
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+/// Cube vertex data ------------- (end)
+
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (start)
+class SceneObject {
+public:
+    glm::mat4 model{};
+    int matId;
+    float rotSpeed;
+
+    // Bounding sphere of the unit cube : rotation about the centre never changes it
+    glm::vec3 boundCenter;
+    float boundRadius;
+
+    // Lights that reach this object, rebuilt every frame by buildObjectLightLists()
+    int lightIndices[MAX_LIGHTS_PER_OBJECT] = {};
+    int lightCount = 0;
+    bool spotLit = false;
+
+    // Translation and scale, the spin is applied on top
+    glm::mat4 base{};
+    // Spin in degrees at the latest and the previous simulation tick
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObject(glm::vec3 pos, float scale, int mat, float rot) : matId(mat), rotSpeed(rot), boundCenter(pos), boundRadius(scale * 0.8660254f) {
+        base = glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(scale));
+        model = base;
+    }
+
+    // One simulation tick
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        // Keep the angle small so it does not lose precision over a long run, both move so the blend is unchanged
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    // Model matrix between the previous and the latest tick
+    void interpolate(float alpha) {
+        model = glm::rotate(base, glm::radians(previousAngle + (angle - previousAngle) * alpha), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (end)
+
+
+/// Mirror sphere mesh ---- (start)
+unsigned int sphereVAO = 0;
+int sphereIndexCount = 0;
+
+// Unit UV sphere with the same attribute layout as the cube (position, normal, uv).
+void setupSphereVAO(int stacks, int slices) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for (int i = 0; i <= stacks; i++) {
+        const float theta = glm::pi<float>() * static_cast<float>(i) / static_cast<float>(stacks);
+        for (int j = 0; j <= slices; j++) {
+            const float phi = 2.0f * glm::pi<float>() * static_cast<float>(j) / static_cast<float>(slices);
+            const glm::vec3 p(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+            vertices.insert(vertices.end(), {p.x, p.y, p.z, p.x, p.y, p.z,
+                                             static_cast<float>(j) / static_cast<float>(slices), static_cast<float>(i) / static_cast<float>(stacks)});
+        }
+    }
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            const unsigned int a = i * (slices + 1) + j, b = a + slices + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    sphereIndexCount = static_cast<int>(indices.size());
+
+    unsigned int VBO, EBO;
+    glGenVertexArrays(1, &sphereVAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glBindVertexArray(sphereVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(float)), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(unsigned int)), indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+/// Mirror sphere mesh ---- (end)
+
+
+/// Environment cube capture ---- (start)
+// GL face order (+X, -X, +Y, -Y, +Z, -Z) with the usual cube-map up vectors
+const glm::vec3 FACE_DIRECTIONS[6] = {{1,0,0}, {-1,0,0}, {0,1,0}, {0,-1,0}, {0,0,1}, {0,0,-1}};
+const glm::vec3 FACE_UPS[6]        = {{0,-1,0}, {0,-1,0}, {0,0,1}, {0,0,-1}, {0,-1,0}, {0,-1,0}};
+
+glm::mat4 envFaceViewProjection(const glm::vec3& origin, int face) {
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, ENV_NEAR, ENV_FAR);
+    return projection * glm::lookAt(origin, origin + FACE_DIRECTIONS[face], FACE_UPS[face]);
+}
+
+// Faces (bit i = face i) whose 90 degree frustum the sphere touches. Each side plane of a face frustum has the
+// normal (forward -+ side) / sqrt(2) through the capture point; near and far planes are checked on the forward axis.
+int sphereFaceMask(const glm::vec3& origin, const glm::vec3& center, float radius) {
+    const glm::vec3 v = center - origin;
+    int mask = 0;
+    for (int face = 0; face < 6; face++) {
+        const glm::vec3 f = FACE_DIRECTIONS[face];
+        const glm::vec3 u = FACE_UPS[face];
+        const glm::vec3 r = glm::cross(f, u);
+        const float along = glm::dot(v, f);
+        if (along < ENV_NEAR - radius || along > ENV_FAR + radius) continue;
+        const float limit = -radius * 1.41421356f;
+        if (glm::dot(v, f - r) < limit || glm::dot(v, f + r) < limit) continue;
+        if (glm::dot(v, f - u) < limit || glm::dot(v, f + u) < limit) continue;
+        mask |= 1 << face;
+    }
+    return mask;
+}
+
+// Colour + depth cube, a layered framebuffer for the single-pass capture and a plain one to clear chosen faces.
+struct EnvironmentCapture {
+    GLuint colorCube = 0, depthCube = 0;
+    GLuint layeredFBO = 0, faceFBO = 0;
+    int nextFace = 0;
+
+    void init() {
+        glGenTextures(1, &colorCube);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, colorCube);
+        for (int face = 0; face < 6; face++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA8, ENV_CUBE_SIZE, ENV_CUBE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+        glGenTextures(1, &depthCube);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, depthCube);
+        for (int face = 0; face < 6; face++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24, ENV_CUBE_SIZE, ENV_CUBE_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glGenFramebuffers(1, &layeredFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, layeredFBO);
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorCube, 0);
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCube, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "Layered environment framebuffer incomplete" << std::endl;
+        }
+
+        glGenFramebuffers(1, &faceFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Next faces in round-robin order, as a bit mask
+    int takeFaces(int count) {
+        int mask = 0;
+        for (int i = 0; i < count; i++) {
+            mask |= 1 << nextFace;
+            nextFace = (nextFace + 1) % 6;
+        }
+        return mask;
+    }
+
+    // glClear on the layered framebuffer would wipe all six layers, so partial refreshes clear face by face
+    void clearFaces(int mask) const {
+        if (mask == 0x3F) {
+            glBindFramebuffer(GL_FRAMEBUFFER, layeredFBO);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            return;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, faceFBO);
+        for (int face = 0; face < 6; face++) {
+            if (!(mask & (1 << face))) continue;
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, colorCube, 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, depthCube, 0);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+    }
+
+    void destroy() {
+        glDeleteFramebuffers(1, &layeredFBO);
+        glDeleteFramebuffers(1, &faceFBO);
+        glDeleteTextures(1, &colorCube);
+        glDeleteTextures(1, &depthCube);
+    }
+};
+/// Environment cube capture ---- (end)
+
+
+/// shaders --------- (Start)
+const char* sceneVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model, view, projection;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = aTexCoord;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+
+)";
+
+// Capture variant : world space out of the vertex shader, the geometry shader projects per face
+const char* captureVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 vFragPos;
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+uniform mat4 model;
+
+void main() {
+    vFragPos = vec3(model * vec4(aPos, 1.0));
+    vNormal = mat3(transpose(inverse(model))) * aNormal;
+    vTexCoord = aTexCoord;
+    gl_Position = vec4(vFragPos, 1.0);
+}
+)";
+
+// Invocation i draws the triangle into cube face i, skipping faces outside the draw's mask and triangles that lie
+// entirely outside one side of that face's frustum.
+const char* captureGeometryShaderSource = R"(
+#version 410 core
+layout (triangles, invocations = 6) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+in vec3 vFragPos[];
+in vec3 vNormal[];
+in vec2 vTexCoord[];
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 faceViewProjection[6];
+uniform int faceMask;
+
+void main() {
+    if ((faceMask & (1 << gl_InvocationID)) == 0) return;
+
+    vec4 clip[3];
+    for (int i = 0; i < 3; i++) clip[i] = faceViewProjection[gl_InvocationID] * vec4(vFragPos[i], 1.0);
+    for (int axis = 0; axis < 3; axis++) {
+        if (clip[0][axis] >  clip[0].w && clip[1][axis] >  clip[1].w && clip[2][axis] >  clip[2].w) return;
+        if (clip[0][axis] < -clip[0].w && clip[1][axis] < -clip[1].w && clip[2][axis] < -clip[2].w) return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        gl_Layer = gl_InvocationID;
+        FragPos = vFragPos[i];
+        Normal = vNormal[i];
+        TexCoord = vTexCoord[i];
+        gl_Position = clip[i];
+        EmitVertex();
+    }
+    EndPrimitive();
+}
+)";
+
+const char* sceneFragmentShaderSource = R"(
+#version 410 core
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float innerCutOff;
+    float outerCutOff;
+    float constant;
+    float linear;
+    float quadratic;
+    float range;
+};
+
+struct PointLight {
+    vec3 position;
+    vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+    float radius;
+};
+
+uniform SpotLight cameraLight;
+uniform PointLight pointLight[3];
+uniform vec3 viewPos;
+uniform Material material;
+uniform int isCameraLightOn;
+uniform float time;
+
+// Per-object light list built on the CPU : only these point lights can reach this draw
+uniform int objectLightCount;
+uniform int objectLights[4];
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+out vec4 FragColor;
+
+float attenuate(float distance, float constant, float linear, float quadratic) {
+    return 1.0 / (constant + linear * distance + quadratic * distance * distance);
+}
+
+// Fades the light to exactly zero at its radius so culling it beyond that distance changes nothing.
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+vec3 calPointLightEffect(PointLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.radius);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+vec3 calSpotLightEffect(SpotLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon , 0.0, 1.0);
+
+    if(intensity <= 0) return vec3(0.0);
+
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.range);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff    = max(dot(norm, lightDir), 0.0);
+    vec3  diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + (diffuse + specular) * intensity) * attenuation;
+}
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec4 texColor = texture(material.diffuseTex, TexCoord);
+
+    vec3 result = 0.1 * texColor.rgb;
+    if (isCameraLightOn == 1) {
+        result += calSpotLightEffect(cameraLight, norm, viewDir) * texColor.rgb;
+    }
+
+    for (int i = 0; i < objectLightCount; i++) {
+        result += calPointLightEffect(pointLight[objectLights[i]], norm, viewDir) * texColor.rgb;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+const char* lightCubeVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+uniform mat4 model, view, projection;
+void main(){
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+})";
+
+// Light cubes in the capture : same geometry shader, the normal and uv it forwards are unused
+const char* lightCubeCaptureVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+out vec3 vFragPos;
+out vec3 vNormal;
+out vec2 vTexCoord;
+uniform mat4 model;
+void main(){
+    vFragPos = vec3(model * vec4(aPos, 1.0));
+    vNormal = vec3(0.0);
+    vTexCoord = vec2(0.0);
+    gl_Position = vec4(vFragPos, 1.0);
+})";
+
+const char* lightCubeFS = R"(
+#version 410 core
+uniform vec3 emissiveColor;
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(emissiveColor, 1.0);
+})";
+
+// Mirror : the captured cube looked up along the reflected view ray, a little darker head-on (Schlick, F0 = 0.5)
+const char* mirrorFS = R"(
+#version 410 core
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+uniform samplerCube environment;
+uniform vec3 viewPos;
+out vec4 FragColor;
+void main(){
+    vec3 norm = normalize(Normal);
+    vec3 incident = normalize(FragPos - viewPos);
+    float fresnel = 0.5 + 0.5 * pow(1.0 - max(dot(-incident, norm), 0.0), 5.0);
+    FragColor = vec4(texture(environment, reflect(incident, norm)).rgb * fresnel, 1.0);
+})";
+/// shaders --------- (End)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* sceneShader = nullptr;
+Shader* captureShader = nullptr;
+Shader* lightingShader = nullptr;
+Shader* lightCaptureShader = nullptr;
+Shader* mirrorShader = nullptr;
+Texture* defaultTexture = nullptr;
+
+std::vector<SceneObject> sceneObjects;
+SpotLight cameraLight(glm::vec3(0.0f), glm::vec3(0.0f,0.0f,-1.0f), glm::vec3(1.0f, 1.0f, 1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER);
+
+PointLight pointLights[3] = {
+    { glm::vec3( 0.0f, 8.0f,  0.0f), glm::vec3(1.0f, 0.55f, 0.15f) }, // warm orange
+    { glm::vec3(12.0f, 5.0f, -6.0f), glm::vec3(0.2f, 0.75f, 1.0f ) }, // cool cyan
+    { glm::vec3(-10.0f,7.0f, 10.0f), glm::vec3(1.0f, 0.3f,  0.5f ) }  // pink-red
+};
+
+int WindowWidth, WindowHeight;
+/// Global Objects ------ (End)
+
+
+/// Light culling ------ (start)
+// Sphere vs cone test : true when the sphere can receive light from the spot's outer cone within its range.
+bool sphereInSpotCone(const SpotLight& light, const glm::vec3& center, float radius) {
+    const glm::vec3 v = center - light.position;
+    const float lenSq = glm::dot(v, v);
+    const float along = glm::dot(v, light.dir);
+    if (along > light.range + radius) return false; // beyond the cap
+    if (along < -radius) return false;               // behind the apex
+    // Distance from the sphere centre to the cone's surface, measured perpendicular to it
+    const float across = sqrt(glm::max(lenSq - along * along, 0.0f));
+    const float distToCone = cos(light.outerAngle) * across - sin(light.outerAngle) * along;
+    return distToCone <= radius;
+}
+
+// Gives every object only the lights whose radius reaches its bounding sphere.
+void buildObjectLightLists() {
+    for (auto& obj : sceneObjects) {
+        obj.lightCount = 0;
+        for (int i = 0; i < 3 && obj.lightCount < MAX_LIGHTS_PER_OBJECT; i++) {
+            const float reach = pointLights[i].radius + obj.boundRadius;
+            const glm::vec3 d = pointLights[i].position - obj.boundCenter;
+            if (glm::dot(d, d) < reach * reach) {
+                obj.lightIndices[obj.lightCount++] = i;
+            }
+        }
+        obj.spotLit = bIsCameraLightOn && sphereInSpotCone(cameraLight, obj.boundCenter, obj.boundRadius);
+    }
+}
+/// Light culling ------ (end)
+
+
+/// Scene uniforms ------ (start)
+// Lights are identical for the main view and the capture, only viewPos differs
+void setSceneLightUniforms(const Shader& shader) {
+    shader.setVec3("cameraLight.position", cameraLight.position);
+    shader.setVec3("cameraLight.direction", cameraLight.dir);
+    shader.setVec3 ("cameraLight.color", cameraLight.color);
+    shader.setFloat("cameraLight.innerCutOff", cameraLight.innerCutoff);
+    shader.setFloat("cameraLight.outerCutOff", cameraLight.outerCutoff);
+    shader.setFloat("cameraLight.constant", cameraLight.constant);
+    shader.setFloat("cameraLight.linear", cameraLight.linear);
+    shader.setFloat("cameraLight.quadratic", cameraLight.quadratic);
+    shader.setFloat("cameraLight.range", cameraLight.range);
+
+    for(int i = 0; i < 3; i++){
+        std::string b = "pointLight[" + std::to_string(i) + "].";
+        shader.setVec3 ((b+"position").c_str(), pointLights[i].position);
+        shader.setVec3 ((b+"color").c_str(), pointLights[i].color);
+        shader.setFloat((b+"constant").c_str(), pointLights[i].constant);
+        shader.setFloat((b+"linear").c_str(), pointLights[i].linear);
+        shader.setFloat((b+"quadratic").c_str(), pointLights[i].quadratic);
+        shader.setFloat((b+"radius").c_str(), pointLights[i].radius);
+    }
+}
+
+void setObjectUniforms(const Shader& shader, const SceneObject& obj) {
+    shader.setInt("objectLightCount", obj.lightCount);
+    shader.setIntArray("objectLights", obj.lightIndices, MAX_LIGHTS_PER_OBJECT);
+    shader.setInt("isCameraLightOn", obj.spotLit ? 1 : 0);
+    shader.setMat4 ("model", obj.model);
+    shader.setVec3 ("material.specular", materials[obj.matId].specular);
+    shader.setFloat("material.shininess", materials[obj.matId].shininess);
+}
+/// Scene uniforms ------ (end)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+}
+
+// [ / ] : tighter or looser luminance cutoff, radii follow
+// C : faces refreshed per frame, X : per-face culling on / off
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_C) {
+        cadenceIndex = (cadenceIndex + 1) % 4;
+        std::cout << "Environment faces per frame : " << FACE_CADENCES[cadenceIndex] << std::endl;
+        return;
+    }
+    if (key == GLFW_KEY_X) {
+        bCullPerFace = !bCullPerFace;
+        std::cout << "Per-face culling " << (bCullPerFace ? "on" : "off") << std::endl;
+        return;
+    }
+    if (key == GLFW_KEY_LEFT_BRACKET) luminanceCutoff = glm::max(luminanceCutoff * 0.5f, 0.001f);
+    else if (key == GLFW_KEY_RIGHT_BRACKET) luminanceCutoff = glm::min(luminanceCutoff * 2.0f, 0.5f);
+    else return;
+
+    for (auto& light : pointLights) light.updateRadius(luminanceCutoff);
+    cameraLight.updateRange(luminanceCutoff);
+    std::cout << "Luminance cutoff " << luminanceCutoff << " | point radius " << pointLights[0].radius
+              << " | spot range " << cameraLight.range << std::endl;
+}
+
+bool roamFirstLight = false;
+bool roamSecondLight = false;
+bool roamThirdLight = false;
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+    if(glfwGetKey(win, GLFW_KEY_O) == GLFW_PRESS) bIsCameraLightOn = true;
+    if(glfwGetKey(win, GLFW_KEY_P) == GLFW_PRESS) bIsCameraLightOn = false;
+
+    if(glfwGetKey(win, GLFW_KEY_1) == GLFW_PRESS) {
+        roamFirstLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_2) == GLFW_PRESS) {
+        roamSecondLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_3) == GLFW_PRESS) {
+        roamThirdLight = true;
+    } else {
+        roamFirstLight = false;
+        roamSecondLight = false;
+        roamThirdLight = false;
+    }
+}
+/// Callbacks ----- (End)
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Dynamic Environment Map", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+    WindowWidth = mode->width;
+    WindowHeight = mode->height;
+
+    lastX = static_cast<float>(WindowWidth) / 2.0f;
+    lastY = static_cast<float>(WindowHeight) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    setupCubeVAO();
+    setupSphereVAO(32, 64);
+    defaultTexture = new Texture();
+    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentShaderSource);
+    captureShader = new Shader(captureVertexShaderSource, sceneFragmentShaderSource, captureGeometryShaderSource);
+    lightingShader = new Shader(lightCubeVS, lightCubeFS);
+    lightCaptureShader = new Shader(lightCubeCaptureVS, lightCubeFS, captureGeometryShaderSource);
+    mirrorShader = new Shader(sceneVertexShaderSource, mirrorFS);
+    camera = new Camera();
+    camera->position = glm::vec3(0.0f, 2.0f, 9.0f);
+
+    EnvironmentCapture capture;
+    capture.init();
+
+    // Capture pass time, read back PROFILER_FRAMES later so it never stalls
+    GpuProfiler gpuProfiler;
+    profilerInit(&gpuProfiler);
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_real_distribution<float> rPos(-15.0f, 15.0f), rRot(-1.5f,1.5f);
+    std::uniform_int_distribution<int> rMat(0,4);
+
+    for(int i = 0; i < NUM_CUBES; i++){
+        float scale = 0.6f + (i%5)*0.1f;
+        glm::vec3 pos(rPos(gen), rPos(gen)*0.3f+1.0f, rPos(gen));
+        // Keep the mirror's surroundings clear so the capture point is never inside a cube
+        if (glm::length(pos - MIRROR_CENTER) < MIRROR_RADIUS + 1.5f) pos.x += 5.0f;
+        sceneObjects.emplace_back(pos, scale, rMat(gen), rRot(gen));
+    }
+
+    glm::mat4 faceMatrices[6];
+    for (int face = 0; face < 6; face++) faceMatrices[face] = envFaceViewProjection(MIRROR_CENTER, face);
+    captureShader->use();
+    captureShader->setMat4Array("faceViewProjection", faceMatrices, 6);
+    lightCaptureShader->use();
+    lightCaptureShader->setMat4Array("faceViewProjection", faceMatrices, 6);
+
+    // Rolling capture stats, printed every 2 s
+    int statFrames = 0, statFaces = 0, statDraws = 0, statSkipped = 0;
+    double lastStatTime = glfwGetTime();
+
+    auto lastTime = std::chrono::high_resolution_clock::now();
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+
+        float time = static_cast<float>(glfwGetTime());
+        processInput(window, dt);
+
+        // --- Animate point lights ---
+        // [0] orbits horizontally around scene centre
+        pointLights[0].position.x = 8.0f * sin(time * 0.3f);
+        pointLights[0].position.z = 8.0f * cos(time * 0.3f);
+        pointLights[0].position.y = 7.0f + sin(time * 0.5f) * 1.5f;
+
+        // [1] bobs up and down on the right side
+        pointLights[1].position.y = 5.0f + sin(time * 0.7f) * 3.0f;
+        pointLights[1].position.x = 10.0f * cos(time * 0.2f);
+
+        // [2] sweeps front-back on the left side
+        pointLights[2].position.z = 8.0f * sin(time * 0.4f);
+        pointLights[2].position.y = 6.0f + cos(time * 0.6f) * 2.0f;
+
+        if (roamFirstLight) {
+            camera->position = pointLights[0].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamSecondLight) {
+            camera->position = pointLights[1].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamThirdLight) {
+            camera->position = pointLights[2].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        }
+
+        // --- Animate camera lights ---
+        cameraLight.position = camera->position;
+        cameraLight.dir = camera->front;
+
+        simClockAdvance(&simClock, dt);
+        while (simClockStep(&simClock)) {
+            for(auto& obj : sceneObjects){
+                obj.update(static_cast<float>(simClock.tickSeconds));
+            }
+        }
+        const float alpha = simClockAlpha(&simClock);
+        for(auto& obj : sceneObjects){
+            obj.interpolate(alpha);
+        }
+        buildObjectLightLists();
+
+        // --- Environment capture : the due faces of the cube in one layered pass ---
+        const int refreshMask = capture.takeFaces(FACE_CADENCES[cadenceIndex]);
+        profilerBeginFrame(&gpuProfiler);
+        profilerPush(&gpuProfiler, "capture");
+
+        glViewport(0, 0, ENV_CUBE_SIZE, ENV_CUBE_SIZE);
+        glClearColor(0.04f, 0.04f, 0.08f, 1.0f);
+        capture.clearFaces(refreshMask);
+        glBindFramebuffer(GL_FRAMEBUFFER, capture.layeredFBO);
+
+        captureShader->use();
+        captureShader->setVec3("viewPos", MIRROR_CENTER);
+        setSceneLightUniforms(*captureShader);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+        captureShader->setInt("material.diffuseTex", 0);
+
+        glBindVertexArray(cubeVAO);
+        for (const auto& obj : sceneObjects) {
+            const int mask = bCullPerFace ? sphereFaceMask(MIRROR_CENTER, obj.boundCenter, obj.boundRadius) & refreshMask : refreshMask;
+            if (mask == 0) {
+                statSkipped++;
+                continue;
+            }
+            captureShader->setInt("faceMask", mask);
+            setObjectUniforms(*captureShader, obj);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            statDraws++;
+        }
+
+        lightCaptureShader->use();
+        for (const auto& pointLight : pointLights) {
+            const int mask = bCullPerFace ? sphereFaceMask(MIRROR_CENTER, pointLight.position, 0.26f) & refreshMask : refreshMask;
+            if (mask == 0) continue;
+            lightCaptureShader->setInt("faceMask", mask);
+            lightCaptureShader->setMat4("model", glm::scale(glm::translate(glm::mat4(1.0f), pointLight.position), glm::vec3(0.3f)));
+            lightCaptureShader->setVec3("emissiveColor", pointLight.color);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        profilerPop(&gpuProfiler);
+        profilerEndFrame(&gpuProfiler);
+        for (int face = 0; face < 6; face++) statFaces += (refreshMask >> face) & 1;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, WindowWidth, WindowHeight);
+
+        // --- Clear ---
+        glClearColor(0.04f, 0.04f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 proj = camera->getProjectionMatrix(static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight));
+        glm::mat4 view = camera->getViewMatrix();
+
+        sceneShader->use();
+        sceneShader->setMat4("projection", proj);
+        sceneShader->setMat4("view", view);
+        sceneShader->setVec3("viewPos", camera->position);
+        setSceneLightUniforms(*sceneShader);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+        sceneShader->setInt("material.diffuseTex", 0);
+
+        glBindVertexArray(cubeVAO);
+        for(auto& obj : sceneObjects){
+            setObjectUniforms(*sceneShader, obj);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        lightingShader->use();
+        lightingShader->setMat4("projection", proj);
+        lightingShader->setMat4("view", view);
+
+        glBindVertexArray(cubeVAO);
+        for(auto & pointLight : pointLights){
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), pointLight.position);
+            model = glm::scale(model, glm::vec3(0.3f));
+            lightingShader->setMat4("model", model);
+            lightingShader->setVec3("emissiveColor", pointLight.color);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        mirrorShader->use();
+        mirrorShader->setMat4("projection", proj);
+        mirrorShader->setMat4("view", view);
+        mirrorShader->setVec3("viewPos", camera->position);
+        mirrorShader->setMat4("model", glm::scale(glm::translate(glm::mat4(1.0f), MIRROR_CENTER), glm::vec3(MIRROR_RADIUS)));
+        mirrorShader->setInt("environment", 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, capture.colorCube);
+        glBindVertexArray(sphereVAO);
+        glDrawElements(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, nullptr);
+
+        statFrames++;
+        if (glfwGetTime() - lastStatTime >= 2.0) {
+            const GpuScopeStats* captureStats = profilerFindStats(&gpuProfiler, "capture");
+            std::cout << "Capture : " << static_cast<float>(statFaces) / statFrames << " faces / frame | "
+                      << static_cast<float>(statDraws) / statFrames << " draws, " << static_cast<float>(statSkipped) / statFrames
+                      << " culled / frame | GPU " << (captureStats ? captureStats->averageMs : 0.0) << " ms / frame" << std::endl;
+            statFrames = statFaces = statDraws = statSkipped = 0;
+            lastStatTime = glfwGetTime();
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    capture.destroy();
+    profilerDestroy(&gpuProfiler);
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &sphereVAO);
+    delete sceneShader;
+    delete captureShader;
+    delete lightingShader;
+    delete lightCaptureShader;
+    delete mirrorShader;
+    delete defaultTexture;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,691 @@
+// Single-image sky to cube map : resamples an equirectangular panorama or a horizontal / vertical cross into the
+// six faces glTexImage2D wants, so one decode replaces the six file reads of loadCubeMap.
+// Resampling runs on the CPU with one RGBA texel per SIMD register (SSE / NEON), bilinear or Catmull-Rom bicubic,
+// with the rows of all six faces spread across the hardware threads.
+//
+// Load time : run without arguments, the skybox is built from Assets/CubeMapSky.png when the window opens.
+// Bake time : EquirectToCubemap --bake <image> <output prefix> [face size]
+//             writes <prefix>right.tga .. <prefix>back.tga, which loadCubeMap reads as they are.
+//
+// F switches bilinear / bicubic (and rebuilds the sky), L cycles the layout used to read the image.
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#include <glm/detail/setup.hpp>
+#include <glm/glm.hpp>
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include "glm/gtc/matrix_transform.hpp"
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+using namespace std;
+using namespace glm;
+/// Shader helpers : ---- (start)
+int success;
+char infoLog[512];
+
+/// This function will create shaders
+/// @param type Shader type
+/// @param source shader source
+/// @return shader ID
+GLuint compileShader(GLenum type, const GLchar* source) {
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        cout << "Error compiling shader: " << infoLog << endl;
+        return 0;
+    }
+    return shader;
+}
+/// This function will create shader program
+/// @param vertexSource vertex shader source
+/// @param fragmentSource fragment shader source
+/// @return program ID
+GLuint createProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint program = glCreateProgram();
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        cout << "Error linking program: " << infoLog << endl;
+    }
+    return  program;
+}
+/// Shader helpers : ---- (end)
+
+/// Camera Structure consisting imp camera properties
+struct Camera {
+    vec3 Position;
+    vec3 Front;
+    vec3 Up;
+    vec3 Right;
+    vec3 WorldUp;
+    float Yaw;
+    float Pitch;
+    float MovementSpeed;
+    float MouseSensitivity;
+    float Zoom;
+};
+
+/// This function will updates camera vectors
+/// @param camera Camera object.
+void cameraUpdateVectors(Camera* camera) {
+    vec3 front;
+    front.x = cos(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    front.y = sin(radians(camera->Pitch));
+    front.z = sin(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    camera->Front = normalize(front);
+    camera->Right = normalize(cross(camera->Front, camera->WorldUp));
+    camera->Up = normalize(cross(camera->Right, camera->Front));
+}
+
+/// This function will initiate camera
+/// @param camera Camera Object
+/// @param position Camera Position
+/// @param up Camera Up vector
+/// @param yaw Along X axis
+/// @param pitch Along Y axis
+/// @param movementSpeed Movement speed of camera
+/// @param mouseSensitivity
+/// @param zoom Initial zoom
+void cameraInit(Camera* camera, glm::vec3 position, glm::vec3 up, float yaw, float pitch, float movementSpeed, float mouseSensitivity, float zoom) {
+    camera->Position = position;
+    camera->WorldUp = up;
+    camera->Yaw = yaw;
+    camera->Pitch = pitch;
+    camera->MovementSpeed = movementSpeed;
+    camera->MouseSensitivity = mouseSensitivity;
+    camera->Zoom = zoom;
+    cameraUpdateVectors(camera);
+}
+
+/// Returns view matrix according to current camera vectors
+/// @param camera Camera object
+/// @return View matrix
+mat4 getCameraViewMatrix(Camera* camera) {
+    return lookAt(camera->Position, camera->Position + camera->Front, camera->Up);
+}
+
+/// Function to process mouse movement
+/// @param camera camera object
+/// @param xoffset Yaw movement
+/// @param yoffset Pitch movement
+void cameraProcessMouseMovement(Camera* camera, float xoffset, float yoffset) {
+    xoffset *= camera->MouseSensitivity;
+    yoffset *= camera->MouseSensitivity;
+    camera->Yaw += xoffset;
+    camera->Pitch += yoffset;
+    camera->Pitch = glm::clamp(camera->Pitch, -89.f, 89.f);
+    cameraUpdateVectors(camera);
+}
+
+/// Function to process scroll movements
+/// @param camera Camera object
+/// @param Zoom Zoom level
+void cameraProcessMouseScroll(Camera* camera, float Zoom) {
+    camera->Zoom -= Zoom;
+    if (camera->Zoom <= 1.0f) {camera->Zoom = 1.0f;}
+    else if (camera->Zoom >= 45.0f) {camera->Zoom = 45.0f;}
+}
+
+/// Panorama to cube conversion ---- (start)
+/// How the single image is laid out
+enum PanoramaLayout {
+    LayoutAuto,             // from the aspect ratio : 2:1 equirectangular, 4:3 horizontal cross, 3:4 vertical cross
+    LayoutEquirectangular,  // longitude across, latitude down, image centre looking down -Z
+    LayoutHorizontalCross,  // 4x3 cells :   . +Y  .  .  /  -X +Z +X -Z  /  . -Y  .  .
+    LayoutVerticalCross     // 3x4 cells :   . +Y  .  /  -X +Z +X  /  . -Y  .  /  . -Z  .   (-Z upside down)
+};
+
+enum ResampleFilter {
+    FilterBilinear,
+    FilterBicubic
+};
+
+const char* layoutName(PanoramaLayout layout) {
+    switch (layout) {
+        case LayoutEquirectangular: return "equirectangular";
+        case LayoutHorizontalCross: return "horizontal cross";
+        case LayoutVerticalCross:   return "vertical cross";
+        default:                    return "auto";
+    }
+}
+
+/// One RGBA texel in a SIMD register : SSE on x86, NEON on Apple silicon, four floats anywhere else
+struct Texel4 {
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128 v;
+    Texel4() : v(_mm_setzero_ps()) {}
+    Texel4(__m128 x) : v(x) {}
+    explicit Texel4(float s) : v(_mm_set1_ps(s)) {}
+    static Texel4 load(const float* p) { return _mm_load_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    friend Texel4 operator+(Texel4 a, Texel4 b) { return _mm_add_ps(a.v, b.v); }
+    friend Texel4 operator*(Texel4 a, Texel4 b) { return _mm_mul_ps(a.v, b.v); }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t v;
+    Texel4() : v(vdupq_n_f32(0.0f)) {}
+    Texel4(float32x4_t x) : v(x) {}
+    explicit Texel4(float s) : v(vdupq_n_f32(s)) {}
+    static Texel4 load(const float* p) { return vld1q_f32(p); }
+    void store(float* p) const { vst1q_f32(p, v); }
+    friend Texel4 operator+(Texel4 a, Texel4 b) { return vaddq_f32(a.v, b.v); }
+    friend Texel4 operator*(Texel4 a, Texel4 b) { return vmulq_f32(a.v, b.v); }
+#else
+    float v[4];
+    Texel4() : v{0.0f, 0.0f, 0.0f, 0.0f} {}
+    explicit Texel4(float s) : v{s, s, s, s} {}
+    static Texel4 load(const float* p) { Texel4 r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+    void store(float* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+    friend Texel4 operator+(Texel4 a, Texel4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+    friend Texel4 operator*(Texel4 a, Texel4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+#endif
+};
+
+/// Decoded source image as 16-byte aligned float RGBA, so every texel is one aligned SIMD load
+struct SourceImage {
+    int width = 0;
+    int height = 0;
+    vector<float> storage;
+    float* texels = nullptr;
+
+    SourceImage(const unsigned char* rgba, int w, int h) : width(w), height(h), storage(static_cast<size_t>(w) * h * 4 + 4) {
+        texels = storage.data();
+        while (reinterpret_cast<uintptr_t>(texels) % 16 != 0) texels++;
+        for (size_t i = 0; i < static_cast<size_t>(w) * h * 4; i++) texels[i] = rgba[i] * (1.0f / 255.0f);
+    }
+    [[nodiscard]] const float* at(int x, int y) const { return texels + (static_cast<size_t>(y) * width + x) * 4; }
+};
+
+/// Six square RGBA8 faces in GL order (+X, -X, +Y, -Y, +Z, -Z)
+struct CubeFaces {
+    int size = 0;
+    vector<unsigned char> faces[6];
+};
+
+/// Pixel rectangle a sample is allowed to read : the whole image for equirectangular, one cell for a cross.
+/// wrapX makes the equirectangular seam continuous instead of clamping at it.
+struct SampleRegion {
+    int x0, y0, width, height;
+    bool wrapX;
+};
+
+int regionX(const SampleRegion& region, int x) {
+    if (region.wrapX) { x %= region.width; if (x < 0) x += region.width; }
+    else x = std::clamp(x, 0, region.width - 1);
+    return region.x0 + x;
+}
+
+int regionY(const SampleRegion& region, int y) {
+    return region.y0 + std::clamp(y, 0, region.height - 1);
+}
+
+/// Bilinear filter at (x, y) in region pixel units (texel centres on .5)
+Texel4 sampleBilinear(const SourceImage& image, const SampleRegion& region, float x, float y) {
+    x -= 0.5f;
+    y -= 0.5f;
+    const float fx0 = std::floor(x), fy0 = std::floor(y);
+    const int ix = static_cast<int>(fx0), iy = static_cast<int>(fy0);
+    const float fx = x - fx0, fy = y - fy0;
+    const int xa = regionX(region, ix), xb = regionX(region, ix + 1);
+    const int ya = regionY(region, iy), yb = regionY(region, iy + 1);
+    return Texel4::load(image.at(xa, ya)) * Texel4((1.0f - fx) * (1.0f - fy)) +
+           Texel4::load(image.at(xb, ya)) * Texel4(fx * (1.0f - fy)) +
+           Texel4::load(image.at(xa, yb)) * Texel4((1.0f - fx) * fy) +
+           Texel4::load(image.at(xb, yb)) * Texel4(fx * fy);
+}
+
+/// Catmull-Rom weights of the four taps around a sample at fraction t
+void catmullRomWeights(float t, float w[4]) {
+    const float t2 = t * t, t3 = t2 * t;
+    w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+    w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+    w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+    w[3] = 0.5f * (t3 - t2);
+}
+
+/// 4x4 Catmull-Rom filter at (x, y) : sharper than bilinear when the faces are larger than the source
+Texel4 sampleBicubic(const SourceImage& image, const SampleRegion& region, float x, float y) {
+    x -= 0.5f;
+    y -= 0.5f;
+    const float fx0 = std::floor(x), fy0 = std::floor(y);
+    const int ix = static_cast<int>(fx0), iy = static_cast<int>(fy0);
+    float wx[4], wy[4];
+    catmullRomWeights(x - fx0, wx);
+    catmullRomWeights(y - fy0, wy);
+    int columns[4];
+    for (int i = 0; i < 4; i++) columns[i] = regionX(region, ix - 1 + i);
+    Texel4 result;
+    for (int j = 0; j < 4; j++) {
+        const int row = regionY(region, iy - 1 + j);
+        Texel4 line = Texel4::load(image.at(columns[0], row)) * Texel4(wx[0]) +
+                      Texel4::load(image.at(columns[1], row)) * Texel4(wx[1]) +
+                      Texel4::load(image.at(columns[2], row)) * Texel4(wx[2]) +
+                      Texel4::load(image.at(columns[3], row)) * Texel4(wx[3]);
+        result = result + line * Texel4(wy[j]);
+    }
+    return result;
+}
+
+/// Direction through texel (u, v) in [-1, 1] of a GL cube face, v growing down the image as uploaded
+vec3 cubeFaceDirection(int face, float u, float v) {
+    switch (face) {
+        case 0:  return { 1.0f,   -v,   -u};
+        case 1:  return {-1.0f,   -v,    u};
+        case 2:  return {    u, 1.0f,    v};
+        case 3:  return {    u,-1.0f,   -v};
+        case 4:  return {    u,   -v, 1.0f};
+        default: return {   -u,   -v,-1.0f};
+    }
+}
+
+/// Runs job(0 .. jobCount-1) across the hardware threads, each worker taking the next index from a shared counter
+template <typename Job>
+void runParallel(int jobCount, const Job& job) {
+    const int workerCount = std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), jobCount));
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        for (int i = next++; i < jobCount; i = next++) job(i);
+    };
+    vector<thread> threads;
+    for (int t = 1; t < workerCount; t++) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+}
+
+PanoramaLayout detectLayout(int width, int height) {
+    if (width * 3 == height * 4) return LayoutHorizontalCross;
+    if (width * 4 == height * 3) return LayoutVerticalCross;
+    if (width != height * 2) {
+        cout << "Panorama is " << width << "x" << height << ", not 2:1 / 4:3 / 3:4 : reading it as equirectangular" << endl;
+    }
+    return LayoutEquirectangular;
+}
+
+/// Edge of one cross cell, kept inside the image even when a cross layout is forced on the wrong aspect ratio
+int crossCellSize(int width, int height, PanoramaLayout layout) {
+    return layout == LayoutHorizontalCross ? std::min(width / 4, height / 3) : std::min(width / 3, height / 4);
+}
+
+/// Face size that keeps roughly the source's texel density : a quarter of the equirectangular width, or one cross cell
+int defaultFaceSize(int width, int height, PanoramaLayout layout) {
+    const int target = std::max(layout == LayoutEquirectangular ? width / 4 : crossCellSize(width, height, layout), 16);
+    int size = 16;
+    while (size * 2 <= target) size *= 2;
+    return size;
+}
+
+/// Resamples an RGBA8 image into six faces, one job per face row
+/// @param rgba Decoded image, 4 channels
+/// @param width Image width
+/// @param height Image height
+/// @param layout How the image is laid out (LayoutAuto to guess from the aspect ratio)
+/// @param filter Bilinear or bicubic
+/// @param faceSize Output face edge in texels, 0 to pick one from the source
+/// @param out Converted faces
+void convertPanoramaToCube(const unsigned char* rgba, int width, int height, PanoramaLayout layout, ResampleFilter filter, int faceSize, CubeFaces& out) {
+    if (layout == LayoutAuto) layout = detectLayout(width, height);
+    if (faceSize <= 0) faceSize = defaultFaceSize(width, height, layout);
+    const SourceImage image(rgba, width, height);
+
+    // Cross cells per GL face (column, row), and whether the cell is stored upside down
+    const int horizontalCells[6][2] = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {3, 1}};
+    const int verticalCells[6][2]   = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {1, 3}};
+    const int cell = layout == LayoutEquirectangular ? 0 : std::max(crossCellSize(width, height, layout), 1);
+
+    out.size = faceSize;
+    for (auto& face : out.faces) face.resize(static_cast<size_t>(faceSize) * faceSize * 4);
+
+    runParallel(6 * faceSize, [&](int job) {
+        const int face = job / faceSize, y = job % faceSize;
+        unsigned char* row = out.faces[face].data() + static_cast<size_t>(y) * faceSize * 4;
+        SampleRegion region{0, 0, width, height, true};
+        bool flipped = false;
+        if (layout != LayoutEquirectangular) {
+            const int (*cells)[2] = layout == LayoutHorizontalCross ? horizontalCells : verticalCells;
+            region = {cells[face][0] * cell, cells[face][1] * cell, cell, cell, false};
+            flipped = layout == LayoutVerticalCross && face == 5;
+        }
+        const float cellScale = static_cast<float>(cell) / static_cast<float>(faceSize);
+        float texel[4];
+        for (int x = 0; x < faceSize; x++) {
+            float sx, sy;
+            if (layout == LayoutEquirectangular) {
+                const float u = (static_cast<float>(x) + 0.5f) * 2.0f / static_cast<float>(faceSize) - 1.0f;
+                const float v = (static_cast<float>(y) + 0.5f) * 2.0f / static_cast<float>(faceSize) - 1.0f;
+                const vec3 d = normalize(cubeFaceDirection(face, u, v));
+                // Longitude 0 (image centre) looks down -Z, growing towards +X; latitude runs +Y at the top
+                sx = (0.5f + std::atan2(d.x, -d.z) / (2.0f * pi<float>())) * static_cast<float>(width);
+                sy = std::acos(std::clamp(d.y, -1.0f, 1.0f)) / pi<float>() * static_cast<float>(height);
+            } else {
+                const int cx = flipped ? faceSize - 1 - x : x;
+                const int cy = flipped ? faceSize - 1 - y : y;
+                sx = (static_cast<float>(cx) + 0.5f) * cellScale;
+                sy = (static_cast<float>(cy) + 0.5f) * cellScale;
+            }
+            const Texel4 color = filter == FilterBicubic ? sampleBicubic(image, region, sx, sy) : sampleBilinear(image, region, sx, sy);
+            color.store(texel);
+            for (int c = 0; c < 4; c++) {
+                row[x * 4 + c] = static_cast<unsigned char>(std::clamp(texel[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    });
+}
+
+/// Uploads converted faces as a cube map with the same sampling state as loadCubeMap
+GLuint createCubeMap(const CubeFaces& cube) {
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+    for (int i = 0; i < 6; i++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, cube.size, cube.size, 0, GL_RGBA, GL_UNSIGNED_BYTE, cube.faces[i].data());
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return texID;
+}
+
+/// Load-time path : one decode, one conversion, one upload. Returns 0 when the image cannot be read.
+/// @param path Panorama image
+/// @param layout Image layout (LayoutAuto to guess)
+/// @param filter Bilinear or bicubic
+/// @param faceSize Face edge in texels, 0 to pick one from the source
+GLuint loadCubeMapFromPanorama(const char* path, PanoramaLayout layout, ResampleFilter filter, int faceSize = 0) {
+    int w, h, ch;
+    unsigned char* data = stbi_load(path, &w, &h, &ch, 4);
+    if (!data) {
+        cout << "Failed to load panorama: " << path << endl;
+        return 0;
+    }
+    const auto start = chrono::high_resolution_clock::now();
+    CubeFaces cube;
+    convertPanoramaToCube(data, w, h, layout, filter, faceSize, cube);
+    stbi_image_free(data);
+    cout << "Converted " << path << " (" << w << "x" << h << ", " << layoutName(layout == LayoutAuto ? detectLayout(w, h) : layout)
+         << ") to 6 x " << cube.size << "^2 " << (filter == FilterBicubic ? "bicubic" : "bilinear") << " in "
+         << chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count() << " ms on "
+         << std::max(1u, thread::hardware_concurrency()) << " threads" << endl;
+    return createCubeMap(cube);
+}
+
+/// Bake-time path : uncompressed 32-bit TGA per face, top-left origin, named like the existing six-face skybox
+bool writeCubeFacesTGA(const CubeFaces& cube, const string& prefix) {
+    const char* names[6] = {"right", "left", "top", "bottom", "front", "back"};
+    for (int face = 0; face < 6; face++) {
+        const string path = prefix + names[face] + ".tga";
+        ofstream file(path, ios::binary);
+        if (!file) {
+            cout << "Could not write " << path << endl;
+            return false;
+        }
+        unsigned char header[18] = {};
+        header[2] = 2; // uncompressed true colour
+        header[12] = static_cast<unsigned char>(cube.size & 0xFF);
+        header[13] = static_cast<unsigned char>(cube.size >> 8);
+        header[14] = header[12];
+        header[15] = header[13];
+        header[16] = 32;
+        header[17] = 0x28; // 8 alpha bits, rows stored top to bottom
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        vector<unsigned char> bgra(cube.faces[face].size());
+        for (size_t i = 0; i < bgra.size(); i += 4) {
+            bgra[i + 0] = cube.faces[face][i + 2];
+            bgra[i + 1] = cube.faces[face][i + 1];
+            bgra[i + 2] = cube.faces[face][i + 0];
+            bgra[i + 3] = cube.faces[face][i + 3];
+        }
+        file.write(reinterpret_cast<const char*>(bgra.data()), static_cast<streamsize>(bgra.size()));
+    }
+    return true;
+}
+
+/// --bake <image> <output prefix> [face size]
+int bakeMain(int argc, char** argv) {
+    if (argc < 4) {
+        cout << "Usage : " << argv[0] << " --bake <image> <output prefix> [face size]" << endl;
+        return -1;
+    }
+    int w, h, ch;
+    unsigned char* data = stbi_load(argv[2], &w, &h, &ch, 4);
+    if (!data) {
+        cout << "Failed to load panorama: " << argv[2] << endl;
+        return -1;
+    }
+    const int faceSize = argc > 4 ? atoi(argv[4]) : 0;
+    const auto start = chrono::high_resolution_clock::now();
+    CubeFaces cube;
+    convertPanoramaToCube(data, w, h, LayoutAuto, FilterBicubic, faceSize, cube);
+    stbi_image_free(data);
+    const float ms = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+    if (!writeCubeFacesTGA(cube, argv[3])) return -1;
+    cout << "Baked " << argv[2] << " into 6 x " << cube.size << "^2 faces in " << ms << " ms" << endl;
+    return 0;
+}
+/// Panorama to cube conversion ---- (end)
+
+/// Shader to render a cube map -------- (start)
+const char* cubeMapVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+out vec3 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    TexCoord = aPos;
+    mat4 rotView = mat4(mat3(view));
+    vec4 pos = projection * rotView * vec4(aPos, 1.0);
+    gl_Position = pos.xyww;
+}
+)";
+
+const char* cubeMapFragmentShader = R"(
+#version 410 core
+in vec3 TexCoord;
+out vec4 FragColor;
+uniform samplerCube skybox;
+
+void main()
+{
+    FragColor = texture(skybox, TexCoord);
+}
+)";
+/// Shader to render a cube map -------- (end)
+
+/// App Global --- (start)
+const char* PANORAMA_PATH = "/Users/udayshinde/Desktop/OpenGLWindow/Assets/CubeMapSky.png";
+
+int SCR_WIDTH;
+int SCR_HEIGHT;
+
+Camera camera;
+float lastX;
+float lastY;
+bool firstMouse = true;
+
+ResampleFilter skyFilter = FilterBilinear;
+PanoramaLayout skyLayout = LayoutAuto;
+bool rebuildSky = false;
+/// App Global --- (end)
+
+/// Callbacks ---- (start)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, GLdouble xPos, GLdouble yPos);
+void scroll_callback(GLFWwindow* window, GLdouble xOffset, GLdouble yOffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+/// Callbacks ---- (end)
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bake") == 0) {
+        return bakeMain(argc, argv);
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Panorama to cube map", monitor, nullptr);
+    glfwMakeContextCurrent(window);
+
+    lastX = mode->width / 2.0f;
+    lastY = mode->height / 2.0f;
+
+    camera = Camera();
+    cameraInit(&camera, vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f, 2.0f, 0.2f, 45.0f);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialise GLAD" << std::endl;
+        return -1;
+    }
+
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+
+    // Callbacks
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    GLuint ShaderProgramSky = createProgram(cubeMapVertexShader, cubeMapFragmentShader);
+
+    float skyboxVertices[] = {
+        -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1, -1,
+        -1, -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1,
+         1, -1, -1,  1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1, -1,  1, -1, -1,
+        -1, -1,  1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1, -1,  1, -1, -1,  1,
+        -1,  1, -1,  1,  1, -1,  1,  1,  1,  1,  1,  1, -1,  1,  1, -1,  1, -1,
+        -1, -1, -1, -1, -1,  1,  1, -1, -1,  1, -1, -1, -1, -1,  1,  1, -1,  1
+    };
+
+    // Skybox VAO
+    GLuint skyVAO, skyVBO;
+    glGenVertexArrays(1, &skyVAO);
+    glGenBuffers(1, &skyVBO);
+
+    glBindVertexArray(skyVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), nullptr);
+    glBindVertexArray(0);
+
+    GLuint cubeMapTex = loadCubeMapFromPanorama(PANORAMA_PATH, skyLayout, skyFilter);
+
+    GLint SkyView = glGetUniformLocation(ShaderProgramSky, "view");
+    GLint SkyProjection = glGetUniformLocation(ShaderProgramSky, "projection");
+    glUseProgram(ShaderProgramSky);
+    glUniform1i(glGetUniformLocation(ShaderProgramSky, "skybox"), 0);
+
+    while (!glfwWindowShouldClose(window)) {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (rebuildSky) {
+            glDeleteTextures(1, &cubeMapTex);
+            cubeMapTex = loadCubeMapFromPanorama(PANORAMA_PATH, skyLayout, skyFilter);
+            rebuildSky = false;
+        }
+
+        glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT), 0.1f, 1000.0f);
+        glm::mat4 view = getCameraViewMatrix(&camera);
+
+        // The sky is the only thing drawn, no depth buffer needed
+        glUseProgram(ShaderProgramSky);
+        glUniformMatrix4fv(SkyView, 1, GL_FALSE, glm::value_ptr(glm::mat4(glm::mat3(view))));
+        glUniformMatrix4fv(SkyProjection, 1, GL_FALSE, glm::value_ptr(projection));
+        glBindVertexArray(skyVAO);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapTex);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteTextures(1, &cubeMapTex);
+    glDeleteVertexArrays(1, &skyVAO);
+    glDeleteBuffers(1, &skyVBO);
+    glDeleteProgram(ShaderProgramSky);
+
+    glfwTerminate();
+    return 0;
+}
+
+void key_callback(GLFWwindow*, int key, int, int action, int)
+{
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_F) {
+        skyFilter = skyFilter == FilterBilinear ? FilterBicubic : FilterBilinear;
+        rebuildSky = true;
+    } else if (key == GLFW_KEY_L) {
+        skyLayout = static_cast<PanoramaLayout>((skyLayout + 1) % 4);
+        cout << "Layout : " << layoutName(skyLayout) << endl;
+        rebuildSky = true;
+    }
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int, int)
+{
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+}
+
+void mouse_callback(GLFWwindow* window, const double xPos, const double yPos)
+{
+    const auto xpos = static_cast<float>(xPos);
+    const auto ypos = static_cast<float>(yPos);
+    if (firstMouse) {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+    float xOffset = xpos - lastX;
+    float yOffset = lastY - ypos; // reversed
+    lastX = xpos;
+    lastY = ypos;
+    cameraProcessMouseMovement(&camera, xOffset, yOffset);
+}
+
+void scroll_callback(GLFWwindow*, double, const double yOffset)
+{
+    cameraProcessMouseScroll(&camera, static_cast<float>(yOffset));
+}
@@ -0,0 +1,71 @@
+// Fixed timestep simulation clock : the simulation advances in ticks of exactly 1 / tick rate seconds however fast the
+// frames come, so behaviour no longer depends on frame rate and the same number of ticks always gives the same state.
+// Rendering blends the last two simulation states by simClockAlpha().
+//
+//   simClockAdvance(&clock, frameSeconds);
+//   while (simClockStep(&clock)) { previous = current; update(current, clock.tickSeconds); }
+//   render(mix(previous, current, simClockAlpha(&clock)));
+//
+// While paused no time is accumulated, no ticks run and the rendered state holds still.
+
+#pragma once
+
+#include <algorithm>
+
+/// Simulation ticks per second unless a demo asks for another rate
+constexpr double SIM_DEFAULT_TICK_RATE = 60.0;
+constexpr double SIM_MIN_TICK_RATE = 10.0;
+constexpr double SIM_MAX_TICK_RATE = 480.0;
+/// Longest frame the clock catches up on (a breakpoint or a window drag), the rest is dropped instead of
+/// running hundreds of ticks in one frame and falling further behind
+constexpr double SIM_MAX_FRAME_SECONDS = 0.25;
+
+struct SimulationClock {
+    double tickSeconds = 1.0 / SIM_DEFAULT_TICK_RATE;
+    double accumulator = 0.0;      // real time not yet simulated, always below one tick after stepping
+    double time = 0.0;             // simulated seconds at the latest tick
+    unsigned long long ticks = 0;
+    bool paused = false;
+};
+
+/// Changes the tick rate, keeping the blend factor so the rendered state does not jump
+/// @param clock Clock
+/// @param ticksPerSecond Tick rate, clamped to SIM_MIN_TICK_RATE .. SIM_MAX_TICK_RATE
+inline void simClockSetTickRate(SimulationClock* clock, double ticksPerSecond) {
+    const double alpha = clock->accumulator / clock->tickSeconds;
+    clock->tickSeconds = 1.0 / std::clamp(ticksPerSecond, SIM_MIN_TICK_RATE, SIM_MAX_TICK_RATE);
+    clock->accumulator = alpha * clock->tickSeconds;
+}
+
+/// Hands the clock the real time of the last frame
+/// @param clock Clock
+/// @param frameSeconds Real seconds since the previous frame
+inline void simClockAdvance(SimulationClock* clock, double frameSeconds) {
+    if (clock->paused) { return; }
+    clock->accumulator += std::min(frameSeconds, SIM_MAX_FRAME_SECONDS);
+}
+
+/// Consumes one tick if a whole one has accumulated
+/// @param clock Clock
+/// @return True if the caller should run one update of clock->tickSeconds
+inline bool simClockStep(SimulationClock* clock) {
+    if (clock->accumulator < clock->tickSeconds) { return false; }
+    clock->accumulator -= clock->tickSeconds;
+    clock->time += clock->tickSeconds;
+    clock->ticks++;
+    return true;
+}
+
+/// How far rendering is between the previous and the latest tick
+/// @param clock Clock
+/// @return 0 = previous state, 1 = latest state
+inline float simClockAlpha(const SimulationClock* clock) {
+    return static_cast<float>(std::min(clock->accumulator / clock->tickSeconds, 1.0));
+}
+
+/// Simulated time matching the blended state, for anything animated straight from time
+/// @param clock Clock
+/// @return Seconds
+inline double simClockRenderTime(const SimulationClock* clock) {
+    return std::max(clock->time - clock->tickSeconds * (1.0 - simClockAlpha(clock)), 0.0);
+}
@@ -1,6 +1,9 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <unordered_map>
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
@@ -9,6 +12,9 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "FixedTimestep.h"
+#include "FrameCapture.h"
+#include "SimdMath.h"
 
 using namespace std;
 
@@ -20,9 +26,13 @@ const char* VertexShaderSourceFlag = R"(
 
     out vec2 TexCord;
 
+#ifdef LEGACY_TRANSFORMS
     uniform mat4 projection;
     uniform mat4 view;
     uniform mat4 model;
+#else
+    uniform mat4 mvp;   // projection * view * model, multiplied once per draw on the CPU
+#endif
     uniform float time;
 
 void main()
@@ -57,7 +67,11 @@ void main()
     // slight vertical tension
     newPos.y += sin(x * 5.0 - t * 2.5) * 0.03 * damp;
 
+#ifdef LEGACY_TRANSFORMS
     gl_Position = projection * view * model * vec4(newPos, 1.0);
+#else
+    gl_Position = mvp * vec4(newPos, 1.0);
+#endif
     TexCord = aTexCord;
 }
 )";
@@ -83,13 +97,21 @@ layout (location = 1) in vec3 aColor;
 
 out vec3 vertex_Color;
 
+#ifdef LEGACY_TRANSFORMS
 uniform mat4 projection;
 uniform mat4 view;
 uniform mat4 model;
+#else
+uniform mat4 mvp;
+#endif
 
 void main()
 {
+#ifdef LEGACY_TRANSFORMS
     gl_Position = projection * view * model * vec4(aPos, 1.0);
+#else
+    gl_Position = mvp * vec4(aPos, 1.0);
+#endif
     vertex_Color = aColor;
 }
 )";
@@ -142,6 +164,22 @@ float AspectRatio(0.0f);
 float camAngle = 0.0f;
 float camRadius = 3.0f;
 float camHeight = -50.0f;
+// Camera state at the tick before the latest one, rendering blends the two
+float previousCamAngle = camAngle;
+float previousCamHeight = camHeight;
+// The camera used to move 0.005 up or 0.0008 rad round per frame, these are the same speeds at 60 fps
+constexpr float CAM_RISE_SPEED = 0.3f;     // units per second
+constexpr float CAM_ORBIT_SPEED = 0.048f;  // radians per second
+// H pauses the simulation, - / = halve / double the tick rate
+SimulationClock simClock;
+// --capture <ppm|yuv> <frames> renders that many frames offscreen in a hidden window and writes them out. The simulation
+// then steps exactly 1 / CAPTURE_FPS per frame, so the clip plays at real speed however slowly it was rendered.
+constexpr int CAPTURE_WIDTH = 1280;
+constexpr int CAPTURE_HEIGHT = 720;
+constexpr double CAPTURE_FPS = 30.0;
+// V (or --legacy-transforms) switches the flag and pole to the old vertex shaders, which multiply
+// projection * view * model for every vertex, to compare vertex cost with the MVP computed once per draw
+bool legacyTransforms = false;
 float skyboxVertices[] = {
     -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1, -1,
     -1, -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1,
@@ -154,8 +192,19 @@ float skyboxVertices[] = {
 
 // Callbacks --------------------------- (start)
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 // Callbacks --------------------------- (end)
 
+// One simulation tick of the camera : rise to the flag, then orbit it
+void stepCamera(float dt) {
+    if (camHeight < 1.0f) {
+        camHeight += CAM_RISE_SPEED * dt;
+    }
+    else {
+        camAngle += CAM_ORBIT_SPEED * dt;
+    }
+}
+
 // structures ------------------ (start)
 struct StructVertexFlag {
     glm::vec3 pos;
@@ -165,6 +214,39 @@ struct StructVertexBox {
     glm::vec3 pos;
     glm::vec3 color;
 };
+
+// GL state cache : shadow copy of the GL state touched every frame so redundant calls never reach the driver
+constexpr GLuint STATE_UNKNOWN = 0xFFFFFFFF;
+constexpr int MAX_TEXTURE_UNITS = 16;
+
+struct CachedUniform {
+    GLenum type = 0;        // GL_INT, GL_FLOAT, GL_FLOAT_VEC3 or GL_FLOAT_MAT4
+    GLint integer = 0;
+    GLfloat floats[16] = {};
+};
+
+struct GLStateCache {
+    GLuint program = STATE_UNKNOWN;
+    GLuint vertexArray = STATE_UNKNOWN;
+    GLuint activeUnit = STATE_UNKNOWN;
+    GLuint texture2D[MAX_TEXTURE_UNITS];
+    GLuint textureCube[MAX_TEXTURE_UNITS];
+    GLint depthTest = -1;   // -1 = unknown, 0 = off, 1 = on
+    GLint depthMask = -1;
+    GLenum depthFunc = STATE_UNKNOWN;
+    GLint blend = -1;
+    GLenum blendSrc = STATE_UNKNOWN;
+    GLenum blendDst = STATE_UNKNOWN;
+
+    // program -> uniform location -> last uploaded value
+    std::unordered_map<GLuint, std::unordered_map<GLint, CachedUniform>> uniforms;
+
+    // Calls forwarded to GL vs. calls dropped because nothing changed
+    unsigned long long issued = 0;
+    unsigned long long elided = 0;
+    // Uniform calls on location -1 (not in the program), dropped but not counted as redundant
+    unsigned long long missingUniforms = 0;
+};
 // structures ------------------ (end)
 
 // Function Declarations ---------------------- (start)
@@ -183,6 +265,7 @@ void AddStrip(
     float StripNumber
 );
 GLuint CreateShaderProgram(const char* VertexShaderSource, const char* FragmentShaderSource);
+std::string LegacyTransformsVariant(const char* ShaderSource);
 void addBox(
     std::vector<StructVertexBox>& verts,
     glm::vec3 min,
@@ -190,15 +273,46 @@ void addBox(
     glm::vec3 boxColor
 );
 GLuint loadCubemap(std::vector<std::string> faces);
+void stateInvalidate(GLStateCache* cache);
+void stateUseProgram(GLStateCache* cache, GLuint program);
+void stateBindVertexArray(GLStateCache* cache, GLuint vao);
+void stateBindTexture(GLStateCache* cache, GLuint unit, GLenum target, GLuint texture);
+void stateSetDepthTest(GLStateCache* cache, bool enabled);
+void stateSetDepthMask(GLStateCache* cache, bool enabled);
+void stateSetDepthFunc(GLStateCache* cache, GLenum func);
+void stateSetBlend(GLStateCache* cache, bool enabled);
+void stateSetBlendFunc(GLStateCache* cache, GLenum src, GLenum dst);
+void stateUniform1i(GLStateCache* cache, GLint location, GLint value);
+void stateUniform1f(GLStateCache* cache, GLint location, GLfloat value);
+void stateUniformMatrix4fv(GLStateCache* cache, GLint location, const glm::mat4& value);
+void statePrintStats(GLStateCache* cache, int frames);
 // Function Declarations ---------------------- (end)
 
 // Main function
-int main() {
+int main(int argc, char** argv) {
+    CaptureFormat captureFormat = CAPTURE_PPM;
+    long captureFrames = 0;   // 0 = interactive, no capture
+    for (int i = 1; i + 2 < argc; i++) {
+        if (strcmp(argv[i], "--capture") != 0) continue;
+        if (strcmp(argv[i + 1], "yuv") == 0) captureFormat = CAPTURE_YUV;
+        else if (strcmp(argv[i + 1], "ppm") != 0) {
+            cout << "Capture format must be ppm or yuv" << endl;
+            return 1;
+        }
+        captureFrames = strtol(argv[i + 2], nullptr, 10);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--legacy-transforms") == 0) legacyTransforms = true;
+    }
+    const bool capturing = captureFrames > 0;
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,1);
     glfwWindowHint(GLFW_OPENGL_CORE_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    // Nothing is shown while capturing, the window only provides the context
+    if (capturing) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     GLFWwindow* window = glfwCreateWindow(800, 600, "Flag", nullptr, nullptr);
     glfwMakeContextCurrent(window);
@@ -217,9 +331,23 @@ int main() {
     AspectRatio = (float)fbWidth / (float)fbHeight;
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetKeyCallback(window, key_callback);
+
+    FrameCapture capture;
+    if (capturing) {
+        if (!captureInit(&capture, CAPTURE_WIDTH, CAPTURE_HEIGHT, captureFormat, "flag_capture")) {
+            glfwTerminate();
+            return 1;
+        }
+        AspectRatio = (float)capture.width / (float)capture.height;
+    }
 
+    // Both vertex shader variants of the flag and the pole : [0] takes the MVP from the CPU, [1] is the legacy one
     cout << "Generating ShaderProgramFlag --- (start)" << endl;
-    GLuint ShaderProgramFlag = CreateShaderProgram(VertexShaderSourceFlag, FragmentShaderSourceFlag);
+    const GLuint ShaderProgramFlag[2] = {
+        CreateShaderProgram(VertexShaderSourceFlag, FragmentShaderSourceFlag),
+        CreateShaderProgram(LegacyTransformsVariant(VertexShaderSourceFlag).c_str(), FragmentShaderSourceFlag)
+    };
     cout << "Generating ShaderProgramFlag --- (End)" << endl;
     // Flag vertex Data -------------- (start)
     GLuint VAOFlag, VBOFlag;
@@ -241,7 +369,10 @@ int main() {
     // Flag vertex Data -------------- (end)
 
     cout << "Generating ShaderProgramBase --- (start)" << endl;
-    GLuint ShaderProgramBase = CreateShaderProgram(VertexShaderSourceBase, FragmentShaderSourceBase);
+    const GLuint ShaderProgramBase[2] = {
+        CreateShaderProgram(VertexShaderSourceBase, FragmentShaderSourceBase),
+        CreateShaderProgram(LegacyTransformsVariant(VertexShaderSourceBase).c_str(), FragmentShaderSourceBase)
+    };
     cout << "Generating ShaderProgramBase --- (End)" << endl;
 
     // Pole vertex Data -------------- (start)
@@ -325,94 +456,144 @@ int main() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glEnable(GL_DEPTH_TEST);
-
-    int timeLoc = glGetUniformLocation(ShaderProgramFlag, "time");
-    int ViewmatrixLocation = glGetUniformLocation(ShaderProgramFlag,"view");
-    int ProjectionMatrixLocation = glGetUniformLocation(ShaderProgramFlag,"projection");
-    int ModelMatrixLocation = glGetUniformLocation(ShaderProgramFlag,"model");
+    int timeLoc[2], FlagTextureLocation[2];
+    for (int variant = 0; variant < 2; variant++) {
+        timeLoc[variant] = glGetUniformLocation(ShaderProgramFlag[variant], "time");
+        FlagTextureLocation[variant] = glGetUniformLocation(ShaderProgramFlag[variant], "Texture");
+    }
+    int MvpLocation = glGetUniformLocation(ShaderProgramFlag[0], "mvp");
+    int ViewmatrixLocation = glGetUniformLocation(ShaderProgramFlag[1],"view");
+    int ProjectionMatrixLocation = glGetUniformLocation(ShaderProgramFlag[1],"projection");
+    int ModelMatrixLocation = glGetUniformLocation(ShaderProgramFlag[1],"model");
+
+    int MvpLocationPole = glGetUniformLocation(ShaderProgramBase[0], "mvp");
+    int ViewMatrixLocationPole = glGetUniformLocation(ShaderProgramBase[1],"view");
+    int ProjectionMatrixLocationPole = glGetUniformLocation(ShaderProgramBase[1],"projection");
+    int ModelMatrixLocationPole = glGetUniformLocation(ShaderProgramBase[1],"model");
+
+    int ViewMatrixLocationSky = glGetUniformLocation(ShaderProgramSky,"view");
+    int ProjectionMatrixLocationSky = glGetUniformLocation(ShaderProgramSky,"projection");
+    int SkyboxLocation = glGetUniformLocation(ShaderProgramSky, "skybox");
+
+    // Everything above talked to GL directly, start the cache from a clean slate
+    GLStateCache glState;
+    stateInvalidate(&glState);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    float lastStatsTime = 0.0f;
+    int statsFrames = 0;
+    double lastFrameTime = glfwGetTime();
+    while (!glfwWindowShouldClose(window)) {
+        if (capturing) captureBindTarget(&capture);
 
-    int ViewMatrixLocationPole = glGetUniformLocation(ShaderProgramBase,"view");
-    int ProjectionMatrixLocationPole = glGetUniformLocation(ShaderProgramBase,"projection");
-    int ModelMatrixLocationPole = glGetUniformLocation(ShaderProgramBase,"model");
+        // Depth writes must be back on before glClear, the sky pass leaves them off
+        stateSetDepthTest(&glState, true);
+        stateSetDepthMask(&glState, true);
+        stateSetDepthFunc(&glState, GL_LESS);
 
-    float camX = 0.0f, camZ = 10.0f;
-    while (!glfwWindowShouldClose(window)) {
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-        float t = glfwGetTime();
-        glUniform1f(timeLoc, t);
-
-        if (camHeight < 1.0f) {
-            camHeight = camHeight + 0.005f;
-        }
-        else {
-            camAngle += 0.05f * 0.016f; // orbit speed
-            camX = sin(camAngle) * 10.0f;
-            camZ = cos(camAngle) * 10.0f;
+        const double now = glfwGetTime();
+        simClockAdvance(&simClock, capturing ? 1.0 / CAPTURE_FPS : now - lastFrameTime);
+        lastFrameTime = now;
+        while (simClockStep(&simClock)) {
+            previousCamAngle = camAngle;
+            previousCamHeight = camHeight;
+            stepCamera(static_cast<float>(simClock.tickSeconds));
         }
 
+        // Render between the last two ticks, the flag waves on simulated time so it pauses with everything else
+        const float alpha = simClockAlpha(&simClock);
+        const float angle = previousCamAngle + (camAngle - previousCamAngle) * alpha;
+        const float camHeightNow = previousCamHeight + (camHeight - previousCamHeight) * alpha;
+        const float camX = sin(angle) * 10.0f;
+        const float camZ = cos(angle) * 10.0f;
+        const float t = static_cast<float>(simClockRenderTime(&simClock));
 
-        glm::vec3 camPos   = glm::vec3(camX, camHeight, camZ);
+        glm::vec3 camPos   = glm::vec3(camX, camHeightNow, camZ);
         glm::vec3 target   = glm::vec3(-0.7f, 0.0f, 0.0f); // center of flag
         glm::vec3 up       = glm::vec3(0.0f, 1.0f, 0.0f);
 
         glm::mat4 view = glm::lookAt(camPos, target, up);
         glm::mat4 projection = glm::perspective(glm::radians(30.0f),AspectRatio,0.1f,100.0f);
         glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model,{-0.7f, 0.0f, 0.0f});
+        glm::mat4 modelPole = glm::mat4(1.0f);
+        modelPole = glm::translate(modelPole,{-0.7f, 0.0f, 0.0f});
+        const int variant = legacyTransforms ? 1 : 0;
 
-        glDepthMask(GL_FALSE);
-        glDepthFunc(GL_LEQUAL);
-        glUseProgram(ShaderProgramSky);
-
-        glm::mat4 skyView = glm::mat4(glm::mat3(view)); // remove translation
-        glUniformMatrix4fv(glGetUniformLocation(ShaderProgramSky,"view"),1,GL_FALSE,glm::value_ptr(skyView));
-        glUniformMatrix4fv(glGetUniformLocation(ShaderProgramSky,"projection"),1,GL_FALSE,glm::value_ptr(projection));
-
-        glBindVertexArray(skyVAO);
-        glUniform1i(glGetUniformLocation(ShaderProgramSky, "skybox"), 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindTexture(GL_TEXTURE_2D, 0);
-
-        glDepthMask(GL_TRUE);
-        glDepthFunc(GL_LESS);
+        // Both MVPs in one batch, as the other demos do for their objects : [0] flag, [1] pole
+        const glm::mat4 models[2] = {model, modelPole};
+        glm::mat4 mvps[2];
+        simdMat4MulBatchShared(projection * view, models, mvps, 2);
 
         // Drawing Flag
-        glUseProgram(ShaderProgramFlag);
-        glUniform1f(timeLoc, t);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, FlagTexture);
-        glUniform1i(glGetUniformLocation(ShaderProgramFlag, "Texture"), 0);
-        glBindVertexArray(VAOFlag);
-        model = glm::translate(model,{-0.7f, 0.0f, 0.0f});
-        glUniformMatrix4fv(ViewmatrixLocation,1,GL_FALSE,glm::value_ptr(view));
-        glUniformMatrix4fv(ProjectionMatrixLocation,1,GL_FALSE,glm::value_ptr(projection));
-        glUniformMatrix4fv(ModelMatrixLocation,1,GL_FALSE,glm::value_ptr(model));
+        // time is uploaded only once the flag program is bound (it used to be sent to whatever program was current)
+        stateUseProgram(&glState, ShaderProgramFlag[variant]);
+        stateUniform1f(&glState, timeLoc[variant], t);
+        stateBindTexture(&glState, 0, GL_TEXTURE_2D, FlagTexture);
+        stateUniform1i(&glState, FlagTextureLocation[variant], 0);
+        stateBindVertexArray(&glState, VAOFlag);
+        if (legacyTransforms) {
+            stateUniformMatrix4fv(&glState, ViewmatrixLocation, view);
+            stateUniformMatrix4fv(&glState, ProjectionMatrixLocation, projection);
+            stateUniformMatrix4fv(&glState, ModelMatrixLocation, model);
+        } else {
+            stateUniformMatrix4fv(&glState, MvpLocation, mvps[0]);
+        }
         glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(FlagVertices.size()));
 
         // Drawing Pole
-        glUseProgram(ShaderProgramBase);
-        glBindVertexArray(VAOPole);
-        //glm::mat4 viewPole = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, CameraDepth));
-        glm::mat4 projectionPole = glm::perspective(glm::radians(30.0f),AspectRatio,0.1f,100.0f);
-        glm::mat4 modelPole = glm::mat4(1.0f);
-        modelPole = glm::translate(modelPole,{-0.7f, 0.0f, 0.0f});
-        glUniformMatrix4fv(ViewMatrixLocationPole,1,GL_FALSE,glm::value_ptr(view));
-        glUniformMatrix4fv(ProjectionMatrixLocationPole,1,GL_FALSE,glm::value_ptr(projectionPole));
-        glUniformMatrix4fv(ModelMatrixLocationPole,1,GL_FALSE,glm::value_ptr(modelPole));
+        stateUseProgram(&glState, ShaderProgramBase[variant]);
+        stateBindVertexArray(&glState, VAOPole);
+        if (legacyTransforms) {
+            stateUniformMatrix4fv(&glState, ViewMatrixLocationPole, view);
+            stateUniformMatrix4fv(&glState, ProjectionMatrixLocationPole, projection);
+            stateUniformMatrix4fv(&glState, ModelMatrixLocationPole, modelPole);
+        } else {
+            stateUniformMatrix4fv(&glState, MvpLocationPole, mvps[1]);
+        }
         glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(PoleVertices.size()));
 
-        glfwSwapBuffers(window);
+        // Drawing Sky last : it sits at the far plane (xyww), so with GL_LEQUAL it only fills pixels
+        // the flag and pole left empty instead of being overdrawn by them
+        stateSetDepthMask(&glState, false);
+        stateSetDepthFunc(&glState, GL_LEQUAL);
+        stateUseProgram(&glState, ShaderProgramSky);
+
+        glm::mat4 skyView = glm::mat4(glm::mat3(view)); // remove translation
+        stateUniformMatrix4fv(&glState, ViewMatrixLocationSky, skyView);
+        stateUniformMatrix4fv(&glState, ProjectionMatrixLocationSky, projection);
+
+        stateBindVertexArray(&glState, skyVAO);
+        stateUniform1i(&glState, SkyboxLocation, 0);
+        stateBindTexture(&glState, 0, GL_TEXTURE_CUBE_MAP, cubemapTex);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+
+        if (capturing) {
+            captureEndFrame(&capture);
+            if (capture.framesIssued >= static_cast<unsigned long long>(captureFrames)) glfwSetWindowShouldClose(window, true);
+        }
+
+        statsFrames++;
+        if (static_cast<float>(now) - lastStatsTime >= 2.0f) {
+            statePrintStats(&glState, statsFrames);
+            if (capturing) capturePrintStats(&capture);
+            lastStatsTime = static_cast<float>(now);
+            statsFrames = 0;
+        }
+
+        // A hidden window has nothing to present, and skipping the swap keeps vsync from capping the capture rate
+        if (!capturing) glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    if (capturing) captureFinish(&capture);
     glDeleteVertexArrays(1, &VAOFlag);
     glDeleteBuffers(1, &VBOFlag);
-    glDeleteProgram(ShaderProgramFlag);
+    glDeleteProgram(ShaderProgramFlag[0]);
+    glDeleteProgram(ShaderProgramFlag[1]);
     glfwTerminate();
     return 0;
 }
@@ -422,6 +603,23 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
     AspectRatio = (float)width / (float)height;
 }
+
+void key_callback(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_H) {
+        simClock.paused = !simClock.paused;
+        cout << "Simulation " << (simClock.paused ? "paused" : "running") << endl;
+    }
+    if (key == GLFW_KEY_MINUS || key == GLFW_KEY_EQUAL) {
+        const double rate = 1.0 / simClock.tickSeconds;
+        simClockSetTickRate(&simClock, key == GLFW_KEY_EQUAL ? rate * 2.0 : rate * 0.5);
+        cout << "Simulation tick rate " << 1.0 / simClock.tickSeconds << " Hz" << endl;
+    }
+    if (key == GLFW_KEY_V) {
+        legacyTransforms = !legacyTransforms;
+        cout << "Vertex transforms : " << (legacyTransforms ? "legacy, projection * view * model per vertex" : "MVP from the CPU") << endl;
+    }
+}
 // Callback Definitions --------------- (start)
 
 // Function definitions ------------------------------------------------------------ (start)
@@ -463,6 +661,14 @@ GLuint CreateShaderProgram(const char* VertexShaderSource, const char* FragmentS
     return ShaderProgram;
 }
 
+// The same shader with LEGACY_TRANSFORMS defined, which must go after the #version line
+std::string LegacyTransformsVariant(const char* ShaderSource) {
+    std::string source = ShaderSource;
+    const size_t versionEnd = source.find('\n', source.find("#version"));
+    source.insert(versionEnd + 1, "#define LEGACY_TRANSFORMS\n");
+    return source;
+}
+
 
 // For Flag vertex data ------- (start)
 /*
@@ -613,4 +819,146 @@ GLuint loadCubemap(std::vector<std::string> faces)
     return texID;
 }
 
+// GL state cache ------- (start)
+// Forgets everything the cache knows, call after code that touches GL directly (setup, loaders)
+void stateInvalidate(GLStateCache* cache) {
+    cache->program = STATE_UNKNOWN;
+    cache->vertexArray = STATE_UNKNOWN;
+    cache->activeUnit = STATE_UNKNOWN;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+        cache->texture2D[i] = STATE_UNKNOWN;
+        cache->textureCube[i] = STATE_UNKNOWN;
+    }
+    cache->depthTest = -1;
+    cache->depthMask = -1;
+    cache->depthFunc = STATE_UNKNOWN;
+    cache->blend = -1;
+    cache->blendSrc = STATE_UNKNOWN;
+    cache->blendDst = STATE_UNKNOWN;
+    cache->uniforms.clear();
+}
+
+void stateUseProgram(GLStateCache* cache, GLuint program) {
+    if (cache->program == program) { cache->elided++; return; }
+    glUseProgram(program);
+    cache->program = program;
+    cache->issued++;
+}
+
+void stateBindVertexArray(GLStateCache* cache, GLuint vao) {
+    if (cache->vertexArray == vao) { cache->elided++; return; }
+    glBindVertexArray(vao);
+    cache->vertexArray = vao;
+    cache->issued++;
+}
+
+// glActiveTexture is only issued when the unit really has to change
+void stateBindTexture(GLStateCache* cache, GLuint unit, GLenum target, GLuint texture) {
+    GLuint* slot = (target == GL_TEXTURE_CUBE_MAP) ? &cache->textureCube[unit] : &cache->texture2D[unit];
+    if (*slot == texture) { cache->elided++; return; }
+    if (cache->activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        cache->activeUnit = unit;
+        cache->issued++;
+    }
+    glBindTexture(target, texture);
+    *slot = texture;
+    cache->issued++;
+}
+
+void stateSetDepthTest(GLStateCache* cache, bool enabled) {
+    if (cache->depthTest == static_cast<GLint>(enabled)) { cache->elided++; return; }
+    if (enabled) { glEnable(GL_DEPTH_TEST); } else { glDisable(GL_DEPTH_TEST); }
+    cache->depthTest = enabled;
+    cache->issued++;
+}
+
+void stateSetDepthMask(GLStateCache* cache, bool enabled) {
+    if (cache->depthMask == static_cast<GLint>(enabled)) { cache->elided++; return; }
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    cache->depthMask = enabled;
+    cache->issued++;
+}
+
+void stateSetDepthFunc(GLStateCache* cache, GLenum func) {
+    if (cache->depthFunc == func) { cache->elided++; return; }
+    glDepthFunc(func);
+    cache->depthFunc = func;
+    cache->issued++;
+}
+
+void stateSetBlend(GLStateCache* cache, bool enabled) {
+    if (cache->blend == static_cast<GLint>(enabled)) { cache->elided++; return; }
+    if (enabled) { glEnable(GL_BLEND); } else { glDisable(GL_BLEND); }
+    cache->blend = enabled;
+    cache->issued++;
+}
+
+void stateSetBlendFunc(GLStateCache* cache, GLenum src, GLenum dst) {
+    if (cache->blendSrc == src && cache->blendDst == dst) { cache->elided++; return; }
+    glBlendFunc(src, dst);
+    cache->blendSrc = src;
+    cache->blendDst = dst;
+    cache->issued++;
+}
+
+// Compares a uniform value against what the current program already holds and records it.
+// Returns true when the value must be uploaded.
+bool stateUniformChanged(GLStateCache* cache, GLint location, GLenum type, const GLfloat* floats, int count, GLint integer) {
+    // location -1 is silently ignored by GL, no need to pay for the call
+    if (location < 0) { cache->missingUniforms++; return false; }
+    if (cache->program == STATE_UNKNOWN || cache->program == 0) {
+        // Reported once, this runs inside the render loop
+        static bool reported = false;
+        if (!reported) {
+            cout << "GL state cache: uniform " << location << " set with no program bound" << endl;
+            reported = true;
+        }
+        cache->issued++;
+        return true;
+    }
+
+    CachedUniform& cached = cache->uniforms[cache->program][location];
+    bool same = cached.type == type;
+    if (same && type == GL_INT) {
+        same = cached.integer == integer;
+    } else if (same) {
+        same = std::memcmp(cached.floats, floats, count * sizeof(GLfloat)) == 0;
+    }
+    if (same) { cache->elided++; return false; }
+
+    cached.type = type;
+    cached.integer = integer;
+    if (floats) { std::memcpy(cached.floats, floats, count * sizeof(GLfloat)); }
+    cache->issued++;
+    return true;
+}
+
+void stateUniform1i(GLStateCache* cache, GLint location, GLint value) {
+    if (stateUniformChanged(cache, location, GL_INT, nullptr, 0, value)) { glUniform1i(location, value); }
+}
+
+void stateUniform1f(GLStateCache* cache, GLint location, GLfloat value) {
+    if (stateUniformChanged(cache, location, GL_FLOAT, &value, 1, 0)) { glUniform1f(location, value); }
+}
+
+void stateUniformMatrix4fv(GLStateCache* cache, GLint location, const glm::mat4& value) {
+    if (stateUniformChanged(cache, location, GL_FLOAT_MAT4, glm::value_ptr(value), 16, 0)) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+}
+
+// Prints issued vs elided calls per frame since the last report and resets the counters
+void statePrintStats(GLStateCache* cache, int frames) {
+    const unsigned long long total = cache->issued + cache->elided;
+    if (frames <= 0 || total == 0) { return; }
+    cout << "GL state cache : issued " << cache->issued / frames
+         << " / elided " << cache->elided / frames << " calls per frame ("
+         << (100.0 * static_cast<double>(cache->elided) / static_cast<double>(total)) << "% elided)";
+    if (cache->missingUniforms > 0) { cout << ", " << cache->missingUniforms / frames << " uniform calls on missing locations"; }
+    cout << endl;
+    cache->issued = 0;
+    cache->elided = 0;
+    cache->missingUniforms = 0;
+}
+// GL state cache ------- (end)
+
 // Function definitions ------------------------------------------------------------ (End)
\ No newline at end of file
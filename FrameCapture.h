@@ -0,0 +1,327 @@
+// Frame capture : renders into an offscreen framebuffer and reads it back through a ring of pixel pack buffers.
+// glReadPixels into a bound pack buffer only queues a copy, a fence marks when it is done, and the buffer is mapped
+// CAPTURE_RING_SIZE frames later, long after the copy finished, so the readback of frame N overlaps the rendering
+// of frames N + 1 and N + 2 instead of stalling the pipeline. Mapped frames go to a writer thread that saves them
+// as binary PPM images or appends them to one raw YUV 4:2:0 (I420) stream for a video encoder.
+//
+//   captureInit(&capture, width, height, CAPTURE_YUV, "flag_capture");
+//   each frame : captureBindTarget(&capture); draw; captureEndFrame(&capture);
+//   captureFinish(&capture);   // while the context is still current
+
+#pragma once
+
+#include "glad/glad.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Frames in flight between glReadPixels and the map, the readback of frame N is collected after frame N + 2
+constexpr int CAPTURE_RING_SIZE = 3;
+/// Frames waiting for the writer before rendering waits for it (a slow disk slows the capture, it never drops frames)
+constexpr size_t CAPTURE_MAX_QUEUED = 16;
+
+enum CaptureFormat { CAPTURE_PPM, CAPTURE_YUV };
+
+/// One mapped frame on its way to disk, RGBA rows bottom to top as GL returns them
+struct CaptureJob {
+    unsigned long long frame;
+    std::vector<unsigned char> pixels;
+};
+
+struct FrameCapture {
+    int width = 0;
+    int height = 0;
+    CaptureFormat format = CAPTURE_PPM;
+    std::string pathPrefix;
+
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+    GLuint packBuffers[CAPTURE_RING_SIZE] = {};
+    GLsync fences[CAPTURE_RING_SIZE] = {};
+    unsigned long long slotFrame[CAPTURE_RING_SIZE] = {};
+    unsigned long long framesIssued = 0;
+
+    // Writer thread, everything below the mutex is shared with it
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobTaken;
+    std::deque<CaptureJob> queue;
+    std::vector<std::vector<unsigned char>> freeBuffers;   // reused so steady capture does not allocate
+    bool stopping = false;
+    unsigned long long framesWritten = 0;
+
+    // Only the writer touches the stream
+    std::ofstream yuv;
+
+    unsigned long long fenceWaits = 0;    // readbacks still unfinished when their slot came round
+    unsigned long long mapFailures = 0;   // readbacks that could not be mapped, skipped instead of written blank
+    unsigned long long writerWaits = 0;   // frames that had to wait for room in the queue
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point lastReport;
+    unsigned long long lastReportFrames = 0;
+};
+
+/// Writes one frame, runs on the writer thread
+/// @param capture Capture
+/// @param job Frame
+inline void captureWriteFrame(FrameCapture* capture, const CaptureJob& job) {
+    const int w = capture->width, h = capture->height;
+    const unsigned char* pixels = job.pixels.data();
+
+    if (capture->format == CAPTURE_PPM) {
+        char path[512];
+        std::snprintf(path, sizeof(path), "%s_%05llu.ppm", capture->pathPrefix.c_str(), job.frame);
+        std::ofstream out(path, std::ios::binary);
+        out << "P6\n" << w << " " << h << "\n255\n";
+        std::vector<unsigned char> row(static_cast<size_t>(w) * 3);
+        for (int y = h - 1; y >= 0; y--) {   // GL rows start at the bottom
+            const unsigned char* src = pixels + static_cast<size_t>(y) * w * 4;
+            for (int x = 0; x < w; x++) {
+                row[x * 3 + 0] = src[x * 4 + 0];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + 2];
+            }
+            out.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+        }
+        return;
+    }
+
+    // I420 : full resolution Y plane, then U and V at half resolution, BT.601 limited range
+    std::vector<unsigned char> planes(static_cast<size_t>(w) * h * 3 / 2);
+    unsigned char* yPlane = planes.data();
+    unsigned char* uPlane = yPlane + static_cast<size_t>(w) * h;
+    unsigned char* vPlane = uPlane + static_cast<size_t>(w / 2) * (h / 2);
+    for (int y = 0; y < h; y++) {
+        const unsigned char* src = pixels + static_cast<size_t>(h - 1 - y) * w * 4;
+        for (int x = 0; x < w; x++) {
+            const int r = src[x * 4 + 0], g = src[x * 4 + 1], b = src[x * 4 + 2];
+            yPlane[static_cast<size_t>(y) * w + x] = static_cast<unsigned char>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    for (int y = 0; y < h / 2; y++) {
+        for (int x = 0; x < w / 2; x++) {
+            // Average of the 2x2 block
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                const unsigned char* src = pixels + static_cast<size_t>(h - 1 - (y * 2 + dy)) * w * 4 + x * 2 * 4;
+                r += src[0] + src[4];
+                g += src[1] + src[5];
+                b += src[2] + src[6];
+            }
+            r = (r + 2) / 4; g = (g + 2) / 4; b = (b + 2) / 4;
+            uPlane[static_cast<size_t>(y) * (w / 2) + x] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[static_cast<size_t>(y) * (w / 2) + x] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+    capture->yuv.write(reinterpret_cast<const char*>(planes.data()), static_cast<std::streamsize>(planes.size()));
+}
+
+/// Writer thread : takes frames off the queue until captureFinish() stops it and the queue is empty
+/// @param capture Capture
+inline void captureWriterLoop(FrameCapture* capture) {
+    std::unique_lock<std::mutex> lock(capture->mutex);
+    while (true) {
+        capture->jobReady.wait(lock, [capture] { return capture->stopping || !capture->queue.empty(); });
+        if (capture->queue.empty()) { return; }   // stopping and drained
+        CaptureJob job = std::move(capture->queue.front());
+        capture->queue.pop_front();
+        capture->jobTaken.notify_one();
+
+        lock.unlock();
+        captureWriteFrame(capture, job);
+        lock.lock();
+
+        capture->framesWritten++;
+        capture->freeBuffers.push_back(std::move(job.pixels));
+    }
+}
+
+/// Creates the offscreen target, the pack buffers and the writer thread
+/// @param capture Capture
+/// @param width Width in pixels (rounded down to even for YUV)
+/// @param height Height in pixels (rounded down to even for YUV)
+/// @param format PPM images or a YUV stream
+/// @param pathPrefix Output path without extension
+/// @return False if the YUV stream cannot be created or the framebuffer is incomplete
+inline bool captureInit(FrameCapture* capture, int width, int height, CaptureFormat format, const std::string& pathPrefix) {
+    capture->width = format == CAPTURE_YUV ? width & ~1 : width;
+    capture->height = format == CAPTURE_YUV ? height & ~1 : height;
+    capture->format = format;
+    capture->pathPrefix = pathPrefix;
+
+    // Opened before any GL object so a failure leaves nothing to release
+    const std::string yuvPath = pathPrefix + "_" + std::to_string(capture->width) + "x" + std::to_string(capture->height) + ".yuv";
+    if (format == CAPTURE_YUV) {
+        capture->yuv.open(yuvPath, std::ios::binary);
+        if (!capture->yuv) {
+            std::cout << "Cannot create capture stream " << yuvPath << std::endl;
+            return false;
+        }
+    }
+
+    glGenFramebuffers(1, &capture->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, capture->framebuffer);
+    glGenRenderbuffers(1, &capture->colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, capture->colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, capture->width, capture->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, capture->colorBuffer);
+    glGenRenderbuffers(1, &capture->depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, capture->depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, capture->width, capture->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, capture->depthBuffer);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cout << "Capture framebuffer incomplete" << std::endl;
+        capture->yuv.close();
+        return false;
+    }
+
+    const GLsizeiptr frameBytes = static_cast<GLsizeiptr>(capture->width) * capture->height * 4;
+    glGenBuffers(CAPTURE_RING_SIZE, capture->packBuffers);
+    for (GLuint buffer : capture->packBuffers) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (format == CAPTURE_YUV) {
+        std::cout << "Capturing to " << yuvPath << " (ffmpeg -f rawvideo -pix_fmt yuv420p -s " << capture->width << "x"
+                  << capture->height << " -i " << yuvPath << " out.mp4)" << std::endl;
+    } else {
+        std::cout << "Capturing to " << pathPrefix << "_NNNNN.ppm" << std::endl;
+    }
+
+    capture->start = capture->lastReport = std::chrono::steady_clock::now();
+    capture->writer = std::thread(captureWriterLoop, capture);
+    return true;
+}
+
+/// Makes the offscreen target current for drawing
+/// @param capture Capture
+inline void captureBindTarget(const FrameCapture* capture) {
+    glBindFramebuffer(GL_FRAMEBUFFER, capture->framebuffer);
+    glViewport(0, 0, capture->width, capture->height);
+}
+
+/// Maps a finished readback and queues it for the writer, waiting on its fence if the GPU has not got there yet.
+/// A readback that cannot be mapped is counted and skipped.
+/// @param capture Capture
+/// @param slot Ring slot
+inline void captureCollect(FrameCapture* capture, int slot) {
+    GLsync& fence = capture->fences[slot];
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        capture->fenceWaits++;
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+
+    const size_t frameBytes = static_cast<size_t>(capture->width) * capture->height * 4;
+    std::vector<unsigned char> pixels;
+    {
+        std::unique_lock<std::mutex> lock(capture->mutex);
+        if (capture->queue.size() >= CAPTURE_MAX_QUEUED) {
+            capture->writerWaits++;
+            capture->jobTaken.wait(lock, [capture] { return capture->queue.size() < CAPTURE_MAX_QUEUED; });
+        }
+        if (!capture->freeBuffers.empty()) {
+            pixels = std::move(capture->freeBuffers.back());
+            capture->freeBuffers.pop_back();
+        }
+    }
+    pixels.resize(frameBytes);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->packBuffers[slot]);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(frameBytes), GL_MAP_READ_BIT);
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        capture->mapFailures++;
+        std::lock_guard<std::mutex> lock(capture->mutex);
+        capture->freeBuffers.push_back(std::move(pixels));
+        return;
+    }
+    std::memcpy(pixels.data(), mapped, frameBytes);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(capture->mutex);
+        capture->queue.push_back({capture->slotFrame[slot], std::move(pixels)});
+    }
+    capture->jobReady.notify_one();
+}
+
+/// Queues the readback of the frame just drawn and hands the oldest finished one to the writer
+/// @param capture Capture
+inline void captureEndFrame(FrameCapture* capture) {
+    const int slot = static_cast<int>(capture->framesIssued % CAPTURE_RING_SIZE);
+    if (capture->fences[slot]) { captureCollect(capture, slot); }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, capture->framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->packBuffers[slot]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture->fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    capture->slotFrame[slot] = capture->framesIssued++;
+}
+
+/// Prints the sustained write rate since the last report
+/// @param capture Capture
+inline void capturePrintStats(FrameCapture* capture) {
+    unsigned long long written, queued;
+    {
+        std::lock_guard<std::mutex> lock(capture->mutex);
+        written = capture->framesWritten;
+        queued = capture->queue.size();
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - capture->lastReport).count();
+    std::cout << "Capture : " << static_cast<double>(written - capture->lastReportFrames) / seconds << " fps written, "
+              << written << " frames, " << queued << " queued, fence waits " << capture->fenceWaits
+              << ", writer waits " << capture->writerWaits;
+    if (capture->mapFailures > 0) { std::cout << ", " << capture->mapFailures << " frames skipped (map failed)"; }
+    std::cout << std::endl;
+    capture->lastReport = now;
+    capture->lastReportFrames = written;
+}
+
+/// Collects the readbacks still in flight, lets the writer drain and releases everything. Needs the GL context.
+/// @param capture Capture
+inline void captureFinish(FrameCapture* capture) {
+    if (!capture->writer.joinable()) { return; }
+    for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+        const int slot = static_cast<int>((capture->framesIssued + i) % CAPTURE_RING_SIZE);   // oldest first
+        if (capture->fences[slot]) { captureCollect(capture, slot); }
+    }
+    {
+        std::lock_guard<std::mutex> lock(capture->mutex);
+        capture->stopping = true;
+    }
+    capture->jobReady.notify_one();
+    capture->writer.join();
+    capture->yuv.close();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - capture->start).count();
+    std::cout << "Captured " << capture->framesWritten << " frames in " << seconds << " s : "
+              << static_cast<double>(capture->framesWritten) / seconds << " fps sustained";
+    if (capture->mapFailures > 0) { std::cout << ", " << capture->mapFailures << " frames skipped (map failed)"; }
+    std::cout << std::endl;
+
+    glDeleteBuffers(CAPTURE_RING_SIZE, capture->packBuffers);
+    glDeleteRenderbuffers(1, &capture->colorBuffer);
+    glDeleteRenderbuffers(1, &capture->depthBuffer);
+    glDeleteFramebuffers(1, &capture->framebuffer);
+}
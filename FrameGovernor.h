@@ -0,0 +1,277 @@
+// Frame budget governor : watches smoothed CPU and GPU frame times against a target frame rate and walks a ladder of
+// quality levels. Resolution goes first (the scene is drawn into a SceneTarget and blitted up to the window), texture
+// LOD bias, shadow resolution and a larger light cutoff follow once the scene is already rendered at reduced size.
+// Each demo applies the knobs it has and ignores the rest.
+//
+//   governorOpenLog(&governor, "frame_governor.csv");
+//   each frame : profilerBeginFrame(&gpuProfiler); profilerPush(&gpuProfiler, "frame");
+//                governorRenderSize(&governor, windowWidth, windowHeight, &w, &h);
+//                draw into sceneTarget.framebuffer at w x h, sceneTargetBlit(&sceneTarget, w, h, windowWidth, windowHeight);
+//                profilerPop(&gpuProfiler); profilerEndFrame(&gpuProfiler);
+//                if (governorUpdate(&governor, cpuMs, governorGpuFrameMs(&gpuProfiler), time)) apply governorQuality(&governor)
+//
+// GPU time comes from the root "frame" scope of the demo's GpuProfiler (GpuProfiler.h), the same numbers its
+// per-pass scopes and report show.
+//
+// Dropping needs GOVERNOR_HOLD_FRAMES consecutive frames over budget, raising needs twice as many under
+// GOVERNOR_HEADROOM of it and a predicted cost at the higher level that still fits, so a level sitting right at the
+// budget does not flip back and forth. Frames that are CPU bound never lower the quality, it would not help.
+// Every decision plus a sample per second goes to the CSV log.
+
+#pragma once
+
+#include "glad/glad.h"
+#include "GpuProfiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/// Frame rates the governor can aim for, governorCycleTarget() steps through them
+constexpr float GOVERNOR_TARGET_FPS[4] = {30.0f, 60.0f, 120.0f, 240.0f};
+/// Weight of the newest sample in the smoothed CPU / GPU frame times
+constexpr float GOVERNOR_SMOOTHING = 0.1f;
+/// Quality is only raised again when the frame would still fit in this fraction of the budget
+constexpr float GOVERNOR_HEADROOM = 0.8f;
+/// Frames over budget before quality drops, raising waits twice as long
+constexpr int GOVERNOR_HOLD_FRAMES = 20;
+/// Frames to let the timings settle after a change before deciding again
+constexpr int GOVERNOR_COOLDOWN_FRAMES = 30;
+
+/// One rung of the quality ladder
+struct QualityLevel {
+    float renderScale;   // fraction of the window size the scene is rendered at, then upscaled
+    float lodBias;       // added to the texture's mip selection
+    float shadowScale;   // multiplies the shadow map size
+    float cutoffScale;   // multiplies the luminance cutoff, shortening light radii
+};
+
+const QualityLevel GOVERNOR_QUALITY_LEVELS[] = {
+    {1.00f, 0.0f, 1.00f, 1.0f},
+    {0.90f, 0.0f, 1.00f, 1.0f},
+    {0.80f, 0.0f, 0.50f, 1.0f},
+    {0.70f, 0.5f, 0.50f, 1.0f},
+    {0.60f, 0.5f, 0.50f, 2.0f},
+    {0.50f, 1.0f, 0.25f, 2.0f},
+    {0.50f, 1.5f, 0.25f, 4.0f},
+};
+constexpr int GOVERNOR_NUM_LEVELS = sizeof(GOVERNOR_QUALITY_LEVELS) / sizeof(GOVERNOR_QUALITY_LEVELS[0]);
+
+struct FrameGovernor {
+    bool enabled = true;
+    int targetFpsIndex = 1;
+    float targetMs = 1000.0f / GOVERNOR_TARGET_FPS[1];
+    int level = 0;
+    float cpuMs = 0.0f;   // smoothed
+    float gpuMs = 0.0f;   // smoothed
+
+    std::ofstream log;
+    bool primed = false;
+    int overFrames = 0;
+    int underFrames = 0;
+    int cooldown = 0;
+    float lastSampleTime = 0.0f;
+    const char* lastHoldReason = nullptr;
+};
+
+/// @param governor Governor
+/// @return Quality level in use
+inline const QualityLevel& governorQuality(const FrameGovernor* governor) {
+    return GOVERNOR_QUALITY_LEVELS[governor->level];
+}
+
+/// @param governor Governor
+/// @param path CSV file, truncated
+inline void governorOpenLog(FrameGovernor* governor, const char* path) {
+    governor->log.open(path);
+    if (!governor->log) {
+        std::cout << "Governor : cannot write " << path << ", decisions are only printed" << std::endl;
+        return;
+    }
+    governor->log << "time_s,cpu_ms,gpu_ms,target_ms,level,render_scale,lod_bias,shadow_scale,cutoff_scale,action,reason\n";
+}
+
+/// Logs the current state, prints it unless it is a periodic sample
+/// @param governor Governor
+/// @param time Seconds
+/// @param action What happened
+/// @param reason Why
+inline void governorRecord(FrameGovernor* governor, float time, const char* action, const char* reason) {
+    const QualityLevel& q = governorQuality(governor);
+    if (governor->log) {
+        governor->log << time << ',' << governor->cpuMs << ',' << governor->gpuMs << ',' << governor->targetMs << ','
+                      << governor->level << ',' << q.renderScale << ',' << q.lodBias << ',' << q.shadowScale << ','
+                      << q.cutoffScale << ',' << action << ',' << reason << '\n';
+    }
+    if (std::string(action) != "sample") {
+        std::cout << "Governor " << action << " (" << reason << ") : level " << governor->level << " | scale "
+                  << q.renderScale << " | lod bias " << q.lodBias << " | shadows x" << q.shadowScale << " | cpu "
+                  << governor->cpuMs << " ms | gpu " << governor->gpuMs << " ms | target " << governor->targetMs
+                  << " ms" << std::endl;
+    }
+}
+
+/// A hold is only logged when its reason differs from the previous one
+/// @param governor Governor
+/// @param time Seconds
+/// @param reason Why the level did not change
+inline void governorHold(FrameGovernor* governor, float time, const char* reason) {
+    if (reason == governor->lastHoldReason) { return; }
+    governor->lastHoldReason = reason;
+    governorRecord(governor, time, "hold", reason);
+}
+
+/// Feeds one frame's measurements
+/// @param governor Governor
+/// @param cpuSample CPU milliseconds of the frame
+/// @param gpuSample GPU milliseconds of a recent frame
+/// @param time Seconds
+/// @return True when the quality level changed
+inline bool governorUpdate(FrameGovernor* governor, float cpuSample, float gpuSample, float time) {
+    if (!governor->primed) {
+        governor->cpuMs = cpuSample;
+        governor->gpuMs = gpuSample;
+        governor->primed = true;
+    }
+    governor->cpuMs += (cpuSample - governor->cpuMs) * GOVERNOR_SMOOTHING;
+    governor->gpuMs += (gpuSample - governor->gpuMs) * GOVERNOR_SMOOTHING;
+
+    if (time - governor->lastSampleTime >= 1.0f) {
+        governorRecord(governor, time, "sample", "");
+        governor->lastSampleTime = time;
+    }
+    if (!governor->enabled) { return false; }
+    if (governor->cooldown > 0) { governor->cooldown--; return false; }
+
+    const float frameMs = std::max(governor->cpuMs, governor->gpuMs);
+    if (frameMs > governor->targetMs) { governor->overFrames++; governor->underFrames = 0; }
+    else if (frameMs < governor->targetMs * GOVERNOR_HEADROOM) { governor->underFrames++; governor->overFrames = 0; }
+    else { governor->overFrames = 0; governor->underFrames = 0; }
+
+    if (governor->overFrames >= GOVERNOR_HOLD_FRAMES) {
+        governor->overFrames = 0;
+        governor->cooldown = GOVERNOR_COOLDOWN_FRAMES;
+        if (governor->cpuMs > governor->gpuMs) { governorHold(governor, time, "cpu bound"); return false; }
+        if (governor->level == GOVERNOR_NUM_LEVELS - 1) { governorHold(governor, time, "lowest level"); return false; }
+        governor->level++;
+        governorRecord(governor, time, "lower", "over budget");
+        governor->lastHoldReason = nullptr;
+        return true;
+    }
+
+    if (governor->underFrames >= GOVERNOR_HOLD_FRAMES * 2 && governor->level > 0) {
+        governor->underFrames = 0;
+        governor->cooldown = GOVERNOR_COOLDOWN_FRAMES;
+        // GPU cost scales roughly with the pixel count
+        const float current = GOVERNOR_QUALITY_LEVELS[governor->level].renderScale;
+        const float next = GOVERNOR_QUALITY_LEVELS[governor->level - 1].renderScale;
+        const float predictedMs = governor->gpuMs * (next * next) / (current * current);
+        if (std::max(predictedMs, governor->cpuMs) >= governor->targetMs * GOVERNOR_HEADROOM) {
+            governorHold(governor, time, "higher level would not fit");
+            return false;
+        }
+        governor->level--;
+        governorRecord(governor, time, "raise", "under budget");
+        governor->lastHoldReason = nullptr;
+        return true;
+    }
+    return false;
+}
+
+/// Back to full quality, used when the governor is switched on or off
+/// @param governor Governor
+/// @param time Seconds
+inline void governorReset(FrameGovernor* governor, float time) {
+    governor->level = 0;
+    governor->overFrames = governor->underFrames = governor->cooldown = 0;
+    governor->lastHoldReason = nullptr;
+    governorRecord(governor, time, "reset", governor->enabled ? "enabled" : "disabled");
+}
+
+/// Aims for the next frame rate in GOVERNOR_TARGET_FPS
+/// @param governor Governor
+inline void governorCycleTarget(FrameGovernor* governor) {
+    governor->targetFpsIndex = (governor->targetFpsIndex + 1) % 4;
+    governor->targetMs = 1000.0f / GOVERNOR_TARGET_FPS[governor->targetFpsIndex];
+    std::cout << "Governor target " << GOVERNOR_TARGET_FPS[governor->targetFpsIndex] << " fps" << std::endl;
+}
+
+/// Size the scene is drawn at this frame
+/// @param governor Governor
+/// @param windowWidth Window width in pixels
+/// @param windowHeight Window height in pixels
+/// @param width Receives the render width
+/// @param height Receives the render height
+inline void governorRenderSize(const FrameGovernor* governor, int windowWidth, int windowHeight, int* width, int* height) {
+    const float scale = governorQuality(governor).renderScale;
+    *width = std::max(static_cast<int>(static_cast<float>(windowWidth) * scale), 1);
+    *height = std::max(static_cast<int>(static_cast<float>(windowHeight) * scale), 1);
+}
+
+// Offscreen scene target ---------------------------------------- (start)
+
+/// The scene is drawn into the lower-left renderScale part of a window sized framebuffer and blitted up to the
+/// window, so changing the scale never reallocates anything
+struct SceneTarget {
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+    int width = 0, height = 0;
+};
+
+/// @param target Target
+inline void sceneTargetRelease(SceneTarget* target) {
+    if (target->framebuffer == 0) { return; }
+    glDeleteFramebuffers(1, &target->framebuffer);
+    glDeleteRenderbuffers(1, &target->colorBuffer);
+    glDeleteRenderbuffers(1, &target->depthBuffer);
+    target->framebuffer = target->colorBuffer = target->depthBuffer = 0;
+}
+
+/// (Re)allocates the target at the window size
+/// @param target Target
+/// @param width Window width in pixels
+/// @param height Window height in pixels
+inline void sceneTargetResize(SceneTarget* target, int width, int height) {
+    sceneTargetRelease(target);
+    target->width = width;
+    target->height = height;
+    glGenRenderbuffers(1, &target->colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &target->depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &target->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target->colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Scene target incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/// Upscales the rendered part to the window and leaves the window framebuffer bound
+/// @param target Target
+/// @param renderWidth Width the scene was drawn at
+/// @param renderHeight Height the scene was drawn at
+/// @param windowWidth Window width in pixels
+/// @param windowHeight Window height in pixels
+inline void sceneTargetBlit(const SceneTarget* target, int renderWidth, int renderHeight, int windowWidth, int windowHeight) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target->framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT,
+                      renderWidth == windowWidth ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Offscreen scene target ---------------------------------------- (end)
+
+/// GPU milliseconds of the latest resolved frame, 0 until the profiler has resolved one
+/// @param profiler Profiler whose root scope is "frame"
+inline float governorGpuFrameMs(const GpuProfiler* profiler) {
+    const GpuScopeStats* frame = profilerFindStats(profiler, "frame");
+    return frame ? static_cast<float>(frame->lastMs) : 0.0f;
+}
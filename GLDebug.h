@@ -0,0 +1,164 @@
+// GL debug output : debug builds install a KHR_debug callback, so errors and driver performance warnings arrive with
+// the driver's own message on the call that caused them instead of as a bare enum from a per-frame glGetError, and
+// name GL objects so those messages (and GPU debuggers) say which program, VAO or texture they are about.
+// Performance warnings also land in the CPU trace when CpuProfiler.h is enabled.
+//
+// Defining NDEBUG compiles all of it away, the macros below expand to nothing and the frame loop polls nothing.
+//   GL_DEBUG_WINDOW_HINTS()                    before glfwCreateWindow, asks for a debug context
+//   GL_DEBUG_INIT()                            after the loader, installs the callback
+//   GL_DEBUG_LABEL(identifier, name, "label")  GL_PROGRAM, GL_VERTEX_ARRAY, GL_BUFFER or GL_TEXTURE
+//   GL_DEBUG_LABEL_TEXTURE(texture, path)      labels a texture with the file name of its asset
+//   GL_DEBUG_FRAME_CHECK()                     once per frame, only does work when KHR_debug is missing
+//
+// macOS stops at OpenGL 4.1 without KHR_debug. There the debug build falls back to one glGetError per frame.
+
+#pragma once
+
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include "CpuProfiler.h"
+
+#ifndef NDEBUG
+
+#include <cstring>
+#include <iostream>
+
+// The loader is generated for 4.1, KHR_debug (core in 4.3) is declared here and loaded by hand
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#define GL_DEBUG_SOURCE_API 0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM 0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER 0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY 0x8249
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+#define GL_DEBUG_TYPE_PORTABILITY 0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE 0x8250
+#define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#define GL_BUFFER 0x82E0
+#define GL_PROGRAM 0x82E2
+#define GL_VERTEX_ARRAY 0x8074
+#define GL_DEBUG_SEVERITY_HIGH 0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM 0x9147
+#define GL_DEBUG_OUTPUT 0x92E0
+#define GL_CONTEXT_FLAG_DEBUG_BIT 0x00000002
+
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECALLBACKPROC_KHR)(GLDEBUGPROC callback, const void* userParam);
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECONTROLPROC_KHR)(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint* ids, GLboolean enabled);
+typedef void (APIENTRYP PFNGLOBJECTLABELPROC_KHR)(GLenum identifier, GLuint name, GLsizei length, const GLchar* label);
+
+struct GLDebugState {
+    bool active = false;   // callback installed, no polling needed
+    PFNGLDEBUGMESSAGECALLBACKPROC_KHR messageCallback = nullptr;
+    PFNGLDEBUGMESSAGECONTROLPROC_KHR messageControl = nullptr;
+    PFNGLOBJECTLABELPROC_KHR objectLabel = nullptr;
+    unsigned long long errors = 0;
+    unsigned long long performanceWarnings = 0;
+};
+
+inline GLDebugState glDebug;
+
+/// Short name of a debug message enum, for the log line
+/// @param value GL_DEBUG_SOURCE_*, GL_DEBUG_TYPE_* or GL_DEBUG_SEVERITY_*
+/// @return Name
+inline const char* glDebugEnumName(GLenum value) {
+    switch (value) {
+        case GL_DEBUG_SOURCE_API: return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "application";
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        case GL_DEBUG_SEVERITY_HIGH: return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+        default: return "other";
+    }
+}
+
+/// Receives every message the driver raises. Runs on the thread of the GL call (synchronous output).
+inline void APIENTRY glDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei, const GLchar* message, const void*) {
+    if (type == GL_DEBUG_TYPE_ERROR) {
+        glDebug.errors++;
+        CPU_PROFILE_INSTANT("GL error");
+    } else if (type == GL_DEBUG_TYPE_PERFORMANCE) {
+        glDebug.performanceWarnings++;
+        CPU_PROFILE_INSTANT("GL performance warning");
+    }
+    std::ostream& out = (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH) ? std::cerr : std::cout;
+    out << "GL " << glDebugEnumName(type) << " (" << glDebugEnumName(severity) << ", " << glDebugEnumName(source)
+        << ", id " << id << ") : " << message << std::endl;
+}
+
+/// Asks GLFW for a debug context, call before glfwCreateWindow
+inline void glDebugWindowHints() {
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+}
+
+/// Installs the callback when the context has KHR_debug, call after the loader
+inline void glDebugInit() {
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    const bool supported = glfwExtensionSupported("GL_KHR_debug") || (GLVersion.major == 4 && GLVersion.minor >= 3) || GLVersion.major > 4;
+    if (!supported || !(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+        std::cout << "GL debug output unavailable, checking glGetError once per frame" << std::endl;
+        return;
+    }
+    glDebug.messageCallback = reinterpret_cast<PFNGLDEBUGMESSAGECALLBACKPROC_KHR>(glfwGetProcAddress("glDebugMessageCallback"));
+    glDebug.messageControl = reinterpret_cast<PFNGLDEBUGMESSAGECONTROLPROC_KHR>(glfwGetProcAddress("glDebugMessageControl"));
+    glDebug.objectLabel = reinterpret_cast<PFNGLOBJECTLABELPROC_KHR>(glfwGetProcAddress("glObjectLabel"));
+    if (!glDebug.messageCallback || !glDebug.messageControl) { return; }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    // Report on the offending call so the CPU trace and a debugger's call stack point at it
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebug.messageCallback(glDebugMessage, nullptr);
+    // Notifications are chatty (buffer placement and the like)
+    glDebug.messageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    glDebug.active = true;
+}
+
+/// Names a GL object
+/// @param identifier GL_PROGRAM, GL_VERTEX_ARRAY, GL_BUFFER or GL_TEXTURE
+/// @param name Object
+/// @param label Name to show
+inline void glDebugLabel(GLenum identifier, GLuint name, const char* label) {
+    if (glDebug.objectLabel) { glDebug.objectLabel(identifier, name, -1, label); }
+}
+
+/// Names a texture after the file it was loaded from
+/// @param texture Texture
+/// @param path Asset path
+inline void glDebugLabelTexture(GLuint texture, const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    glDebugLabel(GL_TEXTURE, texture, slash ? slash + 1 : path);
+}
+
+/// Fallback for contexts without KHR_debug, drains the error queue once per frame
+inline void glDebugFrameCheck() {
+    if (glDebug.active) { return; }
+    for (GLenum err = glGetError(); err != GL_NO_ERROR; err = glGetError()) {
+        glDebug.errors++;
+        std::cerr << "OpenGL error: 0x" << std::hex << err << std::dec << std::endl;
+    }
+}
+
+#define GL_DEBUG_WINDOW_HINTS() glDebugWindowHints()
+#define GL_DEBUG_INIT() glDebugInit()
+#define GL_DEBUG_LABEL(identifier, name, label) glDebugLabel(identifier, name, label)
+#define GL_DEBUG_LABEL_TEXTURE(texture, path) glDebugLabelTexture(texture, path)
+#define GL_DEBUG_FRAME_CHECK() glDebugFrameCheck()
+
+#else
+
+#define GL_DEBUG_WINDOW_HINTS() ((void)0)
+#define GL_DEBUG_INIT() ((void)0)
+#define GL_DEBUG_LABEL(identifier, name, label) ((void)0)
+#define GL_DEBUG_LABEL_TEXTURE(texture, path) ((void)0)
+#define GL_DEBUG_FRAME_CHECK() ((void)0)
+
+#endif
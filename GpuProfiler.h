@@ -0,0 +1,299 @@
+// GPU profiler : nested scopes timed with GL_TIMESTAMP query pairs and read back PROFILER_FRAMES frames later,
+// so timing never stalls the pipeline. A frame whose results are still not ready is skipped and counted.
+//
+//   GpuProfiler profiler;
+//   profilerInit(&profiler);
+//   ...
+//   profilerBeginFrame(&profiler);
+//   {
+//       GpuScope frameScope(&profiler, "frame");
+//       { GpuScope shadowScope(&profiler, "shadows"); drawShadows(); }
+//   }
+//   profilerEndFrame(&profiler);
+//   ...
+//   profilerPrintStats(&profiler);   // or read profiler.stats directly
+//   profilerDestroy(&profiler);
+//
+// Scope names are stored as pointers and must be string literals.
+
+#pragma once
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// Frames a scope's queries stay in flight before they are read. Results are PROFILER_FRAMES - 1 frames old when
+/// read, which is long enough that reading never waits on the GPU.
+constexpr int PROFILER_FRAMES = 3;
+constexpr int PROFILER_MAX_SCOPES = 32;
+constexpr int PROFILER_MAX_DEPTH = 8;
+/// Resolved scope samples kept for the CSV export (a few hundred frames)
+constexpr size_t PROFILER_HISTORY_SAMPLES = 4096;
+/// Weight of the newest sample in a scope's rolling average
+constexpr double PROFILER_SMOOTHING = 0.05;
+
+/// One scope issued in one frame : two timestamp queries, so scopes can nest (GL_TIME_ELAPSED queries cannot)
+struct GpuScopeRecord {
+    const char* name;
+    int depth;
+    GLuint beginQuery;
+    GLuint endQuery;
+};
+
+/// Everything one frame issued, waiting to be resolved
+struct GpuProfilerFrame {
+    GpuScopeRecord scopes[PROFILER_MAX_SCOPES];
+    int count = 0;
+    GLuint lastQuery = 0;   // issued last, so it is also the last to finish
+    unsigned long long frameNumber = 0;
+    bool pending = false;
+};
+
+/// Rolling statistics of one scope, keyed by its path ("frame/post/bloom")
+struct GpuScopeStats {
+    std::string path;
+    int depth = 0;
+    double lastMs = 0.0;
+    double averageMs = 0.0;
+    double windowMinMs = 0.0;   // since the last report
+    double windowMaxMs = 0.0;
+    double totalMs = 0.0;       // whole run, for the export
+    unsigned long long samples = 0;
+    unsigned long long windowSamples = 0;
+    unsigned long long lastFrame = 0;
+};
+
+/// One resolved scope of one frame, for the CSV export
+struct GpuScopeSample {
+    unsigned long long frame;
+    int statIndex;
+    float ms;
+};
+
+struct GpuProfiler {
+    GLuint queries[PROFILER_FRAMES][PROFILER_MAX_SCOPES * 2];
+    GpuProfilerFrame frames[PROFILER_FRAMES];
+    int slot = 0;
+    unsigned long long frameNumber = 0;
+
+    // Open scopes of the frame being recorded, -1 for scopes past PROFILER_MAX_SCOPES (not timed)
+    int stack[PROFILER_MAX_DEPTH];
+    int depth = 0;
+    int ignoredDepth = 0;   // scopes opened past PROFILER_MAX_DEPTH
+
+    std::vector<GpuScopeStats> stats;
+    std::vector<GpuScopeSample> history;
+    size_t historyNext = 0;
+    unsigned long long droppedFrames = 0;   // results not ready after PROFILER_FRAMES, skipped instead of waiting
+};
+
+/// Creates the query pool
+/// @param profiler Profiler
+inline void profilerInit(GpuProfiler* profiler) {
+    for (int i = 0; i < PROFILER_FRAMES; i++) {
+        glGenQueries(PROFILER_MAX_SCOPES * 2, profiler->queries[i]);
+    }
+    profiler->history.reserve(PROFILER_HISTORY_SAMPLES);
+}
+
+/// Releases the query pool
+/// @param profiler Profiler
+inline void profilerDestroy(GpuProfiler* profiler) {
+    for (int i = 0; i < PROFILER_FRAMES; i++) {
+        glDeleteQueries(PROFILER_MAX_SCOPES * 2, profiler->queries[i]);
+    }
+}
+
+/// Finds or adds the statistics entry of a scope path
+/// @param profiler Profiler
+/// @param path Scope path
+/// @param depth Nesting depth
+/// @return Index into profiler->stats
+inline int profilerStatIndex(GpuProfiler* profiler, const std::string& path, int depth) {
+    for (size_t i = 0; i < profiler->stats.size(); i++) {
+        if (profiler->stats[i].path == path) { return static_cast<int>(i); }
+    }
+    GpuScopeStats entry;
+    entry.path = path;
+    entry.depth = depth;
+    profiler->stats.push_back(entry);
+    return static_cast<int>(profiler->stats.size()) - 1;
+}
+
+/// Reads back a finished frame into the statistics
+/// @param profiler Profiler
+/// @param frame Frame to resolve
+inline void profilerResolve(GpuProfiler* profiler, GpuProfilerFrame* frame) {
+    frame->pending = false;
+    if (frame->count == 0) { return; }
+
+    // If the last query is not ready the GPU is more than PROFILER_FRAMES behind
+    GLint available = 0;
+    glGetQueryObjectiv(frame->lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        profiler->droppedFrames++;
+        return;
+    }
+
+    // Paths are rebuilt from the depth sequence, parents always precede their children
+    std::string names[PROFILER_MAX_DEPTH];
+    for (int i = 0; i < frame->count; i++) {
+        const GpuScopeRecord& scope = frame->scopes[i];
+        names[scope.depth] = scope.name;
+        std::string path = names[0];
+        for (int d = 1; d <= scope.depth; d++) { path += "/" + names[d]; }
+
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(scope.beginQuery, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &end);
+        const double ms = static_cast<double>(end - begin) / 1.0e6;
+
+        const int index = profilerStatIndex(profiler, path, scope.depth);
+        GpuScopeStats& stat = profiler->stats[index];
+        stat.averageMs = stat.samples == 0 ? ms : stat.averageMs + (ms - stat.averageMs) * PROFILER_SMOOTHING;
+        stat.windowMinMs = stat.windowSamples == 0 ? ms : std::min(stat.windowMinMs, ms);
+        stat.windowMaxMs = stat.windowSamples == 0 ? ms : std::max(stat.windowMaxMs, ms);
+        stat.lastMs = ms;
+        stat.totalMs += ms;
+        stat.samples++;
+        stat.windowSamples++;
+        stat.lastFrame = frame->frameNumber;
+
+        const GpuScopeSample sample = {frame->frameNumber, index, static_cast<float>(ms)};
+        if (profiler->history.size() < PROFILER_HISTORY_SAMPLES) {
+            profiler->history.push_back(sample);
+        } else {
+            profiler->history[profiler->historyNext] = sample;
+            profiler->historyNext = (profiler->historyNext + 1) % profiler->history.size();
+        }
+    }
+}
+
+/// Starts recording a frame into the oldest slot, resolving what that slot held first
+/// @param profiler Profiler
+inline void profilerBeginFrame(GpuProfiler* profiler) {
+    profiler->slot = static_cast<int>(profiler->frameNumber % PROFILER_FRAMES);
+    GpuProfilerFrame* frame = &profiler->frames[profiler->slot];
+    if (frame->pending) { profilerResolve(profiler, frame); }
+    frame->count = 0;
+    frame->frameNumber = profiler->frameNumber;
+    profiler->depth = 0;
+    profiler->ignoredDepth = 0;
+}
+
+/// Timestamps the start of a scope. Scopes past PROFILER_MAX_SCOPES or PROFILER_MAX_DEPTH are not timed.
+/// @param profiler Profiler
+/// @param name Scope name, must outlive the frame (string literal)
+inline void profilerPush(GpuProfiler* profiler, const char* name) {
+    if (profiler->depth == PROFILER_MAX_DEPTH) {
+        profiler->ignoredDepth++;
+        return;
+    }
+    GpuProfilerFrame* frame = &profiler->frames[profiler->slot];
+    int index = -1;
+    if (frame->count < PROFILER_MAX_SCOPES) {
+        index = frame->count++;
+        GpuScopeRecord& scope = frame->scopes[index];
+        scope.name = name;
+        scope.depth = profiler->depth;
+        scope.beginQuery = profiler->queries[profiler->slot][index * 2];
+        scope.endQuery = profiler->queries[profiler->slot][index * 2 + 1];
+        glQueryCounter(scope.beginQuery, GL_TIMESTAMP);
+        frame->lastQuery = scope.beginQuery;
+    }
+    profiler->stack[profiler->depth++] = index;
+}
+
+/// Timestamps the end of the innermost open scope
+/// @param profiler Profiler
+inline void profilerPop(GpuProfiler* profiler) {
+    if (profiler->ignoredDepth > 0) {
+        profiler->ignoredDepth--;
+        return;
+    }
+    if (profiler->depth == 0) { return; }
+    const int index = profiler->stack[--profiler->depth];
+    if (index >= 0) {
+        GpuProfilerFrame* frame = &profiler->frames[profiler->slot];
+        glQueryCounter(frame->scopes[index].endQuery, GL_TIMESTAMP);
+        frame->lastQuery = frame->scopes[index].endQuery;
+    }
+}
+
+/// Finishes recording the current frame
+/// @param profiler Profiler
+inline void profilerEndFrame(GpuProfiler* profiler) {
+    // Scopes left open would leave end queries that never get issued
+    if (profiler->depth != 0) {
+        std::cout << "GPU profiler : " << profiler->depth << " scopes still open at end of frame" << std::endl;
+        while (profiler->depth > 0) { profilerPop(profiler); }
+    }
+    profiler->frames[profiler->slot].pending = true;
+    profiler->frameNumber++;
+}
+
+/// Times everything issued while it is alive
+struct GpuScope {
+    GpuProfiler* profiler;
+    GpuScope(GpuProfiler* p, const char* name) : profiler(p) { profilerPush(profiler, name); }
+    ~GpuScope() { profilerPop(profiler); }
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+};
+
+/// Finds the statistics of a scope path
+/// @param profiler Profiler
+/// @param path Scope path ("frame/shadows")
+/// @return Statistics, nullptr until the scope has been resolved once
+inline const GpuScopeStats* profilerFindStats(const GpuProfiler* profiler, const char* path) {
+    for (const auto& stat : profiler->stats) {
+        if (stat.path == path) { return &stat; }
+    }
+    return nullptr;
+}
+
+/// Prints every scope seen since the last report, indented by depth, and starts a new window
+/// @param profiler Profiler
+inline void profilerPrintStats(GpuProfiler* profiler) {
+    std::cout << "GPU profile (avg / min / max ms)";
+    if (profiler->droppedFrames > 0) { std::cout << ", " << profiler->droppedFrames << " frames not ready and skipped"; }
+    std::cout << std::endl;
+    for (auto& stat : profiler->stats) {
+        if (stat.windowSamples == 0) { continue; }
+        std::cout << "  " << std::string(stat.depth * 2, ' ') << stat.path.substr(stat.path.find_last_of('/') + 1)
+                  << " : " << stat.averageMs << " / " << stat.windowMinMs << " / " << stat.windowMaxMs << std::endl;
+        stat.windowSamples = 0;
+    }
+}
+
+/// Writes the per-frame history as CSV and the per-scope summary as JSON
+/// @param profiler Profiler
+/// @param csvPath CSV file path
+/// @param jsonPath JSON file path
+inline void profilerExport(const GpuProfiler* profiler, const char* csvPath, const char* jsonPath) {
+    std::ofstream csv(csvPath);
+    csv << "frame,scope,depth,ms\n";
+    const size_t count = profiler->history.size();
+    for (size_t i = 0; i < count; i++) {
+        // Oldest first once the ring has wrapped
+        const GpuScopeSample& sample = profiler->history[(profiler->historyNext + i) % count];
+        const GpuScopeStats& stat = profiler->stats[sample.statIndex];
+        csv << sample.frame << ',' << stat.path << ',' << stat.depth << ',' << sample.ms << '\n';
+    }
+
+    std::ofstream json(jsonPath);
+    json << "{\n  \"frames\": " << profiler->frameNumber << ",\n  \"droppedFrames\": " << profiler->droppedFrames << ",\n  \"scopes\": [\n";
+    for (size_t i = 0; i < profiler->stats.size(); i++) {
+        const GpuScopeStats& stat = profiler->stats[i];
+        json << "    {\"path\": \"" << stat.path << "\", \"depth\": " << stat.depth << ", \"samples\": " << stat.samples
+             << ", \"meanMs\": " << (stat.samples ? stat.totalMs / static_cast<double>(stat.samples) : 0.0)
+             << ", \"rollingMs\": " << stat.averageMs << ", \"lastMs\": " << stat.lastMs << "}"
+             << (i + 1 < profiler->stats.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+    std::cout << "GPU profile written to " << csvPath << " and " << jsonPath << std::endl;
+}
@@ -0,0 +1,1255 @@
+// HDR post processing : the LightWithAttenuation scene rendered into an R11G11B10F target instead of straight into
+// the 8-bit backbuffer, so the 2.0 specular and the bright light cube keep their values above 1.0.
+// The post stack after it :
+//  - dual filter bloom, thresholded downsample to half then quarter resolution and one upsample back to half
+//  - auto exposure, a 64 bin log-luminance histogram built by parallel reduction (rows, then columns) and a
+//    1x1 pass that averages the middle of the histogram and adapts over time, all on the GPU with no readback
+//  - tonemap and resolve, ACES fit and gamma into the default framebuffer
+// Every pass is timed by nested GPU profiler scopes (frame > opaque, sky, post > bloom, exposure, tonemap) read back
+// PROFILER_FRAMES later so timing never stalls the pipeline. Averages are printed every 2 s, drawn as bars in the
+// overlay and exported to gpu_profile.csv / gpu_profile.json on P and on exit.
+//
+// B toggles bloom, E toggles auto exposure, T toggles tonemapping (off = the old clipped output)
+// O toggles the profiler overlay, P exports the profile
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <glm/detail/setup.hpp>
+#include <glm/glm.hpp>
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include "GpuProfiler.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include <glm/gtc/type_ptr.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+using namespace std;
+using namespace glm;
+
+/// Shader helpers : ---- (start)
+int success;
+char infoLog[512];
+
+/// This function will create shaders
+/// @param type Shader type
+/// @param source shader source
+/// @return shader ID
+GLuint compileShader(GLenum type, const GLchar* source) {
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        cout << "Error compiling shader: " << infoLog << endl;
+        return 0;
+    }
+    return shader;
+}
+/// This function will create shader program
+/// @param vertexSource vertex shader source
+/// @param fragmentSource fragment shader source
+/// @return program ID
+GLuint createProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint program = glCreateProgram();
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        cout << "Error linking program: " << infoLog << endl;
+    }
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return  program;
+}
+/// Shader helpers : ---- (end)
+
+/// Camera Structure consisting imp camera properties
+struct Camera {
+    vec3 Position;
+    vec3 Front;
+    vec3 Up;
+    vec3 Right;
+    vec3 WorldUp;
+    float Yaw;
+    float Pitch;
+    float MovementSpeed;
+    float MouseSensitivity;
+    float Zoom;
+};
+
+/// Directions camera will move in
+enum Direction {
+    forwardDir,
+    backwardDir,
+    leftDir,
+    rightDir
+};
+
+/// This function will updates camera vectors
+/// @param camera Camera object.
+void cameraUpdateVectors(Camera* camera) {
+    vec3 front;
+    front.x = cos(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    front.y = sin(radians(camera->Pitch));
+    front.z = sin(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    camera->Front = normalize(front);
+    camera->Right = normalize(cross(camera->Front, camera->WorldUp));
+    camera->Up = normalize(cross(camera->Right, camera->Front));
+}
+
+/// This function will initiate camera
+void cameraInit(Camera* camera, glm::vec3 position, glm::vec3 up, float yaw, float pitch, float movementSpeed, float mouseSensitivity, float zoom) {
+    camera->Position = position;
+    camera->WorldUp = up;
+    camera->Yaw = yaw;
+    camera->Pitch = pitch;
+    camera->MovementSpeed = movementSpeed;
+    camera->MouseSensitivity = mouseSensitivity;
+    camera->Zoom = zoom;
+    cameraUpdateVectors(camera);
+}
+
+/// Returns view matrix according to current camera vectors
+mat4 getCameraViewMatrix(Camera* camera) {
+    return lookAt(camera->Position, camera->Position + camera->Front, camera->Up);
+}
+
+/// Function to process camera inputs
+void cameraProcessKeyboard(Camera* camera, Direction direction, float deltaTime) {
+    float Speed = camera->MovementSpeed * deltaTime;
+    if (direction == forwardDir) {
+        camera->Position += camera->Front * Speed;
+    }
+    else if (direction == backwardDir) {
+        camera->Position -= camera->Front * Speed;
+    }
+    else if (direction == leftDir) {
+        camera->Position -= camera->Right * Speed;
+    }
+    else if (direction == rightDir) {
+        camera->Position += camera->Right * Speed;
+    }
+}
+
+/// Function to process mouse movement
+void cameraProcessMouseMovement(Camera* camera, float xoffset, float yoffset) {
+    xoffset *= camera->MouseSensitivity;
+    yoffset *= camera->MouseSensitivity;
+    camera->Yaw += xoffset;
+    camera->Pitch += yoffset;
+    camera->Pitch = glm::clamp(camera->Pitch, -89.f, 89.f);
+    cameraUpdateVectors(camera);
+}
+
+/// Function to process scroll movements
+void cameraProcessMouseScroll(Camera* camera, float Zoom) {
+    camera->Zoom -= Zoom;
+    if (camera->Zoom <= 1.0f) {camera->Zoom = 1.0f;}
+    else if (camera->Zoom >= 45.0f) {camera->Zoom = 45.0f;}
+}
+
+
+/// Shader to render objects in environment with attenuation ---- (start)
+const char* cubeObjectVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+const char* cubeObjectFragmentShader = R"(
+#version 410 core
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct Light {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform Light light;
+
+void main()
+{
+    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(light.position - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), material.shininess);
+    vec3 specularMap = vec3(texture(material.specular, TexCoords));
+    vec3 specular = light.specular * spec * specularMap;
+
+    float distance = length(light.position - FragPos);
+    float attenuation = 1.0 / (
+        light.constant + (light.linear * distance) + (light.quadratic * distance * distance)
+    );
+
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+
+    vec3 result = ambient + diffuse + specular;
+    FragColor = vec4(result, 1.0);
+}
+)";
+/// Shader to render objects in environment with attenuation ---- (end)
+
+/// Shader to render a cube map -------- (start)
+const char* cubeMapVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+out vec3 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    TexCoord = aPos;
+    mat4 rotView = mat4(mat3(view));
+    vec4 pos = projection * rotView * vec4(aPos, 1.0);
+    gl_Position = pos.xyww;
+}
+)";
+
+const char* cubeMapFragmentShader = R"(
+#version 410 core
+in vec3 TexCoord;
+out vec4 FragColor;
+uniform samplerCube skybox;
+
+void main()
+{
+    FragColor = texture(skybox, TexCoord);
+}
+)";
+/// Shader to render a cube map -------- (end)
+
+/// Shader to render a light cube ------ (start)
+const char* lightCubeVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)";
+
+const char* lightCubeFragmentShader = R"(
+#version 410 core
+out vec4 FragColor;
+uniform vec3 lightColor;
+void main()
+{
+    FragColor = vec4(lightColor, 1.0);
+}
+)";
+/// Shader to render a light cube ------ (end)
+
+/// Full screen post passes ------ (start)
+// One triangle covering the screen, no vertex buffer needed
+const char* fullScreenVertexShader = R"(
+#version 410 core
+out vec2 uv;
+void main()
+{
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Dual filter downsample : centre tap plus four diagonal taps half a source texel out.
+// The first level also applies a soft-knee threshold so only the HDR part of the image blooms.
+const char* bloomDownFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D source;
+uniform int prefilter;
+uniform float threshold;
+uniform float knee;
+void main()
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(source, 0));
+    vec3 sum = texture(source, uv).rgb * 4.0;
+    sum += texture(source, uv - halfTexel).rgb;
+    sum += texture(source, uv + halfTexel).rgb;
+    sum += texture(source, uv + vec2(halfTexel.x, -halfTexel.y)).rgb;
+    sum += texture(source, uv - vec2(halfTexel.x, -halfTexel.y)).rgb;
+    vec3 color = sum / 8.0;
+
+    if (prefilter == 1) {
+        float brightness = max(color.r, max(color.g, color.b));
+        float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+        soft = soft * soft / (4.0 * knee + 0.0001);
+        color *= max(soft, brightness - threshold) / max(brightness, 0.0001);
+    }
+    FragColor = vec4(color, 1.0);
+}
+)";
+
+// Dual filter upsample : eight taps on a tent around the lower level, averaged with the level it lands on
+const char* bloomUpFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D source;
+uniform sampler2D base;
+void main()
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(source, 0));
+    vec3 sum = texture(source, uv + vec2(-halfTexel.x * 2.0, 0.0)).rgb;
+    sum += texture(source, uv + vec2( halfTexel.x * 2.0, 0.0)).rgb;
+    sum += texture(source, uv + vec2(0.0, -halfTexel.y * 2.0)).rgb;
+    sum += texture(source, uv + vec2(0.0,  halfTexel.y * 2.0)).rgb;
+    sum += texture(source, uv + vec2(-halfTexel.x,  halfTexel.y)).rgb * 2.0;
+    sum += texture(source, uv + vec2( halfTexel.x,  halfTexel.y)).rgb * 2.0;
+    sum += texture(source, uv + vec2( halfTexel.x, -halfTexel.y)).rgb * 2.0;
+    sum += texture(source, uv + vec2(-halfTexel.x, -halfTexel.y)).rgb * 2.0;
+    FragColor = vec4((sum / 12.0 + texture(base, uv).rgb) * 0.5, 1.0);
+}
+)";
+
+// Scene luminance on a small grid, stored as 0..1 across the histogram's log range, -1 for pixels too dark to count
+const char* luminanceFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D sceneColor;
+uniform float minLogLuminance;
+uniform float logLuminanceRange;
+uniform float gridSize;
+void main()
+{
+    // Four taps spread over the block of scene pixels this texel stands for
+    vec2 quarter = vec2(0.25 / gridSize);
+    const vec3 weights = vec3(0.2126, 0.7152, 0.0722);
+    float lum = dot(texture(sceneColor, uv + vec2(-quarter.x, -quarter.y)).rgb, weights);
+    lum += dot(texture(sceneColor, uv + vec2( quarter.x, -quarter.y)).rgb, weights);
+    lum += dot(texture(sceneColor, uv + vec2(-quarter.x,  quarter.y)).rgb, weights);
+    lum += dot(texture(sceneColor, uv + vec2( quarter.x,  quarter.y)).rgb, weights);
+    lum *= 0.25;
+    float encoded = lum < 0.0001 ? -1.0 : clamp((log2(lum) - minLogLuminance) / logLuminanceRange, 0.0, 1.0);
+    FragColor = vec4(encoded, 0.0, 0.0, 1.0);
+}
+)";
+
+// Reduction step 1 : fragment (bin, row) counts the texels of one luminance row that fall into its bin
+const char* histogramRowsFragmentShader = R"(
+#version 410 core
+out vec4 FragColor;
+uniform sampler2D logLuminance;
+uniform int binCount;
+void main()
+{
+    int bin = int(gl_FragCoord.x);
+    int row = int(gl_FragCoord.y);
+    int width = textureSize(logLuminance, 0).x;
+    float count = 0.0;
+    for (int x = 0; x < width; x++) {
+        float v = texelFetch(logLuminance, ivec2(x, row), 0).r;
+        if (v >= 0.0 && min(int(v * float(binCount)), binCount - 1) == bin) count += 1.0;
+    }
+    FragColor = vec4(count, 0.0, 0.0, 1.0);
+}
+)";
+
+// Reduction step 2 : fragment (bin, 0) sums its bin over all rows
+const char* histogramColumnsFragmentShader = R"(
+#version 410 core
+out vec4 FragColor;
+uniform sampler2D rowHistogram;
+void main()
+{
+    int bin = int(gl_FragCoord.x);
+    int rows = textureSize(rowHistogram, 0).y;
+    float count = 0.0;
+    for (int y = 0; y < rows; y++) count += texelFetch(rowHistogram, ivec2(bin, y), 0).r;
+    FragColor = vec4(count, 0.0, 0.0, 1.0);
+}
+)";
+
+// Average log luminance of the histogram between the low and high percentiles (drops black pixels and highlights),
+// then moves last frame's adapted luminance towards it.
+const char* exposureFragmentShader = R"(
+#version 410 core
+out vec4 FragColor;
+uniform sampler2D histogram;
+uniform sampler2D previousLuminance;
+uniform float minLogLuminance;
+uniform float logLuminanceRange;
+uniform float lowPercent;
+uniform float highPercent;
+uniform float adaptRate;
+void main()
+{
+    int bins = textureSize(histogram, 0).x;
+    float total = 0.0;
+    for (int i = 0; i < bins; i++) total += texelFetch(histogram, ivec2(i, 0), 0).r;
+
+    float low = total * lowPercent;
+    float high = total * highPercent;
+    float seen = 0.0, weighted = 0.0, counted = 0.0;
+    for (int i = 0; i < bins; i++) {
+        float count = texelFetch(histogram, ivec2(i, 0), 0).r;
+        float inside = max(min(seen + count, high) - max(seen, low), 0.0);
+        weighted += inside * ((float(i) + 0.5) / float(bins) * logLuminanceRange + minLogLuminance);
+        counted += inside;
+        seen += count;
+    }
+
+    float previous = texelFetch(previousLuminance, ivec2(0, 0), 0).r;
+    float target = counted > 0.0 ? exp2(weighted / counted) : previous;
+    FragColor = vec4(previous + (target - previous) * adaptRate, 0.0, 0.0, 1.0);
+}
+)";
+
+// Resolve into the 8-bit backbuffer
+const char* tonemapFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D sceneColor;
+uniform sampler2D bloom;
+uniform sampler2D adaptedLuminance;
+uniform int useBloom;
+uniform int useAutoExposure;
+uniform int useTonemap;
+uniform float bloomStrength;
+uniform float exposureKey;
+
+// Narkowicz's fit of the ACES filmic curve
+vec3 acesFitted(vec3 x)
+{
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main()
+{
+    vec3 color = texture(sceneColor, uv).rgb;
+    if (useBloom == 1) color += texture(bloom, uv).rgb * bloomStrength;
+    if (useAutoExposure == 1) color *= exposureKey / max(texelFetch(adaptedLuminance, ivec2(0, 0), 0).r, 0.0001);
+
+    if (useTonemap == 1) {
+        color = pow(acesFitted(color), vec3(1.0 / 2.2));
+    } else {
+        color = clamp(color, 0.0, 1.0);
+    }
+    FragColor = vec4(color, 1.0);
+}
+)";
+/// Full screen post passes ------ (end)
+
+/// Post targets ---------- (start)
+/// One color texture with its framebuffer, optionally with a depth renderbuffer
+struct RenderTarget {
+    GLuint framebuffer = 0;
+    GLuint texture = 0;
+    GLuint depth = 0;
+    int width = 0;
+    int height = 0;
+};
+
+/// Creates a render target
+/// @param target Target to fill
+/// @param width Width in pixels
+/// @param height Height in pixels
+/// @param internalFormat GL_R11F_G11F_B10F, GL_R32F ...
+/// @param filter GL_LINEAR for targets sampled while resampling, GL_NEAREST for data read with texelFetch
+/// @param withDepth Attach a depth renderbuffer
+/// @param initial Optional texel data (GL_RED floats), used to seed the adapted luminance
+void createRenderTarget(RenderTarget* target, int width, int height, GLenum internalFormat, GLint filter, bool withDepth, const float* initial = nullptr) {
+    target->width = width;
+    target->height = height;
+
+    glGenTextures(1, &target->texture);
+    glBindTexture(GL_TEXTURE_2D, target->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, initial ? GL_RED : GL_RGB, GL_FLOAT, initial);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &target->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->texture, 0);
+
+    if (withDepth) {
+        glGenRenderbuffers(1, &target->depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, target->depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depth);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Render target " << width << "x" << height << " incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/// Releases a render target
+/// @param target Target to release
+void destroyRenderTarget(RenderTarget* target) {
+    glDeleteFramebuffers(1, &target->framebuffer);
+    glDeleteTextures(1, &target->texture);
+    if (target->depth) { glDeleteRenderbuffers(1, &target->depth); }
+    *target = RenderTarget();
+}
+
+/// Binds a target for drawing with a viewport covering it
+/// @param target Target to draw into
+void bindRenderTarget(const RenderTarget* target) {
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    glViewport(0, 0, target->width, target->height);
+}
+/// Post targets ---------- (end)
+
+/// Profiler overlay ---------- (start)
+// One bar per scope, top-left of the screen, indented by depth and as long as its rolling average.
+// The white tick marks the frame budget. Bar colours follow the order of the console report.
+const char* overlayVertexShader = R"(
+#version 410 core
+uniform vec4 rect;   // x, y, width, height in normalized device coordinates
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = vec4(rect.xy + corner * rect.zw, 0.0, 1.0);
+}
+)";
+
+const char* overlayFragmentShader = R"(
+#version 410 core
+out vec4 FragColor;
+uniform vec4 color;
+void main()
+{
+    FragColor = color;
+}
+)";
+
+/// Draws the overlay into the current framebuffer
+/// @param profiler Profiler
+/// @param program Overlay program
+/// @param rectLocation "rect" uniform location
+/// @param colorLocation "color" uniform location
+/// @param budgetMs Frame time the full bar width stands for
+void profilerDrawOverlay(const GpuProfiler* profiler, GLuint program, GLint rectLocation, GLint colorLocation, float budgetMs) {
+    const float left = -0.98f, top = 0.95f, barHeight = 0.03f, gap = 0.01f, fullWidth = 0.8f, indent = 0.03f;
+    glUseProgram(program);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    int row = 0;
+    for (size_t i = 0; i < profiler->stats.size(); i++) {
+        const GpuScopeStats& stat = profiler->stats[i];
+        // Scopes not issued for a while (toggled off) disappear
+        if (stat.lastFrame + PROFILER_FRAMES * 2 < profiler->frameNumber) { continue; }
+        const float y = top - static_cast<float>(row) * (barHeight + gap);
+        const float x = left + static_cast<float>(stat.depth) * indent;
+        const float width = std::min(static_cast<float>(stat.averageMs) / budgetMs, 1.5f) * fullWidth;
+        // Golden ratio hue steps keep neighbouring bars apart
+        const float hue = static_cast<float>(i) * 0.618034f;
+        float color[3];
+        for (int c = 0; c < 3; c++) {
+            const float h = hue + static_cast<float>(3 - c) / 3.0f;
+            color[c] = std::min(std::max(std::fabs((h - std::floor(h)) * 6.0f - 3.0f) - 1.0f, 0.0f), 1.0f);
+        }
+
+        glUniform4f(rectLocation, x, y - barHeight, fullWidth, barHeight);
+        glUniform4f(colorLocation, 0.0f, 0.0f, 0.0f, 0.5f);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glUniform4f(rectLocation, x, y - barHeight, width, barHeight);
+        glUniform4f(colorLocation, color[0], color[1], color[2], 0.9f);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        row++;
+    }
+
+    // Budget tick across all rows
+    glUniform4f(rectLocation, left + fullWidth, top - static_cast<float>(row) * (barHeight + gap), 0.004f, static_cast<float>(row) * (barHeight + gap));
+    glUniform4f(colorLocation, 1.0f, 1.0f, 1.0f, 0.9f);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisable(GL_BLEND);
+}
+/// Profiler overlay ---------- (end)
+
+/// Texture helpers ---------- (start)
+GLuint loadTexture(const char* path) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    int width, height, channels;
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if (data) {
+        GLenum format = GL_RGBA;
+        if (channels == 1) { format = GL_RED; }
+        else if (channels == 3) { format = GL_RGB; }
+        else if (channels == 4) { format = GL_RGBA; }
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    } else {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+
+    stbi_image_free(data);
+    return texture;
+}
+
+GLuint loadCubeMap(std::vector<std::string> faces)
+{
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+
+    int w, h, ch;
+    for (unsigned int i = 0; i < faces.size(); i++) {
+        unsigned char* data = stbi_load(faces[i].c_str(), &w, &h, &ch, 0);
+        if (!data) {
+            std::cout << "Failed to load cubemap: " << faces[i] << std::endl;
+            continue;
+        }
+        GLenum format = (ch == 4) ? GL_RGBA : GL_RGB;
+
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+                     0, format, w, h, 0, format, GL_UNSIGNED_BYTE, data);
+        stbi_image_free(data);
+    }
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return texID;
+}
+/// Texture helpers ---------- (end)
+
+
+/// App Global --- (start)
+int SCR_WIDTH;
+int SCR_HEIGHT;
+
+Camera camera;
+float lastX;
+float lastY;
+bool firstMouse = true;
+
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+/// The light cube is emissive well above 1.0 so it blooms
+glm::vec3 lightCubeColor(8.0f, 8.0f, 7.0f);
+
+/// Bloom
+constexpr float BLOOM_THRESHOLD = 1.0f;
+constexpr float BLOOM_KNEE = 0.5f;
+constexpr float BLOOM_STRENGTH = 0.35f;
+
+/// Auto exposure
+constexpr int LUMINANCE_SIZE = 64;          // luminance grid the histogram is built from
+constexpr int HISTOGRAM_BINS = 64;
+constexpr float MIN_LOG_LUMINANCE = -10.0f;
+constexpr float LOG_LUMINANCE_RANGE = 14.0f; // bins cover 2^-10 .. 2^4
+constexpr float EXPOSURE_LOW_PERCENT = 0.5f;
+constexpr float EXPOSURE_HIGH_PERCENT = 0.95f;
+constexpr float EXPOSURE_KEY = 0.18f;
+constexpr float EXPOSURE_ADAPT_SPEED = 1.5f;
+
+bool bloomEnabled = true;
+bool autoExposureEnabled = true;
+bool tonemapEnabled = true;
+bool overlayEnabled = true;
+constexpr float OVERLAY_BUDGET_MS = 1000.0f / 60.0f;
+const char* PROFILE_CSV_PATH = "gpu_profile.csv";
+const char* PROFILE_JSON_PATH = "gpu_profile.json";
+GpuProfiler gpuProfiler;
+// Set on resize, the screen sized targets are rebuilt at the start of the next frame
+bool targetsDirty = true;
+/// App Global --- (end)
+
+/// Callbacks ---- (start)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, GLdouble xPos, GLdouble yPos);
+void scroll_callback(GLFWwindow* window, GLdouble xOffset, GLdouble yOffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void ProcessInput(GLFWwindow* window);
+/// Callbacks ---- (end)
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "HDR post processing", monitor, nullptr);
+    glfwMakeContextCurrent(window);
+
+    lastX = mode->width / 2.0f;
+    lastY = mode->height / 2.0f;
+
+    camera = Camera();
+    cameraInit(&camera, vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f, 2.0f, 0.2f, 45.0f);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialise GLAD" << std::endl;
+        return -1;
+    }
+
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+
+    // Callbacks
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    GLuint cubeObjectProgram = createProgram(cubeObjectVertexShader, cubeObjectFragmentShader);
+    GLuint lightCubeProgram = createProgram(lightCubeVertexShader, lightCubeFragmentShader);
+    GLuint ShaderProgramSky = createProgram(cubeMapVertexShader, cubeMapFragmentShader);
+    GLuint bloomDownProgram = createProgram(fullScreenVertexShader, bloomDownFragmentShader);
+    GLuint bloomUpProgram = createProgram(fullScreenVertexShader, bloomUpFragmentShader);
+    GLuint luminanceProgram = createProgram(fullScreenVertexShader, luminanceFragmentShader);
+    GLuint histogramRowsProgram = createProgram(fullScreenVertexShader, histogramRowsFragmentShader);
+    GLuint histogramColumnsProgram = createProgram(fullScreenVertexShader, histogramColumnsFragmentShader);
+    GLuint exposureProgram = createProgram(fullScreenVertexShader, exposureFragmentShader);
+    GLuint tonemapProgram = createProgram(fullScreenVertexShader, tonemapFragmentShader);
+
+    // cube vertex data
+    float vertices[] = {
+        // positions          // normals           // tex coords
+        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+         0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,0.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+        -0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+
+        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+        -0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,1.0f,
+        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+
+        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+        -0.5f, 0.5f,-0.5f,  -1.0f,0.0f,0.0f,      1.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+        -0.5f,-0.5f, 0.5f,  -1.0f,0.0f,0.0f,      0.0f,0.0f,
+        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+         0.5f, 0.5f,-0.5f,   1.0f,0.0f,0.0f,      1.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+         0.5f,-0.5f, 0.5f,   1.0f,0.0f,0.0f,      0.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     1.0f,1.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+        -0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     0.0f,0.0f,
+        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+
+        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      1.0f,1.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+        -0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      0.0f,0.0f,
+        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f
+    };
+
+    float skyboxVertices[] = {
+        -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1, -1,
+        -1, -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1,
+         1, -1, -1,  1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1, -1,  1, -1, -1,
+        -1, -1,  1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1, -1,  1, -1, -1,  1,
+        -1,  1, -1,  1,  1, -1,  1,  1,  1,  1,  1,  1, -1,  1,  1, -1,  1, -1,
+        -1, -1, -1, -1, -1,  1,  1, -1, -1,  1, -1, -1, -1, -1,  1,  1, -1,  1
+    };
+
+    glm::vec3 cubePositions[20] = {
+        glm::vec3( 0.0f,  0.0f,   0.0f),
+        glm::vec3( 2.0f,  5.0f,  -6.0f),
+        glm::vec3(-1.5f, -2.2f,  -1.0f),
+        glm::vec3(-3.8f, -2.0f,  -5.0f),
+        glm::vec3( 2.4f, -0.4f,  -1.5f),
+        glm::vec3(-1.7f,  3.0f,  -3.0f),
+        glm::vec3( 1.3f, -2.0f,  -1.0f),
+        glm::vec3( 1.5f,  2.0f,  -1.0f),
+        glm::vec3( 1.5f,  0.2f,  -0.6f),
+        glm::vec3(-1.3f,  1.0f,  -0.6f),
+
+        glm::vec3( 4.0f,  3.0f,  -8.0f),
+        glm::vec3(-4.0f, -3.0f,  -7.0f),
+        glm::vec3( 6.0f,  1.0f, -10.0f),
+        glm::vec3(-6.0f,  2.0f,  -9.0f),
+        glm::vec3( 0.0f,  6.0f, -12.0f),
+        glm::vec3( 3.0f, -4.0f, -11.0f),
+        glm::vec3(-3.0f,  4.0f, -10.5f),
+        glm::vec3( 5.5f, -1.0f, -9.5f),
+        glm::vec3(-5.5f,  2.5f, -10.8f),
+        glm::vec3( 0.0f, -5.0f, -14.0f)
+    };
+
+    GLuint VBO, cubeVAO, lightCubeVAO, emptyVAO;
+    glGenVertexArrays(1, &cubeVAO);
+    glBindVertexArray(cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glGenVertexArrays(1, &lightCubeVAO);
+    glBindVertexArray(lightCubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
+    glEnableVertexAttribArray(0);
+
+    // Full screen passes generate their triangle from gl_VertexID
+    glGenVertexArrays(1, &emptyVAO);
+
+    // Skybox VAO
+    GLuint skyVAO, skyVBO;
+    glGenVertexArrays(1, &skyVAO);
+    glGenBuffers(1, &skyVBO);
+
+    glBindVertexArray(skyVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), nullptr);
+    glBindVertexArray(0);
+
+    std::vector<std::string> faces = {
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/right.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/left.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/top.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/bottom.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/front.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/back.jpg"
+        };
+    GLuint cubeMapTex = loadCubeMap(faces);
+
+    stbi_set_flip_vertically_on_load(true);
+    GLuint diffuseMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2-2.png");
+    GLuint specularMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2_specular-2.png");
+
+    // Constant uniforms, set once
+    glUseProgram(cubeObjectProgram);
+    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.diffuse"), 0);
+    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.specular"), 1);
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.ambient"), 1, value_ptr(vec3(0.2f)));
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.diffuse"), 1, value_ptr(vec3(1.0f)));
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.specular"), 1, value_ptr(vec3(2.0f)));
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "light.constant"), 1.0f);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "light.linear"), 0.045f);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "light.quadratic"), 0.0075f);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "material.shininess"), 512.0f);
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.position"), 1, value_ptr(lightPos));
+    GLint ViewPosition = glGetUniformLocation(cubeObjectProgram, "viewPos");
+    GLint LightShaderProjection = glGetUniformLocation(cubeObjectProgram, "projection");
+    GLint LightShaderView = glGetUniformLocation(cubeObjectProgram, "view");
+    GLint LightShaderModel = glGetUniformLocation(cubeObjectProgram, "model");
+
+    GLint LightCubeProjection = glGetUniformLocation(lightCubeProgram, "projection");
+    GLint LightCubeView = glGetUniformLocation(lightCubeProgram, "view");
+    GLint LightCubeModel = glGetUniformLocation(lightCubeProgram, "model");
+    GLint LightCubeColor = glGetUniformLocation(lightCubeProgram, "lightColor");
+
+    glUseProgram(ShaderProgramSky);
+    glUniform1i(glGetUniformLocation(ShaderProgramSky, "skybox"), 0);
+    GLint SkyView = glGetUniformLocation(ShaderProgramSky, "view");
+    GLint SkyProjection = glGetUniformLocation(ShaderProgramSky, "projection");
+
+    glUseProgram(bloomDownProgram);
+    glUniform1i(glGetUniformLocation(bloomDownProgram, "source"), 0);
+    glUniform1f(glGetUniformLocation(bloomDownProgram, "threshold"), BLOOM_THRESHOLD);
+    glUniform1f(glGetUniformLocation(bloomDownProgram, "knee"), BLOOM_KNEE);
+    GLint BloomPrefilter = glGetUniformLocation(bloomDownProgram, "prefilter");
+    glUseProgram(bloomUpProgram);
+    glUniform1i(glGetUniformLocation(bloomUpProgram, "source"), 0);
+    glUniform1i(glGetUniformLocation(bloomUpProgram, "base"), 1);
+
+    glUseProgram(luminanceProgram);
+    glUniform1i(glGetUniformLocation(luminanceProgram, "sceneColor"), 0);
+    glUniform1f(glGetUniformLocation(luminanceProgram, "minLogLuminance"), MIN_LOG_LUMINANCE);
+    glUniform1f(glGetUniformLocation(luminanceProgram, "logLuminanceRange"), LOG_LUMINANCE_RANGE);
+    glUniform1f(glGetUniformLocation(luminanceProgram, "gridSize"), static_cast<float>(LUMINANCE_SIZE));
+    glUseProgram(histogramRowsProgram);
+    glUniform1i(glGetUniformLocation(histogramRowsProgram, "logLuminance"), 0);
+    glUniform1i(glGetUniformLocation(histogramRowsProgram, "binCount"), HISTOGRAM_BINS);
+    glUseProgram(histogramColumnsProgram);
+    glUniform1i(glGetUniformLocation(histogramColumnsProgram, "rowHistogram"), 0);
+    glUseProgram(exposureProgram);
+    glUniform1i(glGetUniformLocation(exposureProgram, "histogram"), 0);
+    glUniform1i(glGetUniformLocation(exposureProgram, "previousLuminance"), 1);
+    glUniform1f(glGetUniformLocation(exposureProgram, "minLogLuminance"), MIN_LOG_LUMINANCE);
+    glUniform1f(glGetUniformLocation(exposureProgram, "logLuminanceRange"), LOG_LUMINANCE_RANGE);
+    glUniform1f(glGetUniformLocation(exposureProgram, "lowPercent"), EXPOSURE_LOW_PERCENT);
+    glUniform1f(glGetUniformLocation(exposureProgram, "highPercent"), EXPOSURE_HIGH_PERCENT);
+    GLint ExposureAdaptRate = glGetUniformLocation(exposureProgram, "adaptRate");
+
+    glUseProgram(tonemapProgram);
+    glUniform1i(glGetUniformLocation(tonemapProgram, "sceneColor"), 0);
+    glUniform1i(glGetUniformLocation(tonemapProgram, "bloom"), 1);
+    glUniform1i(glGetUniformLocation(tonemapProgram, "adaptedLuminance"), 2);
+    glUniform1f(glGetUniformLocation(tonemapProgram, "bloomStrength"), BLOOM_STRENGTH);
+    glUniform1f(glGetUniformLocation(tonemapProgram, "exposureKey"), EXPOSURE_KEY);
+    GLint TonemapUseBloom = glGetUniformLocation(tonemapProgram, "useBloom");
+    GLint TonemapUseAutoExposure = glGetUniformLocation(tonemapProgram, "useAutoExposure");
+    GLint TonemapUseTonemap = glGetUniformLocation(tonemapProgram, "useTonemap");
+
+    // Screen sized targets, (re)built whenever the framebuffer size changes
+    RenderTarget sceneTarget, bloomHalf, bloomQuarter, bloomResult;
+
+    // Fixed size exposure targets. The adapted luminance ping-pongs between two 1x1 textures and starts at the key,
+    // so the first frames come out at exposure 1.
+    RenderTarget luminanceGrid, rowHistogram, histogram, adaptedLuminance[2];
+    createRenderTarget(&luminanceGrid, LUMINANCE_SIZE, LUMINANCE_SIZE, GL_R16F, GL_NEAREST, false);
+    createRenderTarget(&rowHistogram, HISTOGRAM_BINS, LUMINANCE_SIZE, GL_R32F, GL_NEAREST, false);
+    createRenderTarget(&histogram, HISTOGRAM_BINS, 1, GL_R32F, GL_NEAREST, false);
+    const float initialLuminance = EXPOSURE_KEY;
+    createRenderTarget(&adaptedLuminance[0], 1, 1, GL_R32F, GL_NEAREST, false, &initialLuminance);
+    createRenderTarget(&adaptedLuminance[1], 1, 1, GL_R32F, GL_NEAREST, false, &initialLuminance);
+    int adaptedIndex = 0;
+
+    profilerInit(&gpuProfiler);
+    const GLuint overlayProgram = createProgram(overlayVertexShader, overlayFragmentShader);
+    const GLint OverlayRect = glGetUniformLocation(overlayProgram, "rect");
+    const GLint OverlayColor = glGetUniformLocation(overlayProgram, "color");
+
+    float lastStatsTime = 0.0f;
+
+    while (!glfwWindowShouldClose(window)) {
+        float currentFrame = glfwGetTime();
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        ProcessInput(window);
+
+        if (targetsDirty) {
+            destroyRenderTarget(&sceneTarget);
+            destroyRenderTarget(&bloomHalf);
+            destroyRenderTarget(&bloomQuarter);
+            destroyRenderTarget(&bloomResult);
+            const int halfWidth = std::max(SCR_WIDTH / 2, 1), halfHeight = std::max(SCR_HEIGHT / 2, 1);
+            const int quarterWidth = std::max(SCR_WIDTH / 4, 1), quarterHeight = std::max(SCR_HEIGHT / 4, 1);
+            createRenderTarget(&sceneTarget, SCR_WIDTH, SCR_HEIGHT, GL_R11F_G11F_B10F, GL_LINEAR, true);
+            createRenderTarget(&bloomHalf, halfWidth, halfHeight, GL_R11F_G11F_B10F, GL_LINEAR, false);
+            createRenderTarget(&bloomQuarter, quarterWidth, quarterHeight, GL_R11F_G11F_B10F, GL_LINEAR, false);
+            createRenderTarget(&bloomResult, halfWidth, halfHeight, GL_R11F_G11F_B10F, GL_LINEAR, false);
+            targetsDirty = false;
+        }
+
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT), 0.1f, 1000.0f);
+        glm::mat4 view = getCameraViewMatrix(&camera);
+        glm::mat4 model = glm::mat4(1.0f);
+
+        profilerBeginFrame(&gpuProfiler);
+        {
+            GpuScope frameScope(&gpuProfiler, "frame");
+
+            // --- Scene into the HDR target ---
+            {
+                GpuScope opaqueScope(&gpuProfiler, "opaque");
+                bindRenderTarget(&sceneTarget);
+                glEnable(GL_DEPTH_TEST);
+                glDepthMask(GL_TRUE);
+                glDepthFunc(GL_LESS);
+                glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                glUseProgram(cubeObjectProgram);
+                glUniform3fv(ViewPosition, 1, value_ptr(camera.Position));
+                glUniformMatrix4fv(LightShaderProjection, 1, GL_FALSE, value_ptr(projection));
+                glUniformMatrix4fv(LightShaderView, 1, GL_FALSE, value_ptr(view));
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, diffuseMap);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, specularMap);
+                glBindVertexArray(cubeVAO);
+                for (unsigned int i = 0; i < 20; i++) {
+                    const float angle = 2.0f * i * glfwGetTime();
+                    model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+                    model = glm::translate(model, cubePositions[i]);
+                    glUniformMatrix4fv(LightShaderModel, 1, GL_FALSE, value_ptr(model));
+                    glDrawArrays(GL_TRIANGLES, 0, 36);
+                    model = glm::mat4(1.0f);
+                }
+
+                glUseProgram(lightCubeProgram);
+                glUniformMatrix4fv(LightCubeProjection, 1, GL_FALSE, value_ptr(projection));
+                glUniformMatrix4fv(LightCubeView, 1, GL_FALSE, value_ptr(view));
+                model = glm::scale(glm::translate(glm::mat4(1.0f), lightPos), glm::vec3(0.2f));
+                glUniformMatrix4fv(LightCubeModel, 1, GL_FALSE, value_ptr(model));
+                glUniform3fv(LightCubeColor, 1, value_ptr(lightCubeColor));
+                glBindVertexArray(lightCubeVAO);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            {
+                GpuScope skyScope(&gpuProfiler, "sky");
+                glDepthMask(GL_FALSE);
+                glDepthFunc(GL_LEQUAL);
+                glUseProgram(ShaderProgramSky);
+                glm::mat4 skyView = glm::mat4(glm::mat3(view)); // remove translation
+                glUniformMatrix4fv(SkyView, 1, GL_FALSE, value_ptr(skyView));
+                glUniformMatrix4fv(SkyProjection, 1, GL_FALSE, value_ptr(projection));
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapTex);
+                glBindVertexArray(skyVAO);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+
+            {
+                GpuScope postScope(&gpuProfiler, "post");
+
+                // Everything below is full screen triangles
+                glDisable(GL_DEPTH_TEST);
+                glBindVertexArray(emptyVAO);
+                glActiveTexture(GL_TEXTURE0);
+
+                // --- Bloom : full -> half (threshold) -> quarter -> back up to half ---
+                if (bloomEnabled) {
+                    GpuScope bloomScope(&gpuProfiler, "bloom");
+                    glUseProgram(bloomDownProgram);
+                    bindRenderTarget(&bloomHalf);
+                    glUniform1i(BloomPrefilter, 1);
+                    glBindTexture(GL_TEXTURE_2D, sceneTarget.texture);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+                    bindRenderTarget(&bloomQuarter);
+                    glUniform1i(BloomPrefilter, 0);
+                    glBindTexture(GL_TEXTURE_2D, bloomHalf.texture);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+                    glUseProgram(bloomUpProgram);
+                    bindRenderTarget(&bloomResult);
+                    glBindTexture(GL_TEXTURE_2D, bloomQuarter.texture);
+                    glActiveTexture(GL_TEXTURE1);
+                    glBindTexture(GL_TEXTURE_2D, bloomHalf.texture);
+                    glActiveTexture(GL_TEXTURE0);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+                }
+
+                // --- Auto exposure : luminance grid -> per row histograms -> histogram -> adapted luminance ---
+                if (autoExposureEnabled) {
+                    GpuScope exposureScope(&gpuProfiler, "exposure");
+                    glUseProgram(luminanceProgram);
+                    bindRenderTarget(&luminanceGrid);
+                    glBindTexture(GL_TEXTURE_2D, sceneTarget.texture);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+                    glUseProgram(histogramRowsProgram);
+                    bindRenderTarget(&rowHistogram);
+                    glBindTexture(GL_TEXTURE_2D, luminanceGrid.texture);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+                    glUseProgram(histogramColumnsProgram);
+                    bindRenderTarget(&histogram);
+                    glBindTexture(GL_TEXTURE_2D, rowHistogram.texture);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+                    glUseProgram(exposureProgram);
+                    glUniform1f(ExposureAdaptRate, 1.0f - std::exp(-deltaTime * EXPOSURE_ADAPT_SPEED));
+                    bindRenderTarget(&adaptedLuminance[1 - adaptedIndex]);
+                    glBindTexture(GL_TEXTURE_2D, histogram.texture);
+                    glActiveTexture(GL_TEXTURE1);
+                    glBindTexture(GL_TEXTURE_2D, adaptedLuminance[adaptedIndex].texture);
+                    glActiveTexture(GL_TEXTURE0);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+                    adaptedIndex = 1 - adaptedIndex;
+                }
+
+                // --- Tonemap and resolve into the backbuffer ---
+                {
+                    GpuScope tonemapScope(&gpuProfiler, "tonemap");
+                    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+                    glUseProgram(tonemapProgram);
+                    glUniform1i(TonemapUseBloom, bloomEnabled ? 1 : 0);
+                    glUniform1i(TonemapUseAutoExposure, autoExposureEnabled ? 1 : 0);
+                    glUniform1i(TonemapUseTonemap, tonemapEnabled ? 1 : 0);
+                    glBindTexture(GL_TEXTURE_2D, sceneTarget.texture);
+                    glActiveTexture(GL_TEXTURE1);
+                    glBindTexture(GL_TEXTURE_2D, bloomResult.texture);
+                    glActiveTexture(GL_TEXTURE2);
+                    glBindTexture(GL_TEXTURE_2D, adaptedLuminance[adaptedIndex].texture);
+                    glActiveTexture(GL_TEXTURE0);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+                }
+            }
+
+            if (overlayEnabled) {
+                GpuScope overlayScope(&gpuProfiler, "overlay");
+                glBindVertexArray(emptyVAO);
+                profilerDrawOverlay(&gpuProfiler, overlayProgram, OverlayRect, OverlayColor, OVERLAY_BUDGET_MS);
+            }
+        }
+        profilerEndFrame(&gpuProfiler);
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+
+        if (currentFrame - lastStatsTime >= 2.0f) {
+            profilerPrintStats(&gpuProfiler);
+            lastStatsTime = currentFrame;
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    profilerExport(&gpuProfiler, PROFILE_CSV_PATH, PROFILE_JSON_PATH);
+    profilerDestroy(&gpuProfiler);
+    destroyRenderTarget(&sceneTarget);
+    destroyRenderTarget(&bloomHalf);
+    destroyRenderTarget(&bloomQuarter);
+    destroyRenderTarget(&bloomResult);
+    destroyRenderTarget(&luminanceGrid);
+    destroyRenderTarget(&rowHistogram);
+    destroyRenderTarget(&histogram);
+    destroyRenderTarget(&adaptedLuminance[0]);
+    destroyRenderTarget(&adaptedLuminance[1]);
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &lightCubeVAO);
+    glDeleteVertexArrays(1, &skyVAO);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &skyVBO);
+    glDeleteProgram(cubeObjectProgram);
+    glDeleteProgram(lightCubeProgram);
+    glDeleteProgram(ShaderProgramSky);
+    glDeleteProgram(bloomDownProgram);
+    glDeleteProgram(bloomUpProgram);
+    glDeleteProgram(luminanceProgram);
+    glDeleteProgram(histogramRowsProgram);
+    glDeleteProgram(histogramColumnsProgram);
+    glDeleteProgram(exposureProgram);
+    glDeleteProgram(tonemapProgram);
+    glDeleteProgram(overlayProgram);
+
+    glfwTerminate();
+    return 0;
+}
+
+void ProcessInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, forwardDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, backwardDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, leftDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, rightDir, deltaTime);
+}
+
+void key_callback(GLFWwindow*, int key, int, int action, int)
+{
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_B) { bloomEnabled = !bloomEnabled; std::cout << "Bloom " << (bloomEnabled ? "on" : "off") << std::endl; }
+    if (key == GLFW_KEY_E) { autoExposureEnabled = !autoExposureEnabled; std::cout << "Auto exposure " << (autoExposureEnabled ? "on" : "off") << std::endl; }
+    if (key == GLFW_KEY_T) { tonemapEnabled = !tonemapEnabled; std::cout << "Tonemap " << (tonemapEnabled ? "on" : "off") << std::endl; }
+    if (key == GLFW_KEY_O) { overlayEnabled = !overlayEnabled; }
+    if (key == GLFW_KEY_P) { profilerExport(&gpuProfiler, PROFILE_CSV_PATH, PROFILE_JSON_PATH); }
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int, int)
+{
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+    targetsDirty = true;
+}
+
+void mouse_callback(GLFWwindow* window, const double xPos, const double yPos)
+{
+    const auto xpos = static_cast<float>(xPos);
+    const auto ypos = static_cast<float>(yPos);
+    if (firstMouse) {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+    float xOffset = xpos - lastX;
+    float yOffset = lastY - ypos; // reversed
+    lastX = xpos;
+    lastY = ypos;
+    cameraProcessMouseMovement(&camera, xOffset, yOffset);
+}
+
+void scroll_callback(GLFWwindow*, double, const double yOffset)
+{
+    cameraProcessMouseScroll(&camera, static_cast<float>(yOffset));
+}
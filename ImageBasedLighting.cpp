@@ -0,0 +1,1576 @@
+// Image based lighting : the MultipleLights scene under the skybox, with the flat 0.1 ambient replaced by light
+// taken from the sky itself. At startup the six faces are baked on every core into 9 spherical-harmonic irradiance
+// coefficients, a GGX-prefiltered specular cube mip chain and a split-sum BRDF table. The result is cached next to
+// the executable, keyed by a hash of the face files and the bake settings, so later runs only read it back.
+//
+// I toggles between image based ambient and the old constant ambient.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <ostream>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "FixedTimestep.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+
+/// Defining Globals variable ---- (start)
+/// Rendering
+constexpr int NUM_CUBES = 64;
+
+/// Simulation
+/// SceneObject spin speeds are given in degrees per frame at this rate, they turn at rotSpeed * 60 degrees per second
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+/// Cube spin advances in fixed ticks, so it turns at the same speed and costs the same work at any frame rate
+SimulationClock simClock;
+
+/// Camera
+constexpr float CAMERA_SPEED = 4.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// SpotLight
+constexpr float SPOT_LIGHT_INNER = 15.0f;
+constexpr float SPOT_LIGHT_OUTER = 30.0f;
+
+/// Light culling
+/// A light stops at the distance where its luminance falls below this value ([ and ] halve / double it)
+constexpr float DEFAULT_LUMINANCE_CUTOFF = 0.02f;
+/// Upper bound on point lights a single draw evaluates, must match objectLights[] in the fragment shader
+constexpr int MAX_LIGHTS_PER_OBJECT = 4;
+float luminanceCutoff = DEFAULT_LUMINANCE_CUTOFF;
+
+/// Image based lighting
+/// Faces are box-filtered to this size before anything is integrated
+constexpr int IBL_SOURCE_SIZE = 256;
+/// SH projection reads this level of the source pyramid : irradiance has no detail worth more texels
+constexpr int SH_SOURCE_SIZE = 64;
+/// Specular cube : mip 0 is mirror-like, the last mip is fully rough
+constexpr int PREFILTER_SIZE = 128;
+constexpr int PREFILTER_MIPS = 5;
+constexpr int PREFILTER_SAMPLES = 128;
+constexpr int BRDF_LUT_SIZE = 32;
+constexpr int BRDF_SAMPLES = 256;
+constexpr uint32_t IBL_CACHE_MAGIC = 0x4C424931; // "1IBL"
+constexpr uint32_t IBL_CACHE_VERSION = 1;
+static_assert(SH_SOURCE_SIZE % 4 == 0, "SH rows are integrated four texels at a time");
+bool bUseIBL = true;
+
+/// Turn off or on spotlight
+bool bIsCameraLightOn = true;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 0.0f, 5.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() = default;
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    // deltaX → yaw  (left/right look)
+    // deltaY → pitch (up/down look)
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe  (-1 = left,    +1 = right)
+    // dir.z : forward (-1 = back,    +1 = forward)
+    // dir.y : vertical(-1 = down,    +1 = up)
+    // dir.y uses world Y (0,1,0) not camera up — so Space always goes straight up in world space regardless of where camera is looking.
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    // Transforms world-space coordinates into camera-space.
+    // (position + front) is the target point — direction matters, not distance.
+    // [[nodiscard]] — ignoring this return value is always a bug.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    // aspectRatio = window width / height — pass every frame in case of resize.
+    // FOV, NEAR_PLANE, FAR_PLANE are global constexpr constants, Zoom is not implemented here.
+    // [[nodiscard]] — ignoring this return value is always a bug.
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(FOV, aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles vertex and fragment shader from raw GLSL source strings, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource) {
+        // Local lambda — compiles a single shader stage and reports errors. Defined here because it is only needed during construction.
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a float uniform (shininess, attenuation values, time, etc.).
+    void setFloat(const char* uniform, const float val) const {
+        glUniform1f(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int array uniform (per-object light index lists).
+    void setIntArray(const char* uniform, const int* vals, const int count) const {
+        glUniform1iv(glGetUniformLocation(ProgramID, uniform), count, vals);
+    }
+
+    // Sets a vec3 array uniform (spherical-harmonic coefficients).
+    void setVec3Array(const char* uniform, const glm::vec3* vecs, const int count) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), count, glm::value_ptr(vecs[0]));
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Creating procedural texture ------------------ (start)
+class Texture {
+public:
+    // OpenGL texture handle — 0 = invalid/uninitialized
+    GLuint TextureID = 0;
+    Texture() {
+        glGenTextures(1, &TextureID);
+        glBindTexture(GL_TEXTURE_2D, TextureID);
+
+        // Texture dimensions — 256x256 pixels.
+        constexpr int size = 256;
+
+        // Allocate CPU-side pixel buffer.
+        // sz*sz = total pixels, *4 = RGBA (red, green, blue, alpha channels).
+        // Each channel is 1 byte (0-255), so total = 256*256*4 = 262144 bytes.
+        auto* data = new unsigned char[size * size * 4];
+
+        // Fill every pixel with a procedural pattern.
+        // No image file needed — the pattern is computed mathematically.
+        for (int y = 0 ; y < size ; y++) {
+            for (int x = 0 ; x < size ; x++) {
+                // Normalize pixel coordinates to 0.0 - 1.0 range.
+                // fx=0.0 at left edge, fx=1.0 at right edge (same for fy vertically)
+                const float fx = static_cast<float>(x) / size;
+                const float fy = static_cast<float>(y) / size;
+
+                // Noise value — drives the mix between R and G channels.
+                // sin() oscillates between -1 and +1, *0.5+0.5 shifts to 0.0-1.0.
+                // High frequency (20, 10) creates a fine diagonal stripe pattern.
+                float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+
+                // Calculate flat array index for this pixel.
+                // Each pixel takes 4 consecutive bytes: [R, G, B, A]
+                // Row y starts at y*sz, pixel x is at offset x, times 4 bytes each.
+                const int i = (y * size + x) * 4;
+
+                // RED channel — sin wave scaled to 0-255, fades with noise n.
+                // When n=1.0 → full red contribution
+                // When n=0.0 → red is zero
+                data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+
+                // GREEN channel — cos wave scaled to 0-255, fades opposite to red.
+                // (1-n) means green is bright where red is dark and vice versa.
+                // Creates a complementary color shift across the texture.
+                data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+
+                // BLUE channel — independent sin wave, not affected by noise n.
+                // Adds a third color variation layer across the texture.
+                data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+
+                // ALPHA channel — fully opaque, no transparency.
+                data[i+3] = 255;
+            }
+        }
+
+        // Upload the pixel data from CPU memory to GPU texture memory.
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+        // Auto-generate all mipmap levels from the base image just uploaded
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // Delete CPU side array
+        delete[] data;
+
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    }
+};
+
+/// Creating procedural texture ------------------ (end)
+
+
+
+/// Light structs --------- (Start)
+// Distance at which the light's luminance, attenuated, drops to the cutoff.
+// Solves quadratic*d^2 + linear*d + constant = luminance / cutoff for d.
+float attenuationRadius(const glm::vec3& color, float constant, float linear, float quadratic, float cutoff) {
+    const float luminance = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    const float c = constant - luminance / cutoff;
+    if (c >= 0.0f) return 0.0f; // never bright enough to pass the cutoff
+    return (-linear + sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
+struct PointLight {
+    glm::vec3 position, color;
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+    float radius = 0.0f;
+
+    PointLight(glm::vec3 p, glm::vec3 c) : position(p), color(c) {
+        updateRadius(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRadius(float cutoff) {
+        radius = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
+};
+
+struct SpotLight {
+    glm::vec3 position, dir, color;
+    float innerCutoff, outerCutoff;
+    float outerAngle; // radians, used by the cone vs bounds test
+    float constant = 1.0f;
+    float linear = 0.07f;
+    float quadratic = 0.017f;
+    float range = 0.0f;
+
+    SpotLight(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer)
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))), outerAngle(glm::radians(outer)) {
+        updateRange(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRange(float cutoff) {
+        range = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
+};
+/// Light structs --------- (end)
+
+
+/// Material ------ (start)
+struct Material { glm::vec3 specular; float shininess; };
+
+Material materials[6] = {
+    {{1.0f,1.0f,1.0f}, 32.0f},
+    {{1.0f,1.0f,1.0f}, 64.0f},
+    {{1.0f,1.0f,1.0f}, 128.0f},
+    {{1.0f,1.0f,1.0f}, 256.0f},
+    {{0.9f,0.9f,0.9f}, 512.0f},
+    {{0.4f,0.9f,0.4f}, 1028.0f}
+};
+
+/// Material ------ (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVAO = 0;
+
+float cubeData[288] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
+     0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,  -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,  -0.5f, 0.5f,-0.5f, 0,0,-1, 0,1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,   0.5f,-0.5f, 0.5f, 0,0, 1, 1,0,   0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,
+     0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,  -0.5f, 0.5f, 0.5f, 0,0, 1, 0,1,  -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,
+    -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f,-0.5f,-1,0, 0, 1,1,
+    -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f, 0.5f,-1,0, 0, 0,0,
+     0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f,-0.5f, 1,0, 0, 1,1,
+     0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f, 0.5f, 1,0, 0, 0,0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,   0.5f,-0.5f,-0.5f, 0,-1,0, 1,1,   0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0, 0,0,  -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,
+    -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,   0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0, 1,1,
+     0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,  -0.5f, 0.5f, 0.5f, 0, 1,0, 0,0
+};
+
+void setupCubeVAO() {
+    unsigned int VBO;
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // uv
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+/// Cube vertex data ------------- (end)
+
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (start)
+class SceneObject {
+public:
+    glm::mat4 model{};
+    int matId;
+    float rotSpeed;
+    Texture texture;
+
+    // Bounding sphere of the unit cube : rotation about the centre never changes it
+    glm::vec3 boundCenter;
+    float boundRadius;
+
+    // Lights that reach this object, rebuilt every frame by buildObjectLightLists()
+    int lightIndices[MAX_LIGHTS_PER_OBJECT] = {};
+    int lightCount = 0;
+    bool spotLit = false;
+
+    // Translation and scale, the spin is applied on top
+    glm::mat4 base{};
+    // Spin in degrees at the latest and the previous simulation tick
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObject(glm::vec3 pos, float scale, int mat, float rot) : matId(mat), rotSpeed(rot), boundCenter(pos), boundRadius(scale * 0.8660254f) {
+        base = glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(scale));
+        model = base;
+    }
+
+    // One simulation tick
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        // Keep the angle small so it does not lose precision over a long run, both move so the blend is unchanged
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    // Model matrix between the previous and the latest tick
+    void interpolate(float alpha) {
+        model = glm::rotate(base, glm::radians(previousAngle + (angle - previousAngle) * alpha), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (start)
+
+
+/// Image based lighting bake ---- (start)
+// The skybox faces are reduced once on the CPU into
+//   * 9 spherical-harmonic coefficients of the cosine-convolved sky (diffuse ambient, no texture at all),
+//   * a GGX-prefiltered cube mip chain, one roughness per mip (specular ambient, one textureLod),
+//   * a split-sum BRDF table indexed by (N.V, roughness) (one more lookup).
+// Texel values are integrated as displayed : nothing in this repo linearises its textures, so the ambient stays
+// consistent with the background it comes from.
+
+// Four floats at once : SSE on x86, NEON on Apple silicon, plain loops anywhere else.
+struct Float4 {
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128 v;
+    Float4() : v(_mm_setzero_ps()) {}
+    Float4(__m128 x) : v(x) {}
+    explicit Float4(float s) : v(_mm_set1_ps(s)) {}
+    static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+    friend Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+    friend Float4 sqrt4(Float4 a) { return _mm_sqrt_ps(a.v); }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t v;
+    Float4() : v(vdupq_n_f32(0.0f)) {}
+    Float4(float32x4_t x) : v(x) {}
+    explicit Float4(float s) : v(vdupq_n_f32(s)) {}
+    static Float4 load(const float* p) { return vld1q_f32(p); }
+    void store(float* p) const { vst1q_f32(p, v); }
+    friend Float4 operator+(Float4 a, Float4 b) { return vaddq_f32(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return vsubq_f32(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return vmulq_f32(a.v, b.v); }
+    friend Float4 operator/(Float4 a, Float4 b) { return vdivq_f32(a.v, b.v); }
+    friend Float4 sqrt4(Float4 a) { return vsqrtq_f32(a.v); }
+#else
+    float v[4];
+    Float4() : v{0.0f, 0.0f, 0.0f, 0.0f} {}
+    explicit Float4(float s) : v{s, s, s, s} {}
+    static Float4 load(const float* p) { Float4 r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+    void store(float* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+    friend Float4 operator+(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+    friend Float4 operator-(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+    friend Float4 operator*(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+    friend Float4 operator/(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] /= b.v[i]; return a; }
+    friend Float4 sqrt4(Float4 a) { for (float& x : a.v) x = std::sqrt(x); return a; }
+#endif
+    [[nodiscard]] float sum() const {
+        float lanes[4];
+        store(lanes);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+};
+
+// Runs job(0 .. jobCount-1) on every hardware thread, each worker pulling the next index from a shared counter
+// so a few slow jobs (the rough mips) cannot leave the other threads idle.
+template <typename Job>
+void runParallel(int jobCount, const Job& job) {
+    const int workerCount = std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), jobCount));
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        for (int i = next++; i < jobCount; i = next++) job(i);
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < workerCount; t++) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+// GL face order (+X, -X, +Y, -Y, +Z, -Z). Texel (u, v) in [-1, 1] of a face looks along major + u * uAxis + v * vAxis,
+// v growing down the image like the rows stb_image returns and glTexImage2D uploads.
+struct CubeFaceBasis { glm::vec3 major, uAxis, vAxis; };
+const CubeFaceBasis CUBE_FACES[6] = {
+    {{ 1.0f, 0.0f, 0.0f}, { 0.0f, 0.0f,-1.0f}, {0.0f,-1.0f, 0.0f}},
+    {{-1.0f, 0.0f, 0.0f}, { 0.0f, 0.0f, 1.0f}, {0.0f,-1.0f, 0.0f}},
+    {{ 0.0f, 1.0f, 0.0f}, { 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+    {{ 0.0f,-1.0f, 0.0f}, { 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f,-1.0f}},
+    {{ 0.0f, 0.0f, 1.0f}, { 1.0f, 0.0f, 0.0f}, {0.0f,-1.0f, 0.0f}},
+    {{ 0.0f, 0.0f,-1.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f,-1.0f, 0.0f}}
+};
+
+// Six square RGB float faces of one mip level.
+struct CubeImage {
+    int size = 0;
+    std::vector<float> faces[6];
+
+    explicit CubeImage(int s = 0) : size(s) {
+        for (auto& face : faces) face.assign(static_cast<size_t>(s) * s * 3, 0.0f);
+    }
+    [[nodiscard]] const float* texel(int face, int x, int y) const { return &faces[face][(y * size + x) * 3]; }
+    float* texel(int face, int x, int y) { return &faces[face][(y * size + x) * 3]; }
+};
+
+// Same face selection as the GPU : the major axis picks the face, the other two give [0, 1] coordinates on it.
+void directionToFace(const glm::vec3& d, int& face, float& s, float& t) {
+    const glm::vec3 a = glm::abs(d);
+    float major, u, v;
+    if (a.x >= a.y && a.x >= a.z) { face = d.x > 0.0f ? 0 : 1; major = a.x; u = d.x > 0.0f ? -d.z : d.z; v = -d.y; }
+    else if (a.y >= a.z)          { face = d.y > 0.0f ? 2 : 3; major = a.y; u = d.x; v = d.y > 0.0f ? d.z : -d.z; }
+    else                          { face = d.z > 0.0f ? 4 : 5; major = a.z; u = d.z > 0.0f ? d.x : -d.x; v = -d.y; }
+    s = 0.5f * (u / major + 1.0f);
+    t = 0.5f * (v / major + 1.0f);
+}
+
+// Bilinear lookup inside one face, clamped at its edges. Seams are not filtered across faces, which the
+// prefilter's wide lobes hide completely.
+glm::vec3 sampleFace(const CubeImage& image, int face, float s, float t) {
+    const float x = s * static_cast<float>(image.size) - 0.5f;
+    const float y = t * static_cast<float>(image.size) - 0.5f;
+    const int x0 = static_cast<int>(std::floor(x)), y0 = static_cast<int>(std::floor(y));
+    const float fx = x - static_cast<float>(x0), fy = y - static_cast<float>(y0);
+    const int last = image.size - 1;
+    const int xa = std::clamp(x0, 0, last), xb = std::clamp(x0 + 1, 0, last);
+    const int ya = std::clamp(y0, 0, last), yb = std::clamp(y0 + 1, 0, last);
+    const float* p00 = image.texel(face, xa, ya);
+    const float* p10 = image.texel(face, xb, ya);
+    const float* p01 = image.texel(face, xa, yb);
+    const float* p11 = image.texel(face, xb, yb);
+    glm::vec3 result;
+    for (int c = 0; c < 3; c++) {
+        const float top = p00[c] + (p10[c] - p00[c]) * fx;
+        const float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+        result[c] = top + (bottom - top) * fy;
+    }
+    return result;
+}
+
+// Trilinear lookup into a mip chain of cube images (chain[0] is the largest).
+glm::vec3 sampleCube(const std::vector<CubeImage>& chain, const glm::vec3& dir, float lod) {
+    int face; float s, t;
+    directionToFace(dir, face, s, t);
+    lod = std::clamp(lod, 0.0f, static_cast<float>(chain.size() - 1));
+    const int l0 = static_cast<int>(lod);
+    const int l1 = std::min(l0 + 1, static_cast<int>(chain.size()) - 1);
+    const glm::vec3 a = sampleFace(chain[l0], face, s, t);
+    if (l1 == l0) return a;
+    return glm::mix(a, sampleFace(chain[l1], face, s, t), lod - static_cast<float>(l0));
+}
+
+// Box-filters the decoded 8-bit faces down (or up) to size x size floats in [0, 1].
+CubeImage resampleFaces(unsigned char* const faces[6], int width, int height, int size) {
+    CubeImage image(size);
+    runParallel(6 * size, [&](int job) {
+        const int face = job / size, y = job % size;
+        const int y0 = y * height / size, y1 = std::max(y0 + 1, (y + 1) * height / size);
+        for (int x = 0; x < size; x++) {
+            const int x0 = x * width / size, x1 = std::max(x0 + 1, (x + 1) * width / size);
+            float sum[3] = {0.0f, 0.0f, 0.0f};
+            for (int sy = y0; sy < y1; sy++) {
+                for (int sx = x0; sx < x1; sx++) {
+                    const unsigned char* p = faces[face] + (sy * width + sx) * 3;
+                    for (int c = 0; c < 3; c++) sum[c] += p[c];
+                }
+            }
+            const float scale = 1.0f / (255.0f * static_cast<float>((x1 - x0) * (y1 - y0)));
+            float* out = image.texel(face, x, y);
+            for (int c = 0; c < 3; c++) out[c] = sum[c] * scale;
+        }
+    });
+    return image;
+}
+
+// Full source mip pyramid down to 1x1, each level a 2x2 box of the previous one.
+std::vector<CubeImage> buildSourceChain(CubeImage base) {
+    std::vector<CubeImage> chain;
+    chain.push_back(std::move(base));
+    while (chain.back().size > 1) {
+        const CubeImage& src = chain.back();
+        CubeImage dst(src.size / 2);
+        for (int face = 0; face < 6; face++) {
+            for (int y = 0; y < dst.size; y++) {
+                for (int x = 0; x < dst.size; x++) {
+                    float* out = dst.texel(face, x, y);
+                    for (int c = 0; c < 3; c++) {
+                        out[c] = 0.25f * (src.texel(face, 2 * x, 2 * y)[c] + src.texel(face, 2 * x + 1, 2 * y)[c] +
+                                          src.texel(face, 2 * x, 2 * y + 1)[c] + src.texel(face, 2 * x + 1, 2 * y + 1)[c]);
+                    }
+                }
+            }
+        }
+        chain.push_back(std::move(dst));
+    }
+    return chain;
+}
+
+struct IBLData {
+    glm::vec3 sh[9];                     // irradiance / PI, basis constants already folded in
+    std::vector<CubeImage> prefiltered;  // PREFILTER_MIPS levels, roughness = level / (PREFILTER_MIPS - 1)
+    std::vector<float> brdfLut;          // BRDF_LUT_SIZE^2 RG pairs : (scale, bias) on F0
+};
+
+// Projects the environment onto the first 9 real SH functions, 4 texels of a row at a time, then convolves with
+// the clamped cosine lobe so the shader only evaluates a polynomial in the normal.
+void projectIrradianceSH(const CubeImage& env, glm::vec3 sh[9]) {
+    const int n = env.size;
+    constexpr int STRIDE = 28; // 27 weighted colour sums + the solid angle covered
+    std::vector<float> partial(static_cast<size_t>(6 * n) * STRIDE);
+
+    runParallel(6 * n, [&](int job) {
+        const int face = job / n, y = job % n;
+        const CubeFaceBasis& basis = CUBE_FACES[face];
+        const Float4 v((static_cast<float>(y) + 0.5f) * 2.0f / static_cast<float>(n) - 1.0f);
+        const Float4 one(1.0f);
+        const Float4 texelArea(4.0f / static_cast<float>(n * n));
+        Float4 acc[27];
+        Float4 weightSum;
+        float u[4], rgb[3][4];
+        for (int x = 0; x < n; x += 4) {
+            for (int k = 0; k < 4; k++) {
+                u[k] = (static_cast<float>(x + k) + 0.5f) * 2.0f / static_cast<float>(n) - 1.0f;
+                const float* t = env.texel(face, x + k, y);
+                for (int c = 0; c < 3; c++) rgb[c][k] = t[c];
+            }
+            const Float4 uu = Float4::load(u);
+            // A texel at (u, v) subtends texelArea / (1 + u^2 + v^2)^1.5 steradians
+            const Float4 invLen = one / sqrt4(one + uu * uu + v * v);
+            const Float4 dw = texelArea * invLen * invLen * invLen;
+            const Float4 dx = (Float4(basis.major.x) + uu * Float4(basis.uAxis.x) + v * Float4(basis.vAxis.x)) * invLen;
+            const Float4 dy = (Float4(basis.major.y) + uu * Float4(basis.uAxis.y) + v * Float4(basis.vAxis.y)) * invLen;
+            const Float4 dz = (Float4(basis.major.z) + uu * Float4(basis.uAxis.z) + v * Float4(basis.vAxis.z)) * invLen;
+            const Float4 y9[9] = {
+                Float4(0.282095f),
+                Float4(0.488603f) * dy, Float4(0.488603f) * dz, Float4(0.488603f) * dx,
+                Float4(1.092548f) * dx * dy, Float4(1.092548f) * dy * dz, Float4(0.315392f) * (Float4(3.0f) * dz * dz - one),
+                Float4(1.092548f) * dx * dz, Float4(0.546274f) * (dx * dx - dy * dy)
+            };
+            const Float4 r = Float4::load(rgb[0]) * dw, g = Float4::load(rgb[1]) * dw, b = Float4::load(rgb[2]) * dw;
+            for (int i = 0; i < 9; i++) {
+                acc[i * 3 + 0] = acc[i * 3 + 0] + y9[i] * r;
+                acc[i * 3 + 1] = acc[i * 3 + 1] + y9[i] * g;
+                acc[i * 3 + 2] = acc[i * 3 + 2] + y9[i] * b;
+            }
+            weightSum = weightSum + dw;
+        }
+        float* out = &partial[static_cast<size_t>(job) * STRIDE];
+        for (int i = 0; i < 27; i++) out[i] = acc[i].sum();
+        out[27] = weightSum.sum();
+    });
+
+    double total[STRIDE] = {};
+    for (int job = 0; job < 6 * n; job++) {
+        for (int i = 0; i < STRIDE; i++) total[i] += partial[static_cast<size_t>(job) * STRIDE + i];
+    }
+    // The texel solid angles are an approximation : renormalise so the sphere integrates to exactly 4 PI
+    const double norm = 4.0 * glm::pi<double>() / total[27];
+    // Cosine lobe per band (PI, 2PI/3, PI/4) over PI, times the basis constant the shader leaves out
+    const float band[9] = {
+        0.282095f,
+        0.488603f * 2.0f / 3.0f, 0.488603f * 2.0f / 3.0f, 0.488603f * 2.0f / 3.0f,
+        1.092548f * 0.25f, 1.092548f * 0.25f, 0.315392f * 0.25f, 1.092548f * 0.25f, 0.546274f * 0.25f
+    };
+    for (int i = 0; i < 9; i++) {
+        for (int c = 0; c < 3; c++) sh[i][c] = static_cast<float>(total[i * 3 + c] * norm) * band[i];
+    }
+}
+
+// Van der Corput radical inverse paired with i / count.
+glm::vec2 hammersley(unsigned i, unsigned count) {
+    unsigned bits = i;
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return {static_cast<float>(i) / static_cast<float>(count), static_cast<float>(bits) * 2.3283064365386963e-10f};
+}
+
+// GGX half vector around +Z for a given roughness.
+glm::vec3 importanceSampleGGX(glm::vec2 xi, float roughness) {
+    const float a = roughness * roughness;
+    const float phi = 2.0f * glm::pi<float>() * xi.x;
+    const float cosTheta = std::sqrt((1.0f - xi.y) / (1.0f + (a * a - 1.0f) * xi.y));
+    const float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+    return {sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta};
+}
+
+// Light directions for one prefiltered mip, in the tangent frame of N = V = R and stored as separate x/y/z arrays
+// so four of them rotate into world space with a handful of SIMD multiplies. Each sample also carries the source
+// mip whose texel footprint matches its pdf, which keeps bright pixels from turning into fireflies.
+struct PrefilterSamples {
+    std::vector<float> x, y, z, weight, lod;
+};
+
+PrefilterSamples makePrefilterSamples(float roughness, int sourceSize) {
+    PrefilterSamples samples;
+    const float a2 = roughness * roughness * roughness * roughness;
+    const float texelSolidAngle = 4.0f * glm::pi<float>() / (6.0f * static_cast<float>(sourceSize * sourceSize));
+    for (int i = 0; i < PREFILTER_SAMPLES; i++) {
+        const glm::vec3 h = importanceSampleGGX(hammersley(i, PREFILTER_SAMPLES), roughness);
+        const glm::vec3 l(2.0f * h.z * h.x, 2.0f * h.z * h.y, 2.0f * h.z * h.z - 1.0f);
+        if (l.z <= 0.0f) continue;
+        // With N = V the pdf of L reduces to D(h) / 4
+        const float denom = h.z * h.z * (a2 - 1.0f) + 1.0f;
+        const float pdf = a2 / (glm::pi<float>() * denom * denom) * 0.25f;
+        const float sampleSolidAngle = 1.0f / (static_cast<float>(PREFILTER_SAMPLES) * pdf + 1e-4f);
+        samples.x.push_back(l.x);
+        samples.y.push_back(l.y);
+        samples.z.push_back(l.z);
+        samples.weight.push_back(l.z);
+        samples.lod.push_back(std::max(0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f, 0.0f));
+    }
+    // Pad to a multiple of 4 with zero-weight samples so the SIMD loop never needs a tail
+    while (samples.x.size() % 4 != 0) {
+        samples.x.push_back(0.0f); samples.y.push_back(0.0f); samples.z.push_back(1.0f);
+        samples.weight.push_back(0.0f); samples.lod.push_back(0.0f);
+    }
+    return samples;
+}
+
+// Split-sum specular prefilter (Karis 2013). Mip 0 is the mirror-like source itself, every rougher mip is
+// convolved from the full source chain; one job per (mip, face, row).
+void prefilterSpecular(const std::vector<CubeImage>& chain, IBLData& ibl) {
+    size_t baseLevel = 0;
+    while (chain[baseLevel].size > PREFILTER_SIZE) baseLevel++;
+    ibl.prefiltered.clear();
+    ibl.prefiltered.push_back(chain[baseLevel]);
+
+    std::vector<PrefilterSamples> samples(PREFILTER_MIPS);
+    struct RowJob { int mip, face, row; };
+    std::vector<RowJob> jobs;
+    for (int mip = 1; mip < PREFILTER_MIPS; mip++) {
+        const int size = std::max(PREFILTER_SIZE >> mip, 1);
+        ibl.prefiltered.emplace_back(size);
+        samples[mip] = makePrefilterSamples(static_cast<float>(mip) / static_cast<float>(PREFILTER_MIPS - 1), chain[0].size);
+        for (int face = 0; face < 6; face++) {
+            for (int row = 0; row < size; row++) jobs.push_back({mip, face, row});
+        }
+    }
+
+    runParallel(static_cast<int>(jobs.size()), [&](int index) {
+        const RowJob& job = jobs[index];
+        CubeImage& out = ibl.prefiltered[job.mip];
+        const PrefilterSamples& s = samples[job.mip];
+        const CubeFaceBasis& basis = CUBE_FACES[job.face];
+        const float v = (static_cast<float>(job.row) + 0.5f) * 2.0f / static_cast<float>(out.size) - 1.0f;
+        float wx[4], wy[4], wz[4];
+        for (int x = 0; x < out.size; x++) {
+            const float u = (static_cast<float>(x) + 0.5f) * 2.0f / static_cast<float>(out.size) - 1.0f;
+            const glm::vec3 n = glm::normalize(basis.major + u * basis.uAxis + v * basis.vAxis);
+            const glm::vec3 up = std::abs(n.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            const glm::vec3 t = glm::normalize(glm::cross(up, n));
+            const glm::vec3 b = glm::cross(n, t);
+            const Float4 tx(t.x), ty(t.y), tz(t.z), bx(b.x), by(b.y), bz(b.z), nx(n.x), ny(n.y), nz(n.z);
+
+            glm::vec3 color(0.0f);
+            float weightSum = 0.0f;
+            for (size_t k = 0; k < s.x.size(); k += 4) {
+                const Float4 lx = Float4::load(&s.x[k]), ly = Float4::load(&s.y[k]), lz = Float4::load(&s.z[k]);
+                (tx * lx + bx * ly + nx * lz).store(wx);
+                (ty * lx + by * ly + ny * lz).store(wy);
+                (tz * lx + bz * ly + nz * lz).store(wz);
+                for (int j = 0; j < 4; j++) {
+                    const float w = s.weight[k + j];
+                    if (w <= 0.0f) continue;
+                    color += sampleCube(chain, glm::vec3(wx[j], wy[j], wz[j]), s.lod[k + j]) * w;
+                    weightSum += w;
+                }
+            }
+            color /= std::max(weightSum, 1e-4f);
+            float* texel = out.texel(job.face, x, job.row);
+            texel[0] = color.x; texel[1] = color.y; texel[2] = color.z;
+        }
+    });
+}
+
+// Scale and bias applied to F0 for each (N.V, roughness), integrated against GGX with the IBL remap k = a^2 / 2.
+void integrateBRDF(std::vector<float>& lut) {
+    lut.assign(BRDF_LUT_SIZE * BRDF_LUT_SIZE * 2, 0.0f);
+    runParallel(BRDF_LUT_SIZE, [&](int row) {
+        const float roughness = (static_cast<float>(row) + 0.5f) / BRDF_LUT_SIZE;
+        const float k = roughness * roughness * 0.5f;
+        for (int column = 0; column < BRDF_LUT_SIZE; column++) {
+            const float nDotV = (static_cast<float>(column) + 0.5f) / BRDF_LUT_SIZE;
+            const glm::vec3 view(std::sqrt(1.0f - nDotV * nDotV), 0.0f, nDotV);
+            float scale = 0.0f, bias = 0.0f;
+            for (int i = 0; i < BRDF_SAMPLES; i++) {
+                const glm::vec3 h = importanceSampleGGX(hammersley(i, BRDF_SAMPLES), roughness);
+                const float vDotH = glm::dot(view, h);
+                const glm::vec3 l = 2.0f * vDotH * h - view;
+                if (l.z <= 0.0f) continue;
+                const float nDotL = l.z, nDotH = std::max(h.z, 0.0f);
+                const float g = (nDotV / (nDotV * (1.0f - k) + k)) * (nDotL / (nDotL * (1.0f - k) + k));
+                const float visibility = g * std::max(vDotH, 0.0f) / (nDotH * nDotV);
+                const float fresnel = std::pow(1.0f - std::max(vDotH, 0.0f), 5.0f);
+                scale += (1.0f - fresnel) * visibility;
+                bias += fresnel * visibility;
+            }
+            lut[(row * BRDF_LUT_SIZE + column) * 2 + 0] = scale / BRDF_SAMPLES;
+            lut[(row * BRDF_LUT_SIZE + column) * 2 + 1] = bias / BRDF_SAMPLES;
+        }
+    });
+}
+
+// FNV-1a over the raw face files and every bake setting : a new sky or a tweak here invalidates the cache file
+uint64_t iblCacheKey(const std::vector<std::vector<unsigned char>>& files) {
+    uint64_t hash = 1469598103934665603ull;
+    auto feed = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) { hash ^= bytes[i]; hash *= 1099511628211ull; }
+    };
+    for (const auto& file : files) feed(file.data(), file.size());
+    const int settings[] = {IBL_SOURCE_SIZE, SH_SOURCE_SIZE, PREFILTER_SIZE, PREFILTER_MIPS, PREFILTER_SAMPLES, BRDF_LUT_SIZE, BRDF_SAMPLES};
+    feed(settings, sizeof(settings));
+    return hash;
+}
+
+std::string iblCachePath(uint64_t key) {
+    char name[40];
+    std::snprintf(name, sizeof(name), "ibl_cache_%016llx.bin", static_cast<unsigned long long>(key));
+    return name;
+}
+
+struct IBLCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+};
+
+bool loadIBLCache(uint64_t key, IBLData& ibl) {
+    std::ifstream file(iblCachePath(key), std::ios::binary);
+    if (!file) return false;
+    IBLCacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != IBL_CACHE_MAGIC || header.version != IBL_CACHE_VERSION || header.key != key) return false;
+    file.read(reinterpret_cast<char*>(ibl.sh), sizeof(ibl.sh));
+    ibl.prefiltered.clear();
+    for (int mip = 0; mip < PREFILTER_MIPS; mip++) {
+        ibl.prefiltered.emplace_back(std::max(PREFILTER_SIZE >> mip, 1));
+        for (auto& face : ibl.prefiltered.back().faces) {
+            file.read(reinterpret_cast<char*>(face.data()), static_cast<std::streamsize>(face.size() * sizeof(float)));
+        }
+    }
+    ibl.brdfLut.resize(BRDF_LUT_SIZE * BRDF_LUT_SIZE * 2);
+    file.read(reinterpret_cast<char*>(ibl.brdfLut.data()), static_cast<std::streamsize>(ibl.brdfLut.size() * sizeof(float)));
+    return static_cast<bool>(file);
+}
+
+void saveIBLCache(uint64_t key, const IBLData& ibl) {
+    const std::string path = iblCachePath(key);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "Could not write " << path << std::endl;
+        return;
+    }
+    const IBLCacheHeader header{IBL_CACHE_MAGIC, IBL_CACHE_VERSION, key};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(ibl.sh), sizeof(ibl.sh));
+    for (const auto& level : ibl.prefiltered) {
+        for (const auto& face : level.faces) {
+            file.write(reinterpret_cast<const char*>(face.data()), static_cast<std::streamsize>(face.size() * sizeof(float)));
+        }
+    }
+    file.write(reinterpret_cast<const char*>(ibl.brdfLut.data()), static_cast<std::streamsize>(ibl.brdfLut.size() * sizeof(float)));
+}
+
+// Reads a whole file, the raw bytes feed both the cache key and stb_image.
+bool readFileBytes(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !bytes.empty();
+}
+
+// The decoded skybox, kept until both the background cubemap and (on a cache miss) the bake have used it.
+struct SkyboxFaces {
+    unsigned char* pixels[6] = {};
+    int width = 0, height = 0;
+
+    ~SkyboxFaces() {
+        for (auto* p : pixels) if (p) stbi_image_free(p);
+    }
+};
+
+bool decodeSkybox(const std::vector<std::vector<unsigned char>>& files, SkyboxFaces& faces) {
+    for (int i = 0; i < 6; i++) {
+        int w, h, channels;
+        faces.pixels[i] = stbi_load_from_memory(files[i].data(), static_cast<int>(files[i].size()), &w, &h, &channels, 3);
+        if (!faces.pixels[i] || (i > 0 && (w != faces.width || h != faces.height))) return false;
+        faces.width = w;
+        faces.height = h;
+    }
+    return true;
+}
+
+// Whole bake : source pyramid, SH, prefiltered chain and BRDF table.
+void bakeIBL(const SkyboxFaces& faces, IBLData& ibl) {
+    const std::vector<CubeImage> chain = buildSourceChain(resampleFaces(faces.pixels, faces.width, faces.height, IBL_SOURCE_SIZE));
+    size_t shLevel = 0;
+    while (chain[shLevel].size > SH_SOURCE_SIZE) shLevel++;
+    projectIrradianceSH(chain[shLevel], ibl.sh);
+    prefilterSpecular(chain, ibl);
+    integrateBRDF(ibl.brdfLut);
+}
+/// Image based lighting bake ---- (end)
+
+
+/// Image based lighting textures ---- (start)
+GLuint createSkyboxCubemap(const SkyboxFaces& faces) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < 6; i++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, faces.width, faces.height, 0, GL_RGB, GL_UNSIGNED_BYTE, faces.pixels[i]);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+// Every mip is uploaded explicitly : glGenerateMipmap would box-filter away the roughness stored per level.
+GLuint createPrefilteredCubemap(const IBLData& ibl) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    for (int mip = 0; mip < PREFILTER_MIPS; mip++) {
+        const CubeImage& level = ibl.prefiltered[mip];
+        for (int face = 0; face < 6; face++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mip, GL_RGB16F, level.size, level.size, 0, GL_RGB, GL_FLOAT, level.faces[face].data());
+        }
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, PREFILTER_MIPS - 1);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+GLuint createBrdfLutTexture(const IBLData& ibl) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, BRDF_LUT_SIZE, BRDF_LUT_SIZE, 0, GL_RG, GL_FLOAT, ibl.brdfLut.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+/// Image based lighting textures ---- (end)
+
+
+/// shaders --------- (Start)
+const char* sceneVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model, view, projection;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = aTexCoord;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+
+)";
+
+const char* sceneFragmentShaderSource = R"(
+#version 410 core
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float innerCutOff;
+    float outerCutOff;
+    float constant;
+    float linear;
+    float quadratic;
+    float range;
+};
+
+struct PointLight {
+    vec3 position;
+    vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+    float radius;
+};
+
+uniform SpotLight cameraLight;
+uniform PointLight pointLight[3];
+uniform vec3 viewPos;
+uniform Material material;
+uniform int isCameraLightOn;
+uniform float time;
+
+// Image based ambient
+uniform int useIBL;
+uniform vec3 shIrradiance[9];     // cosine-convolved sky, basis constants folded in on the CPU
+uniform samplerCube prefilteredEnv;
+uniform sampler2D brdfLut;
+uniform float prefilteredMaxLod;
+
+// Per-object light list built on the CPU : only these point lights can reach this draw
+uniform int objectLightCount;
+uniform int objectLights[4];
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+out vec4 FragColor;
+
+float attenuate(float distance, float constant, float linear, float quadratic) {
+    return 1.0 / (constant + linear * distance + quadratic * distance * distance);
+}
+
+// Fades the light to exactly zero at its radius so culling it beyond that distance changes nothing.
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+vec3 calPointLightEffect(PointLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.radius);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+vec3 calSpotLightEffect(SpotLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon , 0.0, 1.0);
+
+    if(intensity <= 0) return vec3(0.0);
+
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.range);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff    = max(dot(norm, lightDir), 0.0);
+    vec3  diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + (diffuse + specular) * intensity) * attenuation;
+}
+
+vec3 irradianceSH(vec3 n) {
+    return shIrradiance[0]
+         + shIrradiance[1] * n.y + shIrradiance[2] * n.z + shIrradiance[3] * n.x
+         + shIrradiance[4] * (n.x * n.y) + shIrradiance[5] * (n.y * n.z) + shIrradiance[6] * (3.0 * n.z * n.z - 1.0)
+         + shIrradiance[7] * (n.x * n.z) + shIrradiance[8] * (n.x * n.x - n.y * n.y);
+}
+
+// Diffuse from the SH polynomial, specular from the prefiltered mip matching the Blinn-Phong lobe width,
+// scaled by the split-sum BRDF for a dielectric F0 of 0.04.
+vec3 ambientIBL(vec3 norm, vec3 viewDir, vec3 albedo) {
+    float roughness = sqrt(2.0 / (material.shininess + 2.0));
+    float nDotV = max(dot(norm, viewDir), 0.0);
+    vec3 prefiltered = textureLod(prefilteredEnv, reflect(-viewDir, norm), roughness * prefilteredMaxLod).rgb;
+    vec2 brdf = texture(brdfLut, vec2(nDotV, roughness)).rg;
+    vec3 diffuse = max(irradianceSH(norm), vec3(0.0)) * albedo;
+    return diffuse + prefiltered * (0.04 * brdf.x + brdf.y) * material.specular;
+}
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec4 texColor = texture(material.diffuseTex, TexCoord);
+
+    vec3 result = useIBL == 1 ? ambientIBL(norm, viewDir, texColor.rgb) : 0.1 * texColor.rgb;
+    if (isCameraLightOn == 1) {
+        result += calSpotLightEffect(cameraLight, norm, viewDir) * texColor.rgb;
+    }
+
+    for (int i = 0; i < objectLightCount; i++) {
+        result += calPointLightEffect(pointLight[objectLights[i]], norm, viewDir) * texColor.rgb;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+const char* lightCubeVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+uniform mat4 model, view, projection;
+void main(){
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+})";
+
+const char* lightCubeFS = R"(
+#version 410 core
+uniform vec3 emissiveColor;
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(emissiveColor, 1.0);
+})";
+
+// Drawn last on the unit cube with the translation stripped from the view, at the far plane (z = w)
+const char* skyboxVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+out vec3 TexCoord;
+uniform mat4 view, projection;
+void main(){
+    TexCoord = aPos;
+    gl_Position = (projection * mat4(mat3(view)) * vec4(aPos, 1.0)).xyww;
+})";
+
+const char* skyboxFS = R"(
+#version 410 core
+in vec3 TexCoord;
+uniform samplerCube skybox;
+out vec4 FragColor;
+void main(){
+    FragColor = texture(skybox, TexCoord);
+})";
+/// shaders --------- (End)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* sceneShader = nullptr;
+Shader* lightingShader = nullptr;
+Shader* skyboxShader = nullptr;
+Texture* defaultTexture = nullptr;
+
+std::vector<SceneObject> sceneObjects;
+SpotLight cameraLight(glm::vec3(0.0f), glm::vec3(0.0f,0.0f,-1.0f), glm::vec3(1.0f, 1.0f, 1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER);
+
+PointLight pointLights[3] = {
+    { glm::vec3( 0.0f, 8.0f,  0.0f), glm::vec3(1.0f, 0.55f, 0.15f) }, // warm orange
+    { glm::vec3(12.0f, 5.0f, -6.0f), glm::vec3(0.2f, 0.75f, 1.0f ) }, // cool cyan
+    { glm::vec3(-10.0f,7.0f, 10.0f), glm::vec3(1.0f, 0.3f,  0.5f ) }  // pink-red
+};
+
+int WindowWidth, WindowHeight;
+/// Global Objects ------ (End)
+
+
+/// Light culling ------ (start)
+// Sphere vs cone test : true when the sphere can receive light from the spot's outer cone within its range.
+bool sphereInSpotCone(const SpotLight& light, const glm::vec3& center, float radius) {
+    const glm::vec3 v = center - light.position;
+    const float lenSq = glm::dot(v, v);
+    const float along = glm::dot(v, light.dir);
+    if (along > light.range + radius) return false; // beyond the cap
+    if (along < -radius) return false;               // behind the apex
+    // Distance from the sphere centre to the cone's surface, measured perpendicular to it
+    const float across = sqrt(glm::max(lenSq - along * along, 0.0f));
+    const float distToCone = cos(light.outerAngle) * across - sin(light.outerAngle) * along;
+    return distToCone <= radius;
+}
+
+// Gives every object only the lights whose radius reaches its bounding sphere.
+void buildObjectLightLists() {
+    for (auto& obj : sceneObjects) {
+        obj.lightCount = 0;
+        for (int i = 0; i < 3 && obj.lightCount < MAX_LIGHTS_PER_OBJECT; i++) {
+            const float reach = pointLights[i].radius + obj.boundRadius;
+            const glm::vec3 d = pointLights[i].position - obj.boundCenter;
+            if (glm::dot(d, d) < reach * reach) {
+                obj.lightIndices[obj.lightCount++] = i;
+            }
+        }
+        obj.spotLit = bIsCameraLightOn && sphereInSpotCone(cameraLight, obj.boundCenter, obj.boundRadius);
+    }
+}
+/// Light culling ------ (end)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+}
+
+// [ / ] : tighter or looser luminance cutoff, radii follow
+// I : image based ambient on / off
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_I) {
+        bUseIBL = !bUseIBL;
+        std::cout << "Ambient : " << (bUseIBL ? "image based" : "constant 0.1") << std::endl;
+        return;
+    }
+    if (key == GLFW_KEY_LEFT_BRACKET) luminanceCutoff = glm::max(luminanceCutoff * 0.5f, 0.001f);
+    else if (key == GLFW_KEY_RIGHT_BRACKET) luminanceCutoff = glm::min(luminanceCutoff * 2.0f, 0.5f);
+    else return;
+
+    for (auto& light : pointLights) light.updateRadius(luminanceCutoff);
+    cameraLight.updateRange(luminanceCutoff);
+    std::cout << "Luminance cutoff " << luminanceCutoff << " | point radius " << pointLights[0].radius
+              << " | spot range " << cameraLight.range << std::endl;
+}
+
+bool roamFirstLight = false;
+bool roamSecondLight = false;
+bool roamThirdLight = false;
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+    if(glfwGetKey(win, GLFW_KEY_O) == GLFW_PRESS) bIsCameraLightOn = true;
+    if(glfwGetKey(win, GLFW_KEY_P) == GLFW_PRESS) bIsCameraLightOn = false;
+
+    if(glfwGetKey(win, GLFW_KEY_1) == GLFW_PRESS) {
+        roamFirstLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_2) == GLFW_PRESS) {
+        roamSecondLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_3) == GLFW_PRESS) {
+        roamThirdLight = true;
+    } else {
+        roamFirstLight = false;
+        roamSecondLight = false;
+        roamThirdLight = false;
+    }
+}
+/// Callbacks ----- (End)
+
+
+int main() {
+    // Bake (or load) before the window exists : none of it needs a GL context, so it is timed on its own
+    const std::vector<std::string> facePaths = {
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/right.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/left.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/top.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/bottom.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/front.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/back.jpg"
+    };
+    std::vector<std::vector<unsigned char>> faceFiles(6);
+    for (int i = 0; i < 6; i++) {
+        if (!readFileBytes(facePaths[i], faceFiles[i])) {
+            std::cout << "Failed to read " << facePaths[i] << std::endl;
+            return -1;
+        }
+    }
+    SkyboxFaces skyboxFaces;
+    if (!decodeSkybox(faceFiles, skyboxFaces)) {
+        std::cout << "Failed to decode the skybox faces" << std::endl;
+        return -1;
+    }
+
+    IBLData ibl;
+    const uint64_t iblKey = iblCacheKey(faceFiles);
+    const auto bakeStart = std::chrono::high_resolution_clock::now();
+    if (loadIBLCache(iblKey, ibl)) {
+        std::cout << "IBL loaded from " << iblCachePath(iblKey) << " in "
+                  << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - bakeStart).count() << " ms" << std::endl;
+    } else {
+        bakeIBL(skyboxFaces, ibl);
+        saveIBLCache(iblKey, ibl);
+        std::cout << "IBL baked on " << std::max(1u, std::thread::hardware_concurrency()) << " threads in "
+                  << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - bakeStart).count() << " ms" << std::endl;
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Image Based Lighting", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+    WindowWidth = mode->width;
+    WindowHeight = mode->height;
+
+    lastX = static_cast<float>(WindowWidth) / 2.0f;
+    lastY = static_cast<float>(WindowHeight) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+    // Lets the rough mips filter across face edges instead of showing the cube seams
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    setupCubeVAO();
+    defaultTexture = new Texture();
+    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentShaderSource);
+    lightingShader = new Shader(lightCubeVS, lightCubeFS);
+    skyboxShader = new Shader(skyboxVS, skyboxFS);
+
+    const GLuint skyboxTexture = createSkyboxCubemap(skyboxFaces);
+    const GLuint prefilteredTexture = createPrefilteredCubemap(ibl);
+    const GLuint brdfLutTexture = createBrdfLutTexture(ibl);
+
+    // Constant for the whole run : set once
+    sceneShader->use();
+    sceneShader->setVec3Array("shIrradiance", ibl.sh, 9);
+    sceneShader->setInt("prefilteredEnv", 1);
+    sceneShader->setInt("brdfLut", 2);
+    sceneShader->setFloat("prefilteredMaxLod", static_cast<float>(PREFILTER_MIPS - 1));
+    skyboxShader->use();
+    skyboxShader->setInt("skybox", 0);
+    camera = new Camera();
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_real_distribution<float> rPos(-15.0f, 15.0f), rRot(-1.5f,1.5f);
+    std::uniform_int_distribution<int> rMat(0,4);
+
+    for(int i = 0; i < NUM_CUBES; i++){
+        float scale = 0.6f + (i%5)*0.1f;
+        sceneObjects.emplace_back(glm::vec3(rPos(gen), rPos(gen)*0.3f+1.0f, rPos(gen)),scale, rMat(gen), rRot(gen));
+    }
+
+    auto lastTime = std::chrono::high_resolution_clock::now();
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+
+        float time = static_cast<float>(glfwGetTime());
+        processInput(window, dt);
+
+        // --- Animate point lights ---
+        // [0] orbits horizontally around scene centre
+        pointLights[0].position.x = 8.0f * sin(time * 0.3f);
+        pointLights[0].position.z = 8.0f * cos(time * 0.3f);
+        pointLights[0].position.y = 7.0f + sin(time * 0.5f) * 1.5f;
+
+        // [1] bobs up and down on the right side
+        pointLights[1].position.y = 5.0f + sin(time * 0.7f) * 3.0f;
+        pointLights[1].position.x = 10.0f * cos(time * 0.2f);
+
+        // [2] sweeps front-back on the left side
+        pointLights[2].position.z = 8.0f * sin(time * 0.4f);
+        pointLights[2].position.y = 6.0f + cos(time * 0.6f) * 2.0f;
+
+        if (roamFirstLight) {
+            camera->position = pointLights[0].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamSecondLight) {
+            camera->position = pointLights[1].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamThirdLight) {
+            camera->position = pointLights[2].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        }
+
+        // --- Animate camera lights ---
+        cameraLight.position = camera->position;
+        cameraLight.dir = camera->front;
+
+        // --- Clear ---
+        glClearColor(0.04f, 0.04f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 proj = camera->getProjectionMatrix(static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight));
+        glm::mat4 view = camera->getViewMatrix();
+
+        sceneShader->use();
+        sceneShader->setMat4("projection", proj);
+        sceneShader->setMat4("view", view);
+        sceneShader->setVec3("viewPos", camera->position);
+
+        sceneShader->setVec3("cameraLight.position", cameraLight.position);
+        sceneShader->setVec3("cameraLight.direction", cameraLight.dir);
+        sceneShader->setVec3 ("cameraLight.color", cameraLight.color);
+        sceneShader->setFloat("cameraLight.innerCutOff", cameraLight.innerCutoff);
+        sceneShader->setFloat("cameraLight.outerCutOff", cameraLight.outerCutoff);
+        sceneShader->setFloat("cameraLight.constant", cameraLight.constant);
+        sceneShader->setFloat("cameraLight.linear", cameraLight.linear);
+        sceneShader->setFloat("cameraLight.quadratic", cameraLight.quadratic);
+        sceneShader->setFloat("cameraLight.range", cameraLight.range);
+
+        for(int i = 0; i < 3; i++){
+            std::string b = "pointLight[" + std::to_string(i) + "].";
+            sceneShader->setVec3 ((b+"position").c_str(), pointLights[i].position);
+            sceneShader->setVec3 ((b+"color").c_str(), pointLights[i].color);
+            sceneShader->setFloat((b+"constant").c_str(), pointLights[i].constant);
+            sceneShader->setFloat((b+"linear").c_str(), pointLights[i].linear);
+            sceneShader->setFloat((b+"quadratic").c_str(), pointLights[i].quadratic);
+            sceneShader->setFloat((b+"radius").c_str(), pointLights[i].radius);
+        }
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+        sceneShader->setInt("material.diffuseTex", 0);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilteredTexture);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, brdfLutTexture);
+        sceneShader->setInt("useIBL", bUseIBL ? 1 : 0);
+
+        simClockAdvance(&simClock, dt);
+        while (simClockStep(&simClock)) {
+            for(auto& obj : sceneObjects){
+                obj.update(static_cast<float>(simClock.tickSeconds));
+            }
+        }
+        const float alpha = simClockAlpha(&simClock);
+        for(auto& obj : sceneObjects){
+            obj.interpolate(alpha);
+        }
+        buildObjectLightLists();
+
+        glBindVertexArray(cubeVAO);
+        for(auto& obj : sceneObjects){
+            sceneShader->setInt("objectLightCount", obj.lightCount);
+            sceneShader->setIntArray("objectLights", obj.lightIndices, MAX_LIGHTS_PER_OBJECT);
+            sceneShader->setInt("isCameraLightOn", obj.spotLit ? 1 : 0);
+            sceneShader->setMat4 ("model", obj.model);
+            sceneShader->setVec3 ("material.specular", materials[obj.matId].specular);
+            sceneShader->setFloat("material.shininess", materials[obj.matId].shininess);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        lightingShader->use();
+        lightingShader->setMat4("projection", proj);
+        lightingShader->setMat4("view", view);
+
+        glBindVertexArray(cubeVAO);
+        for(auto & pointLight : pointLights){
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), pointLight.position);
+            model = glm::scale(model, glm::vec3(0.3f));
+            lightingShader->setMat4("model", model);
+            lightingShader->setVec3("emissiveColor", pointLight.color);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        // Sky last : only pixels nothing else covered pass the depth test
+        glDepthFunc(GL_LEQUAL);
+        skyboxShader->use();
+        skyboxShader->setMat4("projection", proj);
+        skyboxShader->setMat4("view", view);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glDepthFunc(GL_LESS);
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteTextures(1, &skyboxTexture);
+    glDeleteTextures(1, &prefilteredTexture);
+    glDeleteTextures(1, &brdfLutTexture);
+    delete sceneShader;
+    delete lightingShader;
+    delete skyboxShader;
+    delete defaultTexture;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}
\ No newline at end of file
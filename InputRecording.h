@@ -0,0 +1,246 @@
+// Input recording and replay : every frame's duration, the state of the keys a demo polls, the cursor and scroll
+// movement and the RNG seed go to a small binary file, and a replay feeds them back through the same camera code
+// in a hidden window. A replayed run takes the same path through the scene every time, so it can be used as a benchmark.
+//
+//   --record <file>   play normally and record
+//   --replay <file>   hidden window at the recorded size, no vsync, quits when the recording ends and prints timings
+//
+// Each frame the demo calls inputRecordingNextFrame() and drives its camera, clocks and toggles only from the returned
+// frame. Toggles (pause, quality switches...) are polled keys too and act on inputKeyPressed(), not in key callbacks.
+//
+// Determinism check : the demo passes its camera to inputRecordingTrack() every frame and inputRecordingFinish() prints
+// a checksum of the whole path. Recording a run and replaying it any number of times must print the same checksum.
+//
+// File : InputFileHeader, then one InputFrame per frame, native byte order (little endian on every target we build).
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+constexpr char INPUT_FILE_MAGIC[4] = {'O', 'G', 'L', 'R'};
+constexpr uint32_t INPUT_FILE_VERSION = 1;
+/// Keys one recording can hold, one bit each
+constexpr int INPUT_MAX_KEYS = 32;
+
+enum InputMode { INPUT_LIVE, INPUT_RECORD, INPUT_REPLAY };
+
+struct InputFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t seed;
+    int32_t width;
+    int32_t height;
+};
+
+struct InputFrame {
+    float frameSeconds;
+    uint32_t keys;        // bit i = the demo's i-th polled key was down
+    float cursorDeltaX;   // right
+    float cursorDeltaY;   // up
+    float scrollDelta;
+};
+
+struct InputRecording {
+    InputMode mode = INPUT_LIVE;
+    uint32_t seed = 0;
+    int width = 0;    // replay : size of the recorded window
+    int height = 0;
+    double time = 0.0;   // sum of all frame durations so far, what the demo should animate from
+    std::ofstream out;
+    std::vector<InputFrame> frames;
+    size_t next = 0;
+    // Cursor and scroll movement reported by callbacks since the last frame
+    float pendingCursorX = 0.0f;
+    float pendingCursorY = 0.0f;
+    float pendingScroll = 0.0f;
+    std::chrono::steady_clock::time_point replayStart;
+    // Key masks of the current and the previous frame, for inputKeyPressed
+    uint32_t keys = 0;
+    uint32_t previousKeys = 0;
+    // FNV-1a hash of everything passed to inputRecordingTrack
+    uint64_t pathHash = 14695981039346656037ull;
+};
+
+/// Picks the mode from the command line and the seed. Replays load the whole file here. A recording file that cannot
+/// be created is reported and the demo runs on live input.
+/// @param recording Recording
+/// @param argc Argument count
+/// @param argv Arguments
+/// @return False if a replay file could not be read
+inline bool inputRecordingOpen(InputRecording* recording, int argc, char** argv) {
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--record") == 0) { recordPath = argv[++i]; }
+        else if (std::strcmp(argv[i], "--replay") == 0) { replayPath = argv[++i]; }
+    }
+
+    if (replayPath) {
+        std::ifstream in(replayPath, std::ios::binary);
+        InputFileHeader header{};
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!in || std::memcmp(header.magic, INPUT_FILE_MAGIC, 4) != 0 || header.version != INPUT_FILE_VERSION) {
+            std::cout << "Not a version " << INPUT_FILE_VERSION << " input recording : " << replayPath << std::endl;
+            return false;
+        }
+        InputFrame frame{};
+        while (in.read(reinterpret_cast<char*>(&frame), sizeof(frame))) { recording->frames.push_back(frame); }
+        recording->mode = INPUT_REPLAY;
+        recording->seed = header.seed;
+        recording->width = header.width;
+        recording->height = header.height;
+        std::cout << "Replaying " << recording->frames.size() << " frames from " << replayPath << std::endl;
+        return true;
+    }
+
+    recording->seed = std::random_device{}();
+    if (recordPath) {
+        recording->out.open(recordPath, std::ios::binary);
+        if (!recording->out) {
+            std::cout << "Cannot create input recording " << recordPath << ", running on live input" << std::endl;
+            return true;
+        }
+        recording->mode = INPUT_RECORD;
+        std::cout << "Recording input to " << recordPath << std::endl;
+    }
+    return true;
+}
+
+/// Window hints for the mode, call before glfwCreateWindow. Replays run in a hidden window.
+/// @param recording Recording
+inline void inputRecordingWindowHints(const InputRecording* recording) {
+    if (recording->mode == INPUT_REPLAY) { glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); }
+}
+
+/// Starts the run once the window exists : writes the header when recording, drops vsync when replaying
+/// @param recording Recording
+/// @param width Window width
+/// @param height Window height
+inline void inputRecordingBegin(InputRecording* recording, int width, int height) {
+    if (recording->mode == INPUT_RECORD) {
+        InputFileHeader header{};
+        std::memcpy(header.magic, INPUT_FILE_MAGIC, 4);
+        header.version = INPUT_FILE_VERSION;
+        header.seed = recording->seed;
+        header.width = width;
+        header.height = height;
+        recording->out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    if (recording->mode == INPUT_REPLAY) {
+        glfwSwapInterval(0);
+        recording->replayStart = std::chrono::steady_clock::now();
+    }
+}
+
+/// Cursor movement from a cursor callback, ignored while replaying
+inline void inputRecordingAddCursor(InputRecording* recording, float deltaX, float deltaY) {
+    if (recording->mode == INPUT_REPLAY) { return; }
+    recording->pendingCursorX += deltaX;
+    recording->pendingCursorY += deltaY;
+}
+
+/// Scroll movement from a scroll callback, ignored while replaying
+inline void inputRecordingAddScroll(InputRecording* recording, float delta) {
+    if (recording->mode == INPUT_REPLAY) { return; }
+    recording->pendingScroll += delta;
+}
+
+/// Polls the keys a demo records
+/// @param window Window
+/// @param keys GLFW key codes, at most INPUT_MAX_KEYS
+/// @param count Number of keys
+/// @return Bit mask, bit i = keys[i] is down
+inline uint32_t inputPollKeys(GLFWwindow* window, const int* keys, int count) {
+    uint32_t mask = 0;
+    for (int i = 0; i < count && i < INPUT_MAX_KEYS; i++) {
+        if (glfwGetKey(window, keys[i]) == GLFW_PRESS) { mask |= 1u << i; }
+    }
+    return mask;
+}
+
+/// Whether a key was down in a frame
+/// @param frame Frame
+/// @param keys The key list given to inputPollKeys
+/// @param count Number of keys
+/// @param key GLFW key code
+inline bool inputKeyDown(const InputFrame* frame, const int* keys, int count, int key) {
+    for (int i = 0; i < count && i < INPUT_MAX_KEYS; i++) {
+        if (keys[i] == key) { return (frame->keys >> i) & 1u; }
+    }
+    return false;
+}
+
+/// Whether a key went down this frame, for toggles. Uses the frame last returned by inputRecordingNextFrame.
+/// @param recording Recording
+/// @param keys The key list given to inputPollKeys
+/// @param count Number of keys
+/// @param key GLFW key code
+inline bool inputKeyPressed(const InputRecording* recording, const int* keys, int count, int key) {
+    for (int i = 0; i < count && i < INPUT_MAX_KEYS; i++) {
+        if (keys[i] == key) { return ((recording->keys & ~recording->previousKeys) >> i) & 1u; }
+    }
+    return false;
+}
+
+/// Produces this frame's input : the live input (saved when recording) or the next recorded frame
+/// @param recording Recording
+/// @param liveSeconds Measured duration of the last frame
+/// @param liveKeys Key mask from inputPollKeys
+/// @param frame Receives the frame
+/// @return False once a replay has run out of frames
+inline bool inputRecordingNextFrame(InputRecording* recording, float liveSeconds, uint32_t liveKeys, InputFrame* frame) {
+    if (recording->mode == INPUT_REPLAY) {
+        if (recording->next == recording->frames.size()) { return false; }
+        *frame = recording->frames[recording->next++];
+    } else {
+        *frame = {liveSeconds, liveKeys, recording->pendingCursorX, recording->pendingCursorY, recording->pendingScroll};
+        if (recording->mode == INPUT_RECORD) { recording->out.write(reinterpret_cast<const char*>(frame), sizeof(*frame)); }
+    }
+    recording->pendingCursorX = 0.0f;
+    recording->pendingCursorY = 0.0f;
+    recording->pendingScroll = 0.0f;
+    recording->previousKeys = recording->keys;
+    recording->keys = frame->keys;
+    recording->time += frame->frameSeconds;
+    return true;
+}
+
+/// Folds this frame's camera into the path checksum
+/// @param recording Recording
+/// @param values Camera state, position and orientation
+/// @param count Number of values
+inline void inputRecordingTrack(InputRecording* recording, const float* values, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        for (int b = 0; b < 4; b++) {
+            recording->pathHash ^= (bits >> (b * 8)) & 0xFFu;
+            recording->pathHash *= 1099511628211ull;
+        }
+    }
+}
+
+/// Closes the file, or reports how long the replay took, and prints the camera path checksum
+/// @param recording Recording
+inline void inputRecordingFinish(InputRecording* recording) {
+    if (recording->mode != INPUT_LIVE) {
+        std::cout << "Camera path checksum " << std::hex << recording->pathHash << std::dec << std::endl;
+    }
+    if (recording->mode == INPUT_RECORD) {
+        recording->out.close();
+        std::cout << "Input recording closed" << std::endl;
+    }
+    if (recording->mode == INPUT_REPLAY && recording->next > 0) {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - recording->replayStart).count();
+        std::cout << "Replayed " << recording->next << " frames (" << recording->time << " s recorded) in " << seconds
+                  << " s : " << seconds * 1000.0 / static_cast<double>(recording->next) << " ms per frame, "
+                  << static_cast<double>(recording->next) / seconds << " fps" << std::endl;
+    }
+}
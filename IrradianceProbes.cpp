@@ -0,0 +1,1291 @@
+// Irradiance probe grid : the MultipleLights cubes on a floor, with the constant ambient terms (0.1 * texColor and
+// the 0.05 * light.color per light) replaced by indirect light read from a 3D grid of L2 spherical-harmonic probes.
+// Every probe shoots rays into a CPU copy of the scene, shades what they hit with the point lights and projects
+// the result onto 9 SH coefficients, stored across seven RGBA16F 3D textures and sampled trilinearly.
+// The whole grid is baked across all cores at startup; afterwards only the probes the moving lights made stale
+// are re-sampled, most stale first, for at most PROBE_BUDGET_MS per frame.
+//
+// G toggles probe / constant ambient, U freezes the probe updates.
+
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "FixedTimestep.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+/// Defining Globals variable ---- (start)
+/// Rendering
+constexpr int NUM_CUBES = 64;
+
+/// Simulation
+/// SceneObject spin speeds are given in degrees per frame at this rate, they turn at rotSpeed * 60 degrees per second
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+/// Cube spin advances in fixed ticks, so it turns at the same speed and costs the same work at any frame rate
+SimulationClock simClock;
+
+/// Camera
+constexpr float CAMERA_SPEED = 4.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// SpotLight
+constexpr float SPOT_LIGHT_INNER = 15.0f;
+constexpr float SPOT_LIGHT_OUTER = 30.0f;
+
+/// Light culling
+/// A light stops at the distance where its luminance falls below this value ([ and ] halve / double it)
+constexpr float DEFAULT_LUMINANCE_CUTOFF = 0.02f;
+/// Upper bound on point lights a single draw evaluates, must match objectLights[] in the fragment shader
+constexpr int MAX_LIGHTS_PER_OBJECT = 4;
+float luminanceCutoff = DEFAULT_LUMINANCE_CUTOFF;
+
+/// Irradiance probes
+/// Grid over the scene bounds, probes on its corners : x fastest, then y, then z (same as the 3D textures)
+constexpr int PROBE_DIM_X = 10;
+constexpr int PROBE_DIM_Y = 4;
+constexpr int PROBE_DIM_Z = 10;
+constexpr int PROBE_COUNT = PROBE_DIM_X * PROBE_DIM_Y * PROBE_DIM_Z;
+const glm::vec3 PROBE_GRID_MIN(-18.0f, -3.5f, -18.0f);
+const glm::vec3 PROBE_GRID_MAX( 18.0f,  9.0f,  18.0f);
+/// Rays per probe sample, spread over the sphere on a Fibonacci spiral
+constexpr int PROBE_RAYS = 192;
+/// 27 SH floats packed four per texel
+constexpr int PROBE_TEXTURES = 7;
+/// Wall-clock time the incremental update may spend per frame (all threads together)
+constexpr float PROBE_BUDGET_MS = 1.0f;
+/// Probes less stale than this are left alone
+constexpr float PROBE_STALE_THRESHOLD = 0.002f;
+/// Radiance of rays that escape the scene : the clear colour
+const glm::vec3 SKY_RADIANCE(0.04f, 0.04f, 0.08f);
+bool bUseProbes = true;
+bool bUpdateProbes = true;
+
+/// Turn off or on spotlight
+bool bIsCameraLightOn = true;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 0.0f, 5.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() = default;
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    // deltaX → yaw  (left/right look)
+    // deltaY → pitch (up/down look)
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe  (-1 = left,    +1 = right)
+    // dir.z : forward (-1 = back,    +1 = forward)
+    // dir.y : vertical(-1 = down,    +1 = up)
+    // dir.y uses world Y (0,1,0) not camera up — so Space always goes straight up in world space regardless of where camera is looking.
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    // Transforms world-space coordinates into camera-space.
+    // (position + front) is the target point — direction matters, not distance.
+    // [[nodiscard]] — ignoring this return value is always a bug.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    // aspectRatio = window width / height — pass every frame in case of resize.
+    // FOV, NEAR_PLANE, FAR_PLANE are global constexpr constants, Zoom is not implemented here.
+    // [[nodiscard]] — ignoring this return value is always a bug.
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(FOV, aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles vertex and fragment shader from raw GLSL source strings, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource) {
+        // Local lambda — compiles a single shader stage and reports errors. Defined here because it is only needed during construction.
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a float uniform (shininess, attenuation values, time, etc.).
+    void setFloat(const char* uniform, const float val) const {
+        glUniform1f(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int array uniform (per-object light index lists).
+    void setIntArray(const char* uniform, const int* vals, const int count) const {
+        glUniform1iv(glGetUniformLocation(ProgramID, uniform), count, vals);
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Creating procedural texture ------------------ (start)
+class Texture {
+public:
+    // OpenGL texture handle — 0 = invalid/uninitialized
+    GLuint TextureID = 0;
+    // Mean of all texels, the albedo the probe rays see when they hit a cube
+    glm::vec3 averageColor{0.0f};
+    Texture() {
+        glGenTextures(1, &TextureID);
+        glBindTexture(GL_TEXTURE_2D, TextureID);
+
+        // Texture dimensions — 256x256 pixels.
+        constexpr int size = 256;
+
+        // Allocate CPU-side pixel buffer.
+        // sz*sz = total pixels, *4 = RGBA (red, green, blue, alpha channels).
+        // Each channel is 1 byte (0-255), so total = 256*256*4 = 262144 bytes.
+        auto* data = new unsigned char[size * size * 4];
+
+        // Fill every pixel with a procedural pattern.
+        // No image file needed — the pattern is computed mathematically.
+        for (int y = 0 ; y < size ; y++) {
+            for (int x = 0 ; x < size ; x++) {
+                // Normalize pixel coordinates to 0.0 - 1.0 range.
+                // fx=0.0 at left edge, fx=1.0 at right edge (same for fy vertically)
+                const float fx = static_cast<float>(x) / size;
+                const float fy = static_cast<float>(y) / size;
+
+                // Noise value — drives the mix between R and G channels.
+                // sin() oscillates between -1 and +1, *0.5+0.5 shifts to 0.0-1.0.
+                // High frequency (20, 10) creates a fine diagonal stripe pattern.
+                float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+
+                // Calculate flat array index for this pixel.
+                // Each pixel takes 4 consecutive bytes: [R, G, B, A]
+                // Row y starts at y*sz, pixel x is at offset x, times 4 bytes each.
+                const int i = (y * size + x) * 4;
+
+                // RED channel — sin wave scaled to 0-255, fades with noise n.
+                // When n=1.0 → full red contribution
+                // When n=0.0 → red is zero
+                data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+
+                // GREEN channel — cos wave scaled to 0-255, fades opposite to red.
+                // (1-n) means green is bright where red is dark and vice versa.
+                // Creates a complementary color shift across the texture.
+                data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+
+                // BLUE channel — independent sin wave, not affected by noise n.
+                // Adds a third color variation layer across the texture.
+                data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+
+                // ALPHA channel — fully opaque, no transparency.
+                data[i+3] = 255;
+
+                averageColor += glm::vec3(data[i+0], data[i+1], data[i+2]) / 255.0f;
+            }
+        }
+        averageColor /= static_cast<float>(size * size);
+
+        // Upload the pixel data from CPU memory to GPU texture memory.
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+        // Auto-generate all mipmap levels from the base image just uploaded
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // Delete CPU side array
+        delete[] data;
+
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    }
+};
+
+/// Creating procedural texture ------------------ (end)
+
+
+
+/// Light structs --------- (Start)
+// Distance at which the light's luminance, attenuated, drops to the cutoff.
+// Solves quadratic*d^2 + linear*d + constant = luminance / cutoff for d.
+float attenuationRadius(const glm::vec3& color, float constant, float linear, float quadratic, float cutoff) {
+    const float luminance = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    const float c = constant - luminance / cutoff;
+    if (c >= 0.0f) return 0.0f; // never bright enough to pass the cutoff
+    return (-linear + sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
+struct PointLight {
+    glm::vec3 position, color;
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+    float radius = 0.0f;
+
+    PointLight(glm::vec3 p, glm::vec3 c) : position(p), color(c) {
+        updateRadius(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRadius(float cutoff) {
+        radius = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
+};
+
+struct SpotLight {
+    glm::vec3 position, dir, color;
+    float innerCutoff, outerCutoff;
+    float outerAngle; // radians, used by the cone vs bounds test
+    float constant = 1.0f;
+    float linear = 0.07f;
+    float quadratic = 0.017f;
+    float range = 0.0f;
+
+    SpotLight(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer)
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))), outerAngle(glm::radians(outer)) {
+        updateRange(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRange(float cutoff) {
+        range = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
+};
+/// Light structs --------- (end)
+
+
+/// Material ------ (start)
+struct Material { glm::vec3 specular; float shininess; };
+
+Material materials[6] = {
+    {{1.0f,1.0f,1.0f}, 32.0f},
+    {{1.0f,1.0f,1.0f}, 64.0f},
+    {{1.0f,1.0f,1.0f}, 128.0f},
+    {{1.0f,1.0f,1.0f}, 256.0f},
+    {{0.9f,0.9f,0.9f}, 512.0f},
+    {{0.4f,0.9f,0.4f}, 1028.0f}
+};
+
+/// Material ------ (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVAO = 0;
+
+float cubeData[288] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
+     0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,  -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,  -0.5f, 0.5f,-0.5f, 0,0,-1, 0,1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,   0.5f,-0.5f, 0.5f, 0,0, 1, 1,0,   0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,
+     0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,  -0.5f, 0.5f, 0.5f, 0,0, 1, 0,1,  -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,
+    -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f,-0.5f,-1,0, 0, 1,1,
+    -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f, 0.5f,-1,0, 0, 0,0,
+     0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f,-0.5f, 1,0, 0, 1,1,
+     0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f, 0.5f, 1,0, 0, 0,0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,   0.5f,-0.5f,-0.5f, 0,-1,0, 1,1,   0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0, 0,0,  -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,
+    -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,   0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0, 1,1,
+     0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,  -0.5f, 0.5f, 0.5f, 0, 1,0, 0,0
+};
+
+void setupCubeVAO() {
+    unsigned int VBO;
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // uv
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+/// Cube vertex data ------------- (end)
+
+/// Scene objects ---- (start)
+class SceneObject {
+public:
+    glm::mat4 model{};
+    int matId;
+    float rotSpeed;
+
+    // Bounding sphere of the box : rotation about the centre never changes it
+    glm::vec3 boundCenter;
+    float boundRadius;
+
+    // Lights that reach this object, rebuilt every frame by buildObjectLightLists()
+    int lightIndices[MAX_LIGHTS_PER_OBJECT] = {};
+    int lightCount = 0;
+    bool spotLit = false;
+
+    // Translation and scale, the spin is applied on top
+    glm::mat4 base{};
+    // Spin in degrees at the latest and the previous simulation tick
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObject(glm::vec3 pos, glm::vec3 scale, int mat, float rot) : matId(mat), rotSpeed(rot), boundCenter(pos), boundRadius(glm::length(scale) * 0.5f) {
+        base = glm::scale(glm::translate(glm::mat4(1.0f), pos), scale);
+        model = base;
+    }
+
+    // One simulation tick
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        // Keep the angle small so it does not lose precision over a long run, both move so the blend is unchanged
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    // Model matrix between the previous and the latest tick
+    void interpolate(float alpha) {
+        model = glm::rotate(base, glm::radians(previousAngle + (angle - previousAngle) * alpha), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+/// Scene objects ---- (end)
+
+
+/// Irradiance probes ---- (start)
+struct IrradianceProbe {
+    glm::vec3 position;
+    glm::vec3 sh[9];              // irradiance / PI, basis constants folded in
+    glm::vec3 bakedLightPos[3];   // point light positions the last sample saw
+};
+
+// Everything a probe job reads, copied on the main thread before the jobs start so the workers never see the
+// scene change under them.
+struct SceneSnapshot {
+    struct Box {
+        glm::mat4 worldToObject;
+        glm::mat3 normalToWorld;
+        glm::vec3 albedo;
+        glm::vec3 boundCenter;
+        float boundRadius;
+    };
+    std::vector<Box> boxes;
+    std::vector<PointLight> lights;
+};
+
+// Ray directions and their 9 SH basis values, shared by every probe.
+struct ProbeRays {
+    glm::vec3 dir[PROBE_RAYS];
+    float basis[PROBE_RAYS][9];
+
+    ProbeRays() {
+        const float goldenAngle = glm::pi<float>() * (3.0f - std::sqrt(5.0f));
+        for (int i = 0; i < PROBE_RAYS; i++) {
+            const float y = 1.0f - (static_cast<float>(i) + 0.5f) * 2.0f / PROBE_RAYS;
+            const float r = std::sqrt(1.0f - y * y);
+            const float phi = goldenAngle * static_cast<float>(i);
+            const glm::vec3 d(r * std::cos(phi), y, r * std::sin(phi));
+            dir[i] = d;
+            basis[i][0] = 0.282095f;
+            basis[i][1] = 0.488603f * d.y;
+            basis[i][2] = 0.488603f * d.z;
+            basis[i][3] = 0.488603f * d.x;
+            basis[i][4] = 1.092548f * d.x * d.y;
+            basis[i][5] = 1.092548f * d.y * d.z;
+            basis[i][6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+            basis[i][7] = 1.092548f * d.x * d.z;
+            basis[i][8] = 0.546274f * (d.x * d.x - d.y * d.y);
+        }
+    }
+};
+
+// Same falloff as the fragment shader, so the bounce light fades out exactly where the direct light does.
+float lightFalloff(const PointLight& light, float distance) {
+    const float ratio = distance / light.radius;
+    const float window = glm::clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+    return window * window / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+}
+
+// Radiance arriving at origin from dir : the closest box, diffusely lit by the point lights (unshadowed),
+// or the sky when nothing is hit.
+glm::vec3 traceRadiance(const SceneSnapshot& scene, const glm::vec3& origin, const glm::vec3& dir) {
+    float closest = FLT_MAX;
+    const SceneSnapshot::Box* hitBox = nullptr;
+    glm::vec3 hitNormal(0.0f);
+    for (const auto& box : scene.boxes) {
+        // Bounding sphere first : most boxes are nowhere near the ray
+        const glm::vec3 toCenter = box.boundCenter - origin;
+        const float along = glm::dot(toCenter, dir);
+        if (along + box.boundRadius < 0.0f || along - box.boundRadius >= closest) continue;
+        if (glm::dot(toCenter, toCenter) - along * along > box.boundRadius * box.boundRadius) continue;
+
+        // Slab test against the unit cube in object space; t stays the world distance since dir keeps its scale there
+        const glm::vec3 o = glm::vec3(box.worldToObject * glm::vec4(origin, 1.0f));
+        const glm::vec3 d = glm::mat3(box.worldToObject) * dir;
+        float tEnter = -FLT_MAX, tExit = FLT_MAX;
+        int enterAxis = 0;
+        bool miss = false;
+        for (int axis = 0; axis < 3 && !miss; axis++) {
+            if (std::abs(d[axis]) < 1e-8f) {
+                miss = std::abs(o[axis]) > 0.5f;
+                continue;
+            }
+            float t0 = (-0.5f - o[axis]) / d[axis];
+            float t1 = ( 0.5f - o[axis]) / d[axis];
+            if (t0 > t1) std::swap(t0, t1);
+            if (t0 > tEnter) { tEnter = t0; enterAxis = axis; }
+            tExit = std::min(tExit, t1);
+            miss = tEnter > tExit;
+        }
+        // Probes buried inside a box see none of it (tEnter < 0), they only pick up what is outside
+        if (miss || tEnter <= 1e-3f || tEnter >= closest) continue;
+        closest = tEnter;
+        hitBox = &box;
+        hitNormal = glm::vec3(0.0f);
+        hitNormal[enterAxis] = d[enterAxis] > 0.0f ? -1.0f : 1.0f;
+    }
+    if (!hitBox) return SKY_RADIANCE;
+
+    const glm::vec3 p = origin + dir * closest;
+    const glm::vec3 n = glm::normalize(hitBox->normalToWorld * hitNormal);
+    glm::vec3 irradiance(0.0f);
+    for (const auto& light : scene.lights) {
+        const glm::vec3 toLight = light.position - p;
+        const float distance = glm::length(toLight);
+        if (distance >= light.radius) continue;
+        irradiance += light.color * std::max(glm::dot(n, toLight / distance), 0.0f) * lightFalloff(light, distance);
+    }
+    return hitBox->albedo * irradiance;
+}
+
+// Monte Carlo SH projection over the fixed ray set, then the clamped cosine convolution per band.
+void sampleProbe(IrradianceProbe& probe, const SceneSnapshot& scene, const ProbeRays& rays) {
+    glm::vec3 acc[9] = {};
+    for (int r = 0; r < PROBE_RAYS; r++) {
+        const glm::vec3 radiance = traceRadiance(scene, probe.position, rays.dir[r]);
+        for (int k = 0; k < 9; k++) acc[k] += radiance * rays.basis[r][k];
+    }
+    // Each ray covers 4 PI / PROBE_RAYS steradians. Cosine lobe per band (PI, 2PI/3, PI/4) over PI, times the
+    // basis constant the shader leaves out.
+    const float weight = 4.0f * glm::pi<float>() / PROBE_RAYS;
+    const float band[9] = {
+        0.282095f,
+        0.488603f * 2.0f / 3.0f, 0.488603f * 2.0f / 3.0f, 0.488603f * 2.0f / 3.0f,
+        1.092548f * 0.25f, 1.092548f * 0.25f, 0.315392f * 0.25f, 1.092548f * 0.25f, 0.546274f * 0.25f
+    };
+    for (int k = 0; k < 9; k++) probe.sh[k] = acc[k] * (weight * band[k]);
+    for (size_t i = 0; i < scene.lights.size() && i < 3; i++) probe.bakedLightPos[i] = scene.lights[i].position;
+}
+
+// Persistent workers for the probe jobs : spawning threads every frame would eat a good part of the budget.
+class JobPool {
+public:
+    explicit JobPool(unsigned workerCount) {
+        for (unsigned i = 0; i < workerCount; i++) threads.emplace_back([this]() { workerLoop(); });
+    }
+
+    ~JobPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    [[nodiscard]] unsigned threadCount() const { return static_cast<unsigned>(threads.size()) + 1; }
+
+    // Runs job(0 .. count-1) on the workers and the calling thread, returns once every job has finished.
+    void run(int count, const std::function<void(int)>& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &job;
+            jobCount = count;
+            next = 0;
+            active = static_cast<int>(threads.size());
+            generation++;
+        }
+        wake.notify_all();
+        drain();
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return active == 0; });
+        current = nullptr;
+    }
+
+private:
+    void drain() {
+        for (int i = next++; i < jobCount; i = next++) (*current)(i);
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return quit || generation != seen; });
+                if (quit) return;
+                seen = generation;
+            }
+            drain();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                active--;
+            }
+            finished.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    const std::function<void(int)>* current = nullptr;
+    int jobCount = 0;
+    std::atomic<int> next{0};
+    int active = 0;
+    uint64_t generation = 0;
+    bool quit = false;
+};
+
+class ProbeGrid {
+public:
+    std::vector<IrradianceProbe> probes;
+    GLuint textures[PROBE_TEXTURES] = {};
+
+    ProbeGrid() : probes(PROBE_COUNT) {
+        const glm::vec3 spacing = (PROBE_GRID_MAX - PROBE_GRID_MIN) / glm::vec3(PROBE_DIM_X - 1, PROBE_DIM_Y - 1, PROBE_DIM_Z - 1);
+        for (int z = 0; z < PROBE_DIM_Z; z++) {
+            for (int y = 0; y < PROBE_DIM_Y; y++) {
+                for (int x = 0; x < PROBE_DIM_X; x++) {
+                    probes[(z * PROBE_DIM_Y + y) * PROBE_DIM_X + x].position = PROBE_GRID_MIN + glm::vec3(x, y, z) * spacing;
+                }
+            }
+        }
+        glGenTextures(PROBE_TEXTURES, textures);
+        for (GLuint texture : textures) {
+            glBindTexture(GL_TEXTURE_3D, texture);
+            glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, PROBE_DIM_X, PROBE_DIM_Y, PROBE_DIM_Z, 0, GL_RGBA, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        }
+    }
+
+    void bakeAll(const SceneSnapshot& scene, JobPool& pool) {
+        pool.run(PROBE_COUNT, [&](int i) { sampleProbe(probes[i], scene, rays); });
+        upload();
+    }
+
+    // Re-samples the stalest probes until the budget runs out, returns how many were refreshed.
+    // Staleness is how far each light moved since the probe last saw it, weighted by how much of that light
+    // reaches the probe : probes next to a moving light go first, far corners catch up when the budget allows.
+    // Rotating cubes are ignored here, their bounce barely changes as they spin about their centre.
+    int updateStale(const SceneSnapshot& scene, JobPool& pool, float budgetMs) {
+        stale.clear();
+        for (int i = 0; i < PROBE_COUNT; i++) {
+            float score = 0.0f;
+            for (size_t l = 0; l < scene.lights.size() && l < 3; l++) {
+                const PointLight& light = scene.lights[l];
+                const float moved = glm::length(light.position - probes[i].bakedLightPos[l]);
+                if (moved <= 0.0f) continue;
+                const float distance = glm::length(light.position - probes[i].position);
+                const float luminance = glm::dot(light.color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+                score += moved * luminance / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+            }
+            if (score > PROBE_STALE_THRESHOLD) stale.emplace_back(score, i);
+        }
+        if (stale.empty()) return 0;
+        std::sort(stale.begin(), stale.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        // Jobs are handed out in priority order; once the deadline passes the remaining ones return untouched
+        // and stay stale for the next frame.
+        const auto deadline = std::chrono::high_resolution_clock::now() + std::chrono::duration<float, std::milli>(budgetMs);
+        std::atomic<int> updated{0};
+        pool.run(static_cast<int>(stale.size()), [&](int job) {
+            if (std::chrono::high_resolution_clock::now() >= deadline) return;
+            sampleProbe(probes[stale[job].second], scene, rays);
+            updated++;
+        });
+        if (updated > 0) upload();
+        return updated;
+    }
+
+    // The whole grid is 400 probes x 28 floats, re-uploading all of it is cheaper than tracking dirty texels.
+    void upload() {
+        packed.resize(static_cast<size_t>(PROBE_TEXTURES) * PROBE_COUNT * 4);
+        for (int i = 0; i < PROBE_COUNT; i++) {
+            for (int k = 0; k < 27; k++) {
+                const int slot = k / 4, channel = k % 4;
+                packed[(static_cast<size_t>(slot) * PROBE_COUNT + i) * 4 + channel] = probes[i].sh[k / 3][k % 3];
+            }
+        }
+        for (int slot = 0; slot < PROBE_TEXTURES; slot++) {
+            glBindTexture(GL_TEXTURE_3D, textures[slot]);
+            glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, PROBE_DIM_X, PROBE_DIM_Y, PROBE_DIM_Z, GL_RGBA, GL_FLOAT,
+                            &packed[static_cast<size_t>(slot) * PROBE_COUNT * 4]);
+        }
+    }
+
+private:
+    ProbeRays rays;
+    std::vector<std::pair<float, int>> stale;
+    std::vector<float> packed;
+};
+/// Irradiance probes ---- (end)
+
+
+/// shaders --------- (Start)
+const char* sceneVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model, view, projection;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = aTexCoord;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+
+)";
+
+const char* sceneFragmentShaderSource = R"(
+#version 410 core
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float innerCutOff;
+    float outerCutOff;
+    float constant;
+    float linear;
+    float quadratic;
+    float range;
+};
+
+struct PointLight {
+    vec3 position;
+    vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+    float radius;
+};
+
+uniform SpotLight cameraLight;
+uniform PointLight pointLight[3];
+uniform vec3 viewPos;
+uniform Material material;
+uniform int isCameraLightOn;
+uniform float time;
+
+// Per-object light list built on the CPU : only these point lights can reach this draw
+uniform int objectLightCount;
+uniform int objectLights[4];
+
+// Probe grid : 27 SH floats packed four per texel across seven 3D textures
+uniform int useProbes;
+uniform sampler3D probeSH[7];
+uniform vec3 probeGridMin;
+uniform vec3 probeGridSize;
+uniform vec3 probeGridDims;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+out vec4 FragColor;
+
+// Constant per-light ambient, only used when the probes are off
+float legacyAmbient() {
+    return useProbes == 1 ? 0.0 : 0.05;
+}
+
+float attenuate(float distance, float constant, float linear, float quadratic) {
+    return 1.0 / (constant + linear * distance + quadratic * distance * distance);
+}
+
+// Fades the light to exactly zero at its radius so culling it beyond that distance changes nothing.
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+// Trilinear lookup between the 8 surrounding probes. The sample point is pushed off the surface along the
+// normal so a face does not pick up the probes sitting behind it.
+vec3 probeIrradiance(vec3 n) {
+    vec3 cell = clamp((FragPos + n * 0.5 - probeGridMin) / probeGridSize, 0.0, 1.0);
+    vec3 uvw = (cell * (probeGridDims - 1.0) + 0.5) / probeGridDims;
+    vec4 t0 = texture(probeSH[0], uvw);
+    vec4 t1 = texture(probeSH[1], uvw);
+    vec4 t2 = texture(probeSH[2], uvw);
+    vec4 t3 = texture(probeSH[3], uvw);
+    vec4 t4 = texture(probeSH[4], uvw);
+    vec4 t5 = texture(probeSH[5], uvw);
+    vec4 t6 = texture(probeSH[6], uvw);
+    vec3 e = t0.rgb
+           + vec3(t0.a, t1.rg) * n.y + vec3(t1.ba, t2.r) * n.z + t2.gba * n.x
+           + t3.rgb * (n.x * n.y) + vec3(t3.a, t4.rg) * (n.y * n.z) + vec3(t4.ba, t5.r) * (3.0 * n.z * n.z - 1.0)
+           + t5.gba * (n.x * n.z) + t6.rgb * (n.x * n.x - n.y * n.y);
+    return max(e, vec3(0.0));
+}
+
+vec3 calPointLightEffect(PointLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.radius);
+
+    vec3 ambient = legacyAmbient() * light.color;
+
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+vec3 calSpotLightEffect(SpotLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon , 0.0, 1.0);
+
+    if(intensity <= 0) return vec3(0.0);
+
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.range);
+
+    vec3 ambient = legacyAmbient() * light.color;
+
+    float diff    = max(dot(norm, lightDir), 0.0);
+    vec3  diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + (diffuse + specular) * intensity) * attenuation;
+}
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec4 texColor = texture(material.diffuseTex, TexCoord);
+
+    vec3 result = useProbes == 1 ? probeIrradiance(norm) * texColor.rgb : 0.1 * texColor.rgb;
+    if (isCameraLightOn == 1) {
+        result += calSpotLightEffect(cameraLight, norm, viewDir) * texColor.rgb;
+    }
+
+    for (int i = 0; i < objectLightCount; i++) {
+        result += calPointLightEffect(pointLight[objectLights[i]], norm, viewDir) * texColor.rgb;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+const char* lightCubeVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+uniform mat4 model, view, projection;
+void main(){
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+})";
+
+const char* lightCubeFS = R"(
+#version 410 core
+uniform vec3 emissiveColor;
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(emissiveColor, 1.0);
+})";
+/// shaders --------- (End)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* sceneShader = nullptr;
+Shader* lightingShader = nullptr;
+Texture* defaultTexture = nullptr;
+
+std::vector<SceneObject> sceneObjects;
+SpotLight cameraLight(glm::vec3(0.0f), glm::vec3(0.0f,0.0f,-1.0f), glm::vec3(1.0f, 1.0f, 1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER);
+
+PointLight pointLights[3] = {
+    { glm::vec3( 0.0f, 8.0f,  0.0f), glm::vec3(1.0f, 0.55f, 0.15f) }, // warm orange
+    { glm::vec3(12.0f, 5.0f, -6.0f), glm::vec3(0.2f, 0.75f, 1.0f ) }, // cool cyan
+    { glm::vec3(-10.0f,7.0f, 10.0f), glm::vec3(1.0f, 0.3f,  0.5f ) }  // pink-red
+};
+
+int WindowWidth, WindowHeight;
+/// Global Objects ------ (End)
+
+
+/// Light culling ------ (start)
+// Sphere vs cone test : true when the sphere can receive light from the spot's outer cone within its range.
+bool sphereInSpotCone(const SpotLight& light, const glm::vec3& center, float radius) {
+    const glm::vec3 v = center - light.position;
+    const float lenSq = glm::dot(v, v);
+    const float along = glm::dot(v, light.dir);
+    if (along > light.range + radius) return false; // beyond the cap
+    if (along < -radius) return false;               // behind the apex
+    // Distance from the sphere centre to the cone's surface, measured perpendicular to it
+    const float across = sqrt(glm::max(lenSq - along * along, 0.0f));
+    const float distToCone = cos(light.outerAngle) * across - sin(light.outerAngle) * along;
+    return distToCone <= radius;
+}
+
+// Gives every object only the lights whose radius reaches its bounding sphere.
+void buildObjectLightLists() {
+    for (auto& obj : sceneObjects) {
+        obj.lightCount = 0;
+        for (int i = 0; i < 3 && obj.lightCount < MAX_LIGHTS_PER_OBJECT; i++) {
+            const float reach = pointLights[i].radius + obj.boundRadius;
+            const glm::vec3 d = pointLights[i].position - obj.boundCenter;
+            if (glm::dot(d, d) < reach * reach) {
+                obj.lightIndices[obj.lightCount++] = i;
+            }
+        }
+        obj.spotLit = bIsCameraLightOn && sphereInSpotCone(cameraLight, obj.boundCenter, obj.boundRadius);
+    }
+}
+/// Light culling ------ (end)
+
+
+/// Probe snapshot ------ (start)
+// Copies the boxes and point lights the probe jobs trace against.
+void takeSceneSnapshot(SceneSnapshot& snapshot, const glm::vec3& albedo) {
+    snapshot.boxes.resize(sceneObjects.size());
+    for (size_t i = 0; i < sceneObjects.size(); i++) {
+        const glm::mat4 worldToObject = glm::inverse(sceneObjects[i].model);
+        snapshot.boxes[i] = {worldToObject, glm::transpose(glm::mat3(worldToObject)), albedo,
+                             sceneObjects[i].boundCenter, sceneObjects[i].boundRadius};
+    }
+    snapshot.lights.assign(std::begin(pointLights), std::end(pointLights));
+}
+/// Probe snapshot ------ (end)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+}
+
+// [ / ] : tighter or looser luminance cutoff, radii follow
+// G : probe / constant ambient, U : freeze probe updates
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_G) {
+        bUseProbes = !bUseProbes;
+        std::cout << "Ambient : " << (bUseProbes ? "irradiance probes" : "constant") << std::endl;
+        return;
+    }
+    if (key == GLFW_KEY_U) {
+        bUpdateProbes = !bUpdateProbes;
+        std::cout << "Probe updates " << (bUpdateProbes ? "on" : "frozen") << std::endl;
+        return;
+    }
+    if (key == GLFW_KEY_LEFT_BRACKET) luminanceCutoff = glm::max(luminanceCutoff * 0.5f, 0.001f);
+    else if (key == GLFW_KEY_RIGHT_BRACKET) luminanceCutoff = glm::min(luminanceCutoff * 2.0f, 0.5f);
+    else return;
+
+    for (auto& light : pointLights) light.updateRadius(luminanceCutoff);
+    cameraLight.updateRange(luminanceCutoff);
+    std::cout << "Luminance cutoff " << luminanceCutoff << " | point radius " << pointLights[0].radius
+              << " | spot range " << cameraLight.range << std::endl;
+}
+
+bool roamFirstLight = false;
+bool roamSecondLight = false;
+bool roamThirdLight = false;
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+    if(glfwGetKey(win, GLFW_KEY_O) == GLFW_PRESS) bIsCameraLightOn = true;
+    if(glfwGetKey(win, GLFW_KEY_P) == GLFW_PRESS) bIsCameraLightOn = false;
+
+    if(glfwGetKey(win, GLFW_KEY_1) == GLFW_PRESS) {
+        roamFirstLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_2) == GLFW_PRESS) {
+        roamSecondLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_3) == GLFW_PRESS) {
+        roamThirdLight = true;
+    } else {
+        roamFirstLight = false;
+        roamSecondLight = false;
+        roamThirdLight = false;
+    }
+}
+/// Callbacks ----- (End)
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Irradiance Probes", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+    WindowWidth = mode->width;
+    WindowHeight = mode->height;
+
+    lastX = static_cast<float>(WindowWidth) / 2.0f;
+    lastY = static_cast<float>(WindowHeight) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+
+    setupCubeVAO();
+    defaultTexture = new Texture();
+    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentShaderSource);
+    lightingShader = new Shader(lightCubeVS, lightCubeFS);
+    camera = new Camera();
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_real_distribution<float> rPos(-15.0f, 15.0f), rRot(-1.5f,1.5f);
+    std::uniform_int_distribution<int> rMat(0,4);
+
+    // Floor first : the bounce it gives the cubes above it is most of what the probes add
+    sceneObjects.emplace_back(glm::vec3(0.0f, -4.0f, 0.0f), glm::vec3(40.0f, 0.5f, 40.0f), 0, 0.0f);
+    for(int i = 0; i < NUM_CUBES; i++){
+        float scale = 0.6f + (i%5)*0.1f;
+        sceneObjects.emplace_back(glm::vec3(rPos(gen), rPos(gen)*0.3f+1.0f, rPos(gen)), glm::vec3(scale), rMat(gen), rRot(gen));
+    }
+
+    // --- Probes : full bake on every core, then incremental ---
+    JobPool probeJobs(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    ProbeGrid probeGrid;
+    SceneSnapshot snapshot;
+    takeSceneSnapshot(snapshot, defaultTexture->averageColor);
+    const auto bakeStart = std::chrono::high_resolution_clock::now();
+    probeGrid.bakeAll(snapshot, probeJobs);
+    std::cout << PROBE_COUNT << " probes x " << PROBE_RAYS << " rays baked on " << probeJobs.threadCount() << " threads in "
+              << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - bakeStart).count() << " ms" << std::endl;
+
+    sceneShader->use();
+    const int probeUnits[PROBE_TEXTURES] = {1, 2, 3, 4, 5, 6, 7};
+    sceneShader->setIntArray("probeSH", probeUnits, PROBE_TEXTURES);
+    sceneShader->setVec3("probeGridMin", PROBE_GRID_MIN);
+    sceneShader->setVec3("probeGridSize", PROBE_GRID_MAX - PROBE_GRID_MIN);
+    sceneShader->setVec3("probeGridDims", glm::vec3(PROBE_DIM_X, PROBE_DIM_Y, PROBE_DIM_Z));
+
+    // Rolling probe stats, printed every 2 s
+    int statFrames = 0, statProbes = 0;
+    float statUpdateMs = 0.0f;
+    double lastStatTime = glfwGetTime();
+
+    auto lastTime = std::chrono::high_resolution_clock::now();
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+
+        float time = static_cast<float>(glfwGetTime());
+        processInput(window, dt);
+
+        // --- Animate point lights ---
+        // [0] orbits horizontally around scene centre
+        pointLights[0].position.x = 8.0f * sin(time * 0.3f);
+        pointLights[0].position.z = 8.0f * cos(time * 0.3f);
+        pointLights[0].position.y = 7.0f + sin(time * 0.5f) * 1.5f;
+
+        // [1] bobs up and down on the right side
+        pointLights[1].position.y = 5.0f + sin(time * 0.7f) * 3.0f;
+        pointLights[1].position.x = 10.0f * cos(time * 0.2f);
+
+        // [2] sweeps front-back on the left side
+        pointLights[2].position.z = 8.0f * sin(time * 0.4f);
+        pointLights[2].position.y = 6.0f + cos(time * 0.6f) * 2.0f;
+
+        if (roamFirstLight) {
+            camera->position = pointLights[0].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamSecondLight) {
+            camera->position = pointLights[1].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamThirdLight) {
+            camera->position = pointLights[2].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        }
+
+        // --- Animate camera lights ---
+        cameraLight.position = camera->position;
+        cameraLight.dir = camera->front;
+
+        simClockAdvance(&simClock, dt);
+        while (simClockStep(&simClock)) {
+            for(auto& obj : sceneObjects){
+                obj.update(static_cast<float>(simClock.tickSeconds));
+            }
+        }
+        const float alpha = simClockAlpha(&simClock);
+        for(auto& obj : sceneObjects){
+            obj.interpolate(alpha);
+        }
+        buildObjectLightLists();
+
+        // --- Refresh the stalest probes within the frame budget ---
+        if (bUpdateProbes) {
+            const auto updateStart = std::chrono::high_resolution_clock::now();
+            takeSceneSnapshot(snapshot, defaultTexture->averageColor);
+            statProbes += probeGrid.updateStale(snapshot, probeJobs, PROBE_BUDGET_MS);
+            statUpdateMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - updateStart).count();
+        }
+        statFrames++;
+        if (glfwGetTime() - lastStatTime >= 2.0) {
+            std::cout << "Probes updated " << static_cast<float>(statProbes) / statFrames << " / frame | update "
+                      << statUpdateMs / statFrames << " ms / frame" << std::endl;
+            statFrames = statProbes = 0;
+            statUpdateMs = 0.0f;
+            lastStatTime = glfwGetTime();
+        }
+
+        // --- Clear ---
+        glClearColor(SKY_RADIANCE.x, SKY_RADIANCE.y, SKY_RADIANCE.z, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 proj = camera->getProjectionMatrix(static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight));
+        glm::mat4 view = camera->getViewMatrix();
+
+        sceneShader->use();
+        sceneShader->setMat4("projection", proj);
+        sceneShader->setMat4("view", view);
+        sceneShader->setVec3("viewPos", camera->position);
+        sceneShader->setInt("useProbes", bUseProbes ? 1 : 0);
+
+        sceneShader->setVec3("cameraLight.position", cameraLight.position);
+        sceneShader->setVec3("cameraLight.direction", cameraLight.dir);
+        sceneShader->setVec3 ("cameraLight.color", cameraLight.color);
+        sceneShader->setFloat("cameraLight.innerCutOff", cameraLight.innerCutoff);
+        sceneShader->setFloat("cameraLight.outerCutOff", cameraLight.outerCutoff);
+        sceneShader->setFloat("cameraLight.constant", cameraLight.constant);
+        sceneShader->setFloat("cameraLight.linear", cameraLight.linear);
+        sceneShader->setFloat("cameraLight.quadratic", cameraLight.quadratic);
+        sceneShader->setFloat("cameraLight.range", cameraLight.range);
+
+        for(int i = 0; i < 3; i++){
+            std::string b = "pointLight[" + std::to_string(i) + "].";
+            sceneShader->setVec3 ((b+"position").c_str(), pointLights[i].position);
+            sceneShader->setVec3 ((b+"color").c_str(), pointLights[i].color);
+            sceneShader->setFloat((b+"constant").c_str(), pointLights[i].constant);
+            sceneShader->setFloat((b+"linear").c_str(), pointLights[i].linear);
+            sceneShader->setFloat((b+"quadratic").c_str(), pointLights[i].quadratic);
+            sceneShader->setFloat((b+"radius").c_str(), pointLights[i].radius);
+        }
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+        sceneShader->setInt("material.diffuseTex", 0);
+        for (int slot = 0; slot < PROBE_TEXTURES; slot++) {
+            glActiveTexture(GL_TEXTURE0 + probeUnits[slot]);
+            glBindTexture(GL_TEXTURE_3D, probeGrid.textures[slot]);
+        }
+
+        glBindVertexArray(cubeVAO);
+        for(auto& obj : sceneObjects){
+            sceneShader->setInt("objectLightCount", obj.lightCount);
+            sceneShader->setIntArray("objectLights", obj.lightIndices, MAX_LIGHTS_PER_OBJECT);
+            sceneShader->setInt("isCameraLightOn", obj.spotLit ? 1 : 0);
+            sceneShader->setMat4 ("model", obj.model);
+            sceneShader->setVec3 ("material.specular", materials[obj.matId].specular);
+            sceneShader->setFloat("material.shininess", materials[obj.matId].shininess);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        lightingShader->use();
+        lightingShader->setMat4("projection", proj);
+        lightingShader->setMat4("view", view);
+
+        glBindVertexArray(cubeVAO);
+        for(auto & pointLight : pointLights){
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), pointLight.position);
+            model = glm::scale(model, glm::vec3(0.3f));
+            lightingShader->setMat4("model", model);
+            lightingShader->setVec3("emissiveColor", pointLight.color);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteTextures(PROBE_TEXTURES, probeGrid.textures);
+    delete sceneShader;
+    delete lightingShader;
+    delete defaultTexture;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Job system : a fixed pool of worker threads running batches of numbered jobs, used by the software rasterizer and
+// the clustered lighting demo to split loops across cores. The calling thread takes jobs of its own batch too, so
+// threads - 1 workers give threads way parallelism, and a pool of one thread runs everything on the caller.
+//
+//   jobsInit(&jobs, std::thread::hardware_concurrency());
+//   jobsRun(&jobs, count, [&](int i) { work(i); });   // returns once job(0) ... job(count - 1) have finished
+//   jobsShutdown(&jobs);
+//
+// Jobs of one batch may run in any order on any thread, anything that must not depend on the thread count has to be
+// written per job index and combined in index order afterwards.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CpuProfiler.h"
+
+struct JobSystem {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable batchReady;
+    std::condition_variable batchDone;
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextJob{0};
+    int workersBusy = 0;
+    unsigned long long batch = 0;   // bumped for every batch, each worker joins each batch once
+    bool stopping = false;
+};
+
+/// Takes jobs of the current batch until there are none left
+/// @param jobs Job system
+inline void jobsDrain(JobSystem* jobs) {
+    for (int i = jobs->nextJob.fetch_add(1); i < jobs->jobCount; i = jobs->nextJob.fetch_add(1)) { (*jobs->job)(i); }
+}
+
+/// @param jobs Job system
+inline void jobsWorker(JobSystem* jobs) {
+    CPU_PROFILE_THREAD_NAME("job worker");
+    unsigned long long seen = 0;
+    std::unique_lock<std::mutex> lock(jobs->mutex);
+    while (true) {
+        jobs->batchReady.wait(lock, [&] { return jobs->stopping || jobs->batch != seen; });
+        if (jobs->stopping) { return; }
+        seen = jobs->batch;
+        lock.unlock();
+        jobsDrain(jobs);
+        lock.lock();
+        if (--jobs->workersBusy == 0) { jobs->batchDone.notify_one(); }
+    }
+}
+
+/// @param jobs Job system
+/// @param threads Threads to run jobs on, counting the caller
+inline void jobsInit(JobSystem* jobs, int threads) {
+    for (int i = 1; i < threads; i++) { jobs->workers.emplace_back(jobsWorker, jobs); }
+}
+
+/// @param jobs Job system
+/// @return Threads jobs run on, counting the caller
+inline int jobsThreadCount(const JobSystem* jobs) {
+    return static_cast<int>(jobs->workers.size()) + 1;
+}
+
+/// Runs job(0) ... job(count - 1) and waits for all of them. A single job, or a pool without workers, runs on the
+/// caller without waking anyone.
+/// @param jobs Job system
+/// @param count Number of jobs
+/// @param job Called once per job index, from any thread
+inline void jobsRun(JobSystem* jobs, int count, const std::function<void(int)>& job) {
+    if (jobs->workers.empty() || count <= 1) {
+        for (int i = 0; i < count; i++) { job(i); }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobs->mutex);
+        jobs->job = &job;
+        jobs->jobCount = count;
+        jobs->nextJob.store(0);
+        jobs->workersBusy = static_cast<int>(jobs->workers.size());
+        jobs->batch++;
+    }
+    jobs->batchReady.notify_all();
+    jobsDrain(jobs);
+    std::unique_lock<std::mutex> lock(jobs->mutex);
+    jobs->batchDone.wait(lock, [&] { return jobs->workersBusy == 0; });
+    jobs->job = nullptr;
+}
+
+/// @param jobs Job system
+inline void jobsShutdown(JobSystem* jobs) {
+    {
+        std::lock_guard<std::mutex> lock(jobs->mutex);
+        jobs->stopping = true;
+    }
+    jobs->batchReady.notify_all();
+    for (std::thread& worker : jobs->workers) { worker.join(); }
+    jobs->workers.clear();
+}
@@ -1,6 +1,10 @@
 // Adding attenuation (dimming light)
 
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
 #include <glm/detail/setup.hpp>
 #include <glm/glm.hpp>
 #include "glad/glad.h"
@@ -10,6 +14,14 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+
+#include "CpuProfiler.h"
+#include "GLDebug.h"
+#include "InputRecording.h"
+#include "SimdMath.h"
+#include "PointShadows.h"
+#include "FrameGovernor.h"
+#include "SoftwareRasterizer.h"
 using namespace std;
 using namespace glm;
 /// Shader helpers : ---- (start)
@@ -37,6 +49,7 @@ GLuint compileShader(GLenum type, const GLchar* source) {
 /// @param fragmentSource fragment shader source
 /// @return program ID
 GLuint createProgram(const char* vertexSource, const char* fragmentSource) {
+    CPU_PROFILE_SCOPE("createProgram");
     GLuint program = glCreateProgram();
     GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
     GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
@@ -168,18 +181,37 @@ out vec3 Normal;
 out vec2 TexCoords;
 
 uniform mat4 model;
+#ifdef LEGACY_TRANSFORMS
 uniform mat4 view;
 uniform mat4 projection;
+#else
+uniform mat4 mvp;           // projection * view * model
+uniform mat3 normalMatrix;  // mat3(transpose(inverse(model)))
+#endif
 
 void main()
 {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
     TexCoords = aTexCoords;
+#ifdef LEGACY_TRANSFORMS
+    Normal = mat3(transpose(inverse(model))) * aNormal;
     gl_Position = projection * view * vec4(FragPos, 1.0);
+#else
+    Normal = normalMatrix * aNormal;
+    gl_Position = mvp * vec4(aPos, 1.0);
+#endif
 }
 )";
 
+/// The cube shader with LEGACY_TRANSFORMS defined : inverse and projection * view per vertex, as it used to be
+/// @param source Shader source
+/// @return Source with the define after the #version line
+std::string legacyTransformsVariant(const char* source) {
+    std::string variant = source;
+    variant.insert(variant.find('\n', variant.find("#version")) + 1, "#define LEGACY_TRANSFORMS\n");
+    return variant;
+}
+
 const char* cubeObjectFragmentShader = R"(
 #version 410 core
 struct Material {
@@ -208,6 +240,7 @@ out vec4 FragColor;
 uniform vec3 viewPos;
 uniform Material material;
 uniform Light light;
+uniform float shadowRadius;
 
 void main()
 {
@@ -227,9 +260,12 @@ void main()
         light.constant + (light.linear * distance) + (light.quadratic * distance * distance)
     );
 
+    // Point shadows (PointShadows.h) : light 0 is the only light
+    float shadow = pointShadow(0, FragPos, norm, light.position, shadowRadius);
+
     ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
+    diffuse *= attenuation * shadow;
+    specular *= attenuation * shadow;
 
     vec3 result = ambient + diffuse + specular;
     FragColor = vec4(result, 1.0);
@@ -294,6 +330,7 @@ void main()
 
 /// Texture helpers ---------- (start)
 GLuint loadTexture(const char* path) {
+    CPU_PROFILE_SCOPE("loadTexture");
     GLuint texture;
     glGenTextures(1, &texture);
     int width, height, channels;
@@ -305,6 +342,7 @@ GLuint loadTexture(const char* path) {
         else if (channels == 4) { format = GL_RGBA; }
 
         glBindTexture(GL_TEXTURE_2D, texture);
+        GL_DEBUG_LABEL_TEXTURE(texture, path);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -321,9 +359,11 @@ GLuint loadTexture(const char* path) {
 
 GLuint loadCubeMap(std::vector<std::string> faces)
 {
+    CPU_PROFILE_SCOPE("loadCubeMap");
     GLuint texID;
     glGenTextures(1, &texID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+    GL_DEBUG_LABEL(GL_TEXTURE, texID, "skybox");
 
     int w, h, ch;
     for (unsigned int i = 0; i < faces.size(); i++) {
@@ -348,7 +388,279 @@ GLuint loadCubeMap(std::vector<std::string> faces)
 }
 /// Texture helpers ---------- (end)
 
+/// GL state cache ---------- (start)
+/// Marks a cached value as unknown so the next call always reaches the driver.
+constexpr GLuint STATE_UNKNOWN = 0xFFFFFFFF;
+constexpr int MAX_TEXTURE_UNITS = 16;
+
+/// Last value uploaded to one uniform location of one program
+struct CachedUniform {
+    GLenum type = 0;        // GL_INT, GL_FLOAT, GL_FLOAT_VEC3, GL_FLOAT_MAT3 or GL_FLOAT_MAT4
+    GLint integer = 0;
+    GLfloat floats[16] = {};
+};
 
+/// Shadow copy of the GL state touched every frame.
+/// Every wrapper compares against it and only calls GL when the value really changes.
+struct GLStateCache {
+    GLuint program = STATE_UNKNOWN;
+    GLuint vertexArray = STATE_UNKNOWN;
+    GLuint activeUnit = STATE_UNKNOWN;
+    GLuint texture2D[MAX_TEXTURE_UNITS];
+    GLuint textureCube[MAX_TEXTURE_UNITS];
+    GLint depthTest = -1;   // -1 = unknown, 0 = off, 1 = on
+    GLint depthMask = -1;
+    GLenum depthFunc = STATE_UNKNOWN;
+    GLint blend = -1;
+    GLenum blendSrc = STATE_UNKNOWN;
+    GLenum blendDst = STATE_UNKNOWN;
+
+    // program -> uniform location -> last uploaded value
+    std::unordered_map<GLuint, std::unordered_map<GLint, CachedUniform>> uniforms;
+
+    // Calls forwarded to GL vs. calls dropped because nothing changed
+    unsigned long long issued = 0;
+    unsigned long long elided = 0;
+    // Uniform calls on location -1 (not in the program), dropped but not counted as redundant
+    unsigned long long missingUniforms = 0;
+};
+
+/// Forgets everything the cache knows, call after code that touches GL directly (setup, loaders)
+/// @param cache State cache
+void stateInvalidate(GLStateCache* cache) {
+    cache->program = STATE_UNKNOWN;
+    cache->vertexArray = STATE_UNKNOWN;
+    cache->activeUnit = STATE_UNKNOWN;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+        cache->texture2D[i] = STATE_UNKNOWN;
+        cache->textureCube[i] = STATE_UNKNOWN;
+    }
+    cache->depthTest = -1;
+    cache->depthMask = -1;
+    cache->depthFunc = STATE_UNKNOWN;
+    cache->blend = -1;
+    cache->blendSrc = STATE_UNKNOWN;
+    cache->blendDst = STATE_UNKNOWN;
+    cache->uniforms.clear();
+}
+
+/// Binds program only if it is not already current
+/// @param cache State cache
+/// @param program Program ID
+void stateUseProgram(GLStateCache* cache, GLuint program) {
+    if (cache->program == program) { cache->elided++; return; }
+    glUseProgram(program);
+    cache->program = program;
+    cache->issued++;
+}
+
+/// Binds vertex array only if it is not already bound
+/// @param cache State cache
+/// @param vao Vertex array ID
+void stateBindVertexArray(GLStateCache* cache, GLuint vao) {
+    if (cache->vertexArray == vao) { cache->elided++; return; }
+    glBindVertexArray(vao);
+    cache->vertexArray = vao;
+    cache->issued++;
+}
+
+/// Binds texture to a texture unit, glActiveTexture is only issued when the unit really has to change
+/// @param cache State cache
+/// @param unit Texture unit index (0 = GL_TEXTURE0)
+/// @param target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+/// @param texture Texture ID
+void stateBindTexture(GLStateCache* cache, GLuint unit, GLenum target, GLuint texture) {
+    GLuint* slot = (target == GL_TEXTURE_CUBE_MAP) ? &cache->textureCube[unit] : &cache->texture2D[unit];
+    if (*slot == texture) { cache->elided++; return; }
+    if (cache->activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        cache->activeUnit = unit;
+        cache->issued++;
+    }
+    glBindTexture(target, texture);
+    *slot = texture;
+    cache->issued++;
+}
+
+/// Enables or disables depth testing
+/// @param cache State cache
+/// @param enabled New state
+void stateSetDepthTest(GLStateCache* cache, bool enabled) {
+    if (cache->depthTest == static_cast<GLint>(enabled)) { cache->elided++; return; }
+    if (enabled) { glEnable(GL_DEPTH_TEST); } else { glDisable(GL_DEPTH_TEST); }
+    cache->depthTest = enabled;
+    cache->issued++;
+}
+
+/// Sets depth write mask
+/// @param cache State cache
+/// @param enabled Writes depth when true
+void stateSetDepthMask(GLStateCache* cache, bool enabled) {
+    if (cache->depthMask == static_cast<GLint>(enabled)) { cache->elided++; return; }
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    cache->depthMask = enabled;
+    cache->issued++;
+}
+
+/// Sets depth comparison function
+/// @param cache State cache
+/// @param func GL_LESS, GL_LEQUAL ...
+void stateSetDepthFunc(GLStateCache* cache, GLenum func) {
+    if (cache->depthFunc == func) { cache->elided++; return; }
+    glDepthFunc(func);
+    cache->depthFunc = func;
+    cache->issued++;
+}
+
+/// Enables or disables blending
+/// @param cache State cache
+/// @param enabled New state
+void stateSetBlend(GLStateCache* cache, bool enabled) {
+    if (cache->blend == static_cast<GLint>(enabled)) { cache->elided++; return; }
+    if (enabled) { glEnable(GL_BLEND); } else { glDisable(GL_BLEND); }
+    cache->blend = enabled;
+    cache->issued++;
+}
+
+/// Sets blend factors
+/// @param cache State cache
+/// @param src Source factor
+/// @param dst Destination factor
+void stateSetBlendFunc(GLStateCache* cache, GLenum src, GLenum dst) {
+    if (cache->blendSrc == src && cache->blendDst == dst) { cache->elided++; return; }
+    glBlendFunc(src, dst);
+    cache->blendSrc = src;
+    cache->blendDst = dst;
+    cache->issued++;
+}
+
+/// Compares a uniform value against what the current program already holds and records it
+/// @param cache State cache
+/// @param location Uniform location
+/// @param type Value type
+/// @param floats Float data (nullptr for GL_INT)
+/// @param count Number of floats
+/// @param integer Integer data (GL_INT only)
+/// @return true when the value must be uploaded
+bool stateUniformChanged(GLStateCache* cache, GLint location, GLenum type, const GLfloat* floats, int count, GLint integer) {
+    // location -1 is silently ignored by GL, no need to pay for the call
+    if (location < 0) { cache->missingUniforms++; return false; }
+    if (cache->program == STATE_UNKNOWN || cache->program == 0) {
+        // Reported once, this runs inside the render loop
+        static bool reported = false;
+        if (!reported) {
+            std::cout << "GL state cache: uniform " << location << " set with no program bound" << std::endl;
+            reported = true;
+        }
+        cache->issued++;
+        return true;
+    }
+
+    CachedUniform& cached = cache->uniforms[cache->program][location];
+    bool same = cached.type == type;
+    if (same && type == GL_INT) {
+        same = cached.integer == integer;
+    } else if (same) {
+        same = std::memcmp(cached.floats, floats, count * sizeof(GLfloat)) == 0;
+    }
+    if (same) { cache->elided++; return false; }
+
+    cached.type = type;
+    cached.integer = integer;
+    if (floats) { std::memcpy(cached.floats, floats, count * sizeof(GLfloat)); }
+    cache->issued++;
+    return true;
+}
+
+void stateUniform1i(GLStateCache* cache, GLint location, GLint value) {
+    if (stateUniformChanged(cache, location, GL_INT, nullptr, 0, value)) { glUniform1i(location, value); }
+}
+
+void stateUniform1f(GLStateCache* cache, GLint location, GLfloat value) {
+    if (stateUniformChanged(cache, location, GL_FLOAT, &value, 1, 0)) { glUniform1f(location, value); }
+}
+
+void stateUniform3fv(GLStateCache* cache, GLint location, const glm::vec3& value) {
+    if (stateUniformChanged(cache, location, GL_FLOAT_VEC3, glm::value_ptr(value), 3, 0)) { glUniform3fv(location, 1, glm::value_ptr(value)); }
+}
+
+void stateUniformMatrix3fv(GLStateCache* cache, GLint location, const glm::mat3& value) {
+    if (stateUniformChanged(cache, location, GL_FLOAT_MAT3, glm::value_ptr(value), 9, 0)) { glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+}
+
+void stateUniformMatrix4fv(GLStateCache* cache, GLint location, const glm::mat4& value) {
+    if (stateUniformChanged(cache, location, GL_FLOAT_MAT4, glm::value_ptr(value), 16, 0)) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+}
+
+/// Prints issued vs elided calls per frame since the last report and resets the counters
+/// @param cache State cache
+/// @param frames Frames rendered since last report
+void statePrintStats(GLStateCache* cache, int frames) {
+    const unsigned long long total = cache->issued + cache->elided;
+    if (frames <= 0 || total == 0) { return; }
+    std::cout << "GL state cache : issued " << cache->issued / frames
+              << " / elided " << cache->elided / frames << " calls per frame ("
+              << (100.0 * static_cast<double>(cache->elided) / static_cast<double>(total)) << "% elided)";
+    if (cache->missingUniforms > 0) { std::cout << ", " << cache->missingUniforms / frames << " uniform calls on missing locations"; }
+    std::cout << std::endl;
+    cache->issued = 0;
+    cache->elided = 0;
+    cache->missingUniforms = 0;
+}
+/// GL state cache ---------- (end)
+
+
+
+/// Cube object program : ---- (start)
+/// One build of the cube object shaders and its uniform locations. There are two, the legacy vertex shader and the
+/// one fed precomputed matrices, both with the same fragment shader.
+struct CubeObjectProgram {
+    GLuint program;
+    GLint lightPosition;
+    GLint viewPosition;
+    GLint lightAmbient;
+    GLint lightDiffuse;
+    GLint lightSpecular;
+    GLint lightConstant;
+    GLint lightLinear;
+    GLint lightQuadratic;
+    GLint materialShininess;
+    GLint shadowsEnabled;
+    GLint shadowRadius;
+    GLint model;
+    GLint projection;     // legacy only
+    GLint view;           // legacy only
+    GLint mvp;            // precomputed only
+    GLint normalMatrix;   // precomputed only
+};
+
+/// Looks up the uniforms of a cube object program and points its samplers at units 0 and 1, the shadow cube at 2
+/// @param cube Receives the locations
+/// @param program Linked program
+void cubeObjectProgramInit(CubeObjectProgram* cube, GLuint program) {
+    cube->program = program;
+    glUseProgram(program);
+    cube->lightPosition = glGetUniformLocation(program, "light.position");
+    cube->viewPosition = glGetUniformLocation(program, "viewPos");
+    cube->lightAmbient = glGetUniformLocation(program, "light.ambient");
+    cube->lightDiffuse = glGetUniformLocation(program, "light.diffuse");
+    cube->lightSpecular = glGetUniformLocation(program, "light.specular");
+    cube->lightConstant = glGetUniformLocation(program, "light.constant");
+    cube->lightLinear = glGetUniformLocation(program, "light.linear");
+    cube->lightQuadratic = glGetUniformLocation(program, "light.quadratic");
+    cube->materialShininess = glGetUniformLocation(program, "material.shininess");
+    glUniform1i(glGetUniformLocation(program, "material.diffuse"), 0);
+    glUniform1i(glGetUniformLocation(program, "material.specular"), 1);
+    glUniform1i(glGetUniformLocation(program, "pointShadowCubes"), 2);
+    cube->shadowsEnabled = glGetUniformLocation(program, "pointShadowsEnabled");
+    cube->shadowRadius = glGetUniformLocation(program, "shadowRadius");
+    cube->model = glGetUniformLocation(program, "model");
+    cube->projection = glGetUniformLocation(program, "projection");
+    cube->view = glGetUniformLocation(program, "view");
+    cube->mvp = glGetUniformLocation(program, "mvp");
+    cube->normalMatrix = glGetUniformLocation(program, "normalMatrix");
+}
+/// Cube object program : ---- (end)
 
 /// App Global --- (start)
 int SCR_WIDTH;
@@ -363,29 +675,214 @@ float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
 glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+
+// Shadows of the cubes from lightPos, K turns them off
+PointShadows pointShadows;
+constexpr int SHADOW_CUBE_SIZE = 1024;
+// The cubes orbit a still light, so all six faces are redrawn every frame
+constexpr int SHADOW_FACE_BUDGET = 6;
+// Far plane of the shadow cube, past the farthest cube
+constexpr float SHADOW_RADIUS = 25.0f;
+
+// Frame budget governor (FrameGovernor.h) : render scale, texture LOD bias and shadow cube size. The single light has
+// no cutoff to raise. G toggles it, T cycles the target frame rate.
+// GPU times come from the profiler : the governor reads the root "frame" scope, the 2 s report shows every pass.
+FrameGovernor governor;
+GpuProfiler gpuProfiler;
+SceneTarget sceneTarget;
+bool sceneTargetDirty = true;
+bool qualityDirty = true;   // set by G, applied in the render loop where the textures are known
+const char* GOVERNOR_LOG_PATH = "frame_governor_attenuation.csv";
+
+GLStateCache glState;
+
+// Written on F9 and on exit
+const char* CPU_TRACE_PATH = "cpu_trace.json";
+
+// --record <file> / --replay <file>, see InputRecording.h
+InputRecording inputRecording;
+// Keys ProcessInput and processToggles read, in the order of their bits in a recording
+const int RECORDED_KEYS[] = {GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D,
+                             GLFW_KEY_G, GLFW_KEY_T, GLFW_KEY_F9, GLFW_KEY_V, GLFW_KEY_K};
+const int NUM_RECORDED_KEYS = 9;
+
+// V (or --legacy-transforms) switches the cubes back to inverting the model matrix and multiplying
+// projection * view in the vertex shader, instead of matrices computed once per cube on the CPU
+bool legacyTransforms = false;
+
+// --software <frames> renders that many frames on the CPU with SoftwareRasterizer.h instead, no window or GL needed.
+// --threads <n> limits the threads it uses. A --replay drives its camera and clock like it does the GL window's.
+constexpr int SOFTWARE_WIDTH = 1920;
+constexpr int SOFTWARE_HEIGHT = 1080;
+constexpr float SOFTWARE_FRAME_SECONDS = 1.0f / 60.0f;   // animation step without a replay
+const char* SOFTWARE_OUTPUT_PATH = "software_frame.ppm";  // the last frame
 /// App Global --- (end)
 
+/// Scene : ---- (start)
+/// Everything both the GL and the software renderer (--software) draw
+constexpr int NUM_CUBES = 20;
+
+// cube vertex data
+float cubeVertices[] = {
+    // positions          // normals           // tex coords
+    -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+     0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,0.0f,
+     0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+     0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+    -0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,1.0f,
+    -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+
+    -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+     0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,0.0f,
+     0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+     0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+    -0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,1.0f,
+    -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+
+    -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+    -0.5f, 0.5f,-0.5f,  -1.0f,0.0f,0.0f,      1.0f,1.0f,
+    -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+    -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+    -0.5f,-0.5f, 0.5f,  -1.0f,0.0f,0.0f,      0.0f,0.0f,
+    -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+     0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+     0.5f, 0.5f,-0.5f,   1.0f,0.0f,0.0f,      1.0f,1.0f,
+     0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+     0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+     0.5f,-0.5f, 0.5f,   1.0f,0.0f,0.0f,      0.0f,0.0f,
+     0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+    -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+     0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     1.0f,1.0f,
+     0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+     0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+    -0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     0.0f,0.0f,
+    -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+
+    -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f,
+     0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      1.0f,1.0f,
+     0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+     0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+    -0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      0.0f,0.0f,
+    -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f
+};
+
+glm::vec3 cubePositions[NUM_CUBES] = {
+    glm::vec3( 0.0f,  0.0f,   0.0f),
+    glm::vec3( 2.0f,  5.0f,  -6.0f),
+    glm::vec3(-1.5f, -2.2f,  -1.0f),
+    glm::vec3(-3.8f, -2.0f,  -5.0f),
+    glm::vec3( 2.4f, -0.4f,  -1.5f),
+    glm::vec3(-1.7f,  3.0f,  -3.0f),
+    glm::vec3( 1.3f, -2.0f,  -1.0f),
+    glm::vec3( 1.5f,  2.0f,  -1.0f),
+    glm::vec3( 1.5f,  0.2f,  -0.6f),
+    glm::vec3(-1.3f,  1.0f,  -0.6f),
+
+    glm::vec3( 4.0f,  3.0f,  -8.0f),
+    glm::vec3(-4.0f, -3.0f,  -7.0f),
+    glm::vec3( 6.0f,  1.0f, -10.0f),
+    glm::vec3(-6.0f,  2.0f,  -9.0f),
+    glm::vec3( 0.0f,  6.0f, -12.0f),
+    glm::vec3( 3.0f, -4.0f, -11.0f),
+    glm::vec3(-3.0f,  4.0f, -10.5f),
+    glm::vec3( 5.5f, -1.0f, -9.5f),
+    glm::vec3(-5.5f,  2.5f, -10.8f),
+    glm::vec3( 0.0f, -5.0f, -14.0f)
+};
+
+const glm::vec3 LIGHT_AMBIENT(0.2f, 0.2f, 0.2f);
+const glm::vec3 LIGHT_DIFFUSE(1.0f, 1.0f, 1.0f);
+const glm::vec3 LIGHT_SPECULAR(2.0f, 2.0f, 2.0f);
+constexpr float LIGHT_CONSTANT = 1.0f;
+constexpr float LIGHT_LINEAR = 0.045f;
+constexpr float LIGHT_QUADRATIC = 0.0075f;
+constexpr float MATERIAL_SHININESS = 512.0f;
+
+const char* DIFFUSE_MAP_PATH = "/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2-2.png";
+const char* SPECULAR_MAP_PATH = "/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2_specular-2.png";
+const std::vector<std::string> SKYBOX_FACES = {
+    "/Users/udayshinde/Desktop/OpenGLWindow/Assets/right.jpg",
+    "/Users/udayshinde/Desktop/OpenGLWindow/Assets/left.jpg",
+    "/Users/udayshinde/Desktop/OpenGLWindow/Assets/top.jpg",
+    "/Users/udayshinde/Desktop/OpenGLWindow/Assets/bottom.jpg",
+    "/Users/udayshinde/Desktop/OpenGLWindow/Assets/front.jpg",
+    "/Users/udayshinde/Desktop/OpenGLWindow/Assets/back.jpg"
+};
+
+/// Model matrix of a cube, each one spins at its own speed
+/// @param i Cube index
+/// @param time Animation time in seconds
+/// @return Model matrix
+mat4 cubeModelMatrix(int i, float time) {
+    const float angle = 2.0f * static_cast<float>(i) * time;
+    const mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+    return glm::translate(model, cubePositions[i]);
+}
+
+/// Model matrix of the small cube drawn at the light
+/// @return Model matrix
+mat4 lightCubeModelMatrix() {
+    return glm::scale(glm::translate(glm::mat4(1.0f), lightPos), glm::vec3(0.2f));
+}
+/// Scene : ---- (end)
+
 /// Callbacks ---- (start)
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, GLdouble xPos, GLdouble yPos);
 void scroll_callback(GLFWwindow* window, GLdouble xOffset, GLdouble yOffset);
-void ProcessInput(GLFWwindow* window);
+void ProcessInput(GLFWwindow* window, const InputFrame* input);
+void applyCameraInput(const InputFrame* input);
+void processToggles();
 /// Callbacks ---- (end)
 
-int main() {
+int runSoftwareRenderer(int frameCount, int threads);
+
+/// Applies the governor's quality level to the knobs this scene has
+/// @param diffuseMap Diffuse texture
+/// @param specularMap Specular texture
+void applyQualityLevel(GLuint diffuseMap, GLuint specularMap)
+{
+    const QualityLevel& quality = governorQuality(&governor);
+    stateBindTexture(&glState, 0, GL_TEXTURE_2D, diffuseMap);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, quality.lodBias);
+    stateBindTexture(&glState, 1, GL_TEXTURE_2D, specularMap);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, quality.lodBias);
+    pointShadowsResize(&pointShadows, static_cast<int>(SHADOW_CUBE_SIZE * quality.shadowScale));
+}
+
+int main(int argc, char** argv) {
+    if (!inputRecordingOpen(&inputRecording, argc, argv)) return -1;
+    int softwareFrames = 0;
+    int softwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--legacy-transforms") == 0) legacyTransforms = true;
+        else if (std::strcmp(argv[i], "--software") == 0 && i + 1 < argc) softwareFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) softwareThreads = std::atoi(argv[++i]);
+    }
+    if (softwareFrames > 0) return runSoftwareRenderer(softwareFrames, softwareThreads);
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    GL_DEBUG_WINDOW_HINTS();
 
+    inputRecordingWindowHints(&inputRecording);
+
+    // A replay renders off screen at the size it was recorded at
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Point light with decreasing brightness", monitor, nullptr);
+    const bool replaying = inputRecording.mode == INPUT_REPLAY;
+    const int windowWidth = replaying ? inputRecording.width : mode->width;
+    const int windowHeight = replaying ? inputRecording.height : mode->height;
+    GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "Point light with decreasing brightness", replaying ? nullptr : monitor, nullptr);
     glfwMakeContextCurrent(window);
 
-    lastX = mode->width / 2.0f;
-    lastY = mode->height / 2.0f;
+    lastX = windowWidth / 2.0f;
+    lastY = windowHeight / 2.0f;
 
     camera = Camera();
     cameraInit(&camera, vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f, 2.0f, 0.2f, 45.0f);
@@ -394,6 +891,8 @@ int main() {
         std::cout << "Failed to initialise GLAD" << std::endl;
         return -1;
     }
+    GL_DEBUG_INIT();
+    inputRecordingBegin(&inputRecording, windowWidth, windowHeight);
 
     glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
     glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
@@ -407,65 +906,28 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);
 
+    CPU_PROFILE_THREAD_NAME("main");
+    CPU_PROFILE_BEGIN("startup");
+
     // Compile shader
     std::cout << "Compiling cube objects Program --- (start)" << std::endl;
-    GLuint cubeObjectProgram = createProgram(cubeObjectVertexShader, cubeObjectFragmentShader);
+    const std::string cubeObjectFragmentSource = pointShadowsShaderSource(cubeObjectFragmentShader);
+    GLuint cubeObjectProgram = createProgram(cubeObjectVertexShader, cubeObjectFragmentSource.c_str());
+    GL_DEBUG_LABEL(GL_PROGRAM, cubeObjectProgram, "cubeObjectProgram");
+    GLuint cubeObjectLegacyProgram = createProgram(legacyTransformsVariant(cubeObjectVertexShader).c_str(), cubeObjectFragmentSource.c_str());
+    GL_DEBUG_LABEL(GL_PROGRAM, cubeObjectLegacyProgram, "cubeObjectLegacyProgram");
     std::cout << "Compiling cube objetcs Program --- (end)" << std::endl;
 
     std::cout << "Compiling lighting cube program -- (start)" << std::endl;
     GLuint lightCubeProgram = createProgram(lightCubeVertexShader, lightCubeFragmentShader);
+    GL_DEBUG_LABEL(GL_PROGRAM, lightCubeProgram, "lightCubeProgram");
     std::cout << "Compiling lighting cube program -- (end)" << std::endl;
 
     std::cout << "Generating ShaderProgramSky --- (start)" << std::endl;
     GLuint ShaderProgramSky = createProgram(cubeMapVertexShader, cubeMapFragmentShader);
+    GL_DEBUG_LABEL(GL_PROGRAM, ShaderProgramSky, "ShaderProgramSky");
     std::cout << "Generating ShaderProgramSky --- (end)" << std::endl;
 
-        // cube vertex data
-    float vertices[] = {
-        // positions          // normals           // tex coords
-        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
-         0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,0.0f,
-         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
-         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
-        -0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,1.0f,
-        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
-
-        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
-         0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,0.0f,
-         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
-         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
-        -0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,1.0f,
-        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
-
-        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
-        -0.5f, 0.5f,-0.5f,  -1.0f,0.0f,0.0f,      1.0f,1.0f,
-        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
-        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
-        -0.5f,-0.5f, 0.5f,  -1.0f,0.0f,0.0f,      0.0f,0.0f,
-        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
-
-         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
-         0.5f, 0.5f,-0.5f,   1.0f,0.0f,0.0f,      1.0f,1.0f,
-         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
-         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
-         0.5f,-0.5f, 0.5f,   1.0f,0.0f,0.0f,      0.0f,0.0f,
-         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
-
-        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
-         0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     1.0f,1.0f,
-         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
-         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
-        -0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     0.0f,0.0f,
-        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
-
-        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f,
-         0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      1.0f,1.0f,
-         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
-         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
-        -0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      0.0f,0.0f,
-        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f
-    };
-
     float skyboxVertices[] = {
         -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1, -1,
         -1, -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1,
@@ -475,36 +937,15 @@ int main() {
         -1, -1, -1, -1, -1,  1,  1, -1, -1,  1, -1, -1, -1, -1,  1,  1, -1,  1
     };
 
-    glm::vec3 cubePositions[20] = {
-        glm::vec3( 0.0f,  0.0f,   0.0f),
-        glm::vec3( 2.0f,  5.0f,  -6.0f),
-        glm::vec3(-1.5f, -2.2f,  -1.0f),
-        glm::vec3(-3.8f, -2.0f,  -5.0f),
-        glm::vec3( 2.4f, -0.4f,  -1.5f),
-        glm::vec3(-1.7f,  3.0f,  -3.0f),
-        glm::vec3( 1.3f, -2.0f,  -1.0f),
-        glm::vec3( 1.5f,  2.0f,  -1.0f),
-        glm::vec3( 1.5f,  0.2f,  -0.6f),
-        glm::vec3(-1.3f,  1.0f,  -0.6f),
-
-        glm::vec3( 4.0f,  3.0f,  -8.0f),
-        glm::vec3(-4.0f, -3.0f,  -7.0f),
-        glm::vec3( 6.0f,  1.0f, -10.0f),
-        glm::vec3(-6.0f,  2.0f,  -9.0f),
-        glm::vec3( 0.0f,  6.0f, -12.0f),
-        glm::vec3( 3.0f, -4.0f, -11.0f),
-        glm::vec3(-3.0f,  4.0f, -10.5f),
-        glm::vec3( 5.5f, -1.0f, -9.5f),
-        glm::vec3(-5.5f,  2.5f, -10.8f),
-        glm::vec3( 0.0f, -5.0f, -14.0f)
-    };
-
+    CPU_PROFILE_BEGIN("setupCubeVAO");
     GLuint VBO, cubeVAO, lightCubeVAO;
     glGenVertexArrays(1, &cubeVAO);
     glBindVertexArray(cubeVAO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, cubeVAO, "cubeVAO");
     glGenBuffers(1, &VBO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    GL_DEBUG_LABEL(GL_BUFFER, VBO, "cube vertices");
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(3 * sizeof(float)));
@@ -514,6 +955,7 @@ int main() {
 
     glGenVertexArrays(1, &lightCubeVAO);
     glBindVertexArray(lightCubeVAO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, lightCubeVAO, "lightCubeVAO");
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
     glEnableVertexAttribArray(0);
@@ -525,176 +967,300 @@ int main() {
 
     glBindVertexArray(skyVAO);
     glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, skyVAO, "skyVAO");
+    GL_DEBUG_LABEL(GL_BUFFER, skyVBO, "sky vertices");
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), nullptr);
     glBindVertexArray(0);
+    CPU_PROFILE_END();
 
-    std::vector<std::string> faces = {
-        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/right.jpg",
-        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/left.jpg",
-        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/top.jpg",
-        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/bottom.jpg",
-        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/front.jpg",
-        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/back.jpg"
-        };
-    GLuint cubeMapTex = loadCubeMap(faces);
+    GLuint cubeMapTex = loadCubeMap(SKYBOX_FACES);
 
     stbi_set_flip_vertically_on_load(true);
-    GLuint diffuseMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2-2.png");
-    GLuint specularMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2_specular-2.png");
-
-    glUseProgram(cubeObjectProgram);
-
-    GLint LightPosition = glGetUniformLocation(cubeObjectProgram, "light.position");
-    std::cout << "LightPosition : " << LightPosition << std::endl;
-    GLint ViewPosition = glGetUniformLocation(cubeObjectProgram, "viewPos");
-    std::cout << "ViewPosition : " << ViewPosition << std::endl;
-    GLint LightAmbient = glGetUniformLocation(cubeObjectProgram, "light.ambient");
-    std::cout << "LightAmbient : " << LightAmbient << std::endl;
-    GLint LightDiffuse = glGetUniformLocation(cubeObjectProgram, "light.diffuse");
-    std::cout << "LightDiffuse : " << LightDiffuse << std::endl;
-    GLint LightSpecular = glGetUniformLocation(cubeObjectProgram, "light.specular");
-    std::cout << "LightSpecular : " << LightSpecular << std::endl;
-    GLint LightConstant = glGetUniformLocation(cubeObjectProgram, "light.constant");
-    std::cout << "LightConstant : " << LightSpecular << std::endl;
-    GLint LightLinear = glGetUniformLocation(cubeObjectProgram, "light.linear");
-    std::cout << "LightLinear : " << LightSpecular << std::endl;
-    GLint LightQuadratic = glGetUniformLocation(cubeObjectProgram, "light.quadratic");
-    std::cout << "LightQuadratic : " << LightSpecular << std::endl;
-    GLint MaterialShininess = glGetUniformLocation(cubeObjectProgram, "material.shininess");
-    std::cout << "MaterialShininess : " << MaterialShininess << std::endl;
-    GLint MaterialDiffuse = glGetUniformLocation(cubeObjectProgram, "material.diffuse");
-    std::cout << "MaterialDiffuse : " << MaterialDiffuse << std::endl;
-    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.diffuse"), 0);
-    GLint MaterialSpecular = glGetUniformLocation(cubeObjectProgram, "material.specular");
-    std::cout << "MaterialSpecular : " << MaterialSpecular << std::endl;
-    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.specular"), 1);
-    GLint LightShaderProjection = glGetUniformLocation(cubeObjectProgram, "projection");
-    std::cout << "LightShaderProjection : " << LightShaderProjection << std::endl;
-    GLint LightShaderView = glGetUniformLocation(cubeObjectProgram, "view");
-    std::cout << "LightShaderView : " << LightShaderView << std::endl;
-    GLint LightShaderModel = glGetUniformLocation(cubeObjectProgram, "model");
-    std::cout << "LightShaderModel : " << LightShaderModel << std::endl;
+    GLuint diffuseMap = loadTexture(DIFFUSE_MAP_PATH);
+    GLuint specularMap = loadTexture(SPECULAR_MAP_PATH);
+
+    CubeObjectProgram cubeObjects;
+    CubeObjectProgram cubeObjectsLegacy;
+    cubeObjectProgramInit(&cubeObjects, cubeObjectProgram);
+    cubeObjectProgramInit(&cubeObjectsLegacy, cubeObjectLegacyProgram);
+
+    // Unit 2 holds the shadow cube for good, the state cache never binds anything there
+    pointShadowsInit(&pointShadows, 1, SHADOW_CUBE_SIZE, SHADOW_FACE_BUDGET, VBO, 8 * sizeof(float));
+    pointShadowsSetLight(&pointShadows, 0, lightPos, SHADOW_RADIUS);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, pointShadows.cubeArray);
+    glActiveTexture(GL_TEXTURE0);
+
+    // Per cube matrices, built together each frame
+    glm::mat4 cubeModels[NUM_CUBES];
+    glm::mat4 cubeMvps[NUM_CUBES];
+    glm::mat3 cubeNormalMatrices[NUM_CUBES];
+
+    GLint LightCubeProjection = glGetUniformLocation(lightCubeProgram, "projection");
+    GLint LightCubeView = glGetUniformLocation(lightCubeProgram, "view");
+    GLint LightCubeModel = glGetUniformLocation(lightCubeProgram, "model");
+    GLint LightCubeColor = glGetUniformLocation(lightCubeProgram, "lightColor");
+
+    GLint SkyView = glGetUniformLocation(ShaderProgramSky, "view");
+    GLint SkyProjection = glGetUniformLocation(ShaderProgramSky, "projection");
+    GLint SkySampler = glGetUniformLocation(ShaderProgramSky, "skybox");
+
+    governorOpenLog(&governor, GOVERNOR_LOG_PATH);
+    profilerInit(&gpuProfiler);
+
+    // Setup above talked to GL directly, start the cache from a clean slate
+    stateInvalidate(&glState);
+    CPU_PROFILE_END();
 
     float currentFrame = 0.0f;
+    float lastStatsTime = 0.0f;
+    int statsFrames = 0;
 
+    lastFrame = glfwGetTime();
     while (!glfwWindowShouldClose(window)) {
-        currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+        const float now = glfwGetTime();
+        InputFrame input{};
+        if (!inputRecordingNextFrame(&inputRecording, now - lastFrame, inputPollKeys(window, RECORDED_KEYS, NUM_RECORDED_KEYS), &input)) {
+            break; // replay finished
+        }
+        lastFrame = now;
+
+        // Everything animates from the recorded clock, so a replay sees the same times
+        CPU_PROFILE_BEGIN("frame");
+        deltaTime = input.frameSeconds;
+        currentFrame = static_cast<float>(inputRecording.time);
+
+        CPU_PROFILE_BEGIN("input");
+        ProcessInput(window, &input);
+        CPU_PROFILE_END();
+
+        profilerBeginFrame(&gpuProfiler);
+        profilerPush(&gpuProfiler, "frame");
+        if (sceneTargetDirty) {
+            sceneTargetResize(&sceneTarget, SCR_WIDTH, SCR_HEIGHT);
+            sceneTargetDirty = false;
+        }
+        if (qualityDirty) {
+            applyQualityLevel(diffuseMap, specularMap);
+            qualityDirty = false;
+        }
 
-        ProcessInput(window);
+        // Depth writes must be back on before glClear, the sky pass leaves them off
+        stateSetDepthTest(&glState, true);
+        stateSetDepthMask(&glState, true);
+        stateSetDepthFunc(&glState, GL_LESS);
 
+        // Shadow cube first, the cubes cast and the light cube does not
+        CPU_PROFILE_BEGIN("shadows");
+        for (int i = 0; i < NUM_CUBES; i++) {
+            cubeModels[i] = cubeModelMatrix(i, currentFrame);
+        }
+        profilerPush(&gpuProfiler, "shadows");
+        pointShadowsUpdate(&pointShadows, camera.Position, cubeModels, NUM_CUBES, 36);
+        profilerPop(&gpuProfiler);
+        int renderWidth, renderHeight;
+        governorRenderSize(&governor, SCR_WIDTH, SCR_HEIGHT, &renderWidth, &renderHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget.framebuffer);
+        glViewport(0, 0, renderWidth, renderHeight);
+        // It bound its own program and vertex array behind the cache's back
+        glState.program = STATE_UNKNOWN;
+        glState.vertexArray = STATE_UNKNOWN;
+        CPU_PROFILE_END();
+
+        profilerPush(&gpuProfiler, "opaque");
         glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glUseProgram(cubeObjectProgram);
-        glUniform3fv(LightPosition,1, glm::value_ptr(lightPos));
-        glUniform3fv(ViewPosition,1,  glm::value_ptr(camera.Position));
+        // Constant light/material values only reach the driver on the first frame
+        CPU_PROFILE_BEGIN("uniforms");
+        const CubeObjectProgram& cube = legacyTransforms ? cubeObjectsLegacy : cubeObjects;
+        stateUseProgram(&glState, cube.program);
+        stateUniform3fv(&glState, cube.lightPosition, lightPos);
+        stateUniform3fv(&glState, cube.viewPosition, camera.Position);
 
-        glUniform3fv(LightAmbient, 1, glm::value_ptr(glm::vec3(0.2f, 0.2f, 0.2f)));
-        glUniform3fv(LightDiffuse, 1, glm::value_ptr(glm::vec3(1.0f, 1.0f, 1.0f)));
-        glUniform3fv(LightSpecular, 1, glm::value_ptr(glm::vec3(2.0f, 2.0f, 2.0f)));
-        glUniform1f(LightConstant, 1.0f);
-        glUniform1f(LightLinear, 0.045f);
-        glUniform1f(LightQuadratic, 0.0075f);
+        stateUniform3fv(&glState, cube.lightAmbient, LIGHT_AMBIENT);
+        stateUniform3fv(&glState, cube.lightDiffuse, LIGHT_DIFFUSE);
+        stateUniform3fv(&glState, cube.lightSpecular, LIGHT_SPECULAR);
+        stateUniform1f(&glState, cube.lightConstant, LIGHT_CONSTANT);
+        stateUniform1f(&glState, cube.lightLinear, LIGHT_LINEAR);
+        stateUniform1f(&glState, cube.lightQuadratic, LIGHT_QUADRATIC);
 
-        glUniform1f(MaterialShininess, 512.0f);
+        stateUniform1f(&glState, cube.materialShininess, MATERIAL_SHININESS);
+        stateUniform1i(&glState, cube.shadowsEnabled, pointShadows.enabled ? 1 : 0);
+        stateUniform1f(&glState, cube.shadowRadius, SHADOW_RADIUS);
 
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT), 0.1f, 1000.0f);
         glm::mat4 view = getCameraViewMatrix(&camera);
-        glm::mat4 model = glm::mat4(1.0f);
-        glUniformMatrix4fv(LightShaderProjection, 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(LightShaderView, 1, GL_FALSE, glm::value_ptr(view));
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, specularMap);
-
-        glBindVertexArray(cubeVAO);
-
-        for (unsigned int i = 0; i < 20; i++) {
-            const float angle = 2.0f * i * glfwGetTime();
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            model = glm::translate(model, cubePositions[i]);
-            glUniformMatrix4fv(LightShaderModel, 1, GL_FALSE, glm::value_ptr(model));
+        if (legacyTransforms) {
+            stateUniformMatrix4fv(&glState, cube.projection, projection);
+            stateUniformMatrix4fv(&glState, cube.view, view);
+        }
+
+        stateBindTexture(&glState, 0, GL_TEXTURE_2D, diffuseMap);
+        stateBindTexture(&glState, 1, GL_TEXTURE_2D, specularMap);
+
+        stateBindVertexArray(&glState, cubeVAO);
+        CPU_PROFILE_END();
+
+        // The model matrices were built for the shadow pass
+        CPU_PROFILE_BEGIN("draws");
+        if (!legacyTransforms) {
+            // The cubes are rotated and moved but never scaled, so their normal matrices need no inverse
+            simdMat4MulBatchShared(projection * view, cubeModels, cubeMvps, NUM_CUBES);
+            simdNormalMatrixUniformScaleBatch(cubeModels, cubeNormalMatrices, NUM_CUBES);
+        }
+        for (unsigned int i = 0; i < NUM_CUBES; i++) {
+            stateUniformMatrix4fv(&glState, cube.model, cubeModels[i]);
+            if (!legacyTransforms) {
+                stateUniformMatrix4fv(&glState, cube.mvp, cubeMvps[i]);
+                stateUniformMatrix3fv(&glState, cube.normalMatrix, cubeNormalMatrices[i]);
+            }
             glDrawArrays(GL_TRIANGLES, 0, 36);
-            model = glm::mat4(1.0f);
         }
 
-        glUseProgram(lightCubeProgram);
-        glUniformMatrix4fv(glGetUniformLocation(lightCubeProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(glGetUniformLocation(lightCubeProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        stateUseProgram(&glState, lightCubeProgram);
+        stateUniformMatrix4fv(&glState, LightCubeProjection, projection);
+        stateUniformMatrix4fv(&glState, LightCubeView, view);
 
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, lightPos);
-        model = glm::scale(model, glm::vec3(0.2f));
-        glUniformMatrix4fv(glGetUniformLocation(lightCubeProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniform3fv(glGetUniformLocation(lightCubeProgram, "lightColor"), 1, glm::value_ptr(glm::vec3(1.0f)));
+        stateUniformMatrix4fv(&glState, LightCubeModel, lightCubeModelMatrix());
+        stateUniform3fv(&glState, LightCubeColor, glm::vec3(1.0f));
 
-        glBindVertexArray(lightCubeVAO);
+        stateBindVertexArray(&glState, lightCubeVAO);
         glDrawArrays(GL_TRIANGLES, 0, 36);
+        profilerPop(&gpuProfiler);
 
         if (true) {
-            glDepthMask(GL_FALSE);
-            glDepthFunc(GL_LEQUAL);
-            glUseProgram(ShaderProgramSky);
+            GpuScope skyScope(&gpuProfiler, "sky");
+            stateSetDepthMask(&glState, false);
+            stateSetDepthFunc(&glState, GL_LEQUAL);
+            stateUseProgram(&glState, ShaderProgramSky);
 
             glm::mat4 skyView = glm::mat4(glm::mat3(view)); // remove translation
-            glUniformMatrix4fv(glGetUniformLocation(ShaderProgramSky,"view"),1,GL_FALSE,glm::value_ptr(skyView));
-            glUniformMatrix4fv(glGetUniformLocation(ShaderProgramSky,"projection"),1,GL_FALSE,glm::value_ptr(projection));
+            stateUniformMatrix4fv(&glState, SkyView, skyView);
+            stateUniformMatrix4fv(&glState, SkyProjection, projection);
 
-            glBindVertexArray(skyVAO);
-            glUniform1i(glGetUniformLocation(ShaderProgramSky, "skybox"), 0);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapTex);
+            stateBindVertexArray(&glState, skyVAO);
+            stateUniform1i(&glState, SkySampler, 0);
+            stateBindTexture(&glState, 0, GL_TEXTURE_CUBE_MAP, cubeMapTex);
             glDrawArrays(GL_TRIANGLES, 0, 36);
-            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        CPU_PROFILE_END();
+
+        profilerPush(&gpuProfiler, "upscale");
+        sceneTargetBlit(&sceneTarget, renderWidth, renderHeight, SCR_WIDTH, SCR_HEIGHT);
+        profilerPop(&gpuProfiler);   // upscale
+        profilerPop(&gpuProfiler);   // frame
+        profilerEndFrame(&gpuProfiler);
+
+        // CPU time is everything up to the swap, which may block on vsync
+        const float cpuMs = static_cast<float>(glfwGetTime() - now) * 1000.0f;
+        if (governorUpdate(&governor, cpuMs, governorGpuFrameMs(&gpuProfiler), now)) {
+            applyQualityLevel(diffuseMap, specularMap);
+        }
 
-            glDepthMask(GL_TRUE);
-            glDepthFunc(GL_LESS);
+        statsFrames++;
+        if (currentFrame - lastStatsTime >= 2.0f) {
+            statePrintStats(&glState, statsFrames);
+            profilerPrintStats(&gpuProfiler);
+            lastStatsTime = currentFrame;
+            statsFrames = 0;
         }
 
+        CPU_PROFILE_BEGIN("glfwSwapBuffers");
         glfwSwapBuffers(window);
+        CPU_PROFILE_END();
         glfwPollEvents();
 
-        GLenum err = glGetError();
-        if (err != GL_NO_ERROR) {
-            std::cerr << "OpenGL error: 0x" << std::hex << err << std::dec << std::endl;
-        }
+        // Errors come through the debug callback, this only polls where KHR_debug is missing (debug builds only)
+        GL_DEBUG_FRAME_CHECK();
+        CPU_PROFILE_END();
     }
 
+    CPU_PROFILE_FLUSH(CPU_TRACE_PATH);
+    inputRecordingFinish(&inputRecording);
+
+    pointShadowsShutdown(&pointShadows);
+    profilerDestroy(&gpuProfiler);
+    sceneTargetRelease(&sceneTarget);
     glDeleteVertexArrays(1, &cubeVAO);
     glDeleteVertexArrays(1, &lightCubeVAO);
     glDeleteBuffers(1, &VBO);
     glDeleteProgram(cubeObjectProgram);
+    glDeleteProgram(cubeObjectLegacyProgram);
     glDeleteProgram(lightCubeProgram);
 
     glfwTerminate();
     return 0;
 }
 
-void ProcessInput(GLFWwindow *window)
+/// Moves the camera and applies toggles from the frame's (live or replayed) input, only Escape is read live
+/// @param window Window
+/// @param input This frame's input
+void ProcessInput(GLFWwindow *window, const InputFrame* input)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    applyCameraInput(input);
+    processToggles();
+}
+
+/// Moves the camera from a frame's input, shared with the software renderer which has no window
+/// @param input This frame's input
+void applyCameraInput(const InputFrame* input)
+{
+    if (input->cursorDeltaX != 0.0f || input->cursorDeltaY != 0.0f)
+        cameraProcessMouseMovement(&camera, input->cursorDeltaX, input->cursorDeltaY);
+    if (input->scrollDelta != 0.0f)
+        cameraProcessMouseScroll(&camera, input->scrollDelta);
+
+    if (inputKeyDown(input, RECORDED_KEYS, NUM_RECORDED_KEYS, GLFW_KEY_W))
         cameraProcessKeyboard(&camera, forwardDir, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if (inputKeyDown(input, RECORDED_KEYS, NUM_RECORDED_KEYS, GLFW_KEY_S))
         cameraProcessKeyboard(&camera, backwardDir, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if (inputKeyDown(input, RECORDED_KEYS, NUM_RECORDED_KEYS, GLFW_KEY_A))
         cameraProcessKeyboard(&camera, leftDir, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if (inputKeyDown(input, RECORDED_KEYS, NUM_RECORDED_KEYS, GLFW_KEY_D))
         cameraProcessKeyboard(&camera, rightDir, deltaTime);
+
+    const float cameraState[6] = {camera.Position.x, camera.Position.y, camera.Position.z, camera.Yaw, camera.Pitch, camera.Zoom};
+    inputRecordingTrack(&inputRecording, cameraState, 6);
+}
+
+// F9 : write the CPU trace, V : legacy or precomputed vertex transforms, K : shadows on / off
+// G : governor on / off, T : cycle the governor's target frame rate
+// Read from the frame's (live or replayed) input, so a replay toggles at the same frames as the recording
+void processToggles()
+{
+    auto pressed = [](int key) { return inputKeyPressed(&inputRecording, RECORDED_KEYS, NUM_RECORDED_KEYS, key); };
+    if (pressed(GLFW_KEY_G)) {
+        governor.enabled = !governor.enabled;
+        governorReset(&governor, static_cast<float>(glfwGetTime()));
+        qualityDirty = true;
+    }
+    if (pressed(GLFW_KEY_T)) {
+        governorCycleTarget(&governor);
+    }
+    if (pressed(GLFW_KEY_F9)) {
+        CPU_PROFILE_FLUSH(CPU_TRACE_PATH);
+    }
+    if (pressed(GLFW_KEY_V)) {
+        legacyTransforms = !legacyTransforms;
+        std::cout << "Cube transforms : " << (legacyTransforms ? "legacy, inverse per vertex" : "precomputed on the CPU") << std::endl;
+    }
+    if (pressed(GLFW_KEY_K)) {
+        pointShadows.enabled = !pointShadows.enabled;
+        std::cout << "Shadows : " << (pointShadows.enabled ? "on" : "off") << std::endl;
+    }
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int, int)
 {
     glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
     glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+    sceneTargetDirty = true;
 }
 
 void mouse_callback(GLFWwindow* window, const double xPos, const double yPos)
@@ -710,10 +1276,125 @@ void mouse_callback(GLFWwindow* window, const double xPos, const double yPos)
     float yOffset = lastY - ypos; // reversed
     lastX = xpos;
     lastY = ypos;
-    cameraProcessMouseMovement(&camera, xOffset, yOffset);
+    // Applied once per frame from the recorded input
+    inputRecordingAddCursor(&inputRecording, xOffset, yOffset);
 }
 
 void scroll_callback(GLFWwindow*, double, const double yOffset)
 {
-    cameraProcessMouseScroll(&camera, static_cast<float>(yOffset));
-}
\ No newline at end of file
+    inputRecordingAddScroll(&inputRecording, static_cast<float>(yOffset));
+}
+/// Software renderer : ---- (start)
+/// Loads a texture for the software renderer, black if it fails like an incomplete GL texture
+/// @param texture Receives the texture
+/// @param path Image path
+void loadSoftwareTexture(SwTexture* texture, const char* path) {
+    CPU_PROFILE_SCOPE("loadSoftwareTexture");
+    int width, height, channels;
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if (data) {
+        swTextureFromPixels(texture, data, width, height, channels);
+    } else {
+        std::cout << "Failed to load texture" << std::endl;
+        swTextureBlack(texture);
+    }
+    stbi_image_free(data);
+}
+
+/// Loads the sky faces for the software renderer, a face that fails stays black
+/// @param cubeMap Receives the faces
+/// @param faces Image paths, +X -X +Y -Y +Z -Z
+void loadSoftwareCubeMap(SwCubeMap* cubeMap, const std::vector<std::string>& faces) {
+    CPU_PROFILE_SCOPE("loadSoftwareCubeMap");
+    for (size_t i = 0; i < faces.size() && i < 6; i++) {
+        int width, height, channels;
+        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &channels, 0);
+        if (!data) {
+            std::cout << "Failed to load cubemap: " << faces[i] << std::endl;
+            continue;
+        }
+        swImageFromPixels(&cubeMap->faces[i], data, width, height, channels);
+        stbi_image_free(data);
+    }
+}
+
+/// Renders the scene on the CPU at SOFTWARE_WIDTH x SOFTWARE_HEIGHT and writes the last frame to SOFTWARE_OUTPUT_PATH
+/// @param frameCount Frames to render, a replay stops earlier if it runs out
+/// @param threads Threads to render on
+/// @return Exit code
+int runSoftwareRenderer(int frameCount, int threads) {
+    if (inputRecording.mode == INPUT_RECORD) {
+        std::cout << "--record needs the GL window, it cannot be combined with --software" << std::endl;
+        return -1;
+    }
+    CPU_PROFILE_THREAD_NAME("main");
+    CPU_PROFILE_BEGIN("startup");
+    cameraInit(&camera, vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f, 2.0f, 0.2f, 45.0f);
+
+    SwCubeMap sky;
+    loadSoftwareCubeMap(&sky, SKYBOX_FACES);
+    stbi_set_flip_vertically_on_load(true);
+    SwTexture diffuseMap, specularMap;
+    loadSoftwareTexture(&diffuseMap, DIFFUSE_MAP_PATH);
+    loadSoftwareTexture(&specularMap, SPECULAR_MAP_PATH);
+
+    SwMesh cubeMesh;
+    swMeshFromInterleaved(&cubeMesh, cubeVertices, 36);
+    SwMaterial cubeMaterial;
+    cubeMaterial.diffuse = &diffuseMap;
+    cubeMaterial.specular = &specularMap;
+    cubeMaterial.shininess = MATERIAL_SHININESS;
+    SwMaterial lightCubeMaterial;   // lightCubeFragmentShader with lightColor (1, 1, 1)
+    const SwPointLight light = {lightPos, LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR, LIGHT_CONSTANT, LIGHT_LINEAR, LIGHT_QUADRATIC};
+
+    // Same order as the GL draws : the cubes, then the light
+    SwDraw draws[NUM_CUBES + 1];
+    for (int i = 0; i < NUM_CUBES; i++) { draws[i] = {&cubeMesh, &cubeMaterial, glm::mat4(1.0f)}; }
+    draws[NUM_CUBES] = {&cubeMesh, &lightCubeMaterial, lightCubeModelMatrix()};
+
+    SwRenderer renderer;
+    swRendererInit(&renderer, SOFTWARE_WIDTH, SOFTWARE_HEIGHT, threads);
+    CPU_PROFILE_END();
+
+    const auto start = std::chrono::steady_clock::now();
+    auto lastStats = start;
+    int frames = 0;
+    while (frames < frameCount) {
+        InputFrame input{};
+        if (!inputRecordingNextFrame(&inputRecording, SOFTWARE_FRAME_SECONDS, 0, &input)) {
+            break; // replay finished
+        }
+        CPU_PROFILE_BEGIN("frame");
+        deltaTime = input.frameSeconds;
+        const float currentFrame = static_cast<float>(inputRecording.time);
+        applyCameraInput(&input);
+
+        for (int i = 0; i < NUM_CUBES; i++) { draws[i].model = cubeModelMatrix(i, currentFrame); }
+        SwCamera view;
+        view.view = getCameraViewMatrix(&camera);
+        view.projection = glm::perspective(glm::radians(camera.Zoom), static_cast<float>(SOFTWARE_WIDTH) / static_cast<float>(SOFTWARE_HEIGHT), 0.1f, 1000.0f);
+        view.position = camera.Position;
+        view.sky = &sky;
+        swRenderFrame(&renderer, draws, NUM_CUBES + 1, light, view);
+        frames++;
+        CPU_PROFILE_END();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastStats).count() >= 2.0) {
+            swPrintStats(&renderer);
+            lastStats = now;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    swPrintStats(&renderer);
+    if (frames > 0) {
+        std::cout << "Rendered " << frames << " frames in " << seconds << " s : " << seconds * 1000.0 / frames << " ms per frame, "
+                  << frames / seconds << " fps" << std::endl;
+        if (swWritePpm(&renderer, SOFTWARE_OUTPUT_PATH)) { std::cout << "Wrote " << SOFTWARE_OUTPUT_PATH << std::endl; }
+    }
+    swRendererShutdown(&renderer);
+    CPU_PROFILE_FLUSH(CPU_TRACE_PATH);
+    return 0;
+}
+/// Software renderer : ---- (end)
@@ -10,6 +10,9 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "GLDebug.h"
+#include "PointShadows.h"
+#include "FrameGovernor.h"
 using namespace std;
 using namespace glm;
 /// Shader helpers : ---- (start)
@@ -208,6 +211,7 @@ out vec4 FragColor;
 uniform vec3 viewPos;
 uniform Material material;
 uniform Light light;
+uniform float shadowRadius;
 
 void main()
 {
@@ -227,9 +231,12 @@ void main()
         light.constant + (light.linear * distance) + (light.quadratic * distance * distance)
     );
 
+    // Point shadows (PointShadows.h) : light 0 is the only light
+    float shadow = pointShadow(0, FragPos, norm, light.position, shadowRadius);
+
     ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
+    diffuse *= attenuation * shadow;
+    specular *= attenuation * shadow;
 
     vec3 result = ambient + diffuse + specular;
     FragColor = vec4(result, 1.0);
@@ -305,6 +312,7 @@ GLuint loadTexture(const char* path) {
         else if (channels == 4) { format = GL_RGBA; }
 
         glBindTexture(GL_TEXTURE_2D, texture);
+        GL_DEBUG_LABEL_TEXTURE(texture, path);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -324,6 +332,7 @@ GLuint loadCubeMap(std::vector<std::string> faces)
     GLuint texID;
     glGenTextures(1, &texID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+    GL_DEBUG_LABEL(GL_TEXTURE, texID, "skybox");
 
     int w, h, ch;
     for (unsigned int i = 0; i < faces.size(); i++) {
@@ -363,21 +372,54 @@ float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
 glm::vec3 lightPos(0.0f, 0.0f, 0.0f);
+
+// The orbiting cubes shadow each other from lightPos, K turns it off
+PointShadows pointShadows;
+constexpr int SHADOW_CUBE_SIZE = 1024;
+// The cubes orbit a still light, so all six faces are redrawn every frame
+constexpr int SHADOW_FACE_BUDGET = 6;
+// Far plane of the shadow cube, past the orbit of the cubes
+constexpr float SHADOW_RADIUS = 10.0f;
+
+// Frame budget governor (FrameGovernor.h) : render scale, texture LOD bias and shadow cube size. The single light has
+// no cutoff to raise. G toggles it, T cycles the target frame rate.
+// GPU times come from the profiler : the governor reads the root "frame" scope, the 2 s report shows every pass.
+FrameGovernor governor;
+GpuProfiler gpuProfiler;
+SceneTarget sceneTarget;
+bool sceneTargetDirty = true;
+bool qualityDirty = true;   // set by G, applied in the render loop where the textures are known
+const char* GOVERNOR_LOG_PATH = "frame_governor_attenuation2.csv";
 /// App Global --- (end)
 
 /// Callbacks ---- (start)
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, GLdouble xPos, GLdouble yPos);
 void scroll_callback(GLFWwindow* window, GLdouble xOffset, GLdouble yOffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void ProcessInput(GLFWwindow* window);
 /// Callbacks ---- (end)
 
+/// Applies the governor's quality level to the knobs this scene has
+/// @param diffuseMap Diffuse texture
+/// @param specularMap Specular texture
+void applyQualityLevel(GLuint diffuseMap, GLuint specularMap)
+{
+    const QualityLevel& quality = governorQuality(&governor);
+    glBindTexture(GL_TEXTURE_2D, diffuseMap);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, quality.lodBias);
+    glBindTexture(GL_TEXTURE_2D, specularMap);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, quality.lodBias);
+    pointShadowsResize(&pointShadows, static_cast<int>(SHADOW_CUBE_SIZE * quality.shadowScale));
+}
+
 int main() {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    GL_DEBUG_WINDOW_HINTS();
 
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -394,6 +436,7 @@ int main() {
         std::cout << "Failed to initialise GLAD" << std::endl;
         return -1;
     }
+    GL_DEBUG_INIT();
 
     glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
     glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
@@ -402,6 +445,7 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
 
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -409,15 +453,18 @@ int main() {
 
     // Compile shader
     std::cout << "Compiling cube objects Program --- (start)" << std::endl;
-    GLuint cubeObjectProgram = createProgram(cubeObjectVertexShader, cubeObjectFragmentShader);
+    GLuint cubeObjectProgram = createProgram(cubeObjectVertexShader, pointShadowsShaderSource(cubeObjectFragmentShader).c_str());
+    GL_DEBUG_LABEL(GL_PROGRAM, cubeObjectProgram, "cubeObjectProgram");
     std::cout << "Compiling cube objetcs Program --- (end)" << std::endl;
 
     std::cout << "Compiling lighting cube program -- (start)" << std::endl;
     GLuint lightCubeProgram = createProgram(lightCubeVertexShader, lightCubeFragmentShader);
+    GL_DEBUG_LABEL(GL_PROGRAM, lightCubeProgram, "lightCubeProgram");
     std::cout << "Compiling lighting cube program -- (end)" << std::endl;
 
     std::cout << "Generating ShaderProgramSky --- (start)" << std::endl;
     GLuint ShaderProgramSky = createProgram(cubeMapVertexShader, cubeMapFragmentShader);
+    GL_DEBUG_LABEL(GL_PROGRAM, ShaderProgramSky, "ShaderProgramSky");
     std::cout << "Generating ShaderProgramSky --- (end)" << std::endl;
 
         // cube vertex data
@@ -487,8 +534,10 @@ int main() {
     GLuint VBO, cubeVAO, lightCubeVAO;
     glGenVertexArrays(1, &cubeVAO);
     glBindVertexArray(cubeVAO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, cubeVAO, "cubeVAO");
     glGenBuffers(1, &VBO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GL_DEBUG_LABEL(GL_BUFFER, VBO, "cube vertices");
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
     glEnableVertexAttribArray(0);
@@ -499,6 +548,7 @@ int main() {
 
     glGenVertexArrays(1, &lightCubeVAO);
     glBindVertexArray(lightCubeVAO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, lightCubeVAO, "lightCubeVAO");
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
     glEnableVertexAttribArray(0);
@@ -510,6 +560,8 @@ int main() {
 
     glBindVertexArray(skyVAO);
     glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, skyVAO, "skyVAO");
+    GL_DEBUG_LABEL(GL_BUFFER, skyVBO, "sky vertices");
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), nullptr);
@@ -561,8 +613,22 @@ int main() {
     std::cout << "LightShaderView : " << LightShaderView << std::endl;
     GLint LightShaderModel = glGetUniformLocation(cubeObjectProgram, "model");
     std::cout << "LightShaderModel : " << LightShaderModel << std::endl;
+    GLint ShadowsEnabled = glGetUniformLocation(cubeObjectProgram, "pointShadowsEnabled");
+    glUniform1i(glGetUniformLocation(cubeObjectProgram, "pointShadowCubes"), 2);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "shadowRadius"), SHADOW_RADIUS);
+
+    pointShadowsInit(&pointShadows, 1, SHADOW_CUBE_SIZE, SHADOW_FACE_BUDGET, VBO, 8 * sizeof(float));
+    pointShadowsSetLight(&pointShadows, 0, lightPos, SHADOW_RADIUS);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, pointShadows.cubeArray);
+    glActiveTexture(GL_TEXTURE0);
+    glm::mat4 cubeModels[6];
+
+    governorOpenLog(&governor, GOVERNOR_LOG_PATH);
+    profilerInit(&gpuProfiler);
 
     float currentFrame = 0.0f;
+    float lastStatsTime = 0.0f;
 
     while (!glfwWindowShouldClose(window)) {
         currentFrame = glfwGetTime();
@@ -571,6 +637,34 @@ int main() {
 
         ProcessInput(window);
 
+        profilerBeginFrame(&gpuProfiler);
+        profilerPush(&gpuProfiler, "frame");
+        if (sceneTargetDirty) {
+            sceneTargetResize(&sceneTarget, SCR_WIDTH, SCR_HEIGHT);
+            sceneTargetDirty = false;
+        }
+        if (qualityDirty) {
+            applyQualityLevel(diffuseMap, specularMap);
+            qualityDirty = false;
+        }
+
+        for (unsigned int i = 0; i < 6; i++) {
+            const float angle = 5.0f * (i+1) * glfwGetTime();
+            glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(1.0f, 1.0f, 1.0f));
+            model = glm::translate(model, cubePositions[i]);
+            cubeModels[i] = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+        }
+
+        // Shadow cube first, the cubes cast and the light cube does not
+        profilerPush(&gpuProfiler, "shadows");
+        pointShadowsUpdate(&pointShadows, camera.Position, cubeModels, 6, 36);
+        profilerPop(&gpuProfiler);
+        int renderWidth, renderHeight;
+        governorRenderSize(&governor, SCR_WIDTH, SCR_HEIGHT, &renderWidth, &renderHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget.framebuffer);
+        glViewport(0, 0, renderWidth, renderHeight);
+
+        profilerPush(&gpuProfiler, "opaque");
         glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -586,6 +680,7 @@ int main() {
         glUniform1f(LightQuadratic, 0.0075f);
 
         glUniform1f(MaterialShininess, 512.0f);
+        glUniform1i(ShadowsEnabled, pointShadows.enabled ? 1 : 0);
 
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT), 0.1f, 1000.0f);
         glm::mat4 view = getCameraViewMatrix(&camera);
@@ -601,17 +696,7 @@ int main() {
         glBindVertexArray(cubeVAO);
 
         for (unsigned int i = 0; i < 6; i++) {
-
-            model = glm::mat4(1.0f);
-            const float angle = 5.0f * (i+1) * glfwGetTime();
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 1.0f, 1.0f));
-
-            model = glm::translate(model, cubePositions[i]);
-
-
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-
-            glUniformMatrix4fv(LightShaderModel, 1, GL_FALSE, glm::value_ptr(model));
+            glUniformMatrix4fv(LightShaderModel, 1, GL_FALSE, glm::value_ptr(cubeModels[i]));
             glDrawArrays(GL_TRIANGLES, 0, 36);
         }
 
@@ -627,8 +712,10 @@ int main() {
 
         glBindVertexArray(lightCubeVAO);
         glDrawArrays(GL_TRIANGLES, 0, 36);
+        profilerPop(&gpuProfiler);
 
         if (true) {
+            GpuScope skyScope(&gpuProfiler, "sky");
             glDepthMask(GL_FALSE);
             glDepthFunc(GL_LEQUAL);
             glUseProgram(ShaderProgramSky);
@@ -648,15 +735,32 @@ int main() {
             glDepthFunc(GL_LESS);
         }
 
+        profilerPush(&gpuProfiler, "upscale");
+        sceneTargetBlit(&sceneTarget, renderWidth, renderHeight, SCR_WIDTH, SCR_HEIGHT);
+        profilerPop(&gpuProfiler);   // upscale
+        profilerPop(&gpuProfiler);   // frame
+        profilerEndFrame(&gpuProfiler);
+
+        // CPU time is everything up to the swap, which may block on vsync
+        const float cpuMs = static_cast<float>(glfwGetTime() - currentFrame) * 1000.0f;
+        if (governorUpdate(&governor, cpuMs, governorGpuFrameMs(&gpuProfiler), currentFrame)) {
+            applyQualityLevel(diffuseMap, specularMap);
+        }
+        if (currentFrame - lastStatsTime >= 2.0f) {
+            profilerPrintStats(&gpuProfiler);
+            lastStatsTime = currentFrame;
+        }
+
         glfwSwapBuffers(window);
         glfwPollEvents();
 
-        GLenum err = glGetError();
-        if (err != GL_NO_ERROR) {
-            std::cerr << "OpenGL error: 0x" << std::hex << err << std::dec << std::endl;
-        }
+        // Errors come through the debug callback, this only polls where KHR_debug is missing (debug builds only)
+        GL_DEBUG_FRAME_CHECK();
     }
 
+    pointShadowsShutdown(&pointShadows);
+    profilerDestroy(&gpuProfiler);
+    sceneTargetRelease(&sceneTarget);
     glDeleteVertexArrays(1, &cubeVAO);
     glDeleteVertexArrays(1, &lightCubeVAO);
     glDeleteBuffers(1, &VBO);
@@ -682,10 +786,28 @@ void ProcessInput(GLFWwindow *window)
         cameraProcessKeyboard(&camera, rightDir, deltaTime);
 }
 
+// K : shadows on / off, G : governor on / off, T : cycle the governor's target frame rate
+void key_callback(GLFWwindow*, int key, int, int action, int)
+{
+    if (action == GLFW_PRESS && key == GLFW_KEY_G) {
+        governor.enabled = !governor.enabled;
+        governorReset(&governor, static_cast<float>(glfwGetTime()));
+        qualityDirty = true;
+    }
+    if (action == GLFW_PRESS && key == GLFW_KEY_T) {
+        governorCycleTarget(&governor);
+    }
+    if (action == GLFW_PRESS && key == GLFW_KEY_K) {
+        pointShadows.enabled = !pointShadows.enabled;
+        std::cout << "Shadows : " << (pointShadows.enabled ? "on" : "off") << std::endl;
+    }
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int, int)
 {
     glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
     glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+    sceneTargetDirty = true;
 }
 
 void mouse_callback(GLFWwindow* window, const double xPos, const double yPos)
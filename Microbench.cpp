@@ -0,0 +1,868 @@
+// CPU microbenchmarks for the routines the demos run at startup or every frame, built as ogl_microbench when Google
+// Benchmark is installed.
+//
+// The demos are single-file programs with their own main(), so each routine is copied here as its Baseline variant,
+// kept as close to the demo as possible. Its Optimized variant is registered next to it over the same input sizes:
+//   ./ogl_microbench --benchmark_filter=Flag
+// lists both one after the other. A candidate only moves into a demo once it wins here, and when a demo's routine
+// changes its Baseline copy changes with it. Every Optimized benchmark first runs both variants on its input and
+// stops instead of timing a variant that returns something else, and the program then exits with status 1 so a
+// script or CI job running it sees the mismatch.
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include "SimdMath.h"
+
+using namespace glm;
+
+/// Defining Globals variable ---- (start)
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+constexpr float SIM_TICK_SECONDS = 1.0f / 60.0f;
+/// Largest difference allowed between an Optimized variant and its Baseline (float reordering only)
+constexpr float BENCH_TOLERANCE = 1e-4f;
+/// Defining Globals variable ---- (end)
+
+
+/// Benchmarks stopped because a variant returned something else, main() fails when there is any
+static int benchMismatches = 0;
+
+/// Stops a benchmark whose result does not match its reference and counts it against the exit status
+/// @param state Benchmark state
+/// @param message Reported next to the benchmark
+static void benchFail(benchmark::State& state, const char* message) {
+    benchMismatches++;
+    state.SkipWithError(message);
+}
+
+/// Largest difference between two float arrays, relative for values above 1
+static float benchMaxError(const float* result, const float* reference, size_t floats) {
+    float worst = 0.0f;
+    for (size_t i = 0; i < floats; i++) {
+        worst = std::max(worst, std::abs(result[i] - reference[i]) / std::max(1.0f, std::abs(reference[i])));
+    }
+    return worst;
+}
+
+
+/// Flag vertices (FlagSimulation.cpp) ---- (start)
+struct StructVertexFlag {
+    vec3 pos;
+    vec2 TextureCord;
+};
+
+void AddStripBaseline(std::vector<StructVertexFlag>& FlagVertices, vec3 UpperLeft, vec3 BottomRight, float Density, float StripNumber) {
+    auto push = [&](vec3 p, float u, float v) {
+        FlagVertices.push_back({ p, {u, v} });
+    };
+
+    float u0 = (StripNumber - 1.0f) / Density;
+    float u1 = StripNumber / Density;
+
+    push(UpperLeft,            u0, 1.0f);
+    push({BottomRight.x, UpperLeft.y, 0}, u1, 1.0f);
+    push({UpperLeft.x, BottomRight.y, 0}, u0, 0.0f);
+
+    push({UpperLeft.x, BottomRight.y, 0}, u0, 0.0f);
+    push({BottomRight.x, UpperLeft.y, 0}, u1, 1.0f);
+    push(BottomRight,          u1, 0.0f);
+}
+
+void CreateFlagVerticesBaseline(std::vector<StructVertexFlag>& FlagVertices, vec3 UpperLeft, vec3 UpperRight, vec3 BottomLeft, float Density) {
+    float flagLength = UpperRight.x - UpperLeft.x;
+    float StripLength = flagLength / Density;
+
+    for (float i = 1.0f; i < Density; i++) {
+        vec3 StripUpperLeft = UpperLeft + vec3((i - 1.0f)*StripLength, 0.0f, 0.0f);
+        vec3 StripBottomRight = BottomLeft + vec3((i)*StripLength, 0.0f, 0.0f);
+
+        AddStripBaseline(FlagVertices, StripUpperLeft, StripBottomRight, Density, i);
+    }
+}
+
+/// Same vertices in one allocation : the strip count is known up front, so the vector is sized once and every
+/// vertex is written in place instead of going through push_back's capacity check
+/// @param FlagVertices Output, replaced
+/// @param UpperLeft Corner
+/// @param UpperRight Corner
+/// @param BottomLeft Corner
+/// @param Density Strips + 1
+void CreateFlagVerticesOptimized(std::vector<StructVertexFlag>& FlagVertices, vec3 UpperLeft, vec3 UpperRight, vec3 BottomLeft, float Density) {
+    const float StripLength = (UpperRight.x - UpperLeft.x) / Density;
+    const int strips = Density > 1.0f ? static_cast<int>(std::ceil(Density - 1.0f)) : 0;
+    FlagVertices.resize(static_cast<size_t>(strips) * 6);
+    StructVertexFlag* out = FlagVertices.data();
+
+    for (int strip = 1; strip <= strips; strip++) {
+        const float i = static_cast<float>(strip);
+        const float left = UpperLeft.x + (i - 1.0f) * StripLength;
+        const float right = BottomLeft.x + i * StripLength;
+        const float u0 = (i - 1.0f) / Density;
+        const float u1 = i / Density;
+        const vec3 upperLeft(left, UpperLeft.y, UpperLeft.z);
+        const vec3 upperRight(right, UpperLeft.y, 0.0f);
+        const vec3 bottomLeft(left, BottomLeft.y, 0.0f);
+        const vec3 bottomRight(right, BottomLeft.y, BottomLeft.z);
+
+        out[0] = {upperLeft, {u0, 1.0f}};
+        out[1] = {upperRight, {u1, 1.0f}};
+        out[2] = {bottomLeft, {u0, 0.0f}};
+        out[3] = {bottomLeft, {u0, 0.0f}};
+        out[4] = {upperRight, {u1, 1.0f}};
+        out[5] = {bottomRight, {u1, 0.0f}};
+        out += 6;
+    }
+}
+
+static void BM_FlagVerticesBaseline(benchmark::State& state) {
+    const float density = static_cast<float>(state.range(0));
+    for (auto _ : state) {
+        std::vector<StructVertexFlag> vertices;
+        CreateFlagVerticesBaseline(vertices, vec3(0.0f, 0.5f, 0.0f), vec3(1.5f, 0.5f, 0.0f), vec3(0.0f, -0.5f, 0.0f), density);
+        benchmark::DoNotOptimize(vertices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(density - 1.0f) * 6);
+}
+BENCHMARK(BM_FlagVerticesBaseline)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_FlagVerticesOptimized(benchmark::State& state) {
+    const float density = static_cast<float>(state.range(0));
+    std::vector<StructVertexFlag> reference, result;
+    CreateFlagVerticesBaseline(reference, vec3(0.0f, 0.5f, 0.0f), vec3(1.5f, 0.5f, 0.0f), vec3(0.0f, -0.5f, 0.0f), density);
+    CreateFlagVerticesOptimized(result, vec3(0.0f, 0.5f, 0.0f), vec3(1.5f, 0.5f, 0.0f), vec3(0.0f, -0.5f, 0.0f), density);
+    if (result.size() != reference.size()
+        || benchMaxError(&result[0].pos.x, &reference[0].pos.x, reference.size() * sizeof(StructVertexFlag) / sizeof(float)) > BENCH_TOLERANCE) {
+        benchFail(state, "differs from baseline");
+        return;
+    }
+    for (auto _ : state) {
+        std::vector<StructVertexFlag> vertices;
+        CreateFlagVerticesOptimized(vertices, vec3(0.0f, 0.5f, 0.0f), vec3(1.5f, 0.5f, 0.0f), vec3(0.0f, -0.5f, 0.0f), density);
+        benchmark::DoNotOptimize(vertices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(density - 1.0f) * 6);
+}
+BENCHMARK(BM_FlagVerticesOptimized)->RangeMultiplier(10)->Range(10, 100000);
+/// Flag vertices (FlagSimulation.cpp) ---- (end)
+
+
+/// Box vertices (FlagSimulation.cpp) ---- (start)
+struct StructVertexBox {
+    vec3 pos;
+    vec3 color;
+};
+
+void addBoxBaseline(std::vector<StructVertexBox>& verts, vec3 min, vec3 max, vec3 boxColor) {
+    auto push = [&](vec3 p) {
+        vec3 color = boxColor;
+        verts.push_back({ p, color });
+    };
+
+    // Front (+Z)
+    push({min.x, min.y, max.z}); push({max.x, min.y, max.z}); push({max.x, max.y, max.z});
+    push({min.x, min.y, max.z}); push({max.x, max.y, max.z}); push({min.x, max.y, max.z});
+    // Back (-Z)
+    push({max.x, min.y, min.z}); push({min.x, min.y, min.z}); push({min.x, max.y, min.z});
+    push({max.x, min.y, min.z}); push({min.x, max.y, min.z}); push({max.x, max.y, min.z});
+    // Left (-X)
+    push({min.x, min.y, min.z}); push({min.x, min.y, max.z}); push({min.x, max.y, max.z});
+    push({min.x, min.y, min.z}); push({min.x, max.y, max.z}); push({min.x, max.y, min.z});
+    // Right (+X)
+    push({max.x, min.y, max.z}); push({max.x, min.y, min.z}); push({max.x, max.y, min.z});
+    push({max.x, min.y, max.z}); push({max.x, max.y, min.z}); push({max.x, max.y, max.z});
+    // Top (+Y)
+    push({min.x, max.y, max.z}); push({max.x, max.y, max.z}); push({max.x, max.y, min.z});
+    push({min.x, max.y, max.z}); push({max.x, max.y, min.z}); push({min.x, max.y, min.z});
+    // Bottom (-Y)
+    push({min.x, min.y, min.z}); push({max.x, min.y, min.z}); push({max.x, min.y, max.z});
+    push({min.x, min.y, min.z}); push({max.x, min.y, max.z}); push({min.x, min.y, max.z});
+}
+
+/// Corner index (bit 0 = max x, bit 1 = max y, bit 2 = max z) of each of the 36 vertices, in addBox's order
+constexpr unsigned char BOX_CORNERS[36] = {
+    4, 5, 7, 4, 7, 6,   1, 0, 2, 1, 2, 3,   0, 4, 6, 0, 6, 2,
+    5, 1, 3, 5, 3, 7,   6, 7, 3, 6, 3, 2,   0, 1, 5, 0, 5, 4
+};
+
+/// Same triangles from a corner table, appended with a single grow of the vector
+/// @param verts Output, appended to
+/// @param min Box minimum
+/// @param max Box maximum
+/// @param boxColor Colour of every vertex
+void addBoxOptimized(std::vector<StructVertexBox>& verts, vec3 min, vec3 max, vec3 boxColor) {
+    const size_t first = verts.size();
+    verts.resize(first + 36);
+    StructVertexBox* out = verts.data() + first;
+    for (int i = 0; i < 36; i++) {
+        const unsigned corner = BOX_CORNERS[i];
+        out[i] = {{(corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z}, boxColor};
+    }
+}
+
+static void BM_BoxesBaseline(benchmark::State& state) {
+    const int boxes = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        std::vector<StructVertexBox> vertices;
+        for (int i = 0; i < boxes; i++) {
+            const float x = static_cast<float>(i) * 0.1f;
+            addBoxBaseline(vertices, vec3(x, -1.0f, -0.05f), vec3(x + 0.05f, 1.0f, 0.05f), vec3(0.4f, 0.4f, 0.4f));
+        }
+        benchmark::DoNotOptimize(vertices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * boxes);
+}
+BENCHMARK(BM_BoxesBaseline)->RangeMultiplier(8)->Range(1, 4096);
+
+static void BM_BoxesOptimized(benchmark::State& state) {
+    const int boxes = static_cast<int>(state.range(0));
+    std::vector<StructVertexBox> reference, result;
+    for (int i = 0; i < boxes; i++) {
+        const float x = static_cast<float>(i) * 0.1f;
+        addBoxBaseline(reference, vec3(x, -1.0f, -0.05f), vec3(x + 0.05f, 1.0f, 0.05f), vec3(0.4f, 0.4f, 0.4f));
+        addBoxOptimized(result, vec3(x, -1.0f, -0.05f), vec3(x + 0.05f, 1.0f, 0.05f), vec3(0.4f, 0.4f, 0.4f));
+    }
+    if (benchMaxError(&result[0].pos.x, &reference[0].pos.x, reference.size() * sizeof(StructVertexBox) / sizeof(float)) > 0.0f) {
+        benchFail(state, "differs from baseline");
+        return;
+    }
+    for (auto _ : state) {
+        std::vector<StructVertexBox> vertices;
+        vertices.reserve(static_cast<size_t>(boxes) * 36);
+        for (int i = 0; i < boxes; i++) {
+            const float x = static_cast<float>(i) * 0.1f;
+            addBoxOptimized(vertices, vec3(x, -1.0f, -0.05f), vec3(x + 0.05f, 1.0f, 0.05f), vec3(0.4f, 0.4f, 0.4f));
+        }
+        benchmark::DoNotOptimize(vertices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * boxes);
+}
+BENCHMARK(BM_BoxesOptimized)->RangeMultiplier(8)->Range(1, 4096);
+/// Box vertices (FlagSimulation.cpp) ---- (end)
+
+
+/// Procedural texture (Texture constructor in MultipleLights.cpp and friends) ---- (start)
+// Only the pixel loop, the upload is GPU work
+void textureFillBaseline(unsigned char* data, int size) {
+    for (int y = 0 ; y < size ; y++) {
+        for (int x = 0 ; x < size ; x++) {
+            const float fx = static_cast<float>(x) / size;
+            const float fy = static_cast<float>(y) / size;
+            float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+            const int i = (y * size + x) * 4;
+            data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+            data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+            data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+            data[i+3] = 255;
+        }
+    }
+}
+
+/// Same pattern without per-pixel trig. Every term is sin or cos of (a * fx + b * fy), which splits by the angle
+/// sum identities into a column part and a row part, so the trig runs once per row and column and each pixel is
+/// a few multiply-adds. Results can differ from the baseline by one step of rounding in a channel.
+/// @param data RGBA output, size * size * 4 bytes
+/// @param size Width and height
+void textureFillOptimized(unsigned char* data, int size) {
+    // Per column and per row sin / cos of the four terms : n (20, 10), red (12, 8), green (10, 12), blue (8, 15)
+    constexpr float FX[4] = {20.0f, 12.0f, 10.0f, 8.0f};
+    constexpr float FY[4] = {10.0f, 8.0f, 12.0f, 15.0f};
+    std::vector<float> colSin(static_cast<size_t>(size) * 4), colCos(static_cast<size_t>(size) * 4);
+    for (int x = 0; x < size; x++) {
+        const float fx = static_cast<float>(x) / size;
+        for (int k = 0; k < 4; k++) {
+            colSin[x * 4 + k] = std::sin(FX[k] * fx);
+            colCos[x * 4 + k] = std::cos(FX[k] * fx);
+        }
+    }
+
+    for (int y = 0; y < size; y++) {
+        const float fy = static_cast<float>(y) / size;
+        float rowSin[4], rowCos[4];
+        for (int k = 0; k < 4; k++) {
+            rowSin[k] = std::sin(FY[k] * fy);
+            rowCos[k] = std::cos(FY[k] * fy);
+        }
+        unsigned char* row = data + static_cast<size_t>(y) * size * 4;
+        for (int x = 0; x < size; x++) {
+            const float* cs = &colSin[x * 4];
+            const float* cc = &colCos[x * 4];
+            // sin(a + b) = sin a cos b + cos a sin b, cos(a + b) = cos a cos b - sin a sin b
+            const float n = (cs[0] * rowCos[0] + cc[0] * rowSin[0]) * 0.5f + 0.5f;
+            const float red = cs[1] * rowCos[1] + cc[1] * rowSin[1];
+            const float green = cc[2] * rowCos[2] - cs[2] * rowSin[2];
+            const float blue = cs[3] * rowCos[3] + cc[3] * rowSin[3];
+            row[x * 4 + 0] = static_cast<unsigned char>((red * 127 + 128) * n);
+            row[x * 4 + 1] = static_cast<unsigned char>((green * 127 + 128) * (1 - n));
+            row[x * 4 + 2] = static_cast<unsigned char>(blue * 127 + 128);
+            row[x * 4 + 3] = 255;
+        }
+    }
+}
+
+static void BM_TextureBaseline(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    std::vector<unsigned char> data(static_cast<size_t>(size) * size * 4);
+    for (auto _ : state) {
+        textureFillBaseline(data.data(), size);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_TextureBaseline)->RangeMultiplier(2)->Range(64, 1024);
+
+static void BM_TextureOptimized(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    std::vector<unsigned char> data(static_cast<size_t>(size) * size * 4);
+    std::vector<unsigned char> reference(data.size());
+    textureFillBaseline(reference.data(), size);
+    textureFillOptimized(data.data(), size);
+    for (size_t i = 0; i < data.size(); i++) {
+        // One step of rounding either way, see textureFillOptimized
+        if (std::abs(static_cast<int>(data[i]) - static_cast<int>(reference[i])) > 1) {
+            benchFail(state, "differs from baseline");
+            return;
+        }
+    }
+    for (auto _ : state) {
+        textureFillOptimized(data.data(), size);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_TextureOptimized)->RangeMultiplier(2)->Range(64, 1024);
+/// Procedural texture ---- (end)
+
+
+/// Camera vectors (cameraUpdateVectors / Camera::updateVectors) ---- (start)
+struct Camera {
+    vec3 Front;
+    vec3 Up;
+    vec3 Right;
+    vec3 WorldUp;
+    float Yaw;
+    float Pitch;
+};
+
+void cameraUpdateVectorsBaseline(Camera* camera) {
+    vec3 front;
+    front.x = cos(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    front.y = sin(radians(camera->Pitch));
+    front.z = sin(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    camera->Front = normalize(front);
+    camera->Right = normalize(cross(camera->Front, camera->WorldUp));
+    camera->Up = normalize(cross(camera->Right, camera->Front));
+}
+
+/// Same vectors with four trig calls instead of six and one normalize fewer : front is unit length by construction,
+/// and up is the cross product of two perpendicular unit vectors
+/// @param camera Camera
+void cameraUpdateVectorsOptimized(Camera* camera) {
+    const float yaw = radians(camera->Yaw);
+    const float pitch = radians(camera->Pitch);
+    const float cosPitch = std::cos(pitch);
+    camera->Front = vec3(std::cos(yaw) * cosPitch, std::sin(pitch), std::sin(yaw) * cosPitch);
+    camera->Right = normalize(cross(camera->Front, camera->WorldUp));
+    camera->Up = cross(camera->Right, camera->Front);
+}
+
+/// A mouse drag : yaw and pitch change every call, as they do in processMouse
+static std::vector<Camera> makeCameras(int count) {
+    std::vector<Camera> cameras(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        cameras[i] = {vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f),
+                      -90.0f + static_cast<float>(i), static_cast<float>(i % 170) - 85.0f};
+    }
+    return cameras;
+}
+
+static void BM_CameraVectorsBaseline(benchmark::State& state) {
+    std::vector<Camera> cameras = makeCameras(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        for (Camera& camera : cameras) {
+            camera.Yaw += 3.0f * MOUSE_SENSITIVITY;
+            cameraUpdateVectorsBaseline(&camera);
+        }
+        benchmark::DoNotOptimize(cameras.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CameraVectorsBaseline)->RangeMultiplier(16)->Range(1, 4096);
+
+static void BM_CameraVectorsOptimized(benchmark::State& state) {
+    std::vector<Camera> cameras = makeCameras(static_cast<int>(state.range(0)));
+    std::vector<Camera> reference = cameras;
+    for (size_t i = 0; i < cameras.size(); i++) {
+        cameraUpdateVectorsBaseline(&reference[i]);
+        Camera result = cameras[i];
+        cameraUpdateVectorsOptimized(&result);
+        if (benchMaxError(&result.Front.x, &reference[i].Front.x, 9) > BENCH_TOLERANCE) {   // Front, Up, Right
+            benchFail(state, "differs from baseline");
+            return;
+        }
+    }
+    for (auto _ : state) {
+        for (Camera& camera : cameras) {
+            camera.Yaw += 3.0f * MOUSE_SENSITIVITY;
+            cameraUpdateVectorsOptimized(&camera);
+        }
+        benchmark::DoNotOptimize(cameras.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CameraVectorsOptimized)->RangeMultiplier(16)->Range(1, 4096);
+/// Camera vectors ---- (end)
+
+
+/// Scene object spin (SceneObject::update / interpolate in MultipleLights.cpp) ---- (start)
+// The per-object state the update touches, without the texture and light lists
+class SceneObjectBaseline {
+public:
+    mat4 model{};
+    float rotSpeed;
+    mat4 base{};
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObjectBaseline(vec3 pos, float scale, float rot) : rotSpeed(rot) {
+        base = glm::scale(translate(mat4(1.0f), pos), vec3(scale));
+        model = base;
+    }
+
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    void interpolate(float alpha) {
+        model = rotate(base, radians(previousAngle + (angle - previousAngle) * alpha), vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+
+/// Every object's spin state in parallel arrays, updated in one pass. base is only translation and uniform scale,
+/// so the spin about Y mixes columns 0 and 2 of it and the rest of the matrix is copied, instead of a general
+/// glm::rotate building a rotation matrix from an axis for each object.
+struct SceneObjectsOptimized {
+    std::vector<mat4> model;
+    std::vector<mat4> base;
+    std::vector<float> rotSpeed;
+    std::vector<float> angle;
+    std::vector<float> previousAngle;
+};
+
+/// @param objects Objects
+/// @param dt Tick length in seconds
+void sceneObjectsUpdate(SceneObjectsOptimized* objects, float dt) {
+    const size_t count = objects->angle.size();
+    float* angle = objects->angle.data();
+    float* previousAngle = objects->previousAngle.data();
+    const float* rotSpeed = objects->rotSpeed.data();
+    for (size_t i = 0; i < count; i++) {
+        float next = angle[i] + rotSpeed[i] * ROTATION_REFERENCE_FPS * dt;
+        float previous = angle[i];
+        // Wrap, branch free so the loop vectorizes (truncation toward zero as in SceneObject::update)
+        const float turns = 360.0f * std::trunc(next / 360.0f);
+        const float wrap = (next > 360.0f || next < -360.0f) ? turns : 0.0f;
+        angle[i] = next - wrap;
+        previousAngle[i] = previous - wrap;
+    }
+}
+
+/// @param objects Objects
+/// @param alpha Blend between the previous and the latest tick
+void sceneObjectsInterpolate(SceneObjectsOptimized* objects, float alpha) {
+    const size_t count = objects->angle.size();
+    for (size_t i = 0; i < count; i++) {
+        const float a = radians(objects->previousAngle[i] + (objects->angle[i] - objects->previousAngle[i]) * alpha);
+        const float c = std::cos(a), s = std::sin(a);
+        const mat4& b = objects->base[i];
+        mat4& m = objects->model[i];
+        m[0] = b[0] * c - b[2] * s;
+        m[1] = b[1];
+        m[2] = b[0] * s + b[2] * c;
+        m[3] = b[3];
+    }
+}
+
+static void BM_SceneObjectsBaseline(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    std::vector<SceneObjectBaseline> objects;
+    for (int i = 0; i < count; i++) {
+        objects.emplace_back(vec3(static_cast<float>(i % 8), 0.0f, static_cast<float>(i / 8)), 0.5f, 0.2f + 0.01f * static_cast<float>(i % 16));
+    }
+    for (auto _ : state) {
+        for (SceneObjectBaseline& object : objects) { object.update(SIM_TICK_SECONDS); }
+        for (SceneObjectBaseline& object : objects) { object.interpolate(0.5f); }
+        benchmark::DoNotOptimize(objects.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SceneObjectsBaseline)->RangeMultiplier(4)->Range(16, 16384);
+
+static void BM_SceneObjectsOptimized(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    SceneObjectsOptimized objects;
+    std::vector<SceneObjectBaseline> reference;
+    for (int i = 0; i < count; i++) {
+        const vec3 pos(static_cast<float>(i % 8), 0.0f, static_cast<float>(i / 8));
+        objects.base.push_back(glm::scale(translate(mat4(1.0f), pos), vec3(0.5f)));
+        objects.model.push_back(objects.base.back());
+        objects.rotSpeed.push_back(0.2f + 0.01f * static_cast<float>(i % 16));
+        objects.angle.push_back(0.0f);
+        objects.previousAngle.push_back(0.0f);
+        reference.emplace_back(pos, 0.5f, objects.rotSpeed.back());
+    }
+    // Long enough for the fastest spin to wrap past 360 degrees
+    for (int tick = 0; tick < 120; tick++) {
+        sceneObjectsUpdate(&objects, SIM_TICK_SECONDS);
+        for (SceneObjectBaseline& object : reference) { object.update(SIM_TICK_SECONDS); }
+    }
+    sceneObjectsInterpolate(&objects, 0.5f);
+    for (int i = 0; i < count; i++) {
+        reference[i].interpolate(0.5f);
+        if (benchMaxError(&objects.model[i][0][0], &reference[i].model[0][0], 16) > BENCH_TOLERANCE) {
+            benchFail(state, "differs from baseline");
+            return;
+        }
+    }
+    for (auto _ : state) {
+        sceneObjectsUpdate(&objects, SIM_TICK_SECONDS);
+        sceneObjectsInterpolate(&objects, 0.5f);
+        benchmark::DoNotOptimize(objects.model.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SceneObjectsOptimized)->RangeMultiplier(4)->Range(16, 16384);
+/// Scene object spin ---- (end)
+
+
+/// View and projection matrices (glm::lookAt / glm::perspective every frame) ---- (start)
+/// Frames between window resizes, each camera entry stands for one frame
+constexpr int VIEW_RESIZE_FRAMES = 64;
+
+/// Aspect ratio of a frame : a window dragged to a new size every VIEW_RESIZE_FRAMES frames
+static float viewAspect(int64_t frame) {
+    return static_cast<float>(800 + (frame / VIEW_RESIZE_FRAMES) % 16 * 10) / 600.0f;
+}
+
+static void BM_ViewProjectionBaseline(benchmark::State& state) {
+    std::vector<Camera> cameras = makeCameras(static_cast<int>(state.range(0)));
+    for (Camera& camera : cameras) { cameraUpdateVectorsBaseline(&camera); }
+    const vec3 position(0.0f, 0.0f, 5.0f);
+    int64_t frame = 0;
+    for (auto _ : state) {
+        for (const Camera& camera : cameras) {
+            mat4 view = lookAt(position, position + camera.Front, camera.Up);
+            mat4 projection = perspective(radians(FOV), viewAspect(frame++), NEAR_PLANE, FAR_PLANE);
+            benchmark::DoNotOptimize(view);
+            benchmark::DoNotOptimize(projection);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ViewProjectionBaseline)->RangeMultiplier(16)->Range(1, 4096);
+
+/// The camera basis is already orthonormal, so the view matrix is its rows plus the translation, with none of
+/// lookAt's normalizes and cross products. The projection only depends on the aspect ratio and is built when it changes.
+/// @param camera Camera with up to date vectors
+/// @param position Eye position
+/// @return View matrix, equal to lookAt(position, position + Front, Up)
+mat4 cameraViewMatrix(const Camera* camera, vec3 position) {
+    const vec3 s = camera->Right, u = camera->Up, f = camera->Front;
+    mat4 view(1.0f);
+    view[0][0] = s.x; view[1][0] = s.y; view[2][0] = s.z;
+    view[0][1] = u.x; view[1][1] = u.y; view[2][1] = u.z;
+    view[0][2] = -f.x; view[1][2] = -f.y; view[2][2] = -f.z;
+    view[3][0] = -dot(s, position);
+    view[3][1] = -dot(u, position);
+    view[3][2] = dot(f, position);
+    return view;
+}
+
+static void BM_ViewProjectionOptimized(benchmark::State& state) {
+    std::vector<Camera> cameras = makeCameras(static_cast<int>(state.range(0)));
+    for (Camera& camera : cameras) { cameraUpdateVectorsOptimized(&camera); }
+    const vec3 position(0.0f, 0.0f, 5.0f);
+    for (const Camera& camera : cameras) {
+        const mat4 view = cameraViewMatrix(&camera, position);
+        const mat4 reference = lookAt(position, position + camera.Front, camera.Up);
+        if (benchMaxError(&view[0][0], &reference[0][0], 16) > BENCH_TOLERANCE) {
+            benchFail(state, "differs from baseline");
+            return;
+        }
+    }
+    float cachedAspect = 0.0f;
+    mat4 projection(1.0f);
+    int64_t frame = 0;
+    for (auto _ : state) {
+        for (const Camera& camera : cameras) {
+            mat4 view = cameraViewMatrix(&camera, position);
+            const float aspect = viewAspect(frame++);
+            if (aspect != cachedAspect) {
+                projection = perspective(radians(FOV), aspect, NEAR_PLANE, FAR_PLANE);
+                cachedAspect = aspect;
+            }
+            benchmark::DoNotOptimize(view);
+            benchmark::DoNotOptimize(projection);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ViewProjectionOptimized)->RangeMultiplier(16)->Range(1, 4096);
+/// View and projection matrices ---- (end)
+
+
+/// Batched transforms (SimdMath.h) against one glm call per instance ---- (start)
+// Every SimdMath benchmark first checks its output against glm and fails the run instead of timing a wrong kernel.
+// The second argument is the SimdPath, paths the CPU lacks are skipped.
+constexpr float SIMD_TOLERANCE = 1e-4f;
+
+/// Random-ish instances : positions, unit quaternions from axis / angle and non uniform scales, plus the same
+/// transforms built by glm as the reference
+struct BenchInstances {
+    std::vector<float> px, py, pz, qx, qy, qz, qw, sx, sy, sz;
+    std::vector<mat4> models;
+
+    explicit BenchInstances(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            const float f = static_cast<float>(i);
+            const vec3 position(std::sin(f * 0.37f) * 50.0f, std::cos(f * 0.11f) * 10.0f, f * 0.01f);
+            const vec3 axis = normalize(vec3(std::sin(f * 1.3f), 1.0f, std::cos(f * 0.7f)));
+            const float angle = f * 0.05f;
+            const vec3 scale(0.5f + 0.25f * std::sin(f), 1.0f + 0.5f * std::cos(f * 0.3f), 0.75f);
+            px.push_back(position.x); py.push_back(position.y); pz.push_back(position.z);
+            qx.push_back(axis.x * std::sin(angle * 0.5f)); qy.push_back(axis.y * std::sin(angle * 0.5f));
+            qz.push_back(axis.z * std::sin(angle * 0.5f)); qw.push_back(std::cos(angle * 0.5f));
+            sx.push_back(scale.x); sy.push_back(scale.y); sz.push_back(scale.z);
+            models.push_back(translate(mat4(1.0f), position) * rotate(mat4(1.0f), angle, axis) * glm::scale(mat4(1.0f), scale));
+        }
+    }
+
+    SimdTransformsSoA soa() const {
+        return {px.data(), py.data(), pz.data(), qx.data(), qy.data(), qz.data(), qw.data(), sx.data(), sy.data(), sz.data()};
+    }
+};
+
+/// Selects the benchmark's path, false (and the benchmark skipped) if the CPU lacks it
+static bool simdBenchSetPath(benchmark::State& state) {
+    const SimdPath wanted = static_cast<SimdPath>(state.range(1));
+    if (simdSetPath(wanted) != wanted) {
+        state.SkipWithError("SIMD path not supported on this CPU");
+        return false;
+    }
+    state.SetLabel(simdPathName(wanted));
+    return true;
+}
+
+static void simdBenchArgs(benchmark::internal::Benchmark* benchmark) {
+    for (int64_t count : {64, 1024, 16384}) {
+        for (int64_t path : {SIMD_SCALAR, SIMD_SSE41, SIMD_AVX2}) { benchmark->Args({count, path}); }
+    }
+}
+
+static void BM_Mat4MulSharedGlm(benchmark::State& state) {
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    const mat4 viewProjection = perspective(radians(FOV), 800.0f / 600.0f, NEAR_PLANE, FAR_PLANE)
+                              * lookAt(vec3(0.0f, 5.0f, 20.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    std::vector<mat4> out(instances.models.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); i++) { out[i] = viewProjection * instances.models[i]; }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat4MulSharedGlm)->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_Mat4MulSharedSimd(benchmark::State& state) {
+    if (!simdBenchSetPath(state)) { return; }
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    const mat4 viewProjection = perspective(radians(FOV), 800.0f / 600.0f, NEAR_PLANE, FAR_PLANE)
+                              * lookAt(vec3(0.0f, 5.0f, 20.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    std::vector<mat4> out(instances.models.size());
+    simdMat4MulBatchShared(viewProjection, instances.models.data(), out.data(), out.size());
+    for (size_t i = 0; i < out.size(); i++) {
+        const mat4 reference = viewProjection * instances.models[i];
+        if (benchMaxError(&out[i][0][0], &reference[0][0], 16) > SIMD_TOLERANCE) { benchFail(state, "differs from glm"); return; }
+    }
+    for (auto _ : state) {
+        simdMat4MulBatchShared(viewProjection, instances.models.data(), out.data(), out.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat4MulSharedSimd)->Apply(simdBenchArgs);
+
+static void BM_Mat4MulPairsSimd(benchmark::State& state) {
+    if (!simdBenchSetPath(state)) { return; }
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    std::vector<mat4> lhs(instances.models.rbegin(), instances.models.rend());
+    std::vector<mat4> out(instances.models.size());
+    simdMat4MulBatch(lhs.data(), instances.models.data(), out.data(), out.size());
+    for (size_t i = 0; i < out.size(); i++) {
+        const mat4 reference = lhs[i] * instances.models[i];
+        if (benchMaxError(&out[i][0][0], &reference[0][0], 16) > SIMD_TOLERANCE) { benchFail(state, "differs from glm"); return; }
+    }
+    for (auto _ : state) {
+        simdMat4MulBatch(lhs.data(), instances.models.data(), out.data(), out.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat4MulPairsSimd)->Apply(simdBenchArgs);
+
+static void BM_Mat4MulVec4Glm(benchmark::State& state) {
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    std::vector<vec4> points, out(instances.px.size());
+    for (size_t i = 0; i < out.size(); i++) { points.emplace_back(instances.px[i], instances.py[i], instances.pz[i], 1.0f); }
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); i++) { out[i] = instances.models[0] * points[i]; }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat4MulVec4Glm)->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_Mat4MulVec4Simd(benchmark::State& state) {
+    if (!simdBenchSetPath(state)) { return; }
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    std::vector<vec4> points, out(instances.px.size());
+    for (size_t i = 0; i < out.size(); i++) { points.emplace_back(instances.px[i], instances.py[i], instances.pz[i], 1.0f); }
+    simdMat4MulVec4Batch(instances.models[0], points.data(), out.data(), out.size());
+    for (size_t i = 0; i < out.size(); i++) {
+        const vec4 reference = instances.models[0] * points[i];
+        if (benchMaxError(&out[i][0], &reference[0], 4) > SIMD_TOLERANCE) { benchFail(state, "differs from glm"); return; }
+    }
+    for (auto _ : state) {
+        simdMat4MulVec4Batch(instances.models[0], points.data(), out.data(), out.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat4MulVec4Simd)->Apply(simdBenchArgs);
+
+static void BM_ComposeTRSGlm(benchmark::State& state) {
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    std::vector<mat4> out(instances.models.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); i++) {
+            const float angle = 2.0f * std::acos(instances.qw[i]);
+            const vec3 axis = angle > 0.0f ? vec3(instances.qx[i], instances.qy[i], instances.qz[i]) / std::sin(angle * 0.5f) : vec3(0.0f, 1.0f, 0.0f);
+            out[i] = translate(mat4(1.0f), vec3(instances.px[i], instances.py[i], instances.pz[i]))
+                   * rotate(mat4(1.0f), angle, axis) * glm::scale(mat4(1.0f), vec3(instances.sx[i], instances.sy[i], instances.sz[i]));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ComposeTRSGlm)->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_ComposeTRSSimd(benchmark::State& state) {
+    if (!simdBenchSetPath(state)) { return; }
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    std::vector<mat4> out(instances.models.size());
+    simdComposeTRS(instances.soa(), out.data(), out.size());
+    if (benchMaxError(&out[0][0][0], &instances.models[0][0][0], out.size() * 16) > SIMD_TOLERANCE) {
+        benchFail(state, "differs from glm");
+        return;
+    }
+    for (auto _ : state) {
+        simdComposeTRS(instances.soa(), out.data(), out.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ComposeTRSSimd)->Apply(simdBenchArgs);
+
+static void BM_NormalMatrixGlm(benchmark::State& state) {
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    std::vector<mat3> out(instances.models.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); i++) { out[i] = mat3(transpose(inverse(instances.models[i]))); }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NormalMatrixGlm)->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_NormalMatrixSimd(benchmark::State& state) {
+    if (!simdBenchSetPath(state)) { return; }
+    const BenchInstances instances(static_cast<size_t>(state.range(0)));
+    std::vector<mat3> out(instances.models.size());
+    simdNormalMatrixBatch(instances.models.data(), out.data(), out.size());
+    for (size_t i = 0; i < out.size(); i++) {
+        const mat3 reference = mat3(transpose(inverse(instances.models[i])));
+        if (benchMaxError(&out[i][0][0], &reference[0][0], 9) > SIMD_TOLERANCE) { benchFail(state, "differs from glm"); return; }
+    }
+    for (auto _ : state) {
+        simdNormalMatrixBatch(instances.models.data(), out.data(), out.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NormalMatrixSimd)->Apply(simdBenchArgs);
+
+/// The instances' models with their x scale on all three axes, the inputs simdNormalMatrixUniformScaleBatch accepts
+static std::vector<mat4> benchUniformScaleModels(const BenchInstances& instances) {
+    std::vector<mat4> models;
+    models.reserve(instances.models.size());
+    for (size_t i = 0; i < instances.models.size(); i++) {
+        const float angle = 2.0f * std::acos(instances.qw[i]);
+        const vec3 axis = angle > 0.0f ? vec3(instances.qx[i], instances.qy[i], instances.qz[i]) / std::sin(angle * 0.5f) : vec3(0.0f, 1.0f, 0.0f);
+        models.push_back(translate(mat4(1.0f), vec3(instances.px[i], instances.py[i], instances.pz[i]))
+                       * rotate(mat4(1.0f), angle, axis) * glm::scale(mat4(1.0f), vec3(instances.sx[i])));
+    }
+    return models;
+}
+
+static void BM_NormalMatrixUniformScaleGlm(benchmark::State& state) {
+    const std::vector<mat4> models = benchUniformScaleModels(BenchInstances(static_cast<size_t>(state.range(0))));
+    std::vector<mat3> out(models.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < out.size(); i++) { out[i] = transpose(inverse(mat3(models[i]))); }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NormalMatrixUniformScaleGlm)->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_NormalMatrixUniformScaleSimd(benchmark::State& state) {
+    const std::vector<mat4> models = benchUniformScaleModels(BenchInstances(static_cast<size_t>(state.range(0))));
+    std::vector<mat3> out(models.size());
+    simdNormalMatrixUniformScaleBatch(models.data(), out.data(), out.size());
+    for (size_t i = 0; i < out.size(); i++) {
+        const mat3 reference = transpose(inverse(mat3(models[i])));
+        if (benchMaxError(&out[i][0][0], &reference[0][0], 9) > SIMD_TOLERANCE) { benchFail(state, "differs from glm"); return; }
+    }
+    for (auto _ : state) {
+        simdNormalMatrixUniformScaleBatch(models.data(), out.data(), out.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NormalMatrixUniformScaleSimd)->RangeMultiplier(16)->Range(64, 16384);
+/// Batched transforms (SimdMath.h) ---- (end)
+
+// BENCHMARK_MAIN() always returns 0, a mismatch has to fail the run
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) { return 1; }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    if (benchMismatches > 0) {
+        std::cerr << benchMismatches << " benchmark(s) differ from their reference" << std::endl;
+        return 1;
+    }
+    return 0;
+}
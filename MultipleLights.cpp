@@ -1,6 +1,12 @@
 #include <iostream>
 #include <ostream>
+#include <fstream>
 #include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/fwd.hpp>
@@ -10,6 +16,13 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "CpuProfiler.h"
+#include "FixedTimestep.h"
+#include "InputRecording.h"
+#include "SimdMath.h"
+#include "PointShadows.h"
+#include "FrameGovernor.h"
+
 
 /// Defining Globals variable ---- (start)
 /// Rendering
@@ -26,6 +39,32 @@ constexpr float FAR_PLANE = 1000.0f;
 constexpr float SPOT_LIGHT_INNER = 15.0f;
 constexpr float SPOT_LIGHT_OUTER = 30.0f;
 
+/// Light culling
+/// A light stops at the distance where its luminance falls below this value ([ and ] halve / double it)
+constexpr float DEFAULT_LUMINANCE_CUTOFF = 0.02f;
+/// Upper bound on point lights a single draw evaluates, must match objectLights[] in the fragment shader
+constexpr int MAX_LIGHTS_PER_OBJECT = 4;
+float luminanceCutoff = DEFAULT_LUMINANCE_CUTOFF;
+
+/// Point light shadows, see PointShadows.h
+constexpr int SHADOW_CUBE_SIZE = 512;
+/// Cube faces redrawn per frame, out of 18
+constexpr int SHADOW_FACE_BUDGET = 6;
+
+/// Frame budget governor (G toggles, T cycles the target frame rate)
+/// Every decision plus a sample per second goes here
+constexpr const char* GOVERNOR_LOG_PATH = "frame_governor.csv";
+
+/// CPU profiler
+/// Written on F9 and on exit
+constexpr const char* CPU_TRACE_PATH = "cpu_trace.json";
+
+/// Simulation
+/// SceneObject spin speeds are given in degrees per frame at this rate, they turn at rotSpeed * 60 degrees per second
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+/// Cube spin and light paths advance in fixed ticks (H pauses, - / = halve / double the tick rate)
+SimulationClock simClock;
+
 /// Turn off or on spotlight
 bool bIsCameraLightOn = true;
 /// Defining Globals variable ---- (end)
@@ -111,6 +150,7 @@ class Shader {
     public:
     // Constructor — compiles vertex and fragment shader from raw GLSL source strings, links them into a program
     Shader(const char* vertexSource, const char* fragmentSource) {
+        CPU_PROFILE_SCOPE("createProgram");
         // Local lambda — compiles a single shader stage and reports errors. Defined here because it is only needed during construction.
         auto compileShader = [](const GLuint s, const char* source) {
             glShaderSource(s, 1, &source, nullptr);
@@ -151,6 +191,11 @@ class Shader {
         glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
     }
 
+    // Sets a 3x3 matrix uniform (normal matrices).
+    void setMat3 (const char* uniform, const glm::mat3& mat) const {
+        glUniformMatrix3fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
     // Sets a vec3 uniform (positions, colors, directions).
     void setVec3(const char* uniform, const glm::vec3& vec) const {
         glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
@@ -166,6 +211,11 @@ class Shader {
         glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
     }
 
+    // Sets an int array uniform (per-object light index lists).
+    void setIntArray(const char* uniform, const int* vals, const int count) const {
+        glUniform1iv(glGetUniformLocation(ProgramID, uniform), count, vals);
+    }
+
     // Destructor — releases the OpenGL program
     ~Shader() {
         if (ProgramID != 0) {
@@ -184,6 +234,7 @@ public:
     // OpenGL texture handle — 0 = invalid/uninitialized
     GLuint TextureID = 0;
     Texture() {
+        CPU_PROFILE_SCOPE("Texture()");
         glGenTextures(1, &TextureID);
         glBindTexture(GL_TEXTURE_2D, TextureID);
 
@@ -254,24 +305,48 @@ public:
 
 
 /// Light structs --------- (Start)
+// Distance at which the light's luminance, attenuated, drops to the cutoff.
+// Solves quadratic*d^2 + linear*d + constant = luminance / cutoff for d.
+float attenuationRadius(const glm::vec3& color, float constant, float linear, float quadratic, float cutoff) {
+    const float luminance = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    const float c = constant - luminance / cutoff;
+    if (c >= 0.0f) return 0.0f; // never bright enough to pass the cutoff
+    return (-linear + sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
 struct PointLight {
     glm::vec3 position, color;
     float constant = 1.0f;
     float linear = 0.09f;
     float quadratic = 0.032f;
+    float radius = 0.0f;
 
-    PointLight(glm::vec3 p, glm::vec3 c) : position(p), color(c) {}
+    PointLight(glm::vec3 p, glm::vec3 c) : position(p), color(c) {
+        updateRadius(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRadius(float cutoff) {
+        radius = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
 };
 
 struct SpotLight {
     glm::vec3 position, dir, color;
     float innerCutoff, outerCutoff;
+    float outerAngle; // radians, used by the cone vs bounds test
     float constant = 1.0f;
     float linear = 0.07f;
     float quadratic = 0.017f;
+    float range = 0.0f;
 
     SpotLight(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer)
-        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))) {}
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))), outerAngle(glm::radians(outer)) {
+        updateRange(DEFAULT_LUMINANCE_CUTOFF);
+    }
+
+    void updateRange(float cutoff) {
+        range = attenuationRadius(color, constant, linear, quadratic, cutoff);
+    }
 };
 /// Light structs --------- (end)
 
@@ -293,6 +368,7 @@ Material materials[6] = {
 
 /// Cube vertex data ------------- (start)
 unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
 
 float cubeData[288] = {
     -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
@@ -310,11 +386,11 @@ float cubeData[288] = {
 };
 
 void setupCubeVAO() {
-    unsigned int VBO;
+    CPU_PROFILE_SCOPE("setupCubeVAO");
     glGenVertexArrays(1, &cubeVAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &cubeVBO);
     glBindVertexArray(cubeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
     // position
     glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
@@ -336,12 +412,41 @@ public:
     float rotSpeed;
     Texture texture;
 
-    SceneObject(glm::vec3 pos, float scale, int mat, float rot) : matId(mat), rotSpeed(rot) {
-        model = glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(scale));
+    // Bounding sphere of the unit cube : rotation about the centre never changes it
+    glm::vec3 boundCenter;
+    float boundRadius;
+
+    // Lights that reach this object, rebuilt every frame by buildObjectLightLists()
+    int lightIndices[MAX_LIGHTS_PER_OBJECT] = {};
+    int lightCount = 0;
+    bool spotLit = false;
+
+    // Translation and scale, the spin is applied on top
+    glm::mat4 base{};
+    // Spin in degrees at the latest and the previous simulation tick
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObject(glm::vec3 pos, float scale, int mat, float rot) : matId(mat), rotSpeed(rot), boundCenter(pos), boundRadius(scale * 0.8660254f) {
+        base = glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(scale));
+        model = base;
     }
 
-    void update() {
-        model = glm::rotate(model, glm::radians(rotSpeed), glm::vec3(0.0f, 1.0f, 0.0f));
+    // One simulation tick
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        // Keep the angle small so it does not lose precision over a long run, both move so the blend is unchanged
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    // Model matrix between the previous and the latest tick
+    void interpolate(float alpha) {
+        model = glm::rotate(base, glm::radians(previousAngle + (angle - previousAngle) * alpha), glm::vec3(0.0f, 1.0f, 0.0f));
     }
 };
 /// separated functionality for retrieving model matrix with rotation for object in scene ---- (start)
@@ -358,13 +463,24 @@ out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 
-uniform mat4 model, view, projection;
+uniform mat4 model;
+#ifdef LEGACY_TRANSFORMS
+uniform mat4 view, projection;
+#else
+uniform mat4 mvp;           // projection * view * model, built on the CPU
+uniform mat3 normalMatrix;  // mat3(transpose(inverse(model))), built on the CPU
+#endif
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
     TexCoord = aTexCoord;
+#ifdef LEGACY_TRANSFORMS
+    Normal = mat3(transpose(inverse(model))) * aNormal;
     gl_Position = projection * view * vec4(FragPos, 1.0);
+#else
+    Normal = normalMatrix * aNormal;
+    gl_Position = mvp * vec4(aPos, 1.0);
+#endif
 }
 
 )";
@@ -386,6 +502,7 @@ struct SpotLight {
     float constant;
     float linear;
     float quadratic;
+    float range;
 };
 
 struct PointLight {
@@ -394,6 +511,7 @@ struct PointLight {
     float constant;
     float linear;
     float quadratic;
+    float radius;
 };
 
 uniform SpotLight cameraLight;
@@ -403,6 +521,10 @@ uniform Material material;
 uniform int isCameraLightOn;
 uniform float time;
 
+// Per-object light list built on the CPU : only these point lights can reach this draw
+uniform int objectLightCount;
+uniform int objectLights[4];
+
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
@@ -412,10 +534,18 @@ float attenuate(float distance, float constant, float linear, float quadratic) {
     return 1.0 / (constant + linear * distance + quadratic * distance * distance);
 }
 
-vec3 calPointLightEffect(PointLight light, vec3 norm, vec3 viewDir) {
+// Fades the light to exactly zero at its radius so culling it beyond that distance changes nothing.
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+vec3 calPointLightEffect(int index, vec3 norm, vec3 viewDir) {
+    PointLight light = pointLight[index];
     vec3 lightDir = normalize(light.position - FragPos);
     float distance = length(light.position - FragPos);
-    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.radius);
 
     vec3 ambient = 0.05 * light.color;
 
@@ -426,7 +556,8 @@ vec3 calPointLightEffect(PointLight light, vec3 norm, vec3 viewDir) {
     float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
     vec3 specular = spec * light.color * material.specular;
 
-    return (ambient + diffuse + specular) * attenuation;
+    float shadow = pointShadow(index, FragPos, norm, light.position, light.radius);
+    return (ambient + (diffuse + specular) * shadow) * attenuation;
 }
 
 vec3 calSpotLightEffect(SpotLight light, vec3 norm, vec3 viewDir) {
@@ -438,7 +569,7 @@ vec3 calSpotLightEffect(SpotLight light, vec3 norm, vec3 viewDir) {
     if(intensity <= 0) return vec3(0.0);
 
     float distance = length(light.position - FragPos);
-    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.range);
 
     vec3 ambient = 0.05 * light.color;
 
@@ -462,8 +593,8 @@ void main() {
         result += calSpotLightEffect(cameraLight, norm, viewDir) * texColor.rgb;
     }
 
-    for (int i = 0; i < 3; i++) {
-        result += calPointLightEffect(pointLight[i], norm, viewDir) * texColor.rgb;
+    for (int i = 0; i < objectLightCount; i++) {
+        result += calPointLightEffect(objectLights[i], norm, viewDir) * texColor.rgb;
     }
 
     FragColor = vec4(result, 1.0);
@@ -485,14 +616,23 @@ out vec4 FragColor;
 void main(){
     FragColor = vec4(emissiveColor, 1.0);
 })";
+
+// Same source with LEGACY_TRANSFORMS defined right after the #version line
+std::string legacyTransformsVariant(const char* source) {
+    std::string variant = source;
+    variant.insert(variant.find('\n', variant.find("#version")) + 1, "#define LEGACY_TRANSFORMS\n");
+    return variant;
+}
 /// shaders --------- (End)
 
 
 /// Global Objects ------ (Start)
 Camera* camera = nullptr;
 Shader* sceneShader = nullptr;
+Shader* sceneShaderLegacy = nullptr;
 Shader* lightingShader = nullptr;
 Texture* defaultTexture = nullptr;
+PointShadows pointShadows;
 
 std::vector<SceneObject> sceneObjects;
 SpotLight cameraLight(glm::vec3(0.0f), glm::vec3(0.0f,0.0f,-1.0f), glm::vec3(1.0f, 1.0f, 1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER);
@@ -504,13 +644,89 @@ PointLight pointLights[3] = {
 };
 
 int WindowWidth, WindowHeight;
+
+// V (or --legacy-transforms) puts the inverse and projection * view back in the vertex shader,
+// to compare vertex stage cost against the matrices batched on the CPU below
+bool legacyTransforms = false;
+std::vector<glm::mat4> sceneModels;
+std::vector<glm::mat4> sceneMvps;
+std::vector<glm::mat3> sceneNormalMatrices;
 /// Global Objects ------ (End)
 
 
+/// Light culling ------ (start)
+// Sphere vs cone test : true when the sphere can receive light from the spot's outer cone within its range.
+bool sphereInSpotCone(const SpotLight& light, const glm::vec3& center, float radius) {
+    const glm::vec3 v = center - light.position;
+    const float lenSq = glm::dot(v, v);
+    const float along = glm::dot(v, light.dir);
+    if (along > light.range + radius) return false; // beyond the cap
+    if (along < -radius) return false;               // behind the apex
+    // Distance from the sphere centre to the cone's surface, measured perpendicular to it
+    const float across = sqrt(glm::max(lenSq - along * along, 0.0f));
+    const float distToCone = cos(light.outerAngle) * across - sin(light.outerAngle) * along;
+    return distToCone <= radius;
+}
+
+// Gives every object only the lights whose radius reaches its bounding sphere.
+void buildObjectLightLists() {
+    for (auto& obj : sceneObjects) {
+        obj.lightCount = 0;
+        for (int i = 0; i < 3 && obj.lightCount < MAX_LIGHTS_PER_OBJECT; i++) {
+            const float reach = pointLights[i].radius + obj.boundRadius;
+            const glm::vec3 d = pointLights[i].position - obj.boundCenter;
+            if (glm::dot(d, d) < reach * reach) {
+                obj.lightIndices[obj.lightCount++] = i;
+            }
+        }
+        obj.spotLit = bIsCameraLightOn && sphereInSpotCone(cameraLight, obj.boundCenter, obj.boundRadius);
+    }
+}
+/// Light culling ------ (end)
+
+
+/// Frame budget governor ------ (start)
+// See FrameGovernor.h. Resolution goes first; texture LOD bias, shadow cube size and a larger light cutoff follow.
+// The light cutoff shortens every light's radius and with it the per-fragment light count and the reach of its
+// shadow cube. GPU times come from the profiler : the governor reads the root "frame" scope, the 2 s report shows
+// every pass.
+FrameGovernor governor;
+GpuProfiler gpuProfiler;
+SceneTarget sceneTarget;
+bool bSceneTargetDirty = true;
+/// Frame budget governor ------ (end)
+
+
+/// Governor knobs ------ (start)
+// Light radii follow the manual cutoff ([ / ]) times the governor's scale
+void applyLightCutoff() {
+    const float cutoff = glm::min(luminanceCutoff * governorQuality(&governor).cutoffScale, 0.5f);
+    for (auto& light : pointLights) light.updateRadius(cutoff);
+    cameraLight.updateRange(cutoff);
+}
+
+void applyQualityLevel() {
+    glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, governorQuality(&governor).lodBias);
+    pointShadowsResize(&pointShadows, static_cast<int>(SHADOW_CUBE_SIZE * governorQuality(&governor).shadowScale));
+    applyLightCutoff();
+}
+/// Governor knobs ------ (end)
+
+
 /// Callbacks ----- (Start)
 bool firstMouse = true;
 double lastX, lastY;
 
+// --record <file> / --replay <file>, see InputRecording.h
+InputRecording inputRecording;
+// Keys processInput and processToggles read, in the order of their bits in a recording
+constexpr int RECORDED_KEYS[] = {GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_SPACE, GLFW_KEY_LEFT_SHIFT,
+                                 GLFW_KEY_O, GLFW_KEY_P, GLFW_KEY_1, GLFW_KEY_2, GLFW_KEY_3,
+                                 GLFW_KEY_H, GLFW_KEY_MINUS, GLFW_KEY_EQUAL, GLFW_KEY_F9, GLFW_KEY_V, GLFW_KEY_K,
+                                 GLFW_KEY_G, GLFW_KEY_T, GLFW_KEY_LEFT_BRACKET, GLFW_KEY_RIGHT_BRACKET};
+constexpr int NUM_RECORDED_KEYS = sizeof(RECORDED_KEYS) / sizeof(RECORDED_KEYS[0]);
+
 void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
     if (firstMouse) {
         lastX = xPos;
@@ -519,7 +735,8 @@ void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
         return;
     }
 
-    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    // Applied once per frame from the recorded input
+    inputRecordingAddCursor(&inputRecording, static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
     lastX = xPos;
     lastY = yPos;
 }
@@ -527,56 +744,116 @@ void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
 void frameBufferCallBack(GLFWwindow* window, int, int) {
     glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
     glViewport(0, 0, WindowWidth, WindowHeight);
+    bSceneTargetDirty = true;
+}
+
+// [ / ] : tighter or looser luminance cutoff, radii follow
+// G : governor on / off, T : cycle the target frame rate, F9 : write the CPU trace
+// H : pause the simulation, - / = : halve / double the simulation tick rate
+// V : legacy or precomputed vertex transforms, K : point light shadows on / off
+// Read from the frame's (live or replayed) input, so a replay toggles at the same frames as the recording
+void processToggles() {
+    auto pressed = [](int key) { return inputKeyPressed(&inputRecording, RECORDED_KEYS, NUM_RECORDED_KEYS, key); };
+    if (pressed(GLFW_KEY_H)) {
+        simClock.paused = !simClock.paused;
+        std::cout << "Simulation " << (simClock.paused ? "paused" : "running") << std::endl;
+    }
+    if (pressed(GLFW_KEY_MINUS) || pressed(GLFW_KEY_EQUAL)) {
+        const double rate = 1.0 / simClock.tickSeconds;
+        simClockSetTickRate(&simClock, pressed(GLFW_KEY_EQUAL) ? rate * 2.0 : rate * 0.5);
+        std::cout << "Simulation tick rate " << 1.0 / simClock.tickSeconds << " Hz" << std::endl;
+    }
+    if (pressed(GLFW_KEY_F9)) {
+        CPU_PROFILE_FLUSH(CPU_TRACE_PATH);
+    }
+    if (pressed(GLFW_KEY_V)) {
+        legacyTransforms = !legacyTransforms;
+        std::cout << "Scene transforms " << (legacyTransforms ? "legacy, inverse per vertex" : "precomputed on the CPU") << std::endl;
+    }
+    if (pressed(GLFW_KEY_K)) {
+        pointShadows.enabled = !pointShadows.enabled;
+        std::cout << "Point light shadows " << (pointShadows.enabled ? "on" : "off") << std::endl;
+    }
+    if (pressed(GLFW_KEY_G)) {
+        governor.enabled = !governor.enabled;
+        governorReset(&governor, static_cast<float>(glfwGetTime()));
+        applyQualityLevel();
+    }
+    if (pressed(GLFW_KEY_T)) {
+        governorCycleTarget(&governor);
+    }
+    if (pressed(GLFW_KEY_LEFT_BRACKET) || pressed(GLFW_KEY_RIGHT_BRACKET)) {
+        if (pressed(GLFW_KEY_LEFT_BRACKET)) luminanceCutoff = glm::max(luminanceCutoff * 0.5f, 0.001f);
+        else luminanceCutoff = glm::min(luminanceCutoff * 2.0f, 0.5f);
+        applyLightCutoff();
+        std::cout << "Luminance cutoff " << luminanceCutoff << " | point radius " << pointLights[0].radius
+                  << " | spot range " << cameraLight.range << std::endl;
+    }
 }
 
 bool roamFirstLight = false;
 bool roamSecondLight = false;
 bool roamThirdLight = false;
-void processInput(GLFWwindow* win, float dt){
+// Everything but Escape comes from the frame's (live or replayed) input
+void processInput(GLFWwindow* win, const InputFrame& input){
+    auto down = [&input](int key) { return inputKeyDown(&input, RECORDED_KEYS, NUM_RECORDED_KEYS, key); };
+    const float dt = input.frameSeconds;
+    if(input.cursorDeltaX != 0.0f || input.cursorDeltaY != 0.0f) camera->processMouse(input.cursorDeltaX, input.cursorDeltaY);
+
     glm::vec3 dir(0);
-    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
-    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
-    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
-    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
-    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
-    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(down(GLFW_KEY_W))          dir.z =  1;
+    if(down(GLFW_KEY_S))          dir.z = -1;
+    if(down(GLFW_KEY_A))          dir.x = -1;
+    if(down(GLFW_KEY_D))          dir.x =  1;
+    if(down(GLFW_KEY_SPACE))      dir.y =  1;
+    if(down(GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
     if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
     if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
-    if(glfwGetKey(win, GLFW_KEY_O) == GLFW_PRESS) bIsCameraLightOn = true;
-    if(glfwGetKey(win, GLFW_KEY_P) == GLFW_PRESS) bIsCameraLightOn = false;
+    if(down(GLFW_KEY_O)) bIsCameraLightOn = true;
+    if(down(GLFW_KEY_P)) bIsCameraLightOn = false;
 
-    if(glfwGetKey(win, GLFW_KEY_1) == GLFW_PRESS) {
+    if(down(GLFW_KEY_1)) {
         roamFirstLight = true;
-    } else if(glfwGetKey(win, GLFW_KEY_2) == GLFW_PRESS) {
+    } else if(down(GLFW_KEY_2)) {
         roamSecondLight = true;
-    } else if(glfwGetKey(win, GLFW_KEY_3) == GLFW_PRESS) {
+    } else if(down(GLFW_KEY_3)) {
         roamThirdLight = true;
     } else {
         roamFirstLight = false;
         roamSecondLight = false;
         roamThirdLight = false;
     }
+    processToggles();
 }
 /// Callbacks ----- (End)
 
 
-int main() {
+int main(int argc, char** argv) {
+    if (!inputRecordingOpen(&inputRecording, argc, argv)) return -1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--legacy-transforms") == 0) legacyTransforms = true;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
+    inputRecordingWindowHints(&inputRecording);
+
+    // A replay renders off screen at the size it was recorded at
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Multiple Lights", monitor, nullptr);
+    const bool replaying = inputRecording.mode == INPUT_REPLAY;
+    WindowWidth = replaying ? inputRecording.width : mode->width;
+    WindowHeight = replaying ? inputRecording.height : mode->height;
+    GLFWwindow* window = glfwCreateWindow(WindowWidth, WindowHeight, "Multiple Lights", replaying ? nullptr : monitor, nullptr);
     if(!window) {
         std::cout<<"Failed to create window\n";
         glfwTerminate();
         return -1;
     }
-    WindowWidth = mode->width;
-    WindowHeight = mode->height;
 
     lastX = static_cast<float>(WindowWidth) / 2.0f;
     lastY = static_cast<float>(WindowHeight) / 2.0f;
@@ -586,6 +863,7 @@ int main() {
     if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
         std::cout<<"Failed to init GLAD\n"; return -1;
     }
+    inputRecordingBegin(&inputRecording, WindowWidth, WindowHeight);
 
     glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
     glfwSetCursorPosCallback(window, mouseCallBack);
@@ -593,13 +871,18 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);
 
+    CPU_PROFILE_THREAD_NAME("main");
+    CPU_PROFILE_BEGIN("startup");
     setupCubeVAO();
     defaultTexture = new Texture();
-    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentShaderSource);
+    const std::string sceneFragmentSource = pointShadowsShaderSource(sceneFragmentShaderSource);
+    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentSource.c_str());
+    sceneShaderLegacy = new Shader(legacyTransformsVariant(sceneVertexShaderSource).c_str(), sceneFragmentSource.c_str());
     lightingShader = new Shader(lightCubeVS, lightCubeFS);
     camera = new Camera();
 
-    std::mt19937 gen(std::random_device{}());
+    // Recorded with the input, so a replay builds the same scene
+    std::mt19937 gen(inputRecording.seed);
     std::uniform_real_distribution<float> rPos(-15.0f, 15.0f), rRot(-1.5f,1.5f);
     std::uniform_int_distribution<int> rMat(0,4);
 
@@ -608,28 +891,74 @@ int main() {
         sceneObjects.emplace_back(glm::vec3(rPos(gen), rPos(gen)*0.3f+1.0f, rPos(gen)),scale, rMat(gen), rRot(gen));
     }
 
+    // One shadow cube per point light, kept bound on unit 1
+    pointShadowsInit(&pointShadows, 3, SHADOW_CUBE_SIZE, SHADOW_FACE_BUDGET, cubeVBO, 8 * sizeof(float));
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, pointShadows.cubeArray);
+    glActiveTexture(GL_TEXTURE0);
+    for (const Shader* shader : {sceneShader, sceneShaderLegacy}) {
+        shader->use();
+        shader->setInt("pointShadowCubes", 1);
+    }
+    CPU_PROFILE_END();
+
+    governorOpenLog(&governor, GOVERNOR_LOG_PATH);
+    profilerInit(&gpuProfiler);
+
     auto lastTime = std::chrono::high_resolution_clock::now();
+    double lastStatsTime = glfwGetTime();
 
     while (!glfwWindowShouldClose(window)) {
-        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
-        lastTime = std::chrono::high_resolution_clock::now();
+        const auto frameStart = std::chrono::high_resolution_clock::now();
+        InputFrame input{};
+        if (!inputRecordingNextFrame(&inputRecording, std::chrono::duration<float>(frameStart - lastTime).count(),
+                                     inputPollKeys(window, RECORDED_KEYS, NUM_RECORDED_KEYS), &input)) {
+            break; // replay finished
+        }
+        lastTime = frameStart;
+        CPU_PROFILE_BEGIN("frame");
+        const float dt = input.frameSeconds;
+
+        if (bSceneTargetDirty) {
+            sceneTargetResize(&sceneTarget, WindowWidth, WindowHeight);
+            bSceneTargetDirty = false;
+        }
+
+        profilerBeginFrame(&gpuProfiler);
+        profilerPush(&gpuProfiler, "frame");
 
         float time = static_cast<float>(glfwGetTime());
-        processInput(window, dt);
+        CPU_PROFILE_BEGIN("input");
+        processInput(window, input);
+        CPU_PROFILE_END();
+
+        CPU_PROFILE_BEGIN("animation");
+        simClockAdvance(&simClock, dt);
+        while (simClockStep(&simClock)) {
+            for(auto& obj : sceneObjects){
+                obj.update(static_cast<float>(simClock.tickSeconds));
+            }
+        }
+        const float alpha = simClockAlpha(&simClock);
+        for(auto& obj : sceneObjects){
+            obj.interpolate(alpha);
+        }
+        // Lights follow simulated time, so they pause and replay with the cubes
+        const float simTime = static_cast<float>(simClockRenderTime(&simClock));
 
         // --- Animate point lights ---
         // [0] orbits horizontally around scene centre
-        pointLights[0].position.x = 8.0f * sin(time * 0.3f);
-        pointLights[0].position.z = 8.0f * cos(time * 0.3f);
-        pointLights[0].position.y = 7.0f + sin(time * 0.5f) * 1.5f;
+        pointLights[0].position.x = 8.0f * sin(simTime * 0.3f);
+        pointLights[0].position.z = 8.0f * cos(simTime * 0.3f);
+        pointLights[0].position.y = 7.0f + sin(simTime * 0.5f) * 1.5f;
 
         // [1] bobs up and down on the right side
-        pointLights[1].position.y = 5.0f + sin(time * 0.7f) * 3.0f;
-        pointLights[1].position.x = 10.0f * cos(time * 0.2f);
+        pointLights[1].position.y = 5.0f + sin(simTime * 0.7f) * 3.0f;
+        pointLights[1].position.x = 10.0f * cos(simTime * 0.2f);
 
         // [2] sweeps front-back on the left side
-        pointLights[2].position.z = 8.0f * sin(time * 0.4f);
-        pointLights[2].position.y = 6.0f + cos(time * 0.6f) * 2.0f;
+        pointLights[2].position.z = 8.0f * sin(simTime * 0.4f);
+        pointLights[2].position.y = 6.0f + cos(simTime * 0.6f) * 2.0f;
 
         if (roamFirstLight) {
             camera->position = pointLights[0].position + glm::vec3(2.0f, 2.0f, 0.0f);
@@ -639,51 +968,96 @@ int main() {
             camera->position = pointLights[2].position + glm::vec3(2.0f, 2.0f, 0.0f);
         }
 
+        const float cameraState[5] = {camera->position.x, camera->position.y, camera->position.z, camera->yaw, camera->pitch};
+        inputRecordingTrack(&inputRecording, cameraState, 5);
+
         // --- Animate camera lights ---
         cameraLight.position = camera->position;
         cameraLight.dir = camera->front;
 
+        buildObjectLightLists();
+        CPU_PROFILE_END();
+
+        // --- Point light shadows : this frame's budgeted faces, every cube casts ---
+        CPU_PROFILE_BEGIN("shadows");
+        sceneModels.resize(sceneObjects.size());
+        for (size_t i = 0; i < sceneObjects.size(); i++) sceneModels[i] = sceneObjects[i].model;
+        for (int i = 0; i < 3; i++) {
+            pointShadowsSetLight(&pointShadows, i, pointLights[i].position, pointLights[i].radius);
+        }
+        profilerPush(&gpuProfiler, "shadows");
+        pointShadowsUpdate(&pointShadows, camera->position, sceneModels.data(), static_cast<int>(sceneModels.size()), 36);
+        profilerPop(&gpuProfiler);
+        CPU_PROFILE_END();
+
         // --- Clear ---
+        int renderWidth, renderHeight;
+        governorRenderSize(&governor, WindowWidth, WindowHeight, &renderWidth, &renderHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget.framebuffer);
+        glViewport(0, 0, renderWidth, renderHeight);
+        profilerPush(&gpuProfiler, "opaque");
         glClearColor(0.04f, 0.04f, 0.08f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glm::mat4 proj = camera->getProjectionMatrix(static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight));
         glm::mat4 view = camera->getViewMatrix();
 
-        sceneShader->use();
-        sceneShader->setMat4("projection", proj);
-        sceneShader->setMat4("view", view);
-        sceneShader->setVec3("viewPos", camera->position);
-
-        sceneShader->setInt("isCameraLightOn", bIsCameraLightOn ? 1 : 0);
-        sceneShader->setVec3("cameraLight.position", cameraLight.position);
-        sceneShader->setVec3("cameraLight.direction", cameraLight.dir);
-        sceneShader->setVec3 ("cameraLight.color", cameraLight.color);
-        sceneShader->setFloat("cameraLight.innerCutOff", cameraLight.innerCutoff);
-        sceneShader->setFloat("cameraLight.outerCutOff", cameraLight.outerCutoff);
-        sceneShader->setFloat("cameraLight.constant", cameraLight.constant);
-        sceneShader->setFloat("cameraLight.linear", cameraLight.linear);
-        sceneShader->setFloat("cameraLight.quadratic", cameraLight.quadratic);
+        CPU_PROFILE_BEGIN("uniforms");
+        const Shader* shader = legacyTransforms ? sceneShaderLegacy : sceneShader;
+        shader->use();
+        if (legacyTransforms) {
+            shader->setMat4("projection", proj);
+            shader->setMat4("view", view);
+        } else {
+            // Objects only ever take a uniform scale, so the normal matrix is mat3(model) / scale^2
+            const size_t count = sceneObjects.size();
+            sceneMvps.resize(count);
+            sceneNormalMatrices.resize(count);
+            simdMat4MulBatchShared(proj * view, sceneModels.data(), sceneMvps.data(), count);
+            simdNormalMatrixUniformScaleBatch(sceneModels.data(), sceneNormalMatrices.data(), count);
+        }
+        shader->setVec3("viewPos", camera->position);
+        shader->setInt("pointShadowsEnabled", pointShadows.enabled ? 1 : 0);
+
+        shader->setVec3("cameraLight.position", cameraLight.position);
+        shader->setVec3("cameraLight.direction", cameraLight.dir);
+        shader->setVec3 ("cameraLight.color", cameraLight.color);
+        shader->setFloat("cameraLight.innerCutOff", cameraLight.innerCutoff);
+        shader->setFloat("cameraLight.outerCutOff", cameraLight.outerCutoff);
+        shader->setFloat("cameraLight.constant", cameraLight.constant);
+        shader->setFloat("cameraLight.linear", cameraLight.linear);
+        shader->setFloat("cameraLight.quadratic", cameraLight.quadratic);
+        shader->setFloat("cameraLight.range", cameraLight.range);
 
         for(int i = 0; i < 3; i++){
             std::string b = "pointLight[" + std::to_string(i) + "].";
-            sceneShader->setVec3 ((b+"position").c_str(), pointLights[i].position);
-            sceneShader->setVec3 ((b+"color").c_str(), pointLights[i].color);
-            sceneShader->setFloat((b+"constant").c_str(), pointLights[i].constant);
-            sceneShader->setFloat((b+"linear").c_str(), pointLights[i].linear);
-            sceneShader->setFloat((b+"quadratic").c_str(), pointLights[i].quadratic);
+            shader->setVec3 ((b+"position").c_str(), pointLights[i].position);
+            shader->setVec3 ((b+"color").c_str(), pointLights[i].color);
+            shader->setFloat((b+"constant").c_str(), pointLights[i].constant);
+            shader->setFloat((b+"linear").c_str(), pointLights[i].linear);
+            shader->setFloat((b+"quadratic").c_str(), pointLights[i].quadratic);
+            shader->setFloat((b+"radius").c_str(), pointLights[i].radius);
         }
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
-        sceneShader->setInt("material.diffuseTex", 0);
+        shader->setInt("material.diffuseTex", 0);
+        CPU_PROFILE_END();
 
+        CPU_PROFILE_BEGIN("draws");
         glBindVertexArray(cubeVAO);
-        for(auto& obj : sceneObjects){
-            obj.update();
-            sceneShader->setMat4 ("model", obj.model);
-            sceneShader->setVec3 ("material.specular", materials[obj.matId].specular);
-            sceneShader->setFloat("material.shininess", materials[obj.matId].shininess);
+        for(size_t i = 0; i < sceneObjects.size(); i++){
+            const SceneObject& obj = sceneObjects[i];
+            shader->setInt("objectLightCount", obj.lightCount);
+            shader->setIntArray("objectLights", obj.lightIndices, MAX_LIGHTS_PER_OBJECT);
+            shader->setInt("isCameraLightOn", obj.spotLit ? 1 : 0);
+            shader->setMat4 ("model", obj.model);
+            if (!legacyTransforms) {
+                shader->setMat4("mvp", sceneMvps[i]);
+                shader->setMat3("normalMatrix", sceneNormalMatrices[i]);
+            }
+            shader->setVec3 ("material.specular", materials[obj.matId].specular);
+            shader->setFloat("material.shininess", materials[obj.matId].shininess);
             glDrawArrays(GL_TRIANGLES, 0, 36);
         }
 
@@ -699,13 +1073,43 @@ int main() {
             lightingShader->setVec3("emissiveColor", pointLight.color);
             glDrawArrays(GL_TRIANGLES, 0, 36);
         }
+        profilerPop(&gpuProfiler);
+        CPU_PROFILE_END();
+
+        // --- Upscale to the window ---
+        profilerPush(&gpuProfiler, "upscale");
+        sceneTargetBlit(&sceneTarget, renderWidth, renderHeight, WindowWidth, WindowHeight);
+        profilerPop(&gpuProfiler);   // upscale
+        profilerPop(&gpuProfiler);   // frame
+        profilerEndFrame(&gpuProfiler);
+
+        // CPU time is everything up to the swap, which may block on vsync
+        const float cpuMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+        if (governorUpdate(&governor, cpuMs, governorGpuFrameMs(&gpuProfiler), time)) {
+            applyQualityLevel();
+        }
+        if (time - lastStatsTime >= 2.0) {
+            profilerPrintStats(&gpuProfiler);
+            lastStatsTime = time;
+        }
 
+        CPU_PROFILE_BEGIN("glfwSwapBuffers");
         glfwSwapBuffers(window);
+        CPU_PROFILE_END();
         glfwPollEvents();
+        CPU_PROFILE_END();
     }
 
+    CPU_PROFILE_FLUSH(CPU_TRACE_PATH);
+    inputRecordingFinish(&inputRecording);
+
+    profilerDestroy(&gpuProfiler);
+    sceneTargetRelease(&sceneTarget);
+    pointShadowsShutdown(&pointShadows);
     glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteBuffers(1, &cubeVBO);
     delete sceneShader;
+    delete sceneShaderLegacy;
     delete lightingShader;
     delete defaultTexture;
     delete camera;
@@ -5,6 +5,7 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "FixedTimestep.h"
 
 //Vertex shader source
 const char* VertexShaderSource = R"(
@@ -49,6 +50,15 @@ float AtranslateZ = -50.0f;
 float AtranslateX = 0.5f;
 float YtranslateZ = -50.0f;
 float YtranslateX = 1.5f;
+// Letter depths at the tick before the latest one, rendering blends the two
+float UpreviousZ = UtranslateZ;
+float DpreviousZ = DtranslateZ;
+float ApreviousZ = AtranslateZ;
+float YpreviousZ = YtranslateZ;
+// Letters used to move 0.05 per frame, this is the same speed at 60 fps
+constexpr float LETTER_SPEED = 3.0f; // units per second
+// H pauses the simulation, - / = halve / double the tick rate
+SimulationClock simClock;
 
 struct Vertex {
     glm::vec3 pos;
@@ -68,6 +78,23 @@ float aspectRatio(0.0f);
 
 //Callbacks
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// One simulation tick : every letter that has appeared flies in until it reaches z = 0
+void stepLetters(float dt, float simTime) {
+    if (DrawU && UtranslateZ <= 0.0f) {
+        UtranslateZ += LETTER_SPEED * dt;
+    }
+    if (DrawD && simTime > 2.0f && DtranslateZ <= 0.0f) {
+        DtranslateZ += LETTER_SPEED * dt;
+    }
+    if (DrawA && simTime > 4.0f && AtranslateZ <= 0.0f) {
+        AtranslateZ += LETTER_SPEED * dt;
+    }
+    if (DrawY && simTime > 6.0f && YtranslateZ <= 0.0f) {
+        YtranslateZ += LETTER_SPEED * dt;
+    }
+}
 
 // Main Function
 int main() {
@@ -105,6 +132,7 @@ int main() {
     aspectRatio = fbWidth / fbHeight;
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetKeyCallback(window, key_callback);
 
     //VertexShader and FragmentShader
     GLuint VertexShader, FragmentShader;
@@ -250,7 +278,21 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);
 
+    double lastFrameTime = glfwGetTime();
     while (!glfwWindowShouldClose(window)) {
+        const double now = glfwGetTime();
+        simClockAdvance(&simClock, now - lastFrameTime);
+        lastFrameTime = now;
+        while (simClockStep(&simClock)) {
+            UpreviousZ = UtranslateZ;
+            DpreviousZ = DtranslateZ;
+            ApreviousZ = AtranslateZ;
+            YpreviousZ = YtranslateZ;
+            stepLetters(static_cast<float>(simClock.tickSeconds), static_cast<float>(simClock.time));
+        }
+        const float alpha = simClockAlpha(&simClock);
+        const float time = static_cast<float>(simClockRenderTime(&simClock));
+
         glClearColor(0.9f, 0.4f, 0.4f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -263,54 +305,42 @@ int main() {
         glUniformMatrix4fv(glGetUniformLocation(ShaderProgram,"projection"),1,GL_FALSE,glm::value_ptr(projection));
 
         if (DrawU) {
-            if (UtranslateZ <= 0.0f) {
-                UtranslateZ += 0.05f;
-            }
-
+            const float z = UpreviousZ + (UtranslateZ - UpreviousZ) * alpha;
             glBindVertexArray(LetterU_VAO);
             glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model,{UtranslateX, 0.0f, UtranslateZ});
-            model = glm::rotate(model,(float)glfwGetTime()*glm::radians(UtranslateZ),glm::vec3(1,0.3,0.5));
+            model = glm::translate(model,{UtranslateX, 0.0f, z});
+            model = glm::rotate(model,time*glm::radians(z),glm::vec3(1,0.3,0.5));
             glUniformMatrix4fv(glGetUniformLocation(ShaderProgram,"model"),1,GL_FALSE,glm::value_ptr(model));
             glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(U_vertices.size()));
         }
 
 
-        if (DrawD && (float)glfwGetTime() > 2.0f) {
-            if (DtranslateZ <= 0.0f) {
-                DtranslateZ += 0.05f;
-            }
-
+        if (DrawD && time > 2.0f) {
+            const float z = DpreviousZ + (DtranslateZ - DpreviousZ) * alpha;
             glBindVertexArray(LetterD_VAO);
             glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model,{DtranslateX, 0.0f, DtranslateZ});
-            model = glm::rotate(model,(float)glfwGetTime()*glm::radians(DtranslateZ),glm::vec3(1,0.3,0.5));
+            model = glm::translate(model,{DtranslateX, 0.0f, z});
+            model = glm::rotate(model,time*glm::radians(z),glm::vec3(1,0.3,0.5));
             glUniformMatrix4fv(glGetUniformLocation(ShaderProgram,"model"),1,GL_FALSE,glm::value_ptr(model));
             glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(D_vertices.size()));
         }
 
-        if (DrawA && (float)glfwGetTime() > 4.0f) {
-            if (AtranslateZ <= 0.0f) {
-                AtranslateZ += 0.05f;
-            }
-
+        if (DrawA && time > 4.0f) {
+            const float z = ApreviousZ + (AtranslateZ - ApreviousZ) * alpha;
             glBindVertexArray(LetterA_VAO);
             glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model,{AtranslateX, 0.0f, AtranslateZ});
-            model = glm::rotate(model,(float)glfwGetTime()*glm::radians(AtranslateZ),glm::vec3(1,0.3,0.5));
+            model = glm::translate(model,{AtranslateX, 0.0f, z});
+            model = glm::rotate(model,time*glm::radians(z),glm::vec3(1,0.3,0.5));
             glUniformMatrix4fv(glGetUniformLocation(ShaderProgram,"model"),1,GL_FALSE,glm::value_ptr(model));
             glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(A_vertices.size()));
         }
 
-        if (DrawY && (float)glfwGetTime() > 6.0f) {
-            if (YtranslateZ <= 0.0f) {
-                YtranslateZ += 0.05f;
-            }
-
+        if (DrawY && time > 6.0f) {
+            const float z = YpreviousZ + (YtranslateZ - YpreviousZ) * alpha;
             glBindVertexArray(LetterY_VAO);
             glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model,{YtranslateX, 0.0f, YtranslateZ});
-            model = glm::rotate(model,(float)glfwGetTime()*glm::radians(YtranslateZ),glm::vec3(1,0.3,0.5));
+            model = glm::translate(model,{YtranslateX, 0.0f, z});
+            model = glm::rotate(model,time*glm::radians(z),glm::vec3(1,0.3,0.5));
             glUniformMatrix4fv(glGetUniformLocation(ShaderProgram,"model"),1,GL_FALSE,glm::value_ptr(model));
             glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(Y_vertices.size()));
         }
@@ -330,6 +360,19 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     aspectRatio = static_cast<float>(width) / static_cast<float>(height);
 }
 
+void key_callback(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_H) {
+        simClock.paused = !simClock.paused;
+        std::cout << "Simulation " << (simClock.paused ? "paused" : "running") << std::endl;
+    }
+    if (key == GLFW_KEY_MINUS || key == GLFW_KEY_EQUAL) {
+        const double rate = 1.0 / simClock.tickSeconds;
+        simClockSetTickRate(&simClock, key == GLFW_KEY_EQUAL ? rate * 2.0 : rate * 0.5);
+        std::cout << "Simulation tick rate " << 1.0 / simClock.tickSeconds << " Hz" << std::endl;
+    }
+}
+
 void addBox(
     std::vector<Vertex>& verts,
     glm::vec3 min,
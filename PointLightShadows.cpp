@@ -0,0 +1,841 @@
+// Omnidirectional point-light shadows : the MultipleLights scene on a floor, each of the three animated
+// point lights owning one cube of a depth cube-map array.
+// All shadow faces chosen for this frame are drawn in ONE instanced draw : a geometry shader with one invocation
+// per budgeted face picks the light/face, transforms the triangle and routes it with gl_Layer.
+// Faces compete for a fixed per-frame budget by staleness, light motion and distance to the camera.
+// The pass itself lives in PointShadows.h, shared with MultipleLights and the LightWithAttenuation demos.
+//
+// [ / ] change the face budget, V shows which faces were refreshed this frame.
+
+#include <cmath>
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "FixedTimestep.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "GpuProfiler.h"
+#include "PointShadows.h"
+
+
+/// Defining Globals variable ---- (start)
+/// Rendering
+constexpr int NUM_CUBES = 64;
+
+/// Simulation
+/// SceneObject spin speeds are given in degrees per frame at this rate, they turn at rotSpeed * 60 degrees per second
+constexpr float ROTATION_REFERENCE_FPS = 60.0f;
+/// Cube spin advances in fixed ticks, so it turns at the same speed and costs the same work at any frame rate
+SimulationClock simClock;
+
+/// Camera
+constexpr float CAMERA_SPEED = 4.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// SpotLight
+constexpr float SPOT_LIGHT_INNER = 15.0f;
+constexpr float SPOT_LIGHT_OUTER = 30.0f;
+
+/// Point light shadows
+constexpr int NUM_POINT_LIGHTS = 3;
+constexpr int NUM_SHADOW_FACES = NUM_POINT_LIGHTS * 6;
+constexpr int SHADOW_CUBE_SIZE = 512;
+/// The most faces one frame may refresh
+constexpr int MAX_FACE_BUDGET = std::min(NUM_SHADOW_FACES, POINT_SHADOW_MAX_FACES);
+/// Faces refreshed per frame unless changed with [ / ]
+constexpr int DEFAULT_FACE_BUDGET = 6;
+/// A light contribution below this luminance is treated as zero : bounds the shadow far plane
+constexpr float LUMINANCE_CUTOFF = 0.02f;
+
+/// Turn off or on spotlight
+bool bIsCameraLightOn = true;
+bool bShowRefreshedFaces = false;
+int faceBudget = DEFAULT_FACE_BUDGET;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 4.0f, 20.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() = default;
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe, dir.z : forward, dir.y : world vertical
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(glm::radians(FOV), aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + optional geometry + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles the given GLSL stages, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr) {
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        GLuint geometryShader = 0;
+        if (geometrySource) {
+            geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+            compileShader(geometryShader, geometrySource);
+            glAttachShader(ProgramID, geometryShader);
+        }
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        if (geometryShader) glDeleteShader(geometryShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a float uniform (shininess, attenuation values, time, etc.).
+    void setFloat(const char* uniform, const float val) const {
+        glUniform1f(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Creating procedural texture ------------------ (start)
+class Texture {
+public:
+    // OpenGL texture handle — 0 = invalid/uninitialized
+    GLuint TextureID = 0;
+    Texture() {
+        glGenTextures(1, &TextureID);
+        glBindTexture(GL_TEXTURE_2D, TextureID);
+
+        // Texture dimensions — 256x256 pixels, RGBA.
+        constexpr int size = 256;
+        auto* data = new unsigned char[size * size * 4];
+
+        // Same procedural stripes as MultipleLights.
+        for (int y = 0 ; y < size ; y++) {
+            for (int x = 0 ; x < size ; x++) {
+                const float fx = static_cast<float>(x) / size;
+                const float fy = static_cast<float>(y) / size;
+                float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+                const int i = (y * size + x) * 4;
+                data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+                data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+                data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+                data[i+3] = 255;
+            }
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        delete[] data;
+
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    }
+};
+
+/// Creating procedural texture ------------------ (end)
+
+
+
+/// Light structs --------- (Start)
+// Distance at which the light's luminance, attenuated, drops to LUMINANCE_CUTOFF.
+float attenuationRadius(const glm::vec3& color, float constant, float linear, float quadratic) {
+    const float luminance = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    const float c = constant - luminance / LUMINANCE_CUTOFF;
+    if (c >= 0.0f) return POINT_SHADOW_NEAR * 2.0f;
+    return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
+struct PointLight {
+    glm::vec3 position, color;
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+    float radius = 0.0f; // also the shadow far plane
+
+    PointLight(glm::vec3 p, glm::vec3 c) : position(p), color(c) {
+        radius = attenuationRadius(color, constant, linear, quadratic);
+    }
+};
+
+struct SpotLight {
+    glm::vec3 position, dir, color;
+    float innerCutoff, outerCutoff;
+    float constant = 1.0f;
+    float linear = 0.07f;
+    float quadratic = 0.017f;
+
+    SpotLight(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer)
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))) {}
+};
+/// Light structs --------- (end)
+
+
+/// Material ------ (start)
+struct Material { glm::vec3 specular; float shininess; };
+
+Material materials[6] = {
+    {{1.0f,1.0f,1.0f}, 32.0f},
+    {{1.0f,1.0f,1.0f}, 64.0f},
+    {{1.0f,1.0f,1.0f}, 128.0f},
+    {{1.0f,1.0f,1.0f}, 256.0f},
+    {{0.9f,0.9f,0.9f}, 512.0f},
+    {{0.4f,0.9f,0.4f}, 1028.0f}
+};
+
+/// Material ------ (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVAO = 0, cubeVBO = 0;
+
+float cubeData[288] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
+     0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,  -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,  -0.5f, 0.5f,-0.5f, 0,0,-1, 0,1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,   0.5f,-0.5f, 0.5f, 0,0, 1, 1,0,   0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,
+     0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,  -0.5f, 0.5f, 0.5f, 0,0, 1, 0,1,  -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,
+    -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f,-0.5f,-1,0, 0, 1,1,
+    -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f, 0.5f,-1,0, 0, 0,0,
+     0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f,-0.5f, 1,0, 0, 1,1,
+     0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f, 0.5f, 1,0, 0, 0,0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,   0.5f,-0.5f,-0.5f, 0,-1,0, 1,1,   0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0, 0,0,  -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,
+    -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,   0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0, 1,1,
+     0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,  -0.5f, 0.5f, 0.5f, 0, 1,0, 0,0
+};
+
+void setupCubeVAO() {
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &cubeVBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // uv
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+
+/// Cube vertex data ------------- (end)
+
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (start)
+class SceneObject {
+public:
+    glm::mat4 model{};
+    int matId;
+    float rotSpeed;
+
+    // Translation and scale, the spin is applied on top
+    glm::mat4 base{};
+    // Spin in degrees at the latest and the previous simulation tick
+    float angle = 0.0f;
+    float previousAngle = 0.0f;
+
+    SceneObject(glm::vec3 pos, glm::vec3 scale, int mat, float rot) : matId(mat), rotSpeed(rot) {
+        base = glm::scale(glm::translate(glm::mat4(1.0f), pos), scale);
+        model = base;
+    }
+
+    // One simulation tick
+    void update(float dt) {
+        previousAngle = angle;
+        angle += rotSpeed * ROTATION_REFERENCE_FPS * dt;
+        // Keep the angle small so it does not lose precision over a long run, both move so the blend is unchanged
+        if (angle > 360.0f || angle < -360.0f) {
+            const float turns = 360.0f * static_cast<float>(static_cast<int>(angle / 360.0f));
+            angle -= turns;
+            previousAngle -= turns;
+        }
+    }
+
+    // Model matrix between the previous and the latest tick
+    void interpolate(float alpha) {
+        model = glm::rotate(base, glm::radians(previousAngle + (angle - previousAngle) * alpha), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+/// separated functionality for retrieving model matrix with rotation for object in scene ---- (end)
+
+
+/// shaders --------- (Start)
+const char* sceneVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model, view, projection;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = aTexCoord;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+const char* sceneFragmentShaderSource = R"(
+#version 410 core
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float innerCutOff;
+    float outerCutOff;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct PointLight {
+    vec3 position;
+    vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+    float radius;
+};
+
+uniform SpotLight cameraLight;
+uniform PointLight pointLight[3];
+uniform vec3 viewPos;
+uniform Material material;
+uniform int isCameraLightOn;
+
+// Debug : bit (light * 6 + face) set when that face was redrawn this frame
+uniform int refreshedFaces;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+out vec4 FragColor;
+
+float attenuate(float distance, float constant, float linear, float quadratic) {
+    return 1.0 / (constant + linear * distance + quadratic * distance * distance);
+}
+
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+// Index of the cube face a direction falls on, GL order +X -X +Y -Y +Z -Z
+int cubeFace(vec3 d) {
+    vec3 a = abs(d);
+    if (a.x >= a.y && a.x >= a.z) return d.x > 0.0 ? 0 : 1;
+    if (a.y >= a.z) return d.y > 0.0 ? 2 : 3;
+    return d.z > 0.0 ? 4 : 5;
+}
+
+vec3 calPointLightEffect(int index, vec3 norm, vec3 viewDir) {
+    PointLight light = pointLight[index];
+    vec3 lightDir = normalize(light.position - FragPos);
+    float distance = length(light.position - FragPos);
+    if (distance >= light.radius) return vec3(0.0);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic) * rangeWindow(distance, light.radius);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    float shadow = pointShadow(index, FragPos, norm, light.position, light.radius);
+    vec3 result = (ambient + (diffuse + specular) * shadow) * attenuation;
+
+    if (refreshedFaces != 0 && ((refreshedFaces >> (index * 6 + cubeFace(FragPos - light.position))) & 1) == 1) {
+        result += vec3(0.0, 0.15, 0.0) * attenuation;
+    }
+    return result;
+}
+
+vec3 calSpotLightEffect(SpotLight light, vec3 norm, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - FragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon , 0.0, 1.0);
+
+    if(intensity <= 0) return vec3(0.0);
+
+    float distance = length(light.position - FragPos);
+    float attenuation = attenuate(distance, light.constant, light.linear, light.quadratic);
+
+    vec3 ambient = 0.05 * light.color;
+
+    float diff    = max(dot(norm, lightDir), 0.0);
+    vec3  diffuse = diff * light.color;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * light.color * material.specular;
+
+    return (ambient + (diffuse + specular) * intensity) * attenuation;
+}
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec4 texColor = texture(material.diffuseTex, TexCoord);
+
+    vec3 result = 0.1 * texColor.rgb;
+    if (isCameraLightOn == 1) {
+        result += calSpotLightEffect(cameraLight, norm, viewDir) * texColor.rgb;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        result += calPointLightEffect(i, norm, viewDir) * texColor.rgb;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+const char* lightCubeVS = R"(
+#version 410 core
+layout(location=0) in vec3 aPos;
+uniform mat4 model, view, projection;
+void main(){
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+})";
+
+const char* lightCubeFS = R"(
+#version 410 core
+uniform vec3 emissiveColor;
+out vec4 FragColor;
+void main(){
+    FragColor = vec4(emissiveColor, 1.0);
+})";
+/// shaders --------- (End)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* sceneShader = nullptr;
+Shader* lightingShader = nullptr;
+Texture* defaultTexture = nullptr;
+PointShadows pointShadows;
+
+std::vector<SceneObject> sceneObjects;
+SpotLight cameraLight(glm::vec3(0.0f), glm::vec3(0.0f,0.0f,-1.0f), glm::vec3(1.0f, 1.0f, 1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER);
+
+std::vector<PointLight> pointLights = {
+    { glm::vec3( 0.0f, 8.0f,  0.0f), glm::vec3(1.0f, 0.55f, 0.15f) }, // warm orange
+    { glm::vec3(12.0f, 5.0f, -6.0f), glm::vec3(0.2f, 0.75f, 1.0f ) }, // cool cyan
+    { glm::vec3(-10.0f,7.0f, 10.0f), glm::vec3(1.0f, 0.3f,  0.5f ) }  // pink-red
+};
+
+int WindowWidth, WindowHeight;
+/// Global Objects ------ (End)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+}
+
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_LEFT_BRACKET)  faceBudget = std::max(faceBudget - 1, 1);
+    if (key == GLFW_KEY_RIGHT_BRACKET) faceBudget = std::min(faceBudget + 1, MAX_FACE_BUDGET);
+    if (key == GLFW_KEY_V) bShowRefreshedFaces = !bShowRefreshedFaces;
+    if (key == GLFW_KEY_LEFT_BRACKET || key == GLFW_KEY_RIGHT_BRACKET) {
+        std::cout << "Shadow face budget " << faceBudget << " / " << NUM_SHADOW_FACES << std::endl;
+    }
+}
+
+bool roamFirstLight = false;
+bool roamSecondLight = false;
+bool roamThirdLight = false;
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+    if(glfwGetKey(win, GLFW_KEY_O) == GLFW_PRESS) bIsCameraLightOn = true;
+    if(glfwGetKey(win, GLFW_KEY_P) == GLFW_PRESS) bIsCameraLightOn = false;
+
+    if(glfwGetKey(win, GLFW_KEY_1) == GLFW_PRESS) {
+        roamFirstLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_2) == GLFW_PRESS) {
+        roamSecondLight = true;
+    } else if(glfwGetKey(win, GLFW_KEY_3) == GLFW_PRESS) {
+        roamThirdLight = true;
+    } else {
+        roamFirstLight = false;
+        roamSecondLight = false;
+        roamThirdLight = false;
+    }
+}
+/// Callbacks ----- (End)
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Point Light Shadows", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    lastX = static_cast<float>(mode->width) / 2.0f;
+    lastY = static_cast<float>(mode->height) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+
+    setupCubeVAO();
+    defaultTexture = new Texture();
+    sceneShader = new Shader(sceneVertexShaderSource, pointShadowsShaderSource(sceneFragmentShaderSource).c_str());
+    lightingShader = new Shader(lightCubeVS, lightCubeFS);
+    camera = new Camera();
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_real_distribution<float> rPos(-15.0f, 15.0f), rRot(-1.5f,1.5f);
+    std::uniform_int_distribution<int> rMat(0,4);
+
+    // Floor to catch the shadows, then the MultipleLights cubes
+    sceneObjects.emplace_back(glm::vec3(0.0f, -4.0f, 0.0f), glm::vec3(60.0f, 0.5f, 60.0f), 0, 0.0f);
+    for(int i = 0; i < NUM_CUBES; i++){
+        float scale = 0.6f + (i%5)*0.1f;
+        sceneObjects.emplace_back(glm::vec3(rPos(gen), rPos(gen)*0.3f+1.0f, rPos(gen)), glm::vec3(scale), rMat(gen), rRot(gen));
+    }
+
+    // --- Shadow cube-map array : one cube per point light, the floor and cubes cast ---
+    pointShadowsInit(&pointShadows, NUM_POINT_LIGHTS, SHADOW_CUBE_SIZE, faceBudget, cubeVBO, 8 * sizeof(float));
+    std::vector<glm::mat4> casterModels;
+
+    // Shadow pass time, read back PROFILER_FRAMES later so it never stalls
+    GpuProfiler gpuProfiler;
+    profilerInit(&gpuProfiler);
+
+    sceneShader->use();
+    sceneShader->setInt("material.diffuseTex", 0);
+    sceneShader->setInt("pointShadowCubes", 1);
+    sceneShader->setInt("pointShadowsEnabled", 1);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, pointShadows.cubeArray);
+    glActiveTexture(GL_TEXTURE0);
+
+    auto lastTime = std::chrono::high_resolution_clock::now();
+    double lastStatsTime = glfwGetTime();
+    int statsFrames = 0;
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+
+        float time = static_cast<float>(glfwGetTime());
+        processInput(window, dt);
+
+        // --- Animate point lights ---
+        // [0] orbits horizontally around scene centre
+        pointLights[0].position.x = 8.0f * sin(time * 0.3f);
+        pointLights[0].position.z = 8.0f * cos(time * 0.3f);
+        pointLights[0].position.y = 7.0f + sin(time * 0.5f) * 1.5f;
+
+        // [1] bobs up and down on the right side
+        pointLights[1].position.y = 5.0f + sin(time * 0.7f) * 3.0f;
+        pointLights[1].position.x = 10.0f * cos(time * 0.2f);
+
+        // [2] sweeps front-back on the left side
+        pointLights[2].position.z = 8.0f * sin(time * 0.4f);
+        pointLights[2].position.y = 6.0f + cos(time * 0.6f) * 2.0f;
+
+        if (roamFirstLight) {
+            camera->position = pointLights[0].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamSecondLight) {
+            camera->position = pointLights[1].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        } else if(roamThirdLight) {
+            camera->position = pointLights[2].position + glm::vec3(2.0f, 2.0f, 0.0f);
+        }
+
+        // --- Animate camera lights ---
+        cameraLight.position = camera->position;
+        cameraLight.dir = camera->front;
+
+        simClockAdvance(&simClock, dt);
+        while (simClockStep(&simClock)) {
+            for(auto& obj : sceneObjects){
+                obj.update(static_cast<float>(simClock.tickSeconds));
+            }
+        }
+        const float alpha = simClockAlpha(&simClock);
+        for(auto& obj : sceneObjects){
+            obj.interpolate(alpha);
+        }
+
+        // --- Shadow pass : the budgeted faces of all lights in one draw ---
+        for (int i = 0; i < NUM_POINT_LIGHTS; i++) {
+            pointShadowsSetLight(&pointShadows, i, pointLights[i].position, pointLights[i].radius);
+        }
+        pointShadows.faceBudget = faceBudget;
+        casterModels.clear();
+        for (const auto& obj : sceneObjects) casterModels.push_back(obj.model);
+
+        profilerBeginFrame(&gpuProfiler);
+        profilerPush(&gpuProfiler, "shadows");
+        pointShadowsUpdate(&pointShadows, camera->position, casterModels.data(), static_cast<int>(casterModels.size()), 36);
+        profilerPop(&gpuProfiler);
+        profilerEndFrame(&gpuProfiler);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, WindowWidth, WindowHeight);
+
+        // --- Clear ---
+        glClearColor(0.04f, 0.04f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 proj = camera->getProjectionMatrix(static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight));
+        glm::mat4 view = camera->getViewMatrix();
+
+        sceneShader->use();
+        sceneShader->setMat4("projection", proj);
+        sceneShader->setMat4("view", view);
+        sceneShader->setVec3("viewPos", camera->position);
+        sceneShader->setInt("refreshedFaces", bShowRefreshedFaces ? static_cast<int>(pointShadows.refreshedMask) : 0);
+
+        sceneShader->setInt("isCameraLightOn", bIsCameraLightOn ? 1 : 0);
+        sceneShader->setVec3("cameraLight.position", cameraLight.position);
+        sceneShader->setVec3("cameraLight.direction", cameraLight.dir);
+        sceneShader->setVec3 ("cameraLight.color", cameraLight.color);
+        sceneShader->setFloat("cameraLight.innerCutOff", cameraLight.innerCutoff);
+        sceneShader->setFloat("cameraLight.outerCutOff", cameraLight.outerCutoff);
+        sceneShader->setFloat("cameraLight.constant", cameraLight.constant);
+        sceneShader->setFloat("cameraLight.linear", cameraLight.linear);
+        sceneShader->setFloat("cameraLight.quadratic", cameraLight.quadratic);
+
+        for(int i = 0; i < NUM_POINT_LIGHTS; i++){
+            std::string b = "pointLight[" + std::to_string(i) + "].";
+            sceneShader->setVec3 ((b+"position").c_str(), pointLights[i].position);
+            sceneShader->setVec3 ((b+"color").c_str(), pointLights[i].color);
+            sceneShader->setFloat((b+"constant").c_str(), pointLights[i].constant);
+            sceneShader->setFloat((b+"linear").c_str(), pointLights[i].linear);
+            sceneShader->setFloat((b+"quadratic").c_str(), pointLights[i].quadratic);
+            sceneShader->setFloat((b+"radius").c_str(), pointLights[i].radius);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+
+        glBindVertexArray(cubeVAO);
+        for(auto& obj : sceneObjects){
+            sceneShader->setMat4 ("model", obj.model);
+            sceneShader->setVec3 ("material.specular", materials[obj.matId].specular);
+            sceneShader->setFloat("material.shininess", materials[obj.matId].shininess);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        lightingShader->use();
+        lightingShader->setMat4("projection", proj);
+        lightingShader->setMat4("view", view);
+
+        glBindVertexArray(cubeVAO);
+        for(auto & pointLight : pointLights){
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), pointLight.position);
+            model = glm::scale(model, glm::vec3(0.3f));
+            lightingShader->setMat4("model", model);
+            lightingShader->setVec3("emissiveColor", pointLight.color);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+        // --- Shadow cost, every ~2 seconds ---
+        statsFrames++;
+        if (glfwGetTime() - lastStatsTime >= 2.0) {
+            const GpuScopeStats* shadowStats = profilerFindStats(&gpuProfiler, "shadows");
+            std::cout << "Shadow faces " << static_cast<float>(pointShadows.facesRendered) / statsFrames << "/frame (budget " << faceBudget
+                      << ") | shadow pass " << (shadowStats ? shadowStats->averageMs : 0.0) << " ms/frame"
+                      << " | oldest face " << pointShadowsOldestFace(&pointShadows) << " frames" << std::endl;
+            pointShadows.facesRendered = 0;
+            statsFrames = 0;
+            lastStatsTime = glfwGetTime();
+        }
+    }
+
+    profilerDestroy(&gpuProfiler);
+    pointShadowsShutdown(&pointShadows);
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteBuffers(1, &cubeVBO);
+    delete sceneShader;
+    delete lightingShader;
+    delete defaultTexture;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}
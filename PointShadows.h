@@ -0,0 +1,400 @@
+// Point light shadows : every light owns one cube of a depth cube-map array, and all the faces picked for a frame are
+// drawn in ONE instanced draw. A geometry shader invocation per picked face chooses the light and face, transforms
+// the triangle and routes it to its layer with gl_Layer. Faces compete for a fixed per-frame budget by staleness,
+// light motion and distance to the camera, so a light that stands still and is far away is redrawn rarely.
+//
+//   pointShadowsInit(&shadows, lightCount, 512, faceBudget, cubeVBO, 8 * sizeof(float));
+//   each frame : pointShadowsSetLight(&shadows, i, position, radius) for every light
+//                pointShadowsUpdate(&shadows, cameraPosition, casterModels, casterCount, 36);
+//                rebind the scene framebuffer and viewport, draw with the cube array bound as pointShadowCubes
+//   pointShadowsShutdown(&shadows);
+//
+// Lit shaders get pointShadow() from pointShadowsShaderSource(). A cube stores the distance to its light divided
+// by the light's radius, which is also the far plane of its faces.
+
+#pragma once
+
+#include "glad/glad.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+/// Near plane of every shadow face
+constexpr float POINT_SHADOW_NEAR = 0.1f;
+/// Most faces one frame may refresh : geometry shader invocations, GL guarantees at least 32
+constexpr int POINT_SHADOW_MAX_FACES = 32;
+/// Faces tracked in PointShadows::refreshedMask, lights past the tenth are refreshed but not reported
+constexpr int POINT_SHADOW_MASK_FACES = 64;
+/// Urgency added per world unit a light moved since its face was last drawn, in frames
+constexpr float POINT_SHADOW_MOTION_WEIGHT = 8.0f;
+
+/// Face f of light l is layer-face l * 6 + f of the array, in GL cube face order (+X -X +Y -Y +Z -Z)
+struct PointShadowFace {
+    int framesStale = 0;          // frames since this face was drawn
+    glm::vec3 renderedFrom{};     // light position when it was drawn
+    bool everRendered = false;
+    float priority = 0.0f;
+};
+
+struct PointShadows {
+    int lightCount = 0;
+    int size = 0;           // texels per face edge
+    int faceBudget = 0;     // faces refreshed per frame, at most POINT_SHADOW_MAX_FACES
+    bool enabled = true;    // off : nothing is drawn and pointShadow() returns 1
+
+    GLuint cubeArray = 0;
+    GLuint framebuffer = 0;            // the whole array, layered
+    GLuint faceClearFramebuffer = 0;   // one face at a time, clearing the layered one would clear every face
+    GLuint program = 0;
+    GLuint casterVAO = 0;
+    GLuint instanceBuffer = 0;         // one model matrix per caster
+    size_t instanceCapacity = 0;
+    GLint faceCountLocation = -1;
+    GLint faceLayerLocation = -1;
+    GLint faceViewProjectionLocation = -1;
+    GLint faceLightLocation = -1;
+
+    std::vector<glm::vec4> lights;   // xyz position, w radius
+    std::vector<PointShadowFace> faces;
+    uint64_t refreshedMask = 0;      // bit (light * 6 + face) set when that face was drawn by the last update
+    unsigned long long facesRendered = 0;   // since the caller last reset it
+};
+
+/// Shadow pass : world space vertices, the geometry shader does the per face transform
+inline const char* POINT_SHADOW_VERTEX_SHADER = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
+void main() {
+    gl_Position = aModel * vec4(aPos, 1.0);
+}
+)";
+
+/// Invocation i draws the triangle into the i-th picked face, invocations past faceCount emit nothing.
+/// Triangles entirely outside one clip plane of a face are dropped before rasterization.
+inline const std::string POINT_SHADOW_GEOMETRY_SHADER = std::string(R"(
+#version 410 core
+#define MAX_FACES )") + std::to_string(POINT_SHADOW_MAX_FACES) + R"(
+layout (triangles, invocations = MAX_FACES) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+uniform int faceCount;
+uniform int faceLayer[MAX_FACES];
+uniform mat4 faceViewProjection[MAX_FACES];
+uniform vec4 faceLight[MAX_FACES];   // xyz position, w radius
+
+out vec3 WorldPos;
+flat out vec4 LightPosRadius;
+
+void main() {
+    if (gl_InvocationID >= faceCount) return;
+
+    vec4 clip[3];
+    for (int i = 0; i < 3; i++) clip[i] = faceViewProjection[gl_InvocationID] * gl_in[i].gl_Position;
+
+    for (int axis = 0; axis < 3; axis++) {
+        if (clip[0][axis] >  clip[0].w && clip[1][axis] >  clip[1].w && clip[2][axis] >  clip[2].w) return;
+        if (clip[0][axis] < -clip[0].w && clip[1][axis] < -clip[1].w && clip[2][axis] < -clip[2].w) return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        gl_Layer = faceLayer[gl_InvocationID];
+        WorldPos = gl_in[i].gl_Position.xyz;
+        LightPosRadius = faceLight[gl_InvocationID];
+        gl_Position = clip[i];
+        EmitVertex();
+    }
+    EndPrimitive();
+}
+)";
+
+/// Linear distance to the light, so every face of a cube stores the same metric
+inline const char* POINT_SHADOW_FRAGMENT_SHADER = R"(
+#version 410 core
+in vec3 WorldPos;
+flat in vec4 LightPosRadius;
+void main() {
+    gl_FragDepth = length(WorldPos - LightPosRadius.xyz) / LightPosRadius.w;
+}
+)";
+
+/// Lookup for lit fragment shaders, see pointShadowsShaderSource()
+inline const char* POINT_SHADOW_GLSL = R"(
+// Point shadows (PointShadows.h) : cube i belongs to light i and stores distance to the light / its radius
+uniform samplerCubeArrayShadow pointShadowCubes;
+uniform int pointShadowsEnabled;
+
+// Fraction of the light reaching fragPos : four hardware filtered comparisons on a small cross around the lookup
+float pointShadow(int index, vec3 fragPos, vec3 norm, vec3 lightPosition, float radius) {
+    if (pointShadowsEnabled == 0) return 1.0;
+    vec3 fromLight = fragPos + norm * 0.05 - lightPosition;
+    float reference = length(fromLight) / radius - 0.002;
+    if (reference >= 1.0) return 1.0;   // past the far plane nothing was drawn
+    vec3 d = normalize(fromLight);
+    vec3 t = normalize(cross(d, abs(d.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 b = cross(d, t);
+    float spread = 1.5 / float(textureSize(pointShadowCubes, 0).x);
+    float lit = 0.0;
+    lit += texture(pointShadowCubes, vec4(d + (t + b) * spread, float(index)), reference);
+    lit += texture(pointShadowCubes, vec4(d + (t - b) * spread, float(index)), reference);
+    lit += texture(pointShadowCubes, vec4(d - (t + b) * spread, float(index)), reference);
+    lit += texture(pointShadowCubes, vec4(d - (t - b) * spread, float(index)), reference);
+    return lit * 0.25;
+}
+)";
+
+/// A lit fragment shader with POINT_SHADOW_GLSL inserted after its #version line
+/// @param source Shader source
+/// @return Source that can call pointShadow()
+inline std::string pointShadowsShaderSource(const char* source) {
+    std::string shader = source;
+    shader.insert(shader.find('\n', shader.find("#version")) + 1, POINT_SHADOW_GLSL);
+    return shader;
+}
+
+/// @param type Shader stage
+/// @param source Source
+/// @return Shader ID
+inline GLuint pointShadowsCompileStage(GLenum type, const char* source) {
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char info[1024];
+        glGetShaderInfoLog(shader, sizeof(info), nullptr, info);
+        std::cout << "Point shadow shader error : " << info << std::endl;
+    }
+    return shader;
+}
+
+/// Allocates the cube array at shadows->size and forgets every face drawn into the old one
+/// @param shadows Shadows
+inline void pointShadowsAllocate(PointShadows* shadows) {
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadows->cubeArray);
+    glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT32F, shadows->size, shadows->size, shadows->lightCount * 6,
+                 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    for (PointShadowFace& face : shadows->faces) { face = PointShadowFace(); }
+}
+
+/// @param shadows Shadows
+/// @param lightCount Lights, one cube each
+/// @param size Texels per face edge
+/// @param faceBudget Faces refreshed per frame
+/// @param meshVBO Caster vertices, positions (3 floats) at the start of each vertex
+/// @param stride Bytes per vertex
+inline void pointShadowsInit(PointShadows* shadows, int lightCount, int size, int faceBudget, GLuint meshVBO, GLsizei stride) {
+    shadows->lightCount = lightCount;
+    shadows->size = size;
+    shadows->faceBudget = std::clamp(faceBudget, 1, POINT_SHADOW_MAX_FACES);
+    shadows->lights.assign(lightCount, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    shadows->faces.assign(static_cast<size_t>(lightCount) * 6, PointShadowFace());
+
+    glGenTextures(1, &shadows->cubeArray);
+    pointShadowsAllocate(shadows);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    // Layered : the whole array is attached, gl_Layer selects the face
+    glGenFramebuffers(1, &shadows->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->framebuffer);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadows->cubeArray, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Point shadow framebuffer incomplete" << std::endl;
+    }
+    glGenFramebuffers(1, &shadows->faceClearFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->faceClearFramebuffer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    const GLuint vertexShader = pointShadowsCompileStage(GL_VERTEX_SHADER, POINT_SHADOW_VERTEX_SHADER);
+    const GLuint geometryShader = pointShadowsCompileStage(GL_GEOMETRY_SHADER, POINT_SHADOW_GEOMETRY_SHADER.c_str());
+    const GLuint fragmentShader = pointShadowsCompileStage(GL_FRAGMENT_SHADER, POINT_SHADOW_FRAGMENT_SHADER);
+    shadows->program = glCreateProgram();
+    glAttachShader(shadows->program, vertexShader);
+    glAttachShader(shadows->program, geometryShader);
+    glAttachShader(shadows->program, fragmentShader);
+    glLinkProgram(shadows->program);
+    GLint success = 0;
+    glGetProgramiv(shadows->program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char info[1024];
+        glGetProgramInfoLog(shadows->program, sizeof(info), nullptr, info);
+        std::cout << "Point shadow program error : " << info << std::endl;
+    }
+    glDeleteShader(vertexShader);
+    glDeleteShader(geometryShader);
+    glDeleteShader(fragmentShader);
+    shadows->faceCountLocation = glGetUniformLocation(shadows->program, "faceCount");
+    shadows->faceLayerLocation = glGetUniformLocation(shadows->program, "faceLayer");
+    shadows->faceViewProjectionLocation = glGetUniformLocation(shadows->program, "faceViewProjection");
+    shadows->faceLightLocation = glGetUniformLocation(shadows->program, "faceLight");
+
+    // Same mesh, positions only, plus a model matrix per instance (locations 3-6)
+    glGenBuffers(1, &shadows->instanceBuffer);
+    glGenVertexArrays(1, &shadows->casterVAO);
+    glBindVertexArray(shadows->casterVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, shadows->instanceBuffer);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<void*>(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glBindVertexArray(0);
+}
+
+/// Changes the face size (a quality knob), every face is drawn again
+/// @param shadows Shadows
+/// @param size Texels per face edge
+inline void pointShadowsResize(PointShadows* shadows, int size) {
+    if (size == shadows->size) { return; }
+    shadows->size = size;
+    pointShadowsAllocate(shadows);
+}
+
+/// Moves a light. A new radius rescales what its cube stores, so its faces are drawn again.
+/// @param shadows Shadows
+/// @param index Light index
+/// @param position World position
+/// @param radius Reach of the light, the far plane of its faces
+inline void pointShadowsSetLight(PointShadows* shadows, int index, const glm::vec3& position, float radius) {
+    radius = std::max(radius, POINT_SHADOW_NEAR * 2.0f);
+    if (radius != shadows->lights[index].w) {
+        for (int f = 0; f < 6; f++) { shadows->faces[index * 6 + f].everRendered = false; }
+    }
+    shadows->lights[index] = glm::vec4(position, radius);
+}
+
+/// Picks up to faceBudget faces, most urgent first. Faces never drawn always win.
+///   urgency    = frames since drawn + POINT_SHADOW_MOTION_WEIGHT * distance the light moved since then
+///   importance = lights nearer the camera (relative to their reach) matter more
+/// @param shadows Shadows
+/// @param cameraPosition Camera position
+/// @param selected Receives layer-face indices
+/// @return Number of faces picked
+inline int pointShadowsSelectFaces(PointShadows* shadows, const glm::vec3& cameraPosition, int* selected) {
+    const int faceCount = static_cast<int>(shadows->faces.size());
+    std::vector<int> order(faceCount);
+    for (int i = 0; i < faceCount; i++) {
+        PointShadowFace& face = shadows->faces[i];
+        const glm::vec3 light = glm::vec3(shadows->lights[i / 6]);
+        const float radius = shadows->lights[i / 6].w;
+        if (!face.everRendered) {
+            face.priority = 1.0e30f;
+        } else {
+            const float urgency = static_cast<float>(face.framesStale) + POINT_SHADOW_MOTION_WEIGHT * glm::length(light - face.renderedFrom);
+            const float importance = 1.0f / (1.0f + glm::length(cameraPosition - light) / radius);
+            face.priority = urgency * importance;
+        }
+        order[i] = i;
+    }
+    const int budget = std::min(shadows->faceBudget, faceCount);
+    std::partial_sort(order.begin(), order.begin() + budget, order.end(), [shadows](int a, int b) {
+        return shadows->faces[a].priority > shadows->faces[b].priority;
+    });
+    std::copy(order.begin(), order.begin() + budget, selected);
+    return budget;
+}
+
+/// Redraws this frame's budgeted faces. Needs depth test and depth writes on (the faces are cleared with glClear).
+/// Leaves the shadow framebuffer, program and caster VAO bound and the viewport at the face size, the caller rebinds
+/// its own.
+/// @param shadows Shadows
+/// @param cameraPosition Camera position
+/// @param casterModels Model matrix of every shadow casting instance
+/// @param casterCount Number of instances
+/// @param vertexCount Vertices of the caster mesh
+inline void pointShadowsUpdate(PointShadows* shadows, const glm::vec3& cameraPosition, const glm::mat4* casterModels, int casterCount, GLsizei vertexCount) {
+    shadows->refreshedMask = 0;
+    if (!shadows->enabled) { return; }
+    for (PointShadowFace& face : shadows->faces) { face.framesStale++; }
+    int selected[POINT_SHADOW_MAX_FACES];
+    const int faceCount = pointShadowsSelectFaces(shadows, cameraPosition, selected);
+    if (faceCount == 0) { return; }
+
+    glViewport(0, 0, shadows->size, shadows->size);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->faceClearFramebuffer);
+    for (int i = 0; i < faceCount; i++) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadows->cubeArray, 0, selected[i]);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    static const glm::vec3 faceDirections[6] = {
+        { 1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f,-1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f,-1.0f}
+    };
+    static const glm::vec3 faceUps[6] = {
+        {0.0f,-1.0f, 0.0f}, {0.0f,-1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f,-1.0f}, {0.0f,-1.0f, 0.0f}, {0.0f,-1.0f, 0.0f}
+    };
+    glm::mat4 faceMatrices[POINT_SHADOW_MAX_FACES];
+    glm::vec4 faceLights[POINT_SHADOW_MAX_FACES];
+    for (int i = 0; i < faceCount; i++) {
+        const glm::vec4& light = shadows->lights[selected[i] / 6];
+        const int face = selected[i] % 6;
+        const glm::vec3 position = glm::vec3(light);
+        faceMatrices[i] = glm::perspective(glm::radians(90.0f), 1.0f, POINT_SHADOW_NEAR, light.w) *
+                          glm::lookAt(position, position + faceDirections[face], faceUps[face]);
+        faceLights[i] = light;
+
+        PointShadowFace& state = shadows->faces[selected[i]];
+        state.framesStale = 0;
+        state.renderedFrom = position;
+        state.everRendered = true;
+        if (selected[i] < POINT_SHADOW_MASK_FACES) { shadows->refreshedMask |= uint64_t(1) << selected[i]; }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, shadows->instanceBuffer);
+    const size_t bytes = static_cast<size_t>(casterCount) * sizeof(glm::mat4);
+    if (bytes > shadows->instanceCapacity) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), casterModels, GL_DYNAMIC_DRAW);
+        shadows->instanceCapacity = bytes;
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), casterModels);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->framebuffer);
+    glUseProgram(shadows->program);
+    glUniform1i(shadows->faceCountLocation, faceCount);
+    glUniform1iv(shadows->faceLayerLocation, faceCount, selected);
+    glUniformMatrix4fv(shadows->faceViewProjectionLocation, faceCount, GL_FALSE, glm::value_ptr(faceMatrices[0]));
+    glUniform4fv(shadows->faceLightLocation, faceCount, glm::value_ptr(faceLights[0]));
+    glBindVertexArray(shadows->casterVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, casterCount);
+    shadows->facesRendered += faceCount;
+}
+
+/// Frames since the least recently drawn face was drawn
+/// @param shadows Shadows
+/// @return Frames
+inline int pointShadowsOldestFace(const PointShadows* shadows) {
+    int oldest = 0;
+    for (const PointShadowFace& face : shadows->faces) { oldest = std::max(oldest, face.framesStale); }
+    return oldest;
+}
+
+/// @param shadows Shadows
+inline void pointShadowsShutdown(PointShadows* shadows) {
+    glDeleteFramebuffers(1, &shadows->framebuffer);
+    glDeleteFramebuffers(1, &shadows->faceClearFramebuffer);
+    glDeleteTextures(1, &shadows->cubeArray);
+    glDeleteBuffers(1, &shadows->instanceBuffer);
+    glDeleteVertexArrays(1, &shadows->casterVAO);
+    glDeleteProgram(shadows->program);
+    *shadows = PointShadows();
+}
@@ -0,0 +1,1359 @@
+// Render graph : the LightWithAttenuation scene with a bloom post chain, where every pass only declares what it reads
+// and writes. The graph orders the passes, drops passes whose results nobody consumes, and lets transient render
+// targets share one GL texture when their lifetimes do not overlap.
+// Passes are deliberately registered out of order below, the graph still runs the skybox after the opaque geometry.
+//
+// B toggles bloom, Z toggles the depth view (both simply change what the composite pass reads)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <glm/detail/setup.hpp>
+#include <glm/glm.hpp>
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include "glm/gtc/matrix_transform.hpp"
+#include <glm/gtc/type_ptr.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+using namespace std;
+using namespace glm;
+
+/// Shader helpers : ---- (start)
+int success;
+char infoLog[512];
+
+/// This function will create shaders
+/// @param type Shader type
+/// @param source shader source
+/// @return shader ID
+GLuint compileShader(GLenum type, const GLchar* source) {
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        cout << "Error compiling shader: " << infoLog << endl;
+        return 0;
+    }
+    return shader;
+}
+/// This function will create shader program
+/// @param vertexSource vertex shader source
+/// @param fragmentSource fragment shader source
+/// @return program ID
+GLuint createProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint program = glCreateProgram();
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        cout << "Error linking program: " << infoLog << endl;
+    }
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return  program;
+}
+/// Shader helpers : ---- (end)
+
+/// Camera Structure consisting imp camera properties
+struct Camera {
+    vec3 Position;
+    vec3 Front;
+    vec3 Up;
+    vec3 Right;
+    vec3 WorldUp;
+    float Yaw;
+    float Pitch;
+    float MovementSpeed;
+    float MouseSensitivity;
+    float Zoom;
+};
+
+/// Directions camera will move in
+enum Direction {
+    forwardDir,
+    backwardDir,
+    leftDir,
+    rightDir
+};
+
+/// This function will updates camera vectors
+/// @param camera Camera object.
+void cameraUpdateVectors(Camera* camera) {
+    vec3 front;
+    front.x = cos(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    front.y = sin(radians(camera->Pitch));
+    front.z = sin(radians(camera->Yaw)) * cos(radians(camera->Pitch));
+    camera->Front = normalize(front);
+    camera->Right = normalize(cross(camera->Front, camera->WorldUp));
+    camera->Up = normalize(cross(camera->Right, camera->Front));
+}
+
+/// This function will initiate camera
+void cameraInit(Camera* camera, glm::vec3 position, glm::vec3 up, float yaw, float pitch, float movementSpeed, float mouseSensitivity, float zoom) {
+    camera->Position = position;
+    camera->WorldUp = up;
+    camera->Yaw = yaw;
+    camera->Pitch = pitch;
+    camera->MovementSpeed = movementSpeed;
+    camera->MouseSensitivity = mouseSensitivity;
+    camera->Zoom = zoom;
+    cameraUpdateVectors(camera);
+}
+
+/// Returns view matrix according to current camera vectors
+mat4 getCameraViewMatrix(Camera* camera) {
+    return lookAt(camera->Position, camera->Position + camera->Front, camera->Up);
+}
+
+/// Function to process camera inputs
+void cameraProcessKeyboard(Camera* camera, Direction direction, float deltaTime) {
+    float Speed = camera->MovementSpeed * deltaTime;
+    if (direction == forwardDir) {
+        camera->Position += camera->Front * Speed;
+    }
+    else if (direction == backwardDir) {
+        camera->Position -= camera->Front * Speed;
+    }
+    else if (direction == leftDir) {
+        camera->Position -= camera->Right * Speed;
+    }
+    else if (direction == rightDir) {
+        camera->Position += camera->Right * Speed;
+    }
+}
+
+/// Function to process mouse movement
+void cameraProcessMouseMovement(Camera* camera, float xoffset, float yoffset) {
+    xoffset *= camera->MouseSensitivity;
+    yoffset *= camera->MouseSensitivity;
+    camera->Yaw += xoffset;
+    camera->Pitch += yoffset;
+    camera->Pitch = glm::clamp(camera->Pitch, -89.f, 89.f);
+    cameraUpdateVectors(camera);
+}
+
+/// Function to process scroll movements
+void cameraProcessMouseScroll(Camera* camera, float Zoom) {
+    camera->Zoom -= Zoom;
+    if (camera->Zoom <= 1.0f) {camera->Zoom = 1.0f;}
+    else if (camera->Zoom >= 45.0f) {camera->Zoom = 45.0f;}
+}
+
+
+/// Render graph ---------- (start)
+// How a pass touches the depth attachment :
+// DepthWrite clears then writes, DepthModify keeps previous content and writes, DepthRead only tests against it
+enum DepthAccess { DepthNone, DepthWrite, DepthModify, DepthRead };
+
+/// What a pass declares. Names refer to resources created on the graph.
+struct PassDesc {
+    std::vector<std::string> sampled;        // textures read in shaders
+    std::vector<std::string> colorWrites;    // color attachments, cleared before the pass
+    std::vector<std::string> colorModifies;  // color attachments, drawn on top of previous content
+    std::string depth;                       // depth attachment, used as described by depthAccess
+    DepthAccess depthAccess = DepthNone;
+};
+
+struct GraphResource {
+    std::string name;
+    int width = 0, height = 0;
+    GLenum internalFormat = GL_RGBA8;
+    bool imported = false;       // lives outside the graph (the default framebuffer)
+    bool output = false;         // what the frame is for, keeps its producers alive
+    int firstUse = -1, lastUse = -1; // positions in the execution order
+    int physical = -1;           // index into the physical texture pool
+};
+
+struct GraphPass {
+    std::string name;
+    PassDesc desc;
+    std::function<void()> execute;
+    std::vector<int> sampled, colorWrites, colorModifies;
+    int depth = -1;
+    bool culled = false;
+    GLuint framebuffer = 0;
+    int width = 0, height = 0;
+};
+
+/// A GL texture handed to transient resources, reused by any resource with the same size and format
+struct PhysicalTexture {
+    GLuint texture = 0;
+    int width = 0, height = 0;
+    GLenum internalFormat = GL_RGBA8;
+    bool inUse = false;          // taken during the current compile
+};
+
+bool isDepthFormat(GLenum format) {
+    return format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F || format == GL_DEPTH24_STENCIL8;
+}
+
+// Pixel format and type glTexImage2D needs for an internal format, the packed depth-stencil one differs from the rest
+void uploadFormat(GLenum internalFormat, GLenum* format, GLenum* type) {
+    if (internalFormat == GL_DEPTH24_STENCIL8) {
+        *format = GL_DEPTH_STENCIL;
+        *type = GL_UNSIGNED_INT_24_8;
+    } else {
+        *format = isDepthFormat(internalFormat) ? GL_DEPTH_COMPONENT : GL_RGBA;
+        *type = GL_FLOAT;
+    }
+}
+
+size_t bytesPerPixel(GLenum format) {
+    switch (format) {
+        case GL_RGBA16F: return 8;
+        case GL_R8: return 1;
+        default: return 4;
+    }
+}
+
+class RenderGraph {
+public:
+    /// Transient render target, allocated by the graph for the lifetime of its users only
+    void createTexture(const std::string& name, int width, int height, GLenum internalFormat) {
+        GraphResource resource;
+        resource.name = name;
+        resource.width = width;
+        resource.height = height;
+        resource.internalFormat = internalFormat;
+        resources.push_back(resource);
+    }
+
+    /// The default framebuffer, always an output
+    void importBackbuffer(const std::string& name, int width, int height) {
+        GraphResource resource;
+        resource.name = name;
+        resource.width = width;
+        resource.height = height;
+        resource.imported = true;
+        resource.output = true;
+        resources.push_back(resource);
+    }
+
+    void addPass(const std::string& name, const PassDesc& desc, std::function<void()> execute) {
+        GraphPass pass;
+        pass.name = name;
+        pass.desc = desc;
+        pass.execute = std::move(execute);
+        passes.push_back(pass);
+    }
+
+    /// Forgets passes and resources, keeps the physical texture pool for the next compile
+    void reset() {
+        releaseFramebuffers();
+        passes.clear();
+        resources.clear();
+        order.clear();
+    }
+
+    /// Resolves names, culls, orders passes, assigns physical textures and builds one FBO per pass.
+    bool compile() {
+        if (!resolveNames()) return false;
+        cullPasses();
+        if (!sortPasses()) return false;
+        computeLifetimes();
+        assignPhysicalTextures();
+        buildFramebuffers();
+        printSummary();
+        return true;
+    }
+
+    void execute() {
+        for (int p : order) {
+            GraphPass& pass = passes[p];
+            glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+            glViewport(0, 0, pass.width, pass.height);
+
+            // Only attachments the pass declared as written start cleared, modified ones keep their content
+            for (size_t i = 0; i < pass.colorWrites.size(); i++) {
+                const GLfloat clearColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+                glClearBufferfv(GL_COLOR, static_cast<GLint>(i), clearColor);
+            }
+            if (pass.desc.depthAccess == DepthWrite) {
+                const GLfloat one = 1.0f;
+                glDepthMask(GL_TRUE);
+                glClearBufferfv(GL_DEPTH, 0, &one);
+            }
+            pass.execute();
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    /// GL texture behind a resource, valid inside pass callbacks
+    GLuint getTexture(const std::string& name) const {
+        const int id = findResource(name);
+        if (id < 0 || resources[id].physical < 0) return 0;
+        return pool[resources[id].physical].texture;
+    }
+
+    void destroy() {
+        reset();
+        for (auto& physical : pool) glDeleteTextures(1, &physical.texture);
+        pool.clear();
+    }
+
+private:
+    std::vector<GraphResource> resources;
+    std::vector<GraphPass> passes;
+    std::vector<int> order;
+    std::vector<PhysicalTexture> pool;
+
+    int findResource(const std::string& name) const {
+        for (size_t i = 0; i < resources.size(); i++) {
+            if (resources[i].name == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    bool resolveNames() {
+        bool ok = true;
+        auto resolveList = [&](const GraphPass& pass, const std::vector<std::string>& names, std::vector<int>& ids) {
+            ids.clear();
+            for (const auto& name : names) {
+                const int id = findResource(name);
+                if (id < 0) {
+                    cout << "Render graph : pass " << pass.name << " uses unknown resource " << name << endl;
+                    ok = false;
+                    continue;
+                }
+                ids.push_back(id);
+            }
+        };
+        for (auto& pass : passes) {
+            resolveList(pass, pass.desc.sampled, pass.sampled);
+            resolveList(pass, pass.desc.colorWrites, pass.colorWrites);
+            resolveList(pass, pass.desc.colorModifies, pass.colorModifies);
+            pass.depth = -1;
+            if (pass.desc.depthAccess != DepthNone) {
+                pass.depth = findResource(pass.desc.depth);
+                if (pass.depth < 0) {
+                    cout << "Render graph : pass " << pass.name << " uses unknown depth " << pass.desc.depth << endl;
+                    ok = false;
+                }
+            }
+        }
+        return ok;
+    }
+
+    // Everything a pass consumes : sampled textures, modified attachments and a tested depth buffer
+    static std::vector<int> consumedBy(const GraphPass& pass) {
+        std::vector<int> consumed = pass.sampled;
+        consumed.insert(consumed.end(), pass.colorModifies.begin(), pass.colorModifies.end());
+        if (pass.depth >= 0 && pass.desc.depthAccess != DepthWrite) consumed.push_back(pass.depth);
+        return consumed;
+    }
+
+    // Everything a pass produces : written or modified attachments (a read-only depth test produces nothing)
+    static std::vector<int> producedBy(const GraphPass& pass) {
+        std::vector<int> produced = pass.colorWrites;
+        produced.insert(produced.end(), pass.colorModifies.begin(), pass.colorModifies.end());
+        if (pass.depth >= 0 && (pass.desc.depthAccess == DepthWrite || pass.desc.depthAccess == DepthModify)) produced.push_back(pass.depth);
+        return produced;
+    }
+
+    // A pass survives only if something it produces is needed, starting from the outputs and walking back
+    void cullPasses() {
+        std::vector<bool> needed(resources.size(), false);
+        for (size_t r = 0; r < resources.size(); r++) needed[r] = resources[r].output;
+        for (auto& pass : passes) pass.culled = true;
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto& pass : passes) {
+                if (!pass.culled) continue;
+                for (int r : producedBy(pass)) {
+                    if (!needed[r]) continue;
+                    pass.culled = false;
+                    changed = true;
+                    for (int c : consumedBy(pass)) needed[c] = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Dependencies per resource : writers -> modifiers -> readers.
+    // Modifiers of the same resource keep registration order unless another resource orders them.
+    bool sortPasses() {
+        const size_t count = passes.size();
+        std::vector<std::vector<bool>> dependsOn(count, std::vector<bool>(count, false));
+
+        auto isWriter = [&](const GraphPass& pass, int r) {
+            for (int w : pass.colorWrites) if (w == r) return true;
+            return pass.depth == r && pass.desc.depthAccess == DepthWrite;
+        };
+        auto isModifier = [&](const GraphPass& pass, int r) {
+            for (int m : pass.colorModifies) if (m == r) return true;
+            return pass.depth == r && pass.desc.depthAccess == DepthModify;
+        };
+        auto isReader = [&](const GraphPass& pass, int r) {
+            for (int s : pass.sampled) if (s == r) return true;
+            return pass.depth == r && pass.desc.depthAccess == DepthRead;
+        };
+
+        for (size_t r = 0; r < resources.size(); r++) {
+            const int id = static_cast<int>(r);
+            for (size_t a = 0; a < count; a++) {
+                if (passes[a].culled) continue;
+                for (size_t b = 0; b < count; b++) {
+                    if (a == b || passes[b].culled) continue;
+                    const bool aWrites = isWriter(passes[a], id);
+                    const bool aModifies = isModifier(passes[a], id);
+                    if (aWrites && (isModifier(passes[b], id) || isReader(passes[b], id))) dependsOn[b][a] = true;
+                    if (aModifies && isReader(passes[b], id) && !isWriter(passes[b], id) && !isModifier(passes[b], id)) dependsOn[b][a] = true;
+                }
+            }
+        }
+
+        // Kahn's algorithm, always taking the earliest registered ready pass so the result is stable
+        std::vector<bool> placed(count, false);
+        order.clear();
+        size_t alive = 0;
+        for (const auto& pass : passes) alive += pass.culled ? 0 : 1;
+        while (order.size() < alive) {
+            int next = -1;
+            for (size_t p = 0; p < count && next < 0; p++) {
+                if (passes[p].culled || placed[p]) continue;
+                bool ready = true;
+                for (size_t d = 0; d < count && ready; d++) {
+                    if (dependsOn[p][d] && !placed[d]) ready = false;
+                }
+                if (ready) next = static_cast<int>(p);
+            }
+            if (next < 0) {
+                cout << "Render graph : dependency cycle, cannot order passes" << endl;
+                return false;
+            }
+            placed[next] = true;
+            order.push_back(next);
+        }
+        return true;
+    }
+
+    void computeLifetimes() {
+        for (auto& resource : resources) resource.firstUse = resource.lastUse = -1;
+        for (size_t i = 0; i < order.size(); i++) {
+            const GraphPass& pass = passes[order[i]];
+            std::vector<int> touched = consumedBy(pass);
+            for (int r : producedBy(pass)) touched.push_back(r);
+            for (int r : touched) {
+                if (resources[r].firstUse < 0) resources[r].firstUse = static_cast<int>(i);
+                resources[r].lastUse = static_cast<int>(i);
+            }
+        }
+    }
+
+    // Walks the execution order : a resource takes a free texture of its size and format at its first use
+    // and gives it back after its last use, so non-overlapping lifetimes share memory.
+    void assignPhysicalTextures() {
+        for (auto& physical : pool) physical.inUse = false;
+        std::vector<bool> busy(pool.size(), false);
+
+        for (size_t i = 0; i < order.size(); i++) {
+            for (auto& resource : resources) {
+                if (resource.imported || resource.firstUse != static_cast<int>(i)) continue;
+                resource.physical = -1;
+                for (size_t t = 0; t < pool.size(); t++) {
+                    const PhysicalTexture& physical = pool[t];
+                    if (busy[t] || physical.width != resource.width || physical.height != resource.height || physical.internalFormat != resource.internalFormat) continue;
+                    resource.physical = static_cast<int>(t);
+                    break;
+                }
+                if (resource.physical < 0) {
+                    PhysicalTexture physical;
+                    physical.width = resource.width;
+                    physical.height = resource.height;
+                    physical.internalFormat = resource.internalFormat;
+                    pool.push_back(physical);
+                    busy.push_back(false);
+                    resource.physical = static_cast<int>(pool.size() - 1);
+                }
+                busy[resource.physical] = true;
+                pool[resource.physical].inUse = true;
+            }
+            for (auto& resource : resources) {
+                if (!resource.imported && resource.lastUse == static_cast<int>(i)) busy[resource.physical] = false;
+            }
+        }
+
+        // Drop textures nothing uses any more (old sizes after a resize), remap the survivors
+        std::vector<int> remap(pool.size(), -1);
+        std::vector<PhysicalTexture> kept;
+        for (size_t t = 0; t < pool.size(); t++) {
+            if (!pool[t].inUse) {
+                glDeleteTextures(1, &pool[t].texture);
+                continue;
+            }
+            remap[t] = static_cast<int>(kept.size());
+            kept.push_back(pool[t]);
+        }
+        pool = kept;
+        for (auto& resource : resources) {
+            if (resource.physical >= 0) resource.physical = remap[resource.physical];
+        }
+
+        for (auto& physical : pool) {
+            if (physical.texture != 0) continue;
+            const bool depth = isDepthFormat(physical.internalFormat);
+            GLenum format, type;
+            uploadFormat(physical.internalFormat, &format, &type);
+            glGenTextures(1, &physical.texture);
+            glBindTexture(GL_TEXTURE_2D, physical.texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, physical.internalFormat, physical.width, physical.height, 0, format, type, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void releaseFramebuffers() {
+        for (auto& pass : passes) {
+            if (pass.framebuffer != 0) glDeleteFramebuffers(1, &pass.framebuffer);
+            pass.framebuffer = 0;
+        }
+    }
+
+    void buildFramebuffers() {
+        releaseFramebuffers();
+        for (int p : order) {
+            GraphPass& pass = passes[p];
+            std::vector<int> colors = pass.colorWrites;
+            colors.insert(colors.end(), pass.colorModifies.begin(), pass.colorModifies.end());
+            const int sizeFrom = !colors.empty() ? colors[0] : pass.depth;
+            if (sizeFrom >= 0) {
+                pass.width = resources[sizeFrom].width;
+                pass.height = resources[sizeFrom].height;
+            }
+
+            // The imported backbuffer is framebuffer 0 and cannot be combined with graph textures
+            if (!colors.empty() && resources[colors[0]].imported) {
+                pass.framebuffer = 0;
+                continue;
+            }
+
+            glGenFramebuffers(1, &pass.framebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+            std::vector<GLenum> drawBuffers;
+            for (size_t i = 0; i < colors.size(); i++) {
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i), GL_TEXTURE_2D, pool[resources[colors[i]].physical].texture, 0);
+                drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+            }
+            if (pass.depth >= 0) {
+                const PhysicalTexture& depth = pool[resources[pass.depth].physical];
+                const GLenum attachment = depth.internalFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+                glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, depth.texture, 0);
+            }
+            if (drawBuffers.empty()) {
+                glDrawBuffer(GL_NONE);
+            } else {
+                glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+            }
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                cout << "Render graph : framebuffer for pass " << pass.name << " incomplete" << endl;
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void printSummary() const {
+        cout << "Render graph :";
+        for (size_t i = 0; i < order.size(); i++) cout << (i ? " -> " : " ") << passes[order[i]].name;
+        cout << endl;
+        for (const auto& pass : passes) {
+            if (pass.culled) cout << "  culled " << pass.name << " (no output reads it)" << endl;
+        }
+
+        size_t requested = 0, allocated = 0;
+        int transient = 0;
+        for (const auto& resource : resources) {
+            if (resource.imported || resource.physical < 0) continue;
+            requested += static_cast<size_t>(resource.width) * resource.height * bytesPerPixel(resource.internalFormat);
+            transient++;
+        }
+        for (const auto& physical : pool) {
+            allocated += static_cast<size_t>(physical.width) * physical.height * bytesPerPixel(physical.internalFormat);
+        }
+        cout << "  " << transient << " transient targets in " << pool.size() << " textures, "
+             << allocated / (1024 * 1024) << " MB instead of " << requested / (1024 * 1024) << " MB" << endl;
+    }
+};
+/// Render graph ---------- (end)
+
+
+/// Shader to render objects in environment with attenuation ---- (start)
+const char* cubeObjectVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+const char* cubeObjectFragmentShader = R"(
+#version 410 core
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct Light {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform Light light;
+
+void main()
+{
+    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(light.position - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), material.shininess);
+    vec3 specularMap = vec3(texture(material.specular, TexCoords));
+    vec3 specular = light.specular * spec * specularMap;
+
+    float distance = length(light.position - FragPos);
+    float attenuation = 1.0 / (
+        light.constant + (light.linear * distance) + (light.quadratic * distance * distance)
+    );
+
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+
+    vec3 result = ambient + diffuse + specular;
+    FragColor = vec4(result, 1.0);
+}
+)";
+/// Shader to render objects in environment with attenuation ---- (end)
+
+/// Shader to render a cube map -------- (start)
+const char* cubeMapVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+out vec3 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    TexCoord = aPos;
+    mat4 rotView = mat4(mat3(view));
+    vec4 pos = projection * rotView * vec4(aPos, 1.0);
+    gl_Position = pos.xyww;
+}
+)";
+
+const char* cubeMapFragmentShader = R"(
+#version 410 core
+in vec3 TexCoord;
+out vec4 FragColor;
+uniform samplerCube skybox;
+
+void main()
+{
+    FragColor = texture(skybox, TexCoord);
+}
+)";
+/// Shader to render a cube map -------- (end)
+
+/// Shader to render a light cube ------ (start)
+const char* lightCubeVertexShader = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)";
+
+const char* lightCubeFragmentShader = R"(
+#version 410 core
+out vec4 FragColor;
+uniform vec3 lightColor;
+void main()
+{
+    FragColor = vec4(lightColor, 1.0);
+}
+)";
+/// Shader to render a light cube ------ (end)
+
+/// Full screen post passes ------ (start)
+// One triangle covering the screen, no vertex buffer needed
+const char* fullScreenVertexShader = R"(
+#version 410 core
+out vec2 uv;
+void main()
+{
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+const char* brightPassFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D sceneColor;
+uniform float threshold;
+void main()
+{
+    vec3 color = texture(sceneColor, uv).rgb;
+    float brightness = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    FragColor = vec4(color * max(brightness - threshold, 0.0) / max(brightness, 0.0001), 1.0);
+}
+)";
+
+// 9 tap gaussian folded into 5 bilinear fetches
+const char* blurFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D source;
+uniform vec2 direction;
+void main()
+{
+    vec2 texel = direction / vec2(textureSize(source, 0));
+    vec3 sum = texture(source, uv).rgb * 0.2270270270;
+    sum += texture(source, uv + texel * 1.3846153846).rgb * 0.3162162162;
+    sum += texture(source, uv - texel * 1.3846153846).rgb * 0.3162162162;
+    sum += texture(source, uv + texel * 3.2307692308).rgb * 0.0702702703;
+    sum += texture(source, uv - texel * 3.2307692308).rgb * 0.0702702703;
+    FragColor = vec4(sum, 1.0);
+}
+)";
+
+const char* depthViewFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D sceneDepth;
+uniform float nearPlane;
+uniform float farPlane;
+void main()
+{
+    float z = texture(sceneDepth, uv).r * 2.0 - 1.0;
+    float linear = (2.0 * nearPlane * farPlane) / (farPlane + nearPlane - z * (farPlane - nearPlane));
+    FragColor = vec4(vec3(1.0 - clamp(linear / 30.0, 0.0, 1.0)), 1.0);
+}
+)";
+
+const char* compositeFragmentShader = R"(
+#version 410 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D sceneColor;
+uniform sampler2D bloom;
+uniform sampler2D depthView;
+uniform int useBloom;
+uniform int useDepthView;
+void main()
+{
+    vec3 color = texture(sceneColor, uv).rgb;
+    if (useBloom == 1) color += texture(bloom, uv).rgb * 0.6;
+    color = color / (color + vec3(1.0));
+    // Depth view in the bottom-left quarter
+    if (useDepthView == 1 && uv.x < 0.25 && uv.y < 0.25) color = texture(depthView, uv * 4.0).rgb;
+    FragColor = vec4(color, 1.0);
+}
+)";
+/// Full screen post passes ------ (end)
+
+/// Texture helpers ---------- (start)
+GLuint loadTexture(const char* path) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    int width, height, channels;
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if (data) {
+        GLenum format = GL_RGBA;
+        if (channels == 1) { format = GL_RED; }
+        else if (channels == 3) { format = GL_RGB; }
+        else if (channels == 4) { format = GL_RGBA; }
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    } else {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+
+    stbi_image_free(data);
+    return texture;
+}
+
+GLuint loadCubeMap(std::vector<std::string> faces)
+{
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texID);
+
+    int w, h, ch;
+    for (unsigned int i = 0; i < faces.size(); i++) {
+        unsigned char* data = stbi_load(faces[i].c_str(), &w, &h, &ch, 0);
+        if (!data) {
+            std::cout << "Failed to load cubemap: " << faces[i] << std::endl;
+            continue;
+        }
+        GLenum format = (ch == 4) ? GL_RGBA : GL_RGB;
+
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+                     0, format, w, h, 0, format, GL_UNSIGNED_BYTE, data);
+        stbi_image_free(data);
+    }
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return texID;
+}
+/// Texture helpers ---------- (end)
+
+
+/// App Global --- (start)
+int SCR_WIDTH;
+int SCR_HEIGHT;
+
+Camera camera;
+float lastX;
+float lastY;
+bool firstMouse = true;
+
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+bool bloomEnabled = true;
+bool depthViewEnabled = false;
+// Set by callbacks, the graph is rebuilt at the start of the next frame
+bool graphDirty = true;
+/// App Global --- (end)
+
+/// Callbacks ---- (start)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, GLdouble xPos, GLdouble yPos);
+void scroll_callback(GLFWwindow* window, GLdouble xOffset, GLdouble yOffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void ProcessInput(GLFWwindow* window);
+/// Callbacks ---- (end)
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Render graph", monitor, nullptr);
+    glfwMakeContextCurrent(window);
+
+    lastX = mode->width / 2.0f;
+    lastY = mode->height / 2.0f;
+
+    camera = Camera();
+    cameraInit(&camera, vec3(0.0f, 0.0f, 3.0f), vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f, 2.0f, 0.2f, 45.0f);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialise GLAD" << std::endl;
+        return -1;
+    }
+
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+
+    // Callbacks
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    GLuint cubeObjectProgram = createProgram(cubeObjectVertexShader, cubeObjectFragmentShader);
+    GLuint lightCubeProgram = createProgram(lightCubeVertexShader, lightCubeFragmentShader);
+    GLuint ShaderProgramSky = createProgram(cubeMapVertexShader, cubeMapFragmentShader);
+    GLuint brightProgram = createProgram(fullScreenVertexShader, brightPassFragmentShader);
+    GLuint blurProgram = createProgram(fullScreenVertexShader, blurFragmentShader);
+    GLuint depthViewProgram = createProgram(fullScreenVertexShader, depthViewFragmentShader);
+    GLuint compositeProgram = createProgram(fullScreenVertexShader, compositeFragmentShader);
+
+    // cube vertex data
+    float vertices[] = {
+        // positions          // normals           // tex coords
+        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+         0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,0.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     1.0f,1.0f,
+        -0.5f, 0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,   0.0f,0.0f,-1.0f,     0.0f,0.0f,
+
+        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      1.0f,1.0f,
+        -0.5f, 0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,1.0f,
+        -0.5f,-0.5f, 0.5f,   0.0f,0.0f,1.0f,      0.0f,0.0f,
+
+        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+        -0.5f, 0.5f,-0.5f,  -1.0f,0.0f,0.0f,      1.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+        -0.5f,-0.5f,-0.5f,  -1.0f,0.0f,0.0f,      0.0f,1.0f,
+        -0.5f,-0.5f, 0.5f,  -1.0f,0.0f,0.0f,      0.0f,0.0f,
+        -0.5f, 0.5f, 0.5f,  -1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+         0.5f, 0.5f,-0.5f,   1.0f,0.0f,0.0f,      1.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   1.0f,0.0f,0.0f,      0.0f,1.0f,
+         0.5f,-0.5f, 0.5f,   1.0f,0.0f,0.0f,      0.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   1.0f,0.0f,0.0f,      1.0f,0.0f,
+
+        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+         0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     1.0f,1.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+         0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     1.0f,0.0f,
+        -0.5f,-0.5f, 0.5f,   0.0f,-1.0f,0.0f,     0.0f,0.0f,
+        -0.5f,-0.5f,-0.5f,   0.0f,-1.0f,0.0f,     0.0f,1.0f,
+
+        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f,
+         0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      1.0f,1.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+         0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      1.0f,0.0f,
+        -0.5f, 0.5f, 0.5f,   0.0f,1.0f,0.0f,      0.0f,0.0f,
+        -0.5f, 0.5f,-0.5f,   0.0f,1.0f,0.0f,      0.0f,1.0f
+    };
+
+    float skyboxVertices[] = {
+        -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1, -1,
+        -1, -1,  1, -1, -1, -1, -1,  1, -1, -1,  1, -1, -1,  1,  1, -1, -1,  1,
+         1, -1, -1,  1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1, -1,  1, -1, -1,
+        -1, -1,  1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1, -1,  1, -1, -1,  1,
+        -1,  1, -1,  1,  1, -1,  1,  1,  1,  1,  1,  1, -1,  1,  1, -1,  1, -1,
+        -1, -1, -1, -1, -1,  1,  1, -1, -1,  1, -1, -1, -1, -1,  1,  1, -1,  1
+    };
+
+    glm::vec3 cubePositions[20] = {
+        glm::vec3( 0.0f,  0.0f,   0.0f),
+        glm::vec3( 2.0f,  5.0f,  -6.0f),
+        glm::vec3(-1.5f, -2.2f,  -1.0f),
+        glm::vec3(-3.8f, -2.0f,  -5.0f),
+        glm::vec3( 2.4f, -0.4f,  -1.5f),
+        glm::vec3(-1.7f,  3.0f,  -3.0f),
+        glm::vec3( 1.3f, -2.0f,  -1.0f),
+        glm::vec3( 1.5f,  2.0f,  -1.0f),
+        glm::vec3( 1.5f,  0.2f,  -0.6f),
+        glm::vec3(-1.3f,  1.0f,  -0.6f),
+
+        glm::vec3( 4.0f,  3.0f,  -8.0f),
+        glm::vec3(-4.0f, -3.0f,  -7.0f),
+        glm::vec3( 6.0f,  1.0f, -10.0f),
+        glm::vec3(-6.0f,  2.0f,  -9.0f),
+        glm::vec3( 0.0f,  6.0f, -12.0f),
+        glm::vec3( 3.0f, -4.0f, -11.0f),
+        glm::vec3(-3.0f,  4.0f, -10.5f),
+        glm::vec3( 5.5f, -1.0f, -9.5f),
+        glm::vec3(-5.5f,  2.5f, -10.8f),
+        glm::vec3( 0.0f, -5.0f, -14.0f)
+    };
+
+    GLuint VBO, cubeVAO, lightCubeVAO, emptyVAO;
+    glGenVertexArrays(1, &cubeVAO);
+    glBindVertexArray(cubeVAO);
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glGenVertexArrays(1, &lightCubeVAO);
+    glBindVertexArray(lightCubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void *>(0));
+    glEnableVertexAttribArray(0);
+
+    // Full screen passes generate their triangle from gl_VertexID
+    glGenVertexArrays(1, &emptyVAO);
+
+    // Skybox VAO
+    GLuint skyVAO, skyVBO;
+    glGenVertexArrays(1, &skyVAO);
+    glGenBuffers(1, &skyVBO);
+
+    glBindVertexArray(skyVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), nullptr);
+    glBindVertexArray(0);
+
+    std::vector<std::string> faces = {
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/right.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/left.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/top.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/bottom.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/front.jpg",
+        "/Users/udayshinde/Desktop/OpenGLWindow/Assets/back.jpg"
+        };
+    GLuint cubeMapTex = loadCubeMap(faces);
+
+    stbi_set_flip_vertically_on_load(true);
+    GLuint diffuseMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2-2.png");
+    GLuint specularMap = loadTexture("/Users/udayshinde/Desktop/OpenGLWindow/Assets/container2_specular-2.png");
+
+    // Constant uniforms, set once
+    glUseProgram(cubeObjectProgram);
+    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.diffuse"), 0);
+    glUniform1i(glGetUniformLocation(cubeObjectProgram, "material.specular"), 1);
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.ambient"), 1, value_ptr(vec3(0.2f)));
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.diffuse"), 1, value_ptr(vec3(1.0f)));
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.specular"), 1, value_ptr(vec3(2.0f)));
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "light.constant"), 1.0f);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "light.linear"), 0.045f);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "light.quadratic"), 0.0075f);
+    glUniform1f(glGetUniformLocation(cubeObjectProgram, "material.shininess"), 512.0f);
+    glUniform3fv(glGetUniformLocation(cubeObjectProgram, "light.position"), 1, value_ptr(lightPos));
+    GLint ViewPosition = glGetUniformLocation(cubeObjectProgram, "viewPos");
+    GLint LightShaderProjection = glGetUniformLocation(cubeObjectProgram, "projection");
+    GLint LightShaderView = glGetUniformLocation(cubeObjectProgram, "view");
+    GLint LightShaderModel = glGetUniformLocation(cubeObjectProgram, "model");
+
+    GLint LightCubeProjection = glGetUniformLocation(lightCubeProgram, "projection");
+    GLint LightCubeView = glGetUniformLocation(lightCubeProgram, "view");
+    GLint LightCubeModel = glGetUniformLocation(lightCubeProgram, "model");
+    GLint LightCubeColor = glGetUniformLocation(lightCubeProgram, "lightColor");
+
+    glUseProgram(ShaderProgramSky);
+    glUniform1i(glGetUniformLocation(ShaderProgramSky, "skybox"), 0);
+    GLint SkyView = glGetUniformLocation(ShaderProgramSky, "view");
+    GLint SkyProjection = glGetUniformLocation(ShaderProgramSky, "projection");
+
+    glUseProgram(brightProgram);
+    glUniform1i(glGetUniformLocation(brightProgram, "sceneColor"), 0);
+    glUniform1f(glGetUniformLocation(brightProgram, "threshold"), 0.9f);
+    glUseProgram(blurProgram);
+    glUniform1i(glGetUniformLocation(blurProgram, "source"), 0);
+    GLint BlurDirection = glGetUniformLocation(blurProgram, "direction");
+    glUseProgram(depthViewProgram);
+    glUniform1i(glGetUniformLocation(depthViewProgram, "sceneDepth"), 0);
+    glUniform1f(glGetUniformLocation(depthViewProgram, "nearPlane"), NEAR_PLANE);
+    glUniform1f(glGetUniformLocation(depthViewProgram, "farPlane"), FAR_PLANE);
+    glUseProgram(compositeProgram);
+    glUniform1i(glGetUniformLocation(compositeProgram, "sceneColor"), 0);
+    glUniform1i(glGetUniformLocation(compositeProgram, "bloom"), 1);
+    glUniform1i(glGetUniformLocation(compositeProgram, "depthView"), 2);
+    GLint CompositeUseBloom = glGetUniformLocation(compositeProgram, "useBloom");
+    GLint CompositeUseDepthView = glGetUniformLocation(compositeProgram, "useDepthView");
+
+    // Per frame values the pass callbacks read
+    glm::mat4 projection(1.0f), view(1.0f);
+
+    RenderGraph graph;
+
+    // Registers every pass each time the graph is rebuilt (toggles, resize).
+    // Registration order is intentionally not execution order.
+    auto buildGraph = [&]() {
+        graph.reset();
+        const int halfWidth = std::max(SCR_WIDTH / 2, 1), halfHeight = std::max(SCR_HEIGHT / 2, 1);
+        graph.importBackbuffer("backbuffer", SCR_WIDTH, SCR_HEIGHT);
+        graph.createTexture("sceneColor", SCR_WIDTH, SCR_HEIGHT, GL_RGBA16F);
+        graph.createTexture("sceneDepth", SCR_WIDTH, SCR_HEIGHT, GL_DEPTH_COMPONENT24);
+        graph.createTexture("bloomBright", halfWidth, halfHeight, GL_RGBA16F);
+        graph.createTexture("bloomHalf", halfWidth, halfHeight, GL_RGBA16F);
+        graph.createTexture("bloom", halfWidth, halfHeight, GL_RGBA16F);
+        graph.createTexture("depthView", std::max(SCR_WIDTH / 4, 1), std::max(SCR_HEIGHT / 4, 1), GL_RGBA8);
+
+        PassDesc composite;
+        composite.sampled = {"sceneColor"};
+        if (bloomEnabled) composite.sampled.push_back("bloom");
+        if (depthViewEnabled) composite.sampled.push_back("depthView");
+        composite.colorWrites = {"backbuffer"};
+        graph.addPass("Composite", composite, [&]() {
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(compositeProgram);
+            glUniform1i(CompositeUseBloom, bloomEnabled ? 1 : 0);
+            glUniform1i(CompositeUseDepthView, depthViewEnabled ? 1 : 0);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, graph.getTexture("sceneColor"));
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, graph.getTexture("bloom"));
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, graph.getTexture("depthView"));
+            glActiveTexture(GL_TEXTURE0);
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        });
+
+        // Skybox : only depth-tested against what the opaque passes left, never writes depth
+        PassDesc sky;
+        sky.colorModifies = {"sceneColor"};
+        sky.depth = "sceneDepth";
+        sky.depthAccess = DepthRead;
+        graph.addPass("Skybox", sky, [&]() {
+            glEnable(GL_DEPTH_TEST);
+            glDepthMask(GL_FALSE);
+            glDepthFunc(GL_LEQUAL);
+            glUseProgram(ShaderProgramSky);
+            glm::mat4 skyView = glm::mat4(glm::mat3(view)); // remove translation
+            glUniformMatrix4fv(SkyView, 1, GL_FALSE, value_ptr(skyView));
+            glUniformMatrix4fv(SkyProjection, 1, GL_FALSE, value_ptr(projection));
+            glBindVertexArray(skyVAO);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapTex);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glDepthMask(GL_TRUE);
+            glDepthFunc(GL_LESS);
+        });
+
+        PassDesc blurV;
+        blurV.sampled = {"bloomHalf"};
+        blurV.colorWrites = {"bloom"};
+        graph.addPass("BloomBlurV", blurV, [&]() {
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(blurProgram);
+            glUniform2f(BlurDirection, 0.0f, 1.0f);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, graph.getTexture("bloomHalf"));
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        });
+
+        PassDesc opaque;
+        opaque.colorWrites = {"sceneColor"};
+        opaque.depth = "sceneDepth";
+        opaque.depthAccess = DepthWrite;
+        graph.addPass("Opaque", opaque, [&]() {
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LESS);
+            glUseProgram(cubeObjectProgram);
+            glUniform3fv(ViewPosition, 1, value_ptr(camera.Position));
+            glUniformMatrix4fv(LightShaderProjection, 1, GL_FALSE, value_ptr(projection));
+            glUniformMatrix4fv(LightShaderView, 1, GL_FALSE, value_ptr(view));
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, diffuseMap);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, specularMap);
+            glBindVertexArray(cubeVAO);
+            for (unsigned int i = 0; i < 20; i++) {
+                const float angle = 2.0f * i * glfwGetTime();
+                glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+                model = glm::translate(model, cubePositions[i]);
+                glUniformMatrix4fv(LightShaderModel, 1, GL_FALSE, value_ptr(model));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        });
+
+        PassDesc depthView;
+        depthView.sampled = {"sceneDepth"};
+        depthView.colorWrites = {"depthView"};
+        graph.addPass("DepthView", depthView, [&]() {
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(depthViewProgram);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, graph.getTexture("sceneDepth"));
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        });
+
+        PassDesc blurH;
+        blurH.sampled = {"bloomBright"};
+        blurH.colorWrites = {"bloomHalf"};
+        graph.addPass("BloomBlurH", blurH, [&]() {
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(blurProgram);
+            glUniform2f(BlurDirection, 1.0f, 0.0f);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, graph.getTexture("bloomBright"));
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        });
+
+        PassDesc bright;
+        bright.sampled = {"sceneColor"};
+        bright.colorWrites = {"bloomBright"};
+        graph.addPass("BloomBright", bright, [&]() {
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(brightProgram);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, graph.getTexture("sceneColor"));
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        });
+
+        PassDesc lightCube;
+        lightCube.colorModifies = {"sceneColor"};
+        lightCube.depth = "sceneDepth";
+        lightCube.depthAccess = DepthModify;
+        graph.addPass("LightCube", lightCube, [&]() {
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_LESS);
+            glUseProgram(lightCubeProgram);
+            glUniformMatrix4fv(LightCubeProjection, 1, GL_FALSE, value_ptr(projection));
+            glUniformMatrix4fv(LightCubeView, 1, GL_FALSE, value_ptr(view));
+            glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), lightPos), glm::vec3(0.2f));
+            glUniformMatrix4fv(LightCubeModel, 1, GL_FALSE, value_ptr(model));
+            glUniform3fv(LightCubeColor, 1, value_ptr(glm::vec3(4.0f)));
+            glBindVertexArray(lightCubeVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        });
+
+        if (!graph.compile()) {
+            cout << "Render graph : compile failed" << endl;
+        }
+    };
+
+    while (!glfwWindowShouldClose(window)) {
+        float currentFrame = glfwGetTime();
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        ProcessInput(window);
+
+        if (graphDirty) {
+            buildGraph();
+            graphDirty = false;
+        }
+
+        projection = glm::perspective(glm::radians(camera.Zoom), static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT), NEAR_PLANE, FAR_PLANE);
+        view = getCameraViewMatrix(&camera);
+
+        graph.execute();
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    graph.destroy();
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &lightCubeVAO);
+    glDeleteVertexArrays(1, &skyVAO);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &skyVBO);
+    glDeleteProgram(cubeObjectProgram);
+    glDeleteProgram(lightCubeProgram);
+    glDeleteProgram(ShaderProgramSky);
+    glDeleteProgram(brightProgram);
+    glDeleteProgram(blurProgram);
+    glDeleteProgram(depthViewProgram);
+    glDeleteProgram(compositeProgram);
+
+    glfwTerminate();
+    return 0;
+}
+
+void ProcessInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, forwardDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, backwardDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, leftDir, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraProcessKeyboard(&camera, rightDir, deltaTime);
+}
+
+void key_callback(GLFWwindow*, int key, int, int action, int)
+{
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_B) { bloomEnabled = !bloomEnabled; graphDirty = true; }
+    if (key == GLFW_KEY_Z) { depthViewEnabled = !depthViewEnabled; graphDirty = true; }
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int, int)
+{
+    glfwGetFramebufferSize(window, &SCR_WIDTH, &SCR_HEIGHT);
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+    graphDirty = true;
+}
+
+void mouse_callback(GLFWwindow* window, const double xPos, const double yPos)
+{
+    const auto xpos = static_cast<float>(xPos);
+    const auto ypos = static_cast<float>(yPos);
+    if (firstMouse) {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+    float xOffset = xpos - lastX;
+    float yOffset = lastY - ypos; // reversed
+    lastX = xpos;
+    lastY = ypos;
+    cameraProcessMouseMovement(&camera, xOffset, yOffset);
+}
+
+void scroll_callback(GLFWwindow*, double, const double yOffset)
+{
+    cameraProcessMouseScroll(&camera, static_cast<float>(yOffset));
+}
@@ -0,0 +1,497 @@
+// Batched matrix kernels : thousands of mat4 products, point transforms, model matrices built from translation /
+// rotation / scale arrays, and normal matrices, per call, instead of one glm call per object.
+//
+// Each kernel has a scalar, an SSE4.1 and an AVX2 (+ FMA) version. The best one the CPU runs is picked at startup,
+// so the file builds without -mavx2 and still runs on machines without it. Builds that are not x86 (Apple silicon)
+// only have the scalar path, which compilers auto-vectorize reasonably well.
+//   simdMat4MulBatchShared(viewProjection, models, mvps, count);   // mvps[i] = viewProjection * models[i]
+//   simdComposeTRS(transforms, models, count);                      // models[i] = T * R * S
+//   simdNormalMatrixBatch(models, normalMatrices, count);           // mat3(transpose(inverse(models[i])))
+//   simdNormalMatrixUniformScaleBatch(models, normalMatrices, count); // the same without the inverse, uniform scale only
+// simdSetPath() forces a slower path, for comparing them. Outputs must not overlap the inputs.
+//
+// glm stores matrices column major as 16 contiguous floats and that is the layout assumed here.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_MATH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC emits any intrinsic without per-function targets
+#define SIMD_TARGET_SSE41
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+enum SimdPath { SIMD_SCALAR, SIMD_SSE41, SIMD_AVX2 };
+
+/// Translation, rotation and scale of many instances, one array per component
+struct SimdTransformsSoA {
+    const float* positionX;
+    const float* positionY;
+    const float* positionZ;
+    const float* rotationX;   // unit quaternion
+    const float* rotationY;
+    const float* rotationZ;
+    const float* rotationW;
+    const float* scaleX;
+    const float* scaleY;
+    const float* scaleZ;
+};
+
+/// Name of a path, for logs
+inline const char* simdPathName(SimdPath path) {
+    switch (path) {
+        case SIMD_AVX2: return "AVX2";
+        case SIMD_SSE41: return "SSE4.1";
+        default: return "scalar";
+    }
+}
+
+/// Best path this CPU runs
+inline SimdPath simdDetectPath() {
+#ifdef SIMD_MATH_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = info[2] & (1 << 19);
+    const bool fma = info[2] & (1 << 12);
+    // The OS must save the AVX registers
+    const bool osAvx = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && fma && osAvx) {
+        __cpuidex(info, 7, 0);
+        avx2 = info[1] & (1 << 5);
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1");
+    const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    if (avx2) { return SIMD_AVX2; }
+    if (sse41) { return SIMD_SSE41; }
+#endif
+    return SIMD_SCALAR;
+}
+
+inline const SimdPath simdSupportedPath = simdDetectPath();
+inline SimdPath simdPath = simdSupportedPath;
+
+/// Selects the path the kernels use, never one the CPU lacks
+/// @param path Wanted path
+/// @return Path now in use
+inline SimdPath simdSetPath(SimdPath path) {
+    simdPath = std::min(path, simdSupportedPath);
+    return simdPath;
+}
+
+// Scalar kernels ---------------------------------------- (start)
+/// out = a * b for one pair of column major matrices
+inline void simdMat4MulScalar(const float* a, const float* b, float* out) {
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            out[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1]
+                                  + a[8 + row] * b[column * 4 + 2] + a[12 + row] * b[column * 4 + 3];
+        }
+    }
+}
+
+inline void simdMat4MulVec4Scalar(const float* m, const float* v, float* out) {
+    for (int row = 0; row < 4; row++) {
+        out[row] = m[row] * v[0] + m[4 + row] * v[1] + m[8 + row] * v[2] + m[12 + row] * v[3];
+    }
+}
+
+inline void simdComposeTRSScalar(const SimdTransformsSoA& in, float* out, size_t first, size_t end) {
+    for (size_t i = first; i < end; i++) {
+        const float x = in.rotationX[i], y = in.rotationY[i], z = in.rotationZ[i], w = in.rotationW[i];
+        const float sx = in.scaleX[i], sy = in.scaleY[i], sz = in.scaleZ[i];
+        float* m = out + i * 16;
+        m[0] = (1.0f - 2.0f * (y * y + z * z)) * sx;
+        m[1] = 2.0f * (x * y + w * z) * sx;
+        m[2] = 2.0f * (x * z - w * y) * sx;
+        m[3] = 0.0f;
+        m[4] = 2.0f * (x * y - w * z) * sy;
+        m[5] = (1.0f - 2.0f * (x * x + z * z)) * sy;
+        m[6] = 2.0f * (y * z + w * x) * sy;
+        m[7] = 0.0f;
+        m[8] = 2.0f * (x * z + w * y) * sz;
+        m[9] = 2.0f * (y * z - w * x) * sz;
+        m[10] = (1.0f - 2.0f * (x * x + y * y)) * sz;
+        m[11] = 0.0f;
+        m[12] = in.positionX[i];
+        m[13] = in.positionY[i];
+        m[14] = in.positionZ[i];
+        m[15] = 1.0f;
+    }
+}
+
+/// Inverse transpose of the upper 3x3 : with columns a, b, c it is (b x c, c x a, a x b) / det
+inline void simdNormalMatrixScalar(const float* m, float* out) {
+    const float ax = m[0], ay = m[1], az = m[2];
+    const float bx = m[4], by = m[5], bz = m[6];
+    const float cx = m[8], cy = m[9], cz = m[10];
+    const float n0x = by * cz - bz * cy, n0y = bz * cx - bx * cz, n0z = bx * cy - by * cx;
+    const float invDet = 1.0f / (ax * n0x + ay * n0y + az * n0z);
+    out[0] = n0x * invDet;
+    out[1] = n0y * invDet;
+    out[2] = n0z * invDet;
+    out[3] = (cy * az - cz * ay) * invDet;
+    out[4] = (cz * ax - cx * az) * invDet;
+    out[5] = (cx * ay - cy * ax) * invDet;
+    out[6] = (ay * bz - az * by) * invDet;
+    out[7] = (az * bx - ax * bz) * invDet;
+    out[8] = (ax * by - ay * bx) * invDet;
+}
+// Scalar kernels ---------------------------------------- (end)
+
+#ifdef SIMD_MATH_X86
+// SSE4.1 kernels ---------------------------------------- (start)
+/// out[i] = a[i * aStride] * b[i], aStride 0 shares one left matrix
+SIMD_TARGET_SSE41 inline void simdMat4MulBatchSse41(const float* a, size_t aStride, const float* b, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++, a += aStride, b += 16, out += 16) {
+        const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+        for (int column = 0; column < 4; column++) {
+            const __m128 bc = _mm_loadu_ps(b + column * 4);
+            __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, 0x00));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, 0x55)));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, 0xAA)));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, 0xFF)));
+            _mm_storeu_ps(out + column * 4, r);
+        }
+    }
+}
+
+SIMD_TARGET_SSE41 inline void simdMat4MulVec4BatchSse41(const float* m, const float* v, float* out, size_t count) {
+    const __m128 m0 = _mm_loadu_ps(m), m1 = _mm_loadu_ps(m + 4), m2 = _mm_loadu_ps(m + 8), m3 = _mm_loadu_ps(m + 12);
+    for (size_t i = 0; i < count; i++, v += 4, out += 4) {
+        const __m128 p = _mm_loadu_ps(v);
+        __m128 r = _mm_mul_ps(m0, _mm_shuffle_ps(p, p, 0x00));
+        r = _mm_add_ps(r, _mm_mul_ps(m1, _mm_shuffle_ps(p, p, 0x55)));
+        r = _mm_add_ps(r, _mm_mul_ps(m2, _mm_shuffle_ps(p, p, 0xAA)));
+        r = _mm_add_ps(r, _mm_mul_ps(m3, _mm_shuffle_ps(p, p, 0xFF)));
+        _mm_storeu_ps(out, r);
+    }
+}
+
+/// Stores one column of four instances given as x, y, z, w rows
+SIMD_TARGET_SSE41 inline void simdStoreColumnsSse41(__m128 x, __m128 y, __m128 z, __m128 w, float* out, int column) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(out + column * 4, x);
+    _mm_storeu_ps(out + 16 + column * 4, y);
+    _mm_storeu_ps(out + 32 + column * 4, z);
+    _mm_storeu_ps(out + 48 + column * 4, w);
+}
+
+SIMD_TARGET_SSE41 inline void simdComposeTRSSse41(const SimdTransformsSoA& in, float* out, size_t count) {
+    const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_loadu_ps(in.rotationX + i), y = _mm_loadu_ps(in.rotationY + i);
+        const __m128 z = _mm_loadu_ps(in.rotationZ + i), w = _mm_loadu_ps(in.rotationW + i);
+        const __m128 sx = _mm_loadu_ps(in.scaleX + i), sy = _mm_loadu_ps(in.scaleY + i), sz = _mm_loadu_ps(in.scaleZ + i);
+        const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+        float* base = out + i * 16;
+        simdStoreColumnsSse41(_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+                              _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+                              _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx), zero, base, 0);
+        simdStoreColumnsSse41(_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+                              _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+                              _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy), zero, base, 1);
+        simdStoreColumnsSse41(_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+                              _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+                              _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz), zero, base, 2);
+        simdStoreColumnsSse41(_mm_loadu_ps(in.positionX + i), _mm_loadu_ps(in.positionY + i),
+                              _mm_loadu_ps(in.positionZ + i), one, base, 3);
+    }
+    simdComposeTRSScalar(in, out, i, count);
+}
+
+SIMD_TARGET_SSE41 inline void simdNormalMatrixBatchSse41(const float* m, float* out, size_t count) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    alignas(16) float last[4];
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* src = m + i * 16;
+        // Columns a, b, c of four matrices, transposed to one register per component
+        __m128 ax = _mm_loadu_ps(src), ay = _mm_loadu_ps(src + 16), az = _mm_loadu_ps(src + 32), aw = _mm_loadu_ps(src + 48);
+        __m128 bx = _mm_loadu_ps(src + 4), by = _mm_loadu_ps(src + 20), bz = _mm_loadu_ps(src + 36), bw = _mm_loadu_ps(src + 52);
+        __m128 cx = _mm_loadu_ps(src + 8), cy = _mm_loadu_ps(src + 24), cz = _mm_loadu_ps(src + 40), cw = _mm_loadu_ps(src + 56);
+        _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+        _MM_TRANSPOSE4_PS(cx, cy, cz, cw);
+
+        const __m128 n0x = _mm_sub_ps(_mm_mul_ps(by, cz), _mm_mul_ps(bz, cy));
+        const __m128 n0y = _mm_sub_ps(_mm_mul_ps(bz, cx), _mm_mul_ps(bx, cz));
+        const __m128 n0z = _mm_sub_ps(_mm_mul_ps(bx, cy), _mm_mul_ps(by, cx));
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, n0x), _mm_mul_ps(ay, n0y)), _mm_mul_ps(az, n0z));
+        const __m128 invDet = _mm_div_ps(one, det);
+        __m128 n0 = _mm_mul_ps(n0x, invDet), n1 = _mm_mul_ps(n0y, invDet), n2 = _mm_mul_ps(n0z, invDet);
+        __m128 n3 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cy, az), _mm_mul_ps(cz, ay)), invDet);
+        __m128 n4 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cz, ax), _mm_mul_ps(cx, az)), invDet);
+        __m128 n5 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cx, ay), _mm_mul_ps(cy, ax)), invDet);
+        __m128 n6 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)), invDet);
+        __m128 n7 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)), invDet);
+        _mm_store_ps(last, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)), invDet));
+        // Back to one matrix per register : floats 0 - 3 and 4 - 7 of each mat3, the ninth goes on its own.
+        // In order, so no store runs past the matrix it belongs to.
+        _MM_TRANSPOSE4_PS(n0, n1, n2, n3);
+        _MM_TRANSPOSE4_PS(n4, n5, n6, n7);
+        float* dst = out + i * 9;
+        const __m128 low[4] = {n0, n1, n2, n3}, high[4] = {n4, n5, n6, n7};
+        for (int k = 0; k < 4; k++) {
+            _mm_storeu_ps(dst + k * 9, low[k]);
+            _mm_storeu_ps(dst + k * 9 + 4, high[k]);
+            dst[k * 9 + 8] = last[k];
+        }
+    }
+    for (; i < count; i++) { simdNormalMatrixScalar(m + i * 16, out + i * 9); }
+}
+// SSE4.1 kernels ---------------------------------------- (end)
+
+// AVX2 kernels ---------------------------------------- (start)
+/// Two columns per register : each 128-bit half multiplies the left matrix by one column of the right one
+SIMD_TARGET_AVX2 inline void simdMat4MulBatchAvx2(const float* a, size_t aStride, const float* b, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++, a += aStride, b += 16, out += 16) {
+        const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+        const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+        const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+        const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+        for (int column = 0; column < 4; column += 2) {
+            const __m256 bc = _mm256_loadu_ps(b + column * 4);
+            __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(bc, 0x00));
+            r = _mm256_fmadd_ps(a1, _mm256_permute_ps(bc, 0x55), r);
+            r = _mm256_fmadd_ps(a2, _mm256_permute_ps(bc, 0xAA), r);
+            r = _mm256_fmadd_ps(a3, _mm256_permute_ps(bc, 0xFF), r);
+            _mm256_storeu_ps(out + column * 4, r);
+        }
+    }
+}
+
+SIMD_TARGET_AVX2 inline void simdMat4MulVec4BatchAvx2(const float* m, const float* v, float* out, size_t count) {
+    const __m256 m0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m));
+    const __m256 m1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+    const __m256 m2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+    const __m256 m3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m256 p = _mm256_loadu_ps(v + i * 4);
+        __m256 r = _mm256_mul_ps(m0, _mm256_permute_ps(p, 0x00));
+        r = _mm256_fmadd_ps(m1, _mm256_permute_ps(p, 0x55), r);
+        r = _mm256_fmadd_ps(m2, _mm256_permute_ps(p, 0xAA), r);
+        r = _mm256_fmadd_ps(m3, _mm256_permute_ps(p, 0xFF), r);
+        _mm256_storeu_ps(out + i * 4, r);
+    }
+    if (i < count) { simdMat4MulVec4Scalar(m, v + i * 4, out + i * 4); }
+}
+
+/// Stores one column of eight instances given as x, y, z, w rows. The in-lane transpose leaves instances 0 - 3 in
+/// the low halves and 4 - 7 in the high halves.
+SIMD_TARGET_AVX2 inline void simdStoreColumnsAvx2(__m256 x, __m256 y, __m256 z, __m256 w, float* out, int column) {
+    const __m256 t0 = _mm256_unpacklo_ps(x, y), t1 = _mm256_unpackhi_ps(x, y);
+    const __m256 t2 = _mm256_unpacklo_ps(z, w), t3 = _mm256_unpackhi_ps(z, w);
+    const __m256 v[4] = {
+        _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+        _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2))
+    };
+    for (int k = 0; k < 4; k++) {
+        _mm_storeu_ps(out + k * 16 + column * 4, _mm256_castps256_ps128(v[k]));
+        _mm_storeu_ps(out + (k + 4) * 16 + column * 4, _mm256_extractf128_ps(v[k], 1));
+    }
+}
+
+SIMD_TARGET_AVX2 inline void simdComposeTRSAvx2(const SimdTransformsSoA& in, float* out, size_t count) {
+    const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f), zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(in.rotationX + i), y = _mm256_loadu_ps(in.rotationY + i);
+        const __m256 z = _mm256_loadu_ps(in.rotationZ + i), w = _mm256_loadu_ps(in.rotationW + i);
+        const __m256 sx = _mm256_loadu_ps(in.scaleX + i), sy = _mm256_loadu_ps(in.scaleY + i), sz = _mm256_loadu_ps(in.scaleZ + i);
+        const __m256 x2 = _mm256_mul_ps(two, x), y2 = _mm256_mul_ps(two, y), z2 = _mm256_mul_ps(two, z);
+        const __m256 xx = _mm256_mul_ps(x2, x), yy = _mm256_mul_ps(y2, y), zz = _mm256_mul_ps(z2, z);
+        const __m256 xy = _mm256_mul_ps(x2, y), xz = _mm256_mul_ps(x2, z), yz = _mm256_mul_ps(y2, z);
+        const __m256 wx = _mm256_mul_ps(x2, w), wy = _mm256_mul_ps(y2, w), wz = _mm256_mul_ps(z2, w);
+        float* base = out + i * 16;
+        simdStoreColumnsAvx2(_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+                             _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+                             _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), zero, base, 0);
+        simdStoreColumnsAvx2(_mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+                             _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+                             _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), zero, base, 1);
+        simdStoreColumnsAvx2(_mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+                             _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+                             _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero, base, 2);
+        simdStoreColumnsAvx2(_mm256_loadu_ps(in.positionX + i), _mm256_loadu_ps(in.positionY + i),
+                             _mm256_loadu_ps(in.positionZ + i), one, base, 3);
+    }
+    simdComposeTRSScalar(in, out, i, count);
+}
+
+/// Loads one column of eight matrices as one register per component
+SIMD_TARGET_AVX2 inline void simdLoadColumnsAvx2(const float* m, int column, __m256* x, __m256* y, __m256* z) {
+    __m256 r[4];
+    for (int k = 0; k < 4; k++) {
+        r[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(m + k * 16 + column * 4)),
+                                    _mm_loadu_ps(m + (k + 4) * 16 + column * 4), 1);
+    }
+    const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    *x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    *y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    *z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+}
+
+SIMD_TARGET_AVX2 inline void simdNormalMatrixBatchAvx2(const float* m, float* out, size_t count) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    alignas(32) float last[8];
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 ax, ay, az, bx, by, bz, cx, cy, cz;
+        simdLoadColumnsAvx2(m + i * 16, 0, &ax, &ay, &az);
+        simdLoadColumnsAvx2(m + i * 16, 1, &bx, &by, &bz);
+        simdLoadColumnsAvx2(m + i * 16, 2, &cx, &cy, &cz);
+
+        const __m256 n0x = _mm256_fmsub_ps(by, cz, _mm256_mul_ps(bz, cy));
+        const __m256 n0y = _mm256_fmsub_ps(bz, cx, _mm256_mul_ps(bx, cz));
+        const __m256 n0z = _mm256_fmsub_ps(bx, cy, _mm256_mul_ps(by, cx));
+        const __m256 det = _mm256_fmadd_ps(az, n0z, _mm256_fmadd_ps(ay, n0y, _mm256_mul_ps(ax, n0x)));
+        const __m256 invDet = _mm256_div_ps(one, det);
+        __m256 n[8] = {
+            _mm256_mul_ps(n0x, invDet), _mm256_mul_ps(n0y, invDet), _mm256_mul_ps(n0z, invDet),
+            _mm256_mul_ps(_mm256_fmsub_ps(cy, az, _mm256_mul_ps(cz, ay)), invDet),
+            _mm256_mul_ps(_mm256_fmsub_ps(cz, ax, _mm256_mul_ps(cx, az)), invDet),
+            _mm256_mul_ps(_mm256_fmsub_ps(cx, ay, _mm256_mul_ps(cy, ax)), invDet),
+            _mm256_mul_ps(_mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by)), invDet),
+            _mm256_mul_ps(_mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz)), invDet)
+        };
+        _mm256_store_ps(last, _mm256_mul_ps(_mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx)), invDet));
+        // Same in-lane transpose as the loads, low halves hold matrices 0 - 3 and high halves 4 - 7
+        float* dst = out + i * 9;
+        for (int group = 0; group < 2; group++) {
+            const __m256* r = n + group * 4;
+            const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+            const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+            const __m256 v[4] = {
+                _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+                _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2))
+            };
+            for (int k = 0; k < 4; k++) {
+                _mm_storeu_ps(dst + k * 9 + group * 4, _mm256_castps256_ps128(v[k]));
+                _mm_storeu_ps(dst + (k + 4) * 9 + group * 4, _mm256_extractf128_ps(v[k], 1));
+            }
+        }
+        for (int k = 0; k < 8; k++) { dst[k * 9 + 8] = last[k]; }
+    }
+    for (; i < count; i++) { simdNormalMatrixScalar(m + i * 16, out + i * 9); }
+}
+// AVX2 kernels ---------------------------------------- (end)
+#endif
+
+// Batched entry points ---------------------------------------- (start)
+/// out[i] = lhs[i] * rhs[i]
+/// @param lhs Left matrices
+/// @param rhs Right matrices
+/// @param out Products
+/// @param count Number of pairs
+inline void simdMat4MulBatch(const glm::mat4* lhs, const glm::mat4* rhs, glm::mat4* out, size_t count) {
+    if (count == 0) { return; }
+    const float* a = &lhs[0][0][0];
+    const float* b = &rhs[0][0][0];
+    float* o = &out[0][0][0];
+#ifdef SIMD_MATH_X86
+    if (simdPath == SIMD_AVX2) { simdMat4MulBatchAvx2(a, 16, b, o, count); return; }
+    if (simdPath == SIMD_SSE41) { simdMat4MulBatchSse41(a, 16, b, o, count); return; }
+#endif
+    for (size_t i = 0; i < count; i++) { simdMat4MulScalar(a + i * 16, b + i * 16, o + i * 16); }
+}
+
+/// out[i] = lhs * rhs[i], e.g. the view projection times every model matrix
+/// @param lhs Shared left matrix
+/// @param rhs Right matrices
+/// @param out Products
+/// @param count Number of right matrices
+inline void simdMat4MulBatchShared(const glm::mat4& lhs, const glm::mat4* rhs, glm::mat4* out, size_t count) {
+    if (count == 0) { return; }
+    const float* a = &lhs[0][0];
+    const float* b = &rhs[0][0][0];
+    float* o = &out[0][0][0];
+#ifdef SIMD_MATH_X86
+    if (simdPath == SIMD_AVX2) { simdMat4MulBatchAvx2(a, 0, b, o, count); return; }
+    if (simdPath == SIMD_SSE41) { simdMat4MulBatchSse41(a, 0, b, o, count); return; }
+#endif
+    for (size_t i = 0; i < count; i++) { simdMat4MulScalar(a, b + i * 16, o + i * 16); }
+}
+
+/// out[i] = m * in[i]
+/// @param m Matrix
+/// @param in Vectors
+/// @param out Transformed vectors
+/// @param count Number of vectors
+inline void simdMat4MulVec4Batch(const glm::mat4& m, const glm::vec4* in, glm::vec4* out, size_t count) {
+    if (count == 0) { return; }
+    const float* a = &m[0][0];
+    const float* v = &in[0][0];
+    float* o = &out[0][0];
+#ifdef SIMD_MATH_X86
+    if (simdPath == SIMD_AVX2) { simdMat4MulVec4BatchAvx2(a, v, o, count); return; }
+    if (simdPath == SIMD_SSE41) { simdMat4MulVec4BatchSse41(a, v, o, count); return; }
+#endif
+    for (size_t i = 0; i < count; i++) { simdMat4MulVec4Scalar(a, v + i * 4, o + i * 4); }
+}
+
+/// out[i] = translate(position) * mat4_cast(rotation) * scale(scale)
+/// @param in Component arrays, count entries each
+/// @param out Model matrices
+/// @param count Number of instances
+inline void simdComposeTRS(const SimdTransformsSoA& in, glm::mat4* out, size_t count) {
+    if (count == 0) { return; }
+    float* o = &out[0][0][0];
+#ifdef SIMD_MATH_X86
+    if (simdPath == SIMD_AVX2) { simdComposeTRSAvx2(in, o, count); return; }
+    if (simdPath == SIMD_SSE41) { simdComposeTRSSse41(in, o, count); return; }
+#endif
+    simdComposeTRSScalar(in, o, 0, count);
+}
+
+/// out[i] = mat3(transpose(inverse(models[i]))), what normals are transformed by. The matrices must be invertible.
+/// @param models Model matrices
+/// @param out Normal matrices
+/// @param count Number of matrices
+inline void simdNormalMatrixBatch(const glm::mat4* models, glm::mat3* out, size_t count) {
+    if (count == 0) { return; }
+    const float* m = &models[0][0][0];
+    float* o = &out[0][0][0];
+#ifdef SIMD_MATH_X86
+    if (simdPath == SIMD_AVX2) { simdNormalMatrixBatchAvx2(m, o, count); return; }
+    if (simdPath == SIMD_SSE41) { simdNormalMatrixBatchSse41(m, o, count); return; }
+#endif
+    for (size_t i = 0; i < count; i++) { simdNormalMatrixScalar(m + i * 16, o + i * 9); }
+}
+/// Normal matrices for models without non uniform scale. The inverse transpose of s * R is R / s, so this is
+/// mat3(model) / s^2 with s^2 read off the first column, no inverse needed.
+/// @param models Model matrices, rotation, translation and uniform scale only
+/// @param out Normal matrices
+/// @param count Number of matrices
+inline void simdNormalMatrixUniformScaleBatch(const glm::mat4* models, glm::mat3* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const glm::mat4& m = models[i];
+        const float invScale2 = 1.0f / (m[0][0] * m[0][0] + m[0][1] * m[0][1] + m[0][2] * m[0][2]);
+        for (int column = 0; column < 3; column++) {
+            out[i][column] = glm::vec3(m[column][0], m[column][1], m[column][2]) * invScale2;
+        }
+    }
+}
+// Batched entry points ---------------------------------------- (end)
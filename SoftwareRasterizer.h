@@ -0,0 +1,806 @@
+// Software rasterizer : draws the same triangle lists, cameras, materials and point lights as the GL demos on the
+// CPU, for machines without a GPU. A frame runs in four stages :
+//   vertex  one job per draw, positions to clip and world space through SimdMath, normals through the normal matrix
+//   clip    triangles crossing the near plane are cut against it (serial, it appends vertices)
+//   setup   one job per SW_SETUP_CHUNK triangles : barycentric and depth plane equations and pixel bounds, 8 triangles
+//           per AVX2 iteration, then each triangle goes into the bin of every SW_TILE_SIZE square tile it touches
+//   tiles   one job per tile : its triangles are rasterized 8 pixels at a time into a tile sized depth and triangle
+//           id buffer, then every visible pixel is shaded once (Blinn-Phong with attenuation, emissive or the sky)
+// Jobs run on a JobSystem (JobSystem.h), worker threads plus the calling thread. Bins are kept per setup chunk and read back in
+// chunk order, so triangles reach a tile in submission order and the image does not depend on the thread count.
+//
+//   swRendererInit(&renderer, 1920, 1080, threads);
+//   each frame : swRenderFrame(&renderer, draws, drawCount, light, camera);
+//   swWritePpm(&renderer, "frame.ppm");
+//   swRendererShutdown(&renderer);
+//
+// Differences from GL : the mip level is picked once per triangle instead of per pixel quad and levels are not
+// blended (close to GL_LINEAR_MIPMAP_NEAREST), pixel centres on an edge shared by two triangles may be covered by
+// both (the depth test keeps one), there is no blending and nothing beyond the far plane is clipped but the depth test.
+// There are no shadows either, compare against the GL window with its point light shadows off.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <glm/glm.hpp>
+#include "CpuProfiler.h"
+#include "JobSystem.h"
+#include "SimdMath.h"
+
+/// Tile edge in pixels, a multiple of 8 so AVX2 rows never leave the tile
+constexpr int SW_TILE_SIZE = 64;
+/// Triangles per setup job, a multiple of 8
+constexpr int SW_SETUP_CHUNK = 256;
+/// Slack on the barycentric inside test, so a pixel centre on a shared edge is never missed by both triangles
+constexpr float SW_EDGE_EPSILON = 1e-5f;
+/// Triangles with less screen area (in pixels) are dropped at setup
+constexpr float SW_MIN_AREA = 1e-6f;
+/// Triangle id of a pixel no triangle covered
+constexpr uint32_t SW_NO_TRIANGLE = 0xFFFFFFFF;
+
+// Textures ---------------------------------------- (start)
+/// One image or mip level, RGB in [0, 1], row 0 is t = 0 like the data handed to glTexImage2D
+struct SwImage {
+    int width = 0;
+    int height = 0;
+    std::vector<glm::vec3> texels;
+};
+
+/// 2D texture with its mip chain down to 1x1, sampled like GL_REPEAT
+struct SwTexture {
+    std::vector<SwImage> levels;
+    float log2Size = 0.0f;   // half of log2(level 0 texel count), added to a triangle's lod to pick the level
+};
+
+/// Faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X + i order, sampled like GL_CLAMP_TO_EDGE
+struct SwCubeMap {
+    SwImage faces[6];
+};
+
+/// Converts 8 bit pixels as stb_image returns them. One channel goes to red like GL_RED, alpha is dropped.
+/// @param image Receives the texels
+/// @param pixels Pixel data, rows in upload order
+/// @param width Width
+/// @param height Height
+/// @param channels 1, 3 or 4
+inline void swImageFromPixels(SwImage* image, const unsigned char* pixels, int width, int height, int channels) {
+    image->width = width;
+    image->height = height;
+    image->texels.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < image->texels.size(); i++) {
+        const unsigned char* p = pixels + i * channels;
+        image->texels[i] = channels < 3 ? glm::vec3(p[0] / 255.0f, 0.0f, 0.0f) : glm::vec3(p[0], p[1], p[2]) / 255.0f;
+    }
+}
+
+/// Builds level 0 from pixels and the rest by 2x2 box filtering, like glGenerateMipmap
+/// @param texture Receives the levels
+/// @param pixels Pixel data, rows in upload order
+/// @param width Width
+/// @param height Height
+/// @param channels 1, 3 or 4
+inline void swTextureFromPixels(SwTexture* texture, const unsigned char* pixels, int width, int height, int channels) {
+    texture->levels.clear();
+    texture->levels.emplace_back();
+    swImageFromPixels(&texture->levels.back(), pixels, width, height, channels);
+    texture->log2Size = 0.5f * std::log2(static_cast<float>(width) * static_cast<float>(height));
+    while (texture->levels.back().width > 1 || texture->levels.back().height > 1) {
+        const SwImage& src = texture->levels.back();
+        SwImage level;
+        level.width = std::max(src.width / 2, 1);
+        level.height = std::max(src.height / 2, 1);
+        level.texels.resize(static_cast<size_t>(level.width) * level.height);
+        for (int y = 0; y < level.height; y++) {
+            const glm::vec3* row0 = src.texels.data() + static_cast<size_t>(std::min(y * 2, src.height - 1)) * src.width;
+            const glm::vec3* row1 = src.texels.data() + static_cast<size_t>(std::min(y * 2 + 1, src.height - 1)) * src.width;
+            for (int x = 0; x < level.width; x++) {
+                const int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+                level.texels[static_cast<size_t>(y) * level.width + x] = (row0[x0] + row0[x1] + row1[x0] + row1[x1]) * 0.25f;
+            }
+        }
+        texture->levels.push_back(std::move(level));
+    }
+}
+
+/// A 1x1 black texture, what GL samples from a texture whose image failed to load
+/// @param texture Receives the level
+inline void swTextureBlack(SwTexture* texture) {
+    const unsigned char black[3] = {0, 0, 0};
+    swTextureFromPixels(texture, black, 1, 1, 3);
+}
+
+/// Bilinear sample with wrapping
+/// @param image Image
+/// @param u Texture coordinate s
+/// @param v Texture coordinate t
+/// @return RGB
+inline glm::vec3 swSampleRepeat(const SwImage& image, float u, float v) {
+    // Wrapped to [0, 1) first, the texel left of the centre is then at most one off the start
+    const float x = (u - std::floor(u)) * static_cast<float>(image.width) - 0.5f;
+    const float y = (v - std::floor(v)) * static_cast<float>(image.height) - 0.5f;
+    const float floorX = std::floor(x), floorY = std::floor(y);
+    int x0 = static_cast<int>(floorX), y0 = static_cast<int>(floorY);
+    int x1 = x0 + 1, y1 = y0 + 1;
+    if (x0 < 0) { x0 += image.width; }
+    if (y0 < 0) { y0 += image.height; }
+    if (x1 >= image.width) { x1 -= image.width; }
+    if (y1 >= image.height) { y1 -= image.height; }
+    const glm::vec3* row0 = image.texels.data() + static_cast<size_t>(y0) * image.width;
+    const glm::vec3* row1 = image.texels.data() + static_cast<size_t>(y1) * image.width;
+    const float fx = x - floorX, fy = y - floorY;
+    const glm::vec3 top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    const glm::vec3 bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+/// Bilinear sample clamped to the edge texels
+/// @param image Image
+/// @param u Texture coordinate s
+/// @param v Texture coordinate t
+/// @return RGB
+inline glm::vec3 swSampleClamp(const SwImage& image, float u, float v) {
+    const float x = std::clamp(u * static_cast<float>(image.width) - 0.5f, 0.0f, static_cast<float>(image.width - 1));
+    const float y = std::clamp(v * static_cast<float>(image.height) - 0.5f, 0.0f, static_cast<float>(image.height - 1));
+    const int x0 = static_cast<int>(x), y0 = static_cast<int>(y);
+    const int x1 = std::min(x0 + 1, image.width - 1), y1 = std::min(y0 + 1, image.height - 1);
+    const glm::vec3* row0 = image.texels.data() + static_cast<size_t>(y0) * image.width;
+    const glm::vec3* row1 = image.texels.data() + static_cast<size_t>(y1) * image.width;
+    const float fx = x - static_cast<float>(x0), fy = y - static_cast<float>(y0);
+    const glm::vec3 top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    const glm::vec3 bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+/// @param texture Texture
+/// @param texCoords Texture coordinates
+/// @param lod Triangle lod without the texture size, see SwRenderer::triangleLod
+/// @return RGB
+inline glm::vec3 swSampleTexture(const SwTexture& texture, const glm::vec2& texCoords, float lod) {
+    const int level = std::clamp(static_cast<int>(std::floor(lod + texture.log2Size + 0.5f)), 0, static_cast<int>(texture.levels.size()) - 1);
+    return swSampleRepeat(texture.levels[level], texCoords.x, texCoords.y);
+}
+
+/// Picks the face and its coordinates the way GL does for cube map lookups
+/// @param cube Cube map
+/// @param direction Lookup direction, any length
+/// @return RGB, black for a face that failed to load
+inline glm::vec3 swSampleCubeMap(const SwCubeMap& cube, const glm::vec3& direction) {
+    const float ax = std::fabs(direction.x), ay = std::fabs(direction.y), az = std::fabs(direction.z);
+    int face;
+    float sc, tc, ma;
+    if (ax >= ay && ax >= az) {
+        face = direction.x > 0.0f ? 0 : 1;
+        ma = ax;
+        sc = direction.x > 0.0f ? -direction.z : direction.z;
+        tc = -direction.y;
+    } else if (ay >= az) {
+        face = direction.y > 0.0f ? 2 : 3;
+        ma = ay;
+        sc = direction.x;
+        tc = direction.y > 0.0f ? direction.z : -direction.z;
+    } else {
+        face = direction.z > 0.0f ? 4 : 5;
+        ma = az;
+        sc = direction.z > 0.0f ? direction.x : -direction.x;
+        tc = -direction.y;
+    }
+    const SwImage& image = cube.faces[face];
+    if (image.texels.empty()) { return glm::vec3(0.0f); }
+    const float half = 0.5f / ma;
+    return swSampleClamp(image, sc * half + 0.5f, tc * half + 0.5f);
+}
+// Textures ---------------------------------------- (end)
+
+// Scene description ---------------------------------------- (start)
+/// Triangle list with the attributes of the GL demos' vertex buffers
+struct SwMesh {
+    std::vector<glm::vec4> positions;   // w = 1
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+};
+
+/// Fills a mesh from an interleaved vertex array as uploaded to GL : position, normal, tex coords (8 floats)
+/// @param mesh Receives the vertices
+/// @param vertices Vertex data
+/// @param vertexCount Number of vertices, a multiple of 3
+inline void swMeshFromInterleaved(SwMesh* mesh, const float* vertices, int vertexCount) {
+    mesh->positions.resize(vertexCount);
+    mesh->normals.resize(vertexCount);
+    mesh->texCoords.resize(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        const float* v = vertices + i * 8;
+        mesh->positions[i] = glm::vec4(v[0], v[1], v[2], 1.0f);
+        mesh->normals[i] = glm::vec3(v[3], v[4], v[5]);
+        mesh->texCoords[i] = glm::vec2(v[6], v[7]);
+    }
+}
+
+/// Lit with diffuse and specular maps, or a flat emissive color when diffuse is null (like lightCubeFragmentShader)
+struct SwMaterial {
+    const SwTexture* diffuse = nullptr;
+    const SwTexture* specular = nullptr;
+    float shininess = 32.0f;
+    glm::vec3 emissive = glm::vec3(1.0f);
+};
+
+/// Same fields as `struct Light` in the demo shaders
+struct SwPointLight {
+    glm::vec3 position;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SwDraw {
+    const SwMesh* mesh;
+    const SwMaterial* material;
+    glm::mat4 model;
+};
+
+struct SwCamera {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 position;
+    const SwCubeMap* sky = nullptr;          // drawn behind everything, like the skybox pass
+    glm::vec3 clearColor = glm::vec3(0.0f);  // where there is no sky
+};
+// Scene description ---------------------------------------- (end)
+
+// Renderer state ---------------------------------------- (start)
+struct SwRenderer {
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    JobSystem jobs;
+    std::vector<unsigned char> color;   // RGB, rows top to bottom as a PPM stores them
+
+    // Per draw
+    std::vector<glm::mat4> models;
+    std::vector<glm::mat4> mvps;
+    std::vector<glm::mat3> normalMatrices;
+    std::vector<size_t> firstVertex;
+
+    // Vertices after the vertex stage, with the ones made by clipping appended
+    std::vector<glm::vec4> clip;
+    std::vector<glm::vec4> world;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<float> invW;
+
+    // Triangles after clipping, one array per value so setup can load 8 at a time, padded to SW_SETUP_CHUNK
+    std::vector<float> screenX[3];
+    std::vector<float> screenY[3];
+    std::vector<float> screenZ[3];
+    std::vector<uint32_t> triangleVertex[3];
+    std::vector<uint32_t> triangleDraw;
+    std::vector<float> triangleLod;   // half of log2(uv area / pixel area), a texture adds its own size
+    size_t triangleCount = 0;
+
+    // Setup : lambda1 = edge1X * (x - x0) + edge1Y * (y - y0), lambda2 likewise, depth = z0 + depthX * (x - x0) + ...
+    std::vector<float> edge1X, edge1Y, edge2X, edge2Y, depthX, depthY;
+    std::vector<int32_t> minX, minY, maxX, maxY;   // pixel bounds clamped to the frame, max exclusive
+    std::vector<std::vector<uint32_t>> bins;       // [chunk * tile count + tile]
+
+    // Stage times summed since the last swPrintStats
+    double vertexMs = 0.0;
+    double clipMs = 0.0;
+    double setupMs = 0.0;
+    double tileMs = 0.0;
+    unsigned long long binnedTriangles = 0;
+    int frames = 0;
+};
+
+/// @param renderer Renderer
+/// @param width Frame width
+/// @param height Frame height
+/// @param threads Threads to render on, counting the caller (std::thread::hardware_concurrency() for all)
+inline void swRendererInit(SwRenderer* renderer, int width, int height, int threads) {
+    renderer->width = width;
+    renderer->height = height;
+    renderer->tilesX = (width + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+    renderer->tilesY = (height + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+    renderer->color.assign(static_cast<size_t>(width) * height * 3, 0);
+    jobsInit(&renderer->jobs, std::max(threads, 1));
+}
+
+/// @param renderer Renderer
+inline void swRendererShutdown(SwRenderer* renderer) {
+    jobsShutdown(&renderer->jobs);
+}
+// Renderer state ---------------------------------------- (end)
+
+// Clipping and triangle assembly ---------------------------------------- (start)
+/// Appends the vertex a + (b - a) * t
+/// @return Index of the new vertex
+inline uint32_t swLerpVertex(SwRenderer* r, uint32_t a, uint32_t b, float t) {
+    r->clip.push_back(r->clip[a] + (r->clip[b] - r->clip[a]) * t);
+    r->world.push_back(r->world[a] + (r->world[b] - r->world[a]) * t);
+    r->normals.push_back(r->normals[a] + (r->normals[b] - r->normals[a]) * t);
+    r->texCoords.push_back(r->texCoords[a] + (r->texCoords[b] - r->texCoords[a]) * t);
+    return static_cast<uint32_t>(r->clip.size() - 1);
+}
+
+/// Projects a triangle in front of the near plane to the screen and queues it for setup
+inline void swEmitTriangle(SwRenderer* r, const uint32_t* vertex, uint32_t draw) {
+    glm::vec2 screen[3];
+    for (int k = 0; k < 3; k++) {
+        const glm::vec4& c = r->clip[vertex[k]];
+        const float invW = 1.0f / c.w;
+        screen[k] = glm::vec2((c.x * invW * 0.5f + 0.5f) * static_cast<float>(r->width), (0.5f - c.y * invW * 0.5f) * static_cast<float>(r->height));
+        r->screenX[k].push_back(screen[k].x);
+        r->screenY[k].push_back(screen[k].y);
+        r->screenZ[k].push_back(c.z * invW * 0.5f + 0.5f);
+        r->triangleVertex[k].push_back(vertex[k]);
+    }
+    r->triangleDraw.push_back(draw);
+
+    // Texels per pixel over the whole triangle, in place of per pixel derivatives
+    const glm::vec2 uv1 = r->texCoords[vertex[1]] - r->texCoords[vertex[0]], uv2 = r->texCoords[vertex[2]] - r->texCoords[vertex[0]];
+    const glm::vec2 s1 = screen[1] - screen[0], s2 = screen[2] - screen[0];
+    const float uvArea = std::fabs(uv1.x * uv2.y - uv1.y * uv2.x);
+    const float screenArea = std::fabs(s1.x * s2.y - s1.y * s2.x);
+    r->triangleLod.push_back(uvArea > 0.0f && screenArea > 0.0f ? 0.5f * std::log2(uvArea / screenArea) : 0.0f);
+    r->triangleCount++;
+}
+
+/// Cuts every triangle against the near plane (z >= -w in clip space) and queues what is left
+inline void swClipTriangles(SwRenderer* r, int drawCount) {
+    for (int k = 0; k < 3; k++) {
+        r->screenX[k].clear();
+        r->screenY[k].clear();
+        r->screenZ[k].clear();
+        r->triangleVertex[k].clear();
+    }
+    r->triangleDraw.clear();
+    r->triangleLod.clear();
+    r->triangleCount = 0;
+
+    for (int d = 0; d < drawCount; d++) {
+        const size_t end = r->firstVertex[d + 1];
+        for (size_t first = r->firstVertex[d]; first + 2 < end; first += 3) {
+            const uint32_t vertex[3] = {static_cast<uint32_t>(first), static_cast<uint32_t>(first + 1), static_cast<uint32_t>(first + 2)};
+            float distance[3];
+            int inside = 0;
+            for (int k = 0; k < 3; k++) {
+                distance[k] = r->clip[vertex[k]].z + r->clip[vertex[k]].w;
+                inside += distance[k] >= 0.0f ? 1 : 0;
+            }
+            if (inside == 3) {
+                swEmitTriangle(r, vertex, d);
+                continue;
+            }
+            if (inside == 0) { continue; }
+
+            // One plane turns a triangle into at most a quad
+            uint32_t polygon[4];
+            int count = 0;
+            for (int k = 0; k < 3; k++) {
+                const int next = (k + 1) % 3;
+                if (distance[k] >= 0.0f) { polygon[count++] = vertex[k]; }
+                if ((distance[k] >= 0.0f) != (distance[next] >= 0.0f)) {
+                    polygon[count++] = swLerpVertex(r, vertex[k], vertex[next], distance[k] / (distance[k] - distance[next]));
+                }
+            }
+            for (int k = 1; k + 1 < count; k++) {
+                const uint32_t fan[3] = {polygon[0], polygon[k], polygon[k + 1]};
+                swEmitTriangle(r, fan, d);
+            }
+        }
+    }
+
+    // Padding triangles have zero area and fail setup
+    const size_t padded = (r->triangleCount + SW_SETUP_CHUNK - 1) / SW_SETUP_CHUNK * SW_SETUP_CHUNK;
+    for (int k = 0; k < 3; k++) {
+        r->screenX[k].resize(padded, 0.0f);
+        r->screenY[k].resize(padded, 0.0f);
+        r->screenZ[k].resize(padded, 0.0f);
+    }
+    for (std::vector<float>* setup : {&r->edge1X, &r->edge1Y, &r->edge2X, &r->edge2Y, &r->depthX, &r->depthY}) { setup->resize(padded); }
+    for (std::vector<int32_t>* bounds : {&r->minX, &r->minY, &r->maxX, &r->maxY}) { bounds->resize(padded); }
+    r->invW.resize(r->clip.size());
+    for (size_t i = 0; i < r->clip.size(); i++) { r->invW[i] = 1.0f / r->clip[i].w; }
+}
+// Clipping and triangle assembly ---------------------------------------- (end)
+
+// Triangle setup ---------------------------------------- (start)
+// lambda1 is 1 at vertex 1 and 0 on the opposite edge, likewise lambda2, and lambda0 = 1 - lambda1 - lambda2. Taking
+// them relative to vertex 0 keeps the constant terms out, which would lose precision far from the origin.
+
+inline void swSetupTrianglesScalar(SwRenderer* r, size_t first, size_t count) {
+    const float width = static_cast<float>(r->width), height = static_cast<float>(r->height);
+    for (size_t i = first; i < first + count; i++) {
+        const float x0 = r->screenX[0][i], x1 = r->screenX[1][i], x2 = r->screenX[2][i];
+        const float y0 = r->screenY[0][i], y1 = r->screenY[1][i], y2 = r->screenY[2][i];
+        const float area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+        const float invArea = 1.0f / area;
+        r->edge1X[i] = (y2 - y0) * invArea;
+        r->edge1Y[i] = (x0 - x2) * invArea;
+        r->edge2X[i] = (y0 - y1) * invArea;
+        r->edge2Y[i] = (x1 - x0) * invArea;
+        const float dz1 = r->screenZ[1][i] - r->screenZ[0][i], dz2 = r->screenZ[2][i] - r->screenZ[0][i];
+        r->depthX[i] = dz1 * r->edge1X[i] + dz2 * r->edge2X[i];
+        r->depthY[i] = dz1 * r->edge1Y[i] + dz2 * r->edge2Y[i];
+        if (std::fabs(area) <= SW_MIN_AREA) {
+            r->minX[i] = r->minY[i] = r->maxX[i] = r->maxY[i] = 0;
+            continue;
+        }
+        r->minX[i] = static_cast<int32_t>(std::max(std::floor(std::min({x0, x1, x2})), 0.0f));
+        r->minY[i] = static_cast<int32_t>(std::max(std::floor(std::min({y0, y1, y2})), 0.0f));
+        r->maxX[i] = static_cast<int32_t>(std::min(std::ceil(std::max({x0, x1, x2})), width));
+        r->maxY[i] = static_cast<int32_t>(std::min(std::ceil(std::max({y0, y1, y2})), height));
+    }
+}
+
+#ifdef SIMD_MATH_X86
+/// Same as swSetupTrianglesScalar, 8 triangles per iteration
+SIMD_TARGET_AVX2 inline void swSetupTrianglesAvx2(SwRenderer* r, size_t first, size_t count) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 width = _mm256_set1_ps(static_cast<float>(r->width));
+    const __m256 height = _mm256_set1_ps(static_cast<float>(r->height));
+    const __m256 minArea = _mm256_set1_ps(SW_MIN_AREA);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    for (size_t i = first; i < first + count; i += 8) {
+        const __m256 x0 = _mm256_loadu_ps(&r->screenX[0][i]), x1 = _mm256_loadu_ps(&r->screenX[1][i]), x2 = _mm256_loadu_ps(&r->screenX[2][i]);
+        const __m256 y0 = _mm256_loadu_ps(&r->screenY[0][i]), y1 = _mm256_loadu_ps(&r->screenY[1][i]), y2 = _mm256_loadu_ps(&r->screenY[2][i]);
+        const __m256 z0 = _mm256_loadu_ps(&r->screenZ[0][i]);
+        const __m256 dz1 = _mm256_sub_ps(_mm256_loadu_ps(&r->screenZ[1][i]), z0);
+        const __m256 dz2 = _mm256_sub_ps(_mm256_loadu_ps(&r->screenZ[2][i]), z0);
+
+        const __m256 dx1 = _mm256_sub_ps(x1, x0), dx2 = _mm256_sub_ps(x2, x0);
+        const __m256 dy1 = _mm256_sub_ps(y1, y0), dy2 = _mm256_sub_ps(y2, y0);
+        const __m256 area = _mm256_fmsub_ps(dx1, dy2, _mm256_mul_ps(dy1, dx2));
+        const __m256 invArea = _mm256_div_ps(_mm256_set1_ps(1.0f), area);
+        const __m256 edge1X = _mm256_mul_ps(dy2, invArea);
+        const __m256 edge1Y = _mm256_mul_ps(_mm256_sub_ps(zero, dx2), invArea);
+        const __m256 edge2X = _mm256_mul_ps(_mm256_sub_ps(zero, dy1), invArea);
+        const __m256 edge2Y = _mm256_mul_ps(dx1, invArea);
+        _mm256_storeu_ps(&r->edge1X[i], edge1X);
+        _mm256_storeu_ps(&r->edge1Y[i], edge1Y);
+        _mm256_storeu_ps(&r->edge2X[i], edge2X);
+        _mm256_storeu_ps(&r->edge2Y[i], edge2Y);
+        _mm256_storeu_ps(&r->depthX[i], _mm256_fmadd_ps(dz1, edge1X, _mm256_mul_ps(dz2, edge2X)));
+        _mm256_storeu_ps(&r->depthY[i], _mm256_fmadd_ps(dz1, edge1Y, _mm256_mul_ps(dz2, edge2Y)));
+
+        // Degenerate triangles get empty bounds
+        const __m256 degenerate = _mm256_cmp_ps(_mm256_andnot_ps(signMask, area), minArea, _CMP_LE_OQ);
+        __m256 minX = _mm256_max_ps(_mm256_floor_ps(_mm256_min_ps(x0, _mm256_min_ps(x1, x2))), zero);
+        __m256 minY = _mm256_max_ps(_mm256_floor_ps(_mm256_min_ps(y0, _mm256_min_ps(y1, y2))), zero);
+        __m256 maxX = _mm256_min_ps(_mm256_ceil_ps(_mm256_max_ps(x0, _mm256_max_ps(x1, x2))), width);
+        __m256 maxY = _mm256_min_ps(_mm256_ceil_ps(_mm256_max_ps(y0, _mm256_max_ps(y1, y2))), height);
+        minX = _mm256_blendv_ps(minX, zero, degenerate);
+        minY = _mm256_blendv_ps(minY, zero, degenerate);
+        maxX = _mm256_blendv_ps(maxX, zero, degenerate);
+        maxY = _mm256_blendv_ps(maxY, zero, degenerate);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&r->minX[i]), _mm256_cvttps_epi32(minX));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&r->minY[i]), _mm256_cvttps_epi32(minY));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&r->maxX[i]), _mm256_cvttps_epi32(maxX));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&r->maxY[i]), _mm256_cvttps_epi32(maxY));
+    }
+}
+#endif
+
+/// Sets up one chunk of triangles and bins them into the tiles they touch
+/// @param r Renderer
+/// @param chunk Chunk index
+inline void swSetupChunk(SwRenderer* r, int chunk) {
+    const size_t first = static_cast<size_t>(chunk) * SW_SETUP_CHUNK;
+#ifdef SIMD_MATH_X86
+    if (simdPath == SIMD_AVX2) { swSetupTrianglesAvx2(r, first, SW_SETUP_CHUNK); }
+    else { swSetupTrianglesScalar(r, first, SW_SETUP_CHUNK); }
+#else
+    swSetupTrianglesScalar(r, first, SW_SETUP_CHUNK);
+#endif
+
+    const int tileCount = r->tilesX * r->tilesY;
+    std::vector<uint32_t>* bins = r->bins.data() + static_cast<size_t>(chunk) * tileCount;
+    for (int t = 0; t < tileCount; t++) { bins[t].clear(); }
+    const size_t end = std::min(first + SW_SETUP_CHUNK, r->triangleCount);
+    for (size_t i = first; i < end; i++) {
+        if (r->minX[i] >= r->maxX[i] || r->minY[i] >= r->maxY[i]) { continue; }
+        const int tileX0 = r->minX[i] / SW_TILE_SIZE, tileX1 = (r->maxX[i] - 1) / SW_TILE_SIZE;
+        const int tileY0 = r->minY[i] / SW_TILE_SIZE, tileY1 = (r->maxY[i] - 1) / SW_TILE_SIZE;
+        for (int ty = tileY0; ty <= tileY1; ty++) {
+            for (int tx = tileX0; tx <= tileX1; tx++) { bins[ty * r->tilesX + tx].push_back(static_cast<uint32_t>(i)); }
+        }
+    }
+}
+// Triangle setup ---------------------------------------- (end)
+
+// Rasterization ---------------------------------------- (start)
+// Both versions write the nearest triangle's depth and id per pixel of a SW_TILE_SIZE square tile buffer. Pixels are
+// sampled at their centres and kept when nearer than what is there (GL_LESS).
+
+inline void swRasterTriangleScalar(const SwRenderer* r, uint32_t triangle, int tileX, int tileY, float* depth, uint32_t* ids) {
+    const int xBegin = std::max(r->minX[triangle], tileX), xEnd = std::min(r->maxX[triangle], tileX + SW_TILE_SIZE);
+    const int yBegin = std::max(r->minY[triangle], tileY), yEnd = std::min(r->maxY[triangle], tileY + SW_TILE_SIZE);
+    const float x0 = r->screenX[0][triangle], y0 = r->screenY[0][triangle], z0 = r->screenZ[0][triangle];
+    const float edge1X = r->edge1X[triangle], edge1Y = r->edge1Y[triangle];
+    const float edge2X = r->edge2X[triangle], edge2Y = r->edge2Y[triangle];
+    const float depthX = r->depthX[triangle], depthY = r->depthY[triangle];
+    for (int y = yBegin; y < yEnd; y++) {
+        const float py = static_cast<float>(y) + 0.5f - y0;
+        float* depthRow = depth + (y - tileY) * SW_TILE_SIZE - tileX;
+        uint32_t* idRow = ids + (y - tileY) * SW_TILE_SIZE - tileX;
+        for (int x = xBegin; x < xEnd; x++) {
+            const float px = static_cast<float>(x) + 0.5f - x0;
+            const float lambda1 = edge1X * px + edge1Y * py;
+            const float lambda2 = edge2X * px + edge2Y * py;
+            if (lambda1 < -SW_EDGE_EPSILON || lambda2 < -SW_EDGE_EPSILON || 1.0f - lambda1 - lambda2 < -SW_EDGE_EPSILON) { continue; }
+            const float z = z0 + depthX * px + depthY * py;
+            if (z < depthRow[x]) {
+                depthRow[x] = z;
+                idRow[x] = triangle;
+            }
+        }
+    }
+}
+
+#ifdef SIMD_MATH_X86
+/// Same as swRasterTriangleScalar, 8 pixels of a row per iteration. Rows start on a multiple of 8 inside the tile,
+/// pixels left of the bounds are still tested against the edges, so no lane mask is needed.
+SIMD_TARGET_AVX2 inline void swRasterTriangleAvx2(const SwRenderer* r, uint32_t triangle, int tileX, int tileY, float* depth, uint32_t* ids) {
+    const int xBegin = std::max(r->minX[triangle], tileX), xEnd = std::min(r->maxX[triangle], tileX + SW_TILE_SIZE);
+    const int yBegin = std::max(r->minY[triangle], tileY), yEnd = std::min(r->maxY[triangle], tileY + SW_TILE_SIZE);
+    const int xStart = tileX + ((xBegin - tileX) & ~7);
+    const float x0 = r->screenX[0][triangle], y0 = r->screenY[0][triangle];
+    const __m256 edge1X = _mm256_set1_ps(r->edge1X[triangle]), edge1Y = _mm256_set1_ps(r->edge1Y[triangle]);
+    const __m256 edge2X = _mm256_set1_ps(r->edge2X[triangle]), edge2Y = _mm256_set1_ps(r->edge2Y[triangle]);
+    const __m256 depthX = _mm256_set1_ps(r->depthX[triangle]), depthY = _mm256_set1_ps(r->depthY[triangle]);
+    const __m256 z0 = _mm256_set1_ps(r->screenZ[0][triangle]);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minLambda = _mm256_set1_ps(-SW_EDGE_EPSILON);
+    const __m256 laneCentres = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 id = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(triangle)));
+    for (int y = yBegin; y < yEnd; y++) {
+        const __m256 py = _mm256_set1_ps(static_cast<float>(y) + 0.5f - y0);
+        const __m256 rowLambda1 = _mm256_mul_ps(edge1Y, py);
+        const __m256 rowLambda2 = _mm256_mul_ps(edge2Y, py);
+        const __m256 rowDepth = _mm256_fmadd_ps(depthY, py, z0);
+        float* depthRow = depth + (y - tileY) * SW_TILE_SIZE - tileX;
+        uint32_t* idRow = ids + (y - tileY) * SW_TILE_SIZE - tileX;
+        for (int x = xStart; x < xEnd; x += 8) {
+            const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x) - x0), laneCentres);
+            const __m256 lambda1 = _mm256_fmadd_ps(edge1X, px, rowLambda1);
+            const __m256 lambda2 = _mm256_fmadd_ps(edge2X, px, rowLambda2);
+            const __m256 lambda0 = _mm256_sub_ps(_mm256_sub_ps(one, lambda1), lambda2);
+            const __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(lambda1, minLambda, _CMP_GE_OQ), _mm256_cmp_ps(lambda2, minLambda, _CMP_GE_OQ)),
+                                                _mm256_cmp_ps(lambda0, minLambda, _CMP_GE_OQ));
+            if (_mm256_movemask_ps(inside) == 0) { continue; }
+            const __m256 z = _mm256_fmadd_ps(depthX, px, rowDepth);
+            const __m256 oldDepth = _mm256_load_ps(depthRow + x);
+            const __m256 pass = _mm256_and_ps(inside, _mm256_cmp_ps(z, oldDepth, _CMP_LT_OQ));
+            _mm256_store_ps(depthRow + x, _mm256_blendv_ps(oldDepth, z, pass));
+            float* idLanes = reinterpret_cast<float*>(idRow + x);
+            _mm256_store_ps(idLanes, _mm256_blendv_ps(_mm256_load_ps(idLanes), id, pass));
+        }
+    }
+}
+#endif
+// Rasterization ---------------------------------------- (end)
+
+// Shading ---------------------------------------- (start)
+/// pow for the specular term. Whole exponents (the demos use 32 to 512) go by repeated squaring, a handful of
+/// multiplies instead of a log and an exp.
+/// @param base Base, >= 0
+/// @param exponent Exponent
+/// @return base ^ exponent
+inline float swSpecularPow(float base, float exponent) {
+    const int whole = static_cast<int>(exponent);
+    if (static_cast<float>(whole) != exponent || whole < 0 || whole > 4096) { return std::pow(base, exponent); }
+    float result = 1.0f;
+    for (int bits = whole; bits != 0; bits >>= 1) {
+        if (bits & 1) { result *= base; }
+        base *= base;
+        // Stop before denormals, they are very slow and far below one step of an 8 bit channel anyway
+        if (base < 1e-18f) { return 0.0f; }
+    }
+    return result < 1e-30f ? 0.0f : result;
+}
+
+/// C++ port of cubeObjectFragmentShader in LightWithAttenuation.cpp : Blinn-Phong with a diffuse and a specular
+/// map, attenuated with the light's distance
+/// @param light Light
+/// @param material Material with both maps
+/// @param viewPosition Camera position
+/// @param fragPos World position
+/// @param normal Interpolated normal, any length
+/// @param texCoords Texture coordinates
+/// @param lod Triangle lod, see SwRenderer::triangleLod
+/// @return Linear RGB, unclamped
+inline glm::vec3 swShadeBlinnPhong(const SwPointLight& light, const SwMaterial& material, const glm::vec3& viewPosition,
+                                   const glm::vec3& fragPos, const glm::vec3& normal, const glm::vec2& texCoords, float lod) {
+    const glm::vec3 diffuseMap = swSampleTexture(*material.diffuse, texCoords, lod);
+    const glm::vec3 ambient = light.ambient * diffuseMap;
+    const glm::vec3 norm = glm::normalize(normal);
+    const glm::vec3 lightDir = glm::normalize(light.position - fragPos);
+    const float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+    const glm::vec3 diffuse = light.diffuse * diff * diffuseMap;
+    const glm::vec3 viewDir = glm::normalize(viewPosition - fragPos);
+    const glm::vec3 halfwayDir = glm::normalize(lightDir + viewDir);
+    const float spec = swSpecularPow(std::max(glm::dot(norm, halfwayDir), 0.0f), material.shininess);
+    // pow(x, 512) is 0 for most pixels, the map is only read where it shows
+    const glm::vec3 specular = spec > 0.0f ? light.specular * spec * swSampleTexture(*material.specular, texCoords, lod) : glm::vec3(0.0f);
+
+    const float distance = glm::length(light.position - fragPos);
+    const float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+/// Rasterizes one tile, shades its visible pixels and writes them to the color buffer
+/// @param r Renderer
+/// @param tile Tile index, row major
+/// @param chunkCount Setup chunks this frame
+/// @param draws Draws
+/// @param light Light
+/// @param camera Camera
+/// @param skyFromNdc inverse(projection * rotation part of view), takes a far plane point back to a sky direction
+inline void swRenderTile(SwRenderer* r, int tile, int chunkCount, const SwDraw* draws, const SwPointLight& light,
+                         const SwCamera& camera, const glm::mat4& skyFromNdc) {
+    alignas(32) float depth[SW_TILE_SIZE * SW_TILE_SIZE];
+    alignas(32) uint32_t ids[SW_TILE_SIZE * SW_TILE_SIZE];
+    std::fill(depth, depth + SW_TILE_SIZE * SW_TILE_SIZE, 1.0f);
+    std::fill(ids, ids + SW_TILE_SIZE * SW_TILE_SIZE, SW_NO_TRIANGLE);
+
+    const int tileX = (tile % r->tilesX) * SW_TILE_SIZE, tileY = (tile / r->tilesX) * SW_TILE_SIZE;
+    const int tileCount = r->tilesX * r->tilesY;
+#ifdef SIMD_MATH_X86
+    const bool avx2 = simdPath == SIMD_AVX2;
+#endif
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        for (const uint32_t triangle : r->bins[static_cast<size_t>(chunk) * tileCount + tile]) {
+#ifdef SIMD_MATH_X86
+            if (avx2) {
+                swRasterTriangleAvx2(r, triangle, tileX, tileY, depth, ids);
+                continue;
+            }
+#endif
+            swRasterTriangleScalar(r, triangle, tileX, tileY, depth, ids);
+        }
+    }
+
+    const int xEnd = std::min(tileX + SW_TILE_SIZE, r->width), yEnd = std::min(tileY + SW_TILE_SIZE, r->height);
+    // The far plane point (before the divide by w) moves by a fixed step per pixel
+    const glm::vec4 skyStepX = skyFromNdc[0] * (2.0f / static_cast<float>(r->width));
+    const glm::vec4 skyStepY = skyFromNdc[1] * (-2.0f / static_cast<float>(r->height));
+    const glm::vec4 skyOrigin = skyFromNdc[2] + skyFromNdc[3] - skyFromNdc[0] + skyFromNdc[1];   // ndc (-1, 1, 1, 1)
+    for (int y = tileY; y < yEnd; y++) {
+        unsigned char* out = r->color.data() + (static_cast<size_t>(y) * r->width + tileX) * 3;
+        const uint32_t* idRow = ids + (y - tileY) * SW_TILE_SIZE;
+        glm::vec4 sky = skyOrigin + skyStepX * (static_cast<float>(tileX) + 0.5f) + skyStepY * (static_cast<float>(y) + 0.5f);
+        for (int x = tileX; x < xEnd; x++, out += 3, sky += skyStepX) {
+            const uint32_t triangle = idRow[x - tileX];
+            glm::vec3 color = camera.clearColor;
+            if (triangle == SW_NO_TRIANGLE) {
+                // Only the direction matters to the lookup, w just has to be positive
+                if (camera.sky) { color = swSampleCubeMap(*camera.sky, sky.w > 0.0f ? glm::vec3(sky) : -glm::vec3(sky)); }
+            } else {
+                // Screen space barycentrics, then weighted by 1 / w for perspective correct attributes
+                const float px = static_cast<float>(x) + 0.5f - r->screenX[0][triangle];
+                const float py = static_cast<float>(y) + 0.5f - r->screenY[0][triangle];
+                const float lambda1 = r->edge1X[triangle] * px + r->edge1Y[triangle] * py;
+                const float lambda2 = r->edge2X[triangle] * px + r->edge2Y[triangle] * py;
+                const uint32_t v0 = r->triangleVertex[0][triangle], v1 = r->triangleVertex[1][triangle], v2 = r->triangleVertex[2][triangle];
+                const float w0 = (1.0f - lambda1 - lambda2) * r->invW[v0], w1 = lambda1 * r->invW[v1], w2 = lambda2 * r->invW[v2];
+                const float norm = 1.0f / (w0 + w1 + w2);
+                const float b0 = w0 * norm, b1 = w1 * norm, b2 = w2 * norm;
+
+                const SwMaterial& material = *draws[r->triangleDraw[triangle]].material;
+                if (!material.diffuse) {
+                    color = material.emissive;
+                } else {
+                    const glm::vec3 fragPos = glm::vec3(r->world[v0]) * b0 + glm::vec3(r->world[v1]) * b1 + glm::vec3(r->world[v2]) * b2;
+                    const glm::vec3 normal = r->normals[v0] * b0 + r->normals[v1] * b1 + r->normals[v2] * b2;
+                    const glm::vec2 texCoords = r->texCoords[v0] * b0 + r->texCoords[v1] * b1 + r->texCoords[v2] * b2;
+                    color = swShadeBlinnPhong(light, material, camera.position, fragPos, normal, texCoords, r->triangleLod[triangle]);
+                }
+            }
+            for (int c = 0; c < 3; c++) { out[c] = static_cast<unsigned char>(std::clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f); }
+        }
+    }
+}
+// Shading ---------------------------------------- (end)
+
+// Frame ---------------------------------------- (start)
+/// Renders a frame into renderer->color
+/// @param r Renderer
+/// @param draws Draws, in the order GL would submit them
+/// @param drawCount Number of draws
+/// @param light The point light
+/// @param camera Camera
+inline void swRenderFrame(SwRenderer* r, const SwDraw* draws, int drawCount, const SwPointLight& light, const SwCamera& camera) {
+    using Clock = std::chrono::steady_clock;
+    const auto msSince = [](Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+    // Vertex stage
+    CPU_PROFILE_BEGIN("sw vertex");
+    auto start = Clock::now();
+    r->models.resize(drawCount);
+    r->mvps.resize(drawCount);
+    r->normalMatrices.resize(drawCount);
+    r->firstVertex.resize(drawCount + 1);
+    r->firstVertex[0] = 0;
+    for (int d = 0; d < drawCount; d++) {
+        r->models[d] = draws[d].model;
+        r->firstVertex[d + 1] = r->firstVertex[d] + draws[d].mesh->positions.size();
+    }
+    simdMat4MulBatchShared(camera.projection * camera.view, r->models.data(), r->mvps.data(), drawCount);
+    simdNormalMatrixBatch(r->models.data(), r->normalMatrices.data(), drawCount);
+    const size_t vertexCount = r->firstVertex[drawCount];
+    r->clip.resize(vertexCount);
+    r->world.resize(vertexCount);
+    r->normals.resize(vertexCount);
+    r->texCoords.resize(vertexCount);
+    jobsRun(&r->jobs, drawCount, [&](int d) {
+        const SwMesh& mesh = *draws[d].mesh;
+        const size_t first = r->firstVertex[d], count = mesh.positions.size();
+        simdMat4MulVec4Batch(r->mvps[d], mesh.positions.data(), r->clip.data() + first, count);
+        simdMat4MulVec4Batch(r->models[d], mesh.positions.data(), r->world.data() + first, count);
+        for (size_t i = 0; i < count; i++) {
+            r->normals[first + i] = r->normalMatrices[d] * mesh.normals[i];
+            r->texCoords[first + i] = mesh.texCoords[i];
+        }
+    });
+    r->vertexMs += msSince(start);
+    CPU_PROFILE_END();
+
+    CPU_PROFILE_BEGIN("sw clip");
+    start = Clock::now();
+    swClipTriangles(r, drawCount);
+    r->clipMs += msSince(start);
+    CPU_PROFILE_END();
+
+    CPU_PROFILE_BEGIN("sw setup");
+    start = Clock::now();
+    const int tileCount = r->tilesX * r->tilesY;
+    const int chunkCount = static_cast<int>(r->triangleCount + SW_SETUP_CHUNK - 1) / SW_SETUP_CHUNK;
+    if (r->bins.size() < static_cast<size_t>(chunkCount) * tileCount) { r->bins.resize(static_cast<size_t>(chunkCount) * tileCount); }
+    jobsRun(&r->jobs, chunkCount, [&](int chunk) { swSetupChunk(r, chunk); });
+    for (size_t i = 0; i < static_cast<size_t>(chunkCount) * tileCount; i++) { r->binnedTriangles += r->bins[i].size(); }
+    r->setupMs += msSince(start);
+    CPU_PROFILE_END();
+
+    CPU_PROFILE_BEGIN("sw tiles");
+    start = Clock::now();
+    const glm::mat4 skyFromNdc = glm::inverse(camera.projection * glm::mat4(glm::mat3(camera.view)));
+    jobsRun(&r->jobs, tileCount, [&](int tile) { swRenderTile(r, tile, chunkCount, draws, light, camera, skyFromNdc); });
+    r->tileMs += msSince(start);
+    CPU_PROFILE_END();
+    r->frames++;
+}
+
+/// Prints average stage times since the last call and starts over
+/// @param r Renderer
+inline void swPrintStats(SwRenderer* r) {
+    if (r->frames == 0) { return; }
+    const double frames = static_cast<double>(r->frames);
+    const double total = r->vertexMs + r->clipMs + r->setupMs + r->tileMs;
+    std::cout << "Software " << r->width << "x" << r->height << " on " << jobsThreadCount(&r->jobs) << " threads ["
+              << simdPathName(simdPath) << "] : " << total / frames << " ms per frame (vertex " << r->vertexMs / frames
+              << ", clip " << r->clipMs / frames << ", setup " << r->setupMs / frames << ", tiles " << r->tileMs / frames
+              << "), " << static_cast<double>(r->binnedTriangles) / frames << " binned triangles per frame" << std::endl;
+    r->vertexMs = r->clipMs = r->setupMs = r->tileMs = 0.0;
+    r->binnedTriangles = 0;
+    r->frames = 0;
+}
+
+/// Writes the last frame as a binary PPM
+/// @param r Renderer
+/// @param path File path
+/// @return False if the file could not be written
+inline bool swWritePpm(const SwRenderer* r, const char* path) {
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << r->width << " " << r->height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(r->color.data()), static_cast<std::streamsize>(r->color.size()));
+    return static_cast<bool>(out);
+}
+// Frame ---------------------------------------- (end)
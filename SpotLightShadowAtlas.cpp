@@ -0,0 +1,1092 @@
+// Shadow atlas for many spot lights : the MultipleLights cubes on a floor, lit by the camera flashlight and
+// a ring of area spots, all shadowed out of one 4096x4096 depth texture.
+// A quadtree allocator hands each visible light a power-of-two tile sized by its screen coverage.
+// Lights that did not move keep their tile untouched; changed tiles are re-rendered in batches of up to
+// MAX_VIEWPORTS_PER_BATCH, one instanced draw per batch, a geometry shader routing each copy with gl_ViewportIndex.
+//
+// V shows the atlas, M toggles the sweeping spots.
+
+#include <cmath>
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "GpuProfiler.h"
+#include <glm/fwd.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/detail/setup.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+/// Defining Globals variable ---- (start)
+/// Rendering
+constexpr int NUM_CUBES = 64;
+
+/// Camera
+constexpr float CAMERA_SPEED = 4.0f;
+constexpr float MOUSE_SENSITIVITY = 0.1f;
+constexpr float FOV = 45.0f;
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 1000.0f;
+
+/// SpotLight
+constexpr float SPOT_LIGHT_INNER = 15.0f;
+constexpr float SPOT_LIGHT_OUTER = 30.0f;
+/// Camera flashlight + area spots
+constexpr int NUM_SPOT_LIGHTS = 48;
+/// A light contribution below this luminance is treated as zero : bounds each light's range
+constexpr float LUMINANCE_CUTOFF = 0.02f;
+
+/// Shadow atlas
+constexpr int ATLAS_SIZE = 4096;
+constexpr int MIN_TILE_SIZE = 128;
+constexpr int MAX_TILE_SIZE = 1024;
+/// A light granted a smaller tile than it asked for keeps it, and asks again for the bigger one after a release or
+/// at least this often (frames)
+constexpr int ATLAS_RETRY_FRAMES = 30;
+/// Quadtree depth : ATLAS_SIZE down to MIN_TILE_SIZE
+constexpr int ATLAS_LEVELS = 6;
+/// Shadow texels per screen pixel of light coverage
+constexpr float SHADOW_RES_SCALE = 1.0f;
+/// GL guarantees at least 16 viewports
+constexpr int MAX_VIEWPORTS_PER_BATCH = 16;
+constexpr float SHADOW_NEAR = 0.1f;
+/// Texel data per light in the light buffer
+constexpr int LIGHT_TEXELS = 9;
+
+bool bShowAtlas = false;
+bool bSweepSpots = true;
+/// Defining Globals variable ---- (end)
+
+/// Implementing camera ----------- (Start)
+/// Camera Class
+class Camera {
+    public:
+    // public variables
+    // Camera axes : rebuilt everytime yaw and pitch changes
+    glm::vec3 position = glm::vec3(0.0f, 6.0f, 24.0f); // position of the camera
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f); // direction where camera is looking
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f); // perpendicular vector to front and right
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f); // perpendicular to front, directs towards the right of camera
+
+    // Euler angles in degrees.
+    // yaw : rotation left/right around world Y axis (-90 = looking down -Z)
+    // pitch : rotation up/down, clamped to (-89, 89) to avoid gimbal lock
+    float yaw = -90.0f;
+    float pitch = -15.0f;
+
+    // Default constructor — members use in-class initializers above.
+    Camera() { updateVectors(); }
+
+    // Recomputes front/right/up from current yaw and pitch.
+    void updateVectors() {
+        glm::vec3 f;
+        f.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+        f.y = sin(glm::radians(pitch));
+        f.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+        front = glm::normalize(f);
+
+        // right = front × worldUp
+        right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        // up = right × front
+        up = glm::normalize(glm::cross(right, front));
+    }
+
+    // Called every frame with raw mouse delta (pixels moved since last frame).
+    void processMouse(const float deltaX,const float deltaY) {
+        yaw += deltaX * MOUSE_SENSITIVITY;
+        pitch = glm::clamp(pitch + deltaY * MOUSE_SENSITIVITY, -89.0f, 89.0f);
+        updateVectors();
+    }
+
+    // Moves camera position based on input direction and elapsed time.
+    // dir.x : strafe, dir.z : forward, dir.y : world vertical
+    void processKeyboard(const glm::vec3 dir, float deltaTime) {
+        position += glm::normalize(dir.x * right + dir.y * glm::vec3(0.0f, 1.0f, 0.0f) + dir.z * front) * deltaTime * CAMERA_SPEED;
+    }
+
+    // Returns the view matrix for this frame.
+    [[nodiscard]] glm::mat4 getViewMatrix() const {
+        return glm::lookAt(position, position + front, up);
+    }
+
+    // Returns the perspective projection matrix.
+    [[nodiscard]] glm::mat4 getProjectionMatrix(const float aspectRatio) const {
+        return glm::perspective(glm::radians(FOV), aspectRatio, NEAR_PLANE, FAR_PLANE);
+    }
+};
+/// Implementing camera ----------- (End)
+
+/// Implementing shader class --------------------- (start)
+// Shader class wraps an OpenGL shader program (vertex + optional geometry + fragment).
+class Shader {
+    // OpenGL handle to the linked shader program.
+    // 0 = invalid/uninitialized
+    GLuint ProgramID = 0;
+
+    public:
+    // Constructor — compiles the given GLSL stages, links them into a program
+    Shader(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr) {
+        auto compileShader = [](const GLuint s, const char* source) {
+            glShaderSource(s, 1, &source, nullptr);
+            glCompileShader(s);
+            int success; char info[1024];
+            glGetShaderiv(s, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(s, 1024, nullptr, info);
+                std::cout << "Shader Error : " << info << std::endl;
+            }
+        };
+
+        ProgramID = glCreateProgram();
+        const GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        compileShader(vertexShader, vertexSource);
+        compileShader(fragmentShader, fragmentSource);
+        glAttachShader(ProgramID, vertexShader);
+        glAttachShader(ProgramID, fragmentShader);
+        GLuint geometryShader = 0;
+        if (geometrySource) {
+            geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
+            compileShader(geometryShader, geometrySource);
+            glAttachShader(ProgramID, geometryShader);
+        }
+        glLinkProgram(ProgramID);
+        int success; char info[1024];
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ProgramID, 1024, nullptr, info);
+            std::cout << "Shader Error : " << info << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        if (geometryShader) glDeleteShader(geometryShader);
+    }
+
+    // Binds this shader program for all subsequent draw calls.
+    void use() const {
+        glUseProgram(ProgramID);
+    }
+
+    // Sets a 4x4 matrix uniform (model, view, projection matrices).
+    void setMat4 (const char* uniform, const glm::mat4& mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    // Sets an array of 4x4 matrices (one light view-projection per tile in a batch).
+    void setMat4Array(const char* uniform, const glm::mat4* mats, const int count) const {
+        glUniformMatrix4fv(glGetUniformLocation(ProgramID, uniform), count, GL_FALSE, glm::value_ptr(mats[0]));
+    }
+
+    // Sets a vec3 uniform (positions, colors, directions).
+    void setVec3(const char* uniform, const glm::vec3& vec) const {
+        glUniform3fv(glGetUniformLocation(ProgramID, uniform), 1, glm::value_ptr(vec));
+    }
+
+    // Sets a float uniform (shininess, attenuation values, time, etc.).
+    void setFloat(const char* uniform, const float val) const {
+        glUniform1f(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Sets an int uniform (texture unit slots, boolean flags, counts).
+    void setInt(const char* uniform, const int val) const {
+        glUniform1i(glGetUniformLocation(ProgramID, uniform), val);
+    }
+
+    // Destructor — releases the OpenGL program
+    ~Shader() {
+        if (ProgramID != 0) {
+            glDeleteProgram(ProgramID);
+        }
+        ProgramID = 0;
+    }
+};
+
+/// Implementing shader class --------------------- (end)
+
+
+/// Creating procedural texture ------------------ (start)
+class Texture {
+public:
+    // OpenGL texture handle — 0 = invalid/uninitialized
+    GLuint TextureID = 0;
+    Texture() {
+        glGenTextures(1, &TextureID);
+        glBindTexture(GL_TEXTURE_2D, TextureID);
+
+        // Texture dimensions — 256x256 pixels, RGBA.
+        constexpr int size = 256;
+        auto* data = new unsigned char[size * size * 4];
+
+        // Same procedural stripes as MultipleLights.
+        for (int y = 0 ; y < size ; y++) {
+            for (int x = 0 ; x < size ; x++) {
+                const float fx = static_cast<float>(x) / size;
+                const float fy = static_cast<float>(y) / size;
+                float n = sin(fx*20 + fy*10) * 0.5f + 0.5f;
+                const int i = (y * size + x) * 4;
+                data[i+0] = static_cast<unsigned char>((sin(fx * 12 + fy * 8) * 127 + 128) * n);
+                data[i+1] = static_cast<unsigned char>((cos(fx * 10 + fy * 12) * 127 + 128) * (1 - n));
+                data[i+2] = static_cast<unsigned char>(sin(fx * 8 + fy * 15) * 127 + 128);
+                data[i+3] = 255;
+            }
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        delete[] data;
+
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    }
+};
+
+/// Creating procedural texture ------------------ (end)
+
+
+/// Material ------ (start)
+struct Material { glm::vec3 specular; float shininess; };
+
+Material materials[6] = {
+    {{1.0f,1.0f,1.0f}, 32.0f},
+    {{1.0f,1.0f,1.0f}, 64.0f},
+    {{1.0f,1.0f,1.0f}, 128.0f},
+    {{1.0f,1.0f,1.0f}, 256.0f},
+    {{0.9f,0.9f,0.9f}, 512.0f},
+    {{0.4f,0.9f,0.4f}, 1028.0f}
+};
+
+/// Material ------ (end)
+
+
+/// Cube vertex data ------------- (start)
+unsigned int cubeVAO = 0, cubeVBO = 0;
+
+float cubeData[288] = {
+    -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,   0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,   0.5f,-0.5f,-0.5f, 0,0,-1, 1,0,
+     0.5f, 0.5f,-0.5f, 0,0,-1, 1,1,  -0.5f,-0.5f,-0.5f, 0,0,-1, 0,0,  -0.5f, 0.5f,-0.5f, 0,0,-1, 0,1,
+    -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,   0.5f,-0.5f, 0.5f, 0,0, 1, 1,0,   0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,
+     0.5f, 0.5f, 0.5f, 0,0, 1, 1,1,  -0.5f, 0.5f, 0.5f, 0,0, 1, 0,1,  -0.5f,-0.5f, 0.5f, 0,0, 1, 0,0,
+    -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f,-0.5f,-1,0, 0, 1,1,
+    -0.5f,-0.5f,-0.5f,-1,0, 0, 0,1,  -0.5f, 0.5f, 0.5f,-1,0, 0, 1,0,  -0.5f,-0.5f, 0.5f,-1,0, 0, 0,0,
+     0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f,-0.5f, 1,0, 0, 1,1,
+     0.5f,-0.5f,-0.5f, 1,0, 0, 0,1,   0.5f, 0.5f, 0.5f, 1,0, 0, 1,0,   0.5f,-0.5f, 0.5f, 1,0, 0, 0,0,
+    -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,   0.5f,-0.5f,-0.5f, 0,-1,0, 1,1,   0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,
+     0.5f,-0.5f, 0.5f, 0,-1,0, 1,0,  -0.5f,-0.5f, 0.5f, 0,-1,0, 0,0,  -0.5f,-0.5f,-0.5f, 0,-1,0, 0,1,
+    -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,   0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,   0.5f, 0.5f,-0.5f, 0, 1,0, 1,1,
+     0.5f, 0.5f, 0.5f, 0, 1,0, 1,0,  -0.5f, 0.5f,-0.5f, 0, 1,0, 0,1,  -0.5f, 0.5f, 0.5f, 0, 1,0, 0,0
+};
+
+void setupCubeVAO() {
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &cubeVBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeData), cubeData, GL_STATIC_DRAW);
+    // position
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    // normal
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // uv
+    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),reinterpret_cast<void *>(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+
+// Same cube, positions only, plus a model matrix per instance (locations 3-6) for the shadow pass.
+GLuint setupShadowCasterVAO(GLuint instanceBuffer) {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),static_cast<void *>(nullptr));
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<void *>(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glBindVertexArray(0);
+    return vao;
+}
+/// Cube vertex data ------------- (end)
+
+/// Static scene : the atlas only re-renders a tile when its light moves ---- (start)
+struct SceneObject {
+    glm::mat4 model{};
+    int matId;
+
+    SceneObject(glm::vec3 pos, glm::vec3 scale, int mat) : matId(mat) {
+        model = glm::scale(glm::translate(glm::mat4(1.0f), pos), scale);
+    }
+};
+/// Static scene ---- (end)
+
+
+/// Quadtree atlas allocator ---- (start)
+// Complete quadtree over the atlas : node 0 is the whole texture, children of n are 4n+1 .. 4n+4.
+// A node is free, split (some descendant is used) or used (handed out as a tile).
+class ShadowAtlasAllocator {
+public:
+    enum NodeState : unsigned char { FREE, SPLIT, USED };
+
+    struct Tile {
+        int node = -1;
+        int x = 0, y = 0, size = 0;
+    };
+
+    ShadowAtlasAllocator() : states(nodeCount(ATLAS_LEVELS), FREE) {}
+
+    // Returns a tile of exactly `size` texels, or node == -1 when none is left.
+    // Prefers subtrees that are already split so large free blocks stay whole for large requests.
+    Tile allocate(int size) {
+        Tile tile;
+        const int level = levelForSize(size);
+        if (level < 0) return tile;
+        allocateIn(0, 0, 0, 0, ATLAS_SIZE, level, tile);
+        if (tile.node >= 0) usedTexels += static_cast<long long>(size) * size;
+        return tile;
+    }
+
+    void release(const Tile& tile) {
+        if (tile.node < 0) return;
+        usedTexels -= static_cast<long long>(tile.size) * tile.size;
+        int node = tile.node;
+        states[node] = FREE;
+        // Merge upwards while all four siblings are free
+        while (node > 0) {
+            const int parent = (node - 1) / 4;
+            for (int c = 1; c <= 4; c++) {
+                if (states[4 * parent + c] != FREE) return;
+            }
+            states[parent] = FREE;
+            node = parent;
+        }
+    }
+
+    [[nodiscard]] float occupancy() const {
+        return static_cast<float>(usedTexels) / (static_cast<float>(ATLAS_SIZE) * ATLAS_SIZE);
+    }
+
+private:
+    std::vector<NodeState> states;
+    long long usedTexels = 0;
+
+    static int nodeCount(int levels) {
+        int count = 0, perLevel = 1;
+        for (int i = 0; i < levels; i++) { count += perLevel; perLevel *= 4; }
+        return count;
+    }
+
+    static int levelForSize(int size) {
+        int level = 0;
+        for (int s = ATLAS_SIZE; s > size; s /= 2) level++;
+        return (level < ATLAS_LEVELS && (ATLAS_SIZE >> level) == size) ? level : -1;
+    }
+
+    bool allocateIn(int node, int level, int x, int y, int size, int targetLevel, Tile& tile) {
+        if (states[node] == USED) return false;
+        if (level == targetLevel) {
+            if (states[node] != FREE) return false;
+            states[node] = USED;
+            tile.node = node; tile.x = x; tile.y = y; tile.size = size;
+            return true;
+        }
+        const int half = size / 2;
+        const int childX[4] = {x, x + half, x, x + half};
+        const int childY[4] = {y, y, y + half, y + half};
+        // Two sweeps : partially used children first, untouched ones only if that fails
+        for (int sweep = 0; sweep < 2; sweep++) {
+            for (int c = 0; c < 4; c++) {
+                const int child = 4 * node + 1 + c;
+                const bool untouched = states[child] == FREE;
+                if ((sweep == 0) == untouched) continue;
+                if (allocateIn(child, level + 1, childX[c], childY[c], half, targetLevel, tile)) {
+                    states[node] = SPLIT;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+/// Quadtree atlas allocator ---- (end)
+
+
+/// Spot lights ---- (start)
+struct ShadowSpot {
+    glm::vec3 position, dir, color;
+    float innerCutoff, outerCutoff, outerAngle;
+    float constant = 1.0f;
+    float linear = 0.07f;
+    float quadratic = 0.017f;
+    float range = 0.0f;
+
+    // Sweeping spots swing around their rest direction
+    glm::vec3 restDir{};
+    bool sweeping = false;
+    float phase = 0.0f;
+
+    // Atlas state
+    ShadowAtlasAllocator::Tile tile;
+    glm::mat4 lightViewProjection{1.0f};
+    glm::vec3 renderedPos{}, renderedDir{};
+    bool tileRendered = false;
+    // Size asked for when the atlas could only grant a smaller tile, 0 when the tile is what it asked for
+    int deniedSize = 0;
+
+    ShadowSpot(glm::vec3 p, glm::vec3 d, glm::vec3 c, float inner, float outer, float l, float q)
+        : position(p), dir(glm::normalize(d)), color(c), innerCutoff(cos(glm::radians(inner))), outerCutoff(cos(glm::radians(outer))),
+          outerAngle(glm::radians(outer)), linear(l), quadratic(q), restDir(glm::normalize(d)) {
+        const float luminance = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+        const float k = constant - luminance / LUMINANCE_CUTOFF;
+        range = k >= 0.0f ? 1.0f : (-linear + std::sqrt(linear * linear - 4.0f * quadratic * k)) / (2.0f * quadratic);
+    }
+
+    [[nodiscard]] glm::mat4 computeViewProjection() const {
+        const glm::vec3 up = fabs(dir.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        const glm::mat4 projection = glm::perspective(2.0f * outerAngle + glm::radians(2.0f), 1.0f, SHADOW_NEAR, range);
+        return projection * glm::lookAt(position, position + dir, up);
+    }
+};
+
+// Tile edge the light deserves : its cone's bounding sphere projected on screen, rounded to a power of two.
+// Returns 0 when the cone cannot touch the view.
+int requestedTileSize(const ShadowSpot& light, const Camera& cam, const glm::mat4& viewProjection, float screenHeight) {
+    const float halfRange = light.range * 0.5f;
+    const glm::vec3 center = light.position + light.dir * halfRange;
+    const float radius = std::sqrt(halfRange * halfRange + std::pow(light.range * tan(light.outerAngle), 2.0f));
+
+    // Sphere vs view frustum (planes from the rows of the view-projection matrix)
+    const glm::mat4 m = glm::transpose(viewProjection);
+    const glm::vec4 planes[6] = {m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2]};
+    for (const auto& p : planes) {
+        const float len = glm::length(glm::vec3(p));
+        if (glm::dot(glm::vec3(p), center) + p.w < -radius * len) return 0;
+    }
+
+    const float distance = glm::max(glm::length(center - cam.position) - radius, NEAR_PLANE);
+    const float pixelsPerUnit = screenHeight * 0.5f / tan(glm::radians(FOV) * 0.5f);
+    const float coverage = glm::min(2.0f * radius / distance * pixelsPerUnit, screenHeight) * SHADOW_RES_SCALE;
+
+    int size = MIN_TILE_SIZE;
+    while (size < MAX_TILE_SIZE && static_cast<float>(size) < coverage) size *= 2;
+    return size;
+}
+/// Spot lights ---- (end)
+
+
+/// shaders --------- (Start)
+const char* sceneVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model, view, projection;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = aTexCoord;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+// Spot lights come from a texture buffer, LIGHT_TEXELS texels each :
+// 0 position, range   1 direction, outer cos   2 color, inner cos   3 constant, linear, quadratic, has shadow
+// 4 atlas rect (u, v, width, height)   5-8 light view-projection columns
+const char* sceneFragmentShaderSource = R"(
+#version 410 core
+struct Material {
+    vec3 specular;
+    sampler2D diffuseTex;
+    float shininess;
+};
+
+uniform Material material;
+uniform vec3 viewPos;
+uniform samplerBuffer spotData;
+uniform int spotCount;
+uniform sampler2DShadow shadowAtlas;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+out vec4 FragColor;
+
+float attenuate(float distance, float constant, float linear, float quadratic) {
+    return 1.0 / (constant + linear * distance + quadratic * distance * distance);
+}
+
+float rangeWindow(float distance, float radius) {
+    float ratio = distance / radius;
+    float w = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return w * w;
+}
+
+// 2x2 hardware-filtered taps kept half a texel inside the light's tile so neighbours never bleed in
+float atlasShadow(int base, vec3 norm) {
+    vec4 rect = texelFetch(spotData, base + 4);
+    mat4 lightViewProjection = mat4(texelFetch(spotData, base + 5), texelFetch(spotData, base + 6),
+                                    texelFetch(spotData, base + 7), texelFetch(spotData, base + 8));
+    vec4 clip = lightViewProjection * vec4(FragPos + norm * 0.03, 1.0);
+    vec3 coord = clip.xyz / clip.w * 0.5 + 0.5;
+
+    vec2 texel = 1.0 / vec2(textureSize(shadowAtlas, 0));
+    vec2 lo = rect.xy + texel * 1.5, hi = rect.xy + rect.zw - texel * 1.5;
+    vec2 uv = rect.xy + coord.xy * rect.zw;
+    float lit = 0.0;
+    for (int x = 0; x < 2; x++) {
+        for (int y = 0; y < 2; y++) {
+            vec2 tap = clamp(uv + (vec2(x, y) - 0.5) * texel, lo, hi);
+            lit += texture(shadowAtlas, vec3(tap, coord.z - 0.0004));
+        }
+    }
+    return lit * 0.25;
+}
+
+vec3 calSpotLightEffect(int index, vec3 norm, vec3 viewDir) {
+    int base = index * 9;
+    vec4 positionRange = texelFetch(spotData, base);
+    vec4 directionOuter = texelFetch(spotData, base + 1);
+    vec4 colorInner = texelFetch(spotData, base + 2);
+    vec4 attenuationShadow = texelFetch(spotData, base + 3);
+
+    vec3 toLight = positionRange.xyz - FragPos;
+    float distance = length(toLight);
+    if (distance >= positionRange.w) return vec3(0.0);
+    vec3 lightDir = toLight / distance;
+
+    float theta = dot(lightDir, -directionOuter.xyz);
+    float intensity = clamp((theta - directionOuter.w) / (colorInner.w - directionOuter.w), 0.0, 1.0);
+    if (intensity <= 0.0) return vec3(0.0);
+
+    float attenuation = attenuate(distance, attenuationShadow.x, attenuationShadow.y, attenuationShadow.z) * rangeWindow(distance, positionRange.w);
+
+    vec3 ambient = 0.05 * colorInner.rgb;
+
+    float diff    = max(dot(norm, lightDir), 0.0);
+    vec3  diffuse = diff * colorInner.rgb;
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfway), 0.0), material.shininess);
+    vec3 specular = spec * colorInner.rgb * material.specular;
+
+    float shadow = attenuationShadow.w > 0.5 ? atlasShadow(base, norm) : 1.0;
+    return (ambient + (diffuse + specular) * intensity * shadow) * attenuation;
+}
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec4 texColor = texture(material.diffuseTex, TexCoord);
+
+    vec3 result = 0.1 * texColor.rgb;
+    for (int i = 0; i < spotCount; i++) {
+        result += calSpotLightEffect(i, norm, viewDir) * texColor.rgb;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+/// Atlas pass : world-space vertices, the geometry shader copies each triangle to every tile of the batch
+const char* shadowVertexShaderSource = R"(
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
+void main() {
+    gl_Position = aModel * vec4(aPos, 1.0);
+}
+)";
+
+const std::string shadowGeometryShaderSource = std::string(R"(
+#version 410 core
+#define MAX_VIEWPORTS_PER_BATCH )") + std::to_string(MAX_VIEWPORTS_PER_BATCH) + R"(
+layout (triangles, invocations = MAX_VIEWPORTS_PER_BATCH) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+uniform int tileCount;
+uniform mat4 tileViewProjection[MAX_VIEWPORTS_PER_BATCH];
+
+void main() {
+    if (gl_InvocationID >= tileCount) return;
+
+    vec4 clip[3];
+    for (int i = 0; i < 3; i++) clip[i] = tileViewProjection[gl_InvocationID] * gl_in[i].gl_Position;
+
+    // Outside one plane of this light's frustum : nothing to rasterize
+    for (int axis = 0; axis < 3; axis++) {
+        if (clip[0][axis] >  clip[0].w && clip[1][axis] >  clip[1].w && clip[2][axis] >  clip[2].w) return;
+        if (clip[0][axis] < -clip[0].w && clip[1][axis] < -clip[1].w && clip[2][axis] < -clip[2].w) return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        gl_ViewportIndex = gl_InvocationID;
+        gl_Position = clip[i];
+        EmitVertex();
+    }
+    EndPrimitive();
+}
+)";
+
+const char* shadowFragmentShaderSource = R"(
+#version 410 core
+void main() {}
+)";
+
+/// Atlas debug view, bottom-left corner
+const char* atlasDebugVS = R"(
+#version 410 core
+out vec2 uv;
+void main() {
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+const char* atlasDebugFS = R"(
+#version 410 core
+in vec2 uv;
+uniform sampler2D atlas;
+out vec4 FragColor;
+void main() {
+    float d = texture(atlas, uv).r;
+    FragColor = vec4(vec3(pow(d, 8.0)), 1.0);
+})";
+/// shaders --------- (End)
+
+
+/// Global Objects ------ (Start)
+Camera* camera = nullptr;
+Shader* sceneShader = nullptr;
+Shader* shadowShader = nullptr;
+Shader* atlasDebugShader = nullptr;
+Texture* defaultTexture = nullptr;
+
+std::vector<SceneObject> sceneObjects;
+std::vector<ShadowSpot> spotLights;
+ShadowAtlasAllocator atlasAllocator;
+
+int WindowWidth, WindowHeight;
+/// Global Objects ------ (End)
+
+
+/// Callbacks ----- (Start)
+bool firstMouse = true;
+double lastX, lastY;
+
+void mouseCallBack(GLFWwindow* window, double xPos, double yPos) {
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+        return;
+    }
+
+    camera->processMouse(static_cast<float>(xPos - lastX), static_cast<float>(lastY - yPos));
+    lastX = xPos;
+    lastY = yPos;
+}
+
+void frameBufferCallBack(GLFWwindow* window, int, int) {
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+}
+
+void keyCallBack(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    if (key == GLFW_KEY_V) bShowAtlas = !bShowAtlas;
+    if (key == GLFW_KEY_M) bSweepSpots = !bSweepSpots;
+}
+
+void processInput(GLFWwindow* win, float dt){
+    glm::vec3 dir(0);
+    if(glfwGetKey(win,GLFW_KEY_W))          dir.z =  1;
+    if(glfwGetKey(win,GLFW_KEY_S))          dir.z = -1;
+    if(glfwGetKey(win,GLFW_KEY_A))          dir.x = -1;
+    if(glfwGetKey(win,GLFW_KEY_D))          dir.x =  1;
+    if(glfwGetKey(win,GLFW_KEY_SPACE))      dir.y =  1;
+    if(glfwGetKey(win,GLFW_KEY_LEFT_SHIFT)) dir.y = -1;
+    if(glm::length(dir) > 0.0f) camera->processKeyboard(dir, dt);
+    if(glfwGetKey(win,GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(win, true);
+}
+/// Callbacks ----- (End)
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "Spot Light Shadow Atlas", monitor, nullptr);
+    if(!window) {
+        std::cout<<"Failed to create window\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    lastX = static_cast<float>(mode->width) / 2.0f;
+    lastY = static_cast<float>(mode->height) / 2.0f;
+
+    glfwMakeContextCurrent(window);
+
+    if(!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))){
+        std::cout<<"Failed to init GLAD\n"; return -1;
+    }
+
+    glfwGetFramebufferSize(window, &WindowWidth, &WindowHeight);
+    glViewport(0, 0, WindowWidth, WindowHeight);
+
+    glfwSetFramebufferSizeCallback(window, frameBufferCallBack);
+    glfwSetCursorPosCallback(window, mouseCallBack);
+    glfwSetKeyCallback(window, keyCallBack);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    glEnable(GL_DEPTH_TEST);
+
+    setupCubeVAO();
+    defaultTexture = new Texture();
+    sceneShader = new Shader(sceneVertexShaderSource, sceneFragmentShaderSource);
+    shadowShader = new Shader(shadowVertexShaderSource, shadowFragmentShaderSource, shadowGeometryShaderSource.c_str());
+    atlasDebugShader = new Shader(atlasDebugVS, atlasDebugFS);
+    camera = new Camera();
+
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> rPos(-15.0f, 15.0f), rUnit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> rMat(0,4);
+
+    // --- Scene : floor + MultipleLights cubes, static ---
+    sceneObjects.emplace_back(glm::vec3(0.0f, -4.0f, 0.0f), glm::vec3(60.0f, 0.5f, 60.0f), 0);
+    for(int i = 0; i < NUM_CUBES; i++){
+        float scale = 0.6f + (i%5)*0.1f;
+        sceneObjects.emplace_back(glm::vec3(rPos(gen), rPos(gen)*0.3f+1.0f, rPos(gen)), glm::vec3(scale), rMat(gen));
+    }
+
+    // --- Spots : [0] camera flashlight (the MultipleLights cameraLight), the rest on a ring looking inwards and down ---
+    spotLights.emplace_back(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(1.0f), SPOT_LIGHT_INNER, SPOT_LIGHT_OUTER, 0.07f, 0.017f);
+    for (int i = 1; i < NUM_SPOT_LIGHTS; i++) {
+        const float a = static_cast<float>(i) / (NUM_SPOT_LIGHTS - 1) * 2.0f * glm::pi<float>();
+        const float ringRadius = 10.0f + 8.0f * rUnit(gen);
+        const glm::vec3 pos(cos(a) * ringRadius, 6.0f + 3.0f * rUnit(gen), sin(a) * ringRadius);
+        const glm::vec3 target(rPos(gen) * 0.4f, -4.0f, rPos(gen) * 0.4f);
+        const glm::vec3 color = glm::vec3(0.4f) + 0.6f * glm::vec3(rUnit(gen), rUnit(gen), rUnit(gen));
+        ShadowSpot spot(pos, target - pos, color, 12.0f, 22.0f, 0.14f, 0.07f);
+        spot.sweeping = (i % 4 == 0);
+        spot.phase = rUnit(gen) * 6.28f;
+        spotLights.push_back(spot);
+    }
+
+    // --- Atlas : one depth texture, hardware comparison for lighting, a sampler object for the raw debug view ---
+    GLuint atlasTexture;
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, ATLAS_SIZE, ATLAS_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    GLuint rawDepthSampler;
+    glGenSamplers(1, &rawDepthSampler);
+    glSamplerParameteri(rawDepthSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+    glSamplerParameteri(rawDepthSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(rawDepthSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    GLuint atlasFBO;
+    glGenFramebuffers(1, &atlasFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, atlasTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Shadow atlas framebuffer incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Casters never move : instance matrices uploaded once
+    std::vector<glm::mat4> casterModels;
+    for (const auto& obj : sceneObjects) casterModels.push_back(obj.model);
+    GLuint casterInstanceBuffer;
+    glGenBuffers(1, &casterInstanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, casterInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, casterModels.size() * sizeof(glm::mat4), casterModels.data(), GL_STATIC_DRAW);
+    const GLuint casterVAO = setupShadowCasterVAO(casterInstanceBuffer);
+
+    // Light buffer
+    GLuint spotBuffer, spotBufferTex;
+    glGenBuffers(1, &spotBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, spotBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, NUM_SPOT_LIGHTS * LIGHT_TEXELS * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, &spotBufferTex);
+    glBindTexture(GL_TEXTURE_BUFFER, spotBufferTex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, spotBuffer);
+    std::vector<glm::vec4> spotTexels(NUM_SPOT_LIGHTS * LIGHT_TEXELS);
+
+    GLuint emptyVAO;
+    glGenVertexArrays(1, &emptyVAO);
+
+    sceneShader->use();
+    sceneShader->setInt("material.diffuseTex", 0);
+    sceneShader->setInt("shadowAtlas", 1);
+    sceneShader->setInt("spotData", 2);
+    atlasDebugShader->use();
+    atlasDebugShader->setInt("atlas", 1);
+
+    // Atlas pass time, read back PROFILER_FRAMES later so it never stalls
+    GpuProfiler gpuProfiler;
+    profilerInit(&gpuProfiler);
+    int tilesRendered = 0, batchesDrawn = 0, unshadowedLights = 0;
+
+    float sweepTime = 0.0f;
+    int frameIndex = 0;
+    auto lastTime = std::chrono::high_resolution_clock::now();
+    double lastStatsTime = glfwGetTime();
+    int statsFrames = 0;
+
+    while (!glfwWindowShouldClose(window)) {
+        const float dt = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastTime).count();
+        lastTime = std::chrono::high_resolution_clock::now();
+        processInput(window, dt);
+
+        // --- Animate lights ---
+        spotLights[0].position = camera->position;
+        spotLights[0].dir = camera->front;
+        if (bSweepSpots) sweepTime += dt;
+        for (auto& spot : spotLights) {
+            if (!spot.sweeping) continue;
+            const float swing = 0.35f * sin(sweepTime * 0.8f + spot.phase);
+            spot.dir = glm::normalize(spot.restDir + glm::vec3(cos(spot.phase) * swing, 0.0f, sin(spot.phase) * swing));
+        }
+
+        const float aspect = static_cast<float>(WindowWidth) / static_cast<float>(WindowHeight);
+        const glm::mat4 proj = camera->getProjectionMatrix(aspect);
+        const glm::mat4 view = camera->getViewMatrix();
+
+        // --- Atlas allocation : keep tiles that still fit, free and re-request the rest, biggest requests first ---
+        std::vector<std::pair<int, int>> requests; // (size, light)
+        std::vector<int> upgrades;                 // lights holding a smaller tile than they want
+        bool released = false;
+        for (int i = 0; i < NUM_SPOT_LIGHTS; i++) {
+            ShadowSpot& spot = spotLights[i];
+            int wanted = requestedTileSize(spot, *camera, proj * view, static_cast<float>(WindowHeight));
+            // One level of hysteresis downwards so lights near a size boundary do not thrash
+            if (spot.tile.node >= 0 && wanted > 0 && wanted < spot.tile.size && wanted * 2 >= spot.tile.size) wanted = spot.tile.size;
+            if (spot.tile.node >= 0 && wanted == spot.tile.size) {
+                spot.deniedSize = 0;
+                continue;
+            }
+            // Already turned down once : keep the smaller tile instead of releasing and redrawing it every frame
+            if (spot.tile.node >= 0 && wanted > spot.tile.size && spot.deniedSize > 0) {
+                spot.deniedSize = wanted;
+                upgrades.push_back(i);
+                continue;
+            }
+
+            released = released || spot.tile.node >= 0;
+            atlasAllocator.release(spot.tile);
+            spot.tile = ShadowAtlasAllocator::Tile();
+            spot.tileRendered = false;
+            spot.deniedSize = 0;
+            if (wanted > 0) requests.emplace_back(wanted, i);
+        }
+        std::sort(requests.begin(), requests.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (const auto& [size, index] : requests) {
+            // Atlas full : step down until something fits, else the light goes unshadowed this frame
+            ShadowSpot& spot = spotLights[index];
+            for (int s = size; s >= MIN_TILE_SIZE && spot.tile.node < 0; s /= 2) {
+                spot.tile = atlasAllocator.allocate(s);
+            }
+            if (spot.tile.node < 0) unshadowedLights++;
+            else if (spot.tile.size < size) spot.deniedSize = size;
+        }
+        // Smaller tiles try for the size they want once space was freed, or every ATLAS_RETRY_FRAMES. The old tile is
+        // only given back once a bigger one is in hand, so a still full atlas costs no redraw.
+        if (released || frameIndex % ATLAS_RETRY_FRAMES == 0) {
+            for (int index : upgrades) {
+                ShadowSpot& spot = spotLights[index];
+                ShadowAtlasAllocator::Tile bigger;
+                for (int s = spot.deniedSize; s > spot.tile.size && bigger.node < 0; s /= 2) {
+                    bigger = atlasAllocator.allocate(s);
+                }
+                if (bigger.node < 0) continue;
+                if (bigger.size == spot.deniedSize) spot.deniedSize = 0;
+                atlasAllocator.release(spot.tile);
+                spot.tile = bigger;
+                spot.tileRendered = false;
+            }
+        }
+        frameIndex++;
+
+        // --- Changed tiles : new tile, or the light moved / turned since it was drawn ---
+        std::vector<int> dirty;
+        for (int i = 0; i < NUM_SPOT_LIGHTS; i++) {
+            ShadowSpot& spot = spotLights[i];
+            if (spot.tile.node < 0) continue;
+            if (spot.tileRendered && spot.renderedPos == spot.position && spot.renderedDir == spot.dir) continue;
+            spot.lightViewProjection = spot.computeViewProjection();
+            spot.renderedPos = spot.position;
+            spot.renderedDir = spot.dir;
+            spot.tileRendered = true;
+            dirty.push_back(i);
+        }
+
+        // --- Atlas pass : batches of up to MAX_VIEWPORTS_PER_BATCH tiles, one instanced draw each ---
+        profilerBeginFrame(&gpuProfiler);
+        if (!dirty.empty()) {
+            profilerPush(&gpuProfiler, "atlas");
+
+            glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+            glEnable(GL_SCISSOR_TEST);
+            shadowShader->use();
+            glBindVertexArray(casterVAO);
+
+            for (size_t first = 0; first < dirty.size(); first += MAX_VIEWPORTS_PER_BATCH) {
+                const int count = static_cast<int>(std::min<size_t>(MAX_VIEWPORTS_PER_BATCH, dirty.size() - first));
+                glm::mat4 matrices[MAX_VIEWPORTS_PER_BATCH];
+
+                for (int t = 0; t < count; t++) {
+                    const ShadowSpot& spot = spotLights[dirty[first + t]];
+                    const auto& tile = spot.tile;
+                    // Clear just this tile : glClear follows the scissor box of viewport 0
+                    glScissorIndexed(0, tile.x, tile.y, tile.size, tile.size);
+                    glClear(GL_DEPTH_BUFFER_BIT);
+                    matrices[t] = spot.lightViewProjection;
+                }
+                for (int t = 0; t < count; t++) {
+                    const auto& tile = spotLights[dirty[first + t]].tile;
+                    glViewportIndexedf(t, static_cast<float>(tile.x), static_cast<float>(tile.y), static_cast<float>(tile.size), static_cast<float>(tile.size));
+                    glScissorIndexed(t, tile.x, tile.y, tile.size, tile.size);
+                }
+
+                shadowShader->setInt("tileCount", count);
+                shadowShader->setMat4Array("tileViewProjection", matrices, count);
+                glDrawArraysInstanced(GL_TRIANGLES, 0, 36, static_cast<GLsizei>(casterModels.size()));
+                batchesDrawn++;
+            }
+
+            glDisable(GL_SCISSOR_TEST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, WindowWidth, WindowHeight);
+
+            profilerPop(&gpuProfiler);
+            tilesRendered += static_cast<int>(dirty.size());
+        }
+        profilerEndFrame(&gpuProfiler);
+
+        // --- Light buffer ---
+        for (int i = 0; i < NUM_SPOT_LIGHTS; i++) {
+            const ShadowSpot& spot = spotLights[i];
+            glm::vec4* t = &spotTexels[i * LIGHT_TEXELS];
+            const bool shadowed = spot.tile.node >= 0;
+            t[0] = glm::vec4(spot.position, spot.range);
+            t[1] = glm::vec4(spot.dir, spot.outerCutoff);
+            t[2] = glm::vec4(spot.color, spot.innerCutoff);
+            t[3] = glm::vec4(spot.constant, spot.linear, spot.quadratic, shadowed ? 1.0f : 0.0f);
+            t[4] = glm::vec4(spot.tile.x, spot.tile.y, spot.tile.size, spot.tile.size) / static_cast<float>(ATLAS_SIZE);
+            for (int c = 0; c < 4; c++) t[5 + c] = spot.lightViewProjection[c];
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, spotBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, spotTexels.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, spotTexels.size() * sizeof(glm::vec4), spotTexels.data());
+
+        // --- Scene ---
+        glClearColor(0.04f, 0.04f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        sceneShader->use();
+        sceneShader->setMat4("projection", proj);
+        sceneShader->setMat4("view", view);
+        sceneShader->setVec3("viewPos", camera->position);
+        sceneShader->setInt("spotCount", NUM_SPOT_LIGHTS);
+
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_BUFFER, spotBufferTex);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, defaultTexture->TextureID);
+
+        glBindVertexArray(cubeVAO);
+        for(auto& obj : sceneObjects){
+            sceneShader->setMat4 ("model", obj.model);
+            sceneShader->setVec3 ("material.specular", materials[obj.matId].specular);
+            sceneShader->setFloat("material.shininess", materials[obj.matId].shininess);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+        if (bShowAtlas) {
+            const int side = WindowHeight / 3;
+            glViewport(0, 0, side, side);
+            glDisable(GL_DEPTH_TEST);
+            glBindSampler(1, rawDepthSampler);
+            atlasDebugShader->use();
+            glBindVertexArray(emptyVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindSampler(1, 0);
+            glEnable(GL_DEPTH_TEST);
+            glViewport(0, 0, WindowWidth, WindowHeight);
+        }
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+        // --- Atlas stats, every ~2 seconds ---
+        statsFrames++;
+        if (glfwGetTime() - lastStatsTime >= 2.0) {
+            int tiles = 0;
+            for (const auto& spot : spotLights) tiles += spot.tile.node >= 0 ? 1 : 0;
+            const GpuScopeStats* atlasStats = profilerFindStats(&gpuProfiler, "atlas");
+            std::cout << "Atlas " << static_cast<int>(atlasAllocator.occupancy() * 100.0f) << "% used, " << tiles << " tiles"
+                      << " | re-rendered " << static_cast<float>(tilesRendered) / statsFrames << " tiles/frame in "
+                      << static_cast<float>(batchesDrawn) / statsFrames << " batches"
+                      << " | " << (atlasStats ? atlasStats->averageMs : 0.0) << " ms/pass"
+                      << " | unshadowed " << static_cast<float>(unshadowedLights) / statsFrames << " lights/frame" << std::endl;
+            tilesRendered = batchesDrawn = unshadowedLights = 0;
+            statsFrames = 0;
+            lastStatsTime = glfwGetTime();
+        }
+    }
+
+    profilerDestroy(&gpuProfiler);
+    glDeleteFramebuffers(1, &atlasFBO);
+    glDeleteSamplers(1, &rawDepthSampler);
+    glDeleteTextures(1, &atlasTexture);
+    glDeleteTextures(1, &spotBufferTex);
+    glDeleteBuffers(1, &spotBuffer);
+    glDeleteBuffers(1, &casterInstanceBuffer);
+    glDeleteVertexArrays(1, &casterVAO);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteBuffers(1, &cubeVBO);
+    delete sceneShader;
+    delete shadowShader;
+    delete atlasDebugShader;
+    delete defaultTexture;
+    delete camera;
+    glfwTerminate();
+    return 0;
+}